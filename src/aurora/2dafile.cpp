@@ -52,89 +52,53 @@ static const uint32_t kVersion2b = MKTAG('V', '2', '.', 'b');
 
 namespace Aurora {
 
-TwoDARow::TwoDARow(TwoDAFile &parent) : _parent(&parent) {
+TwoDARow::TwoDARow(const TwoDAFile &parent, size_t index) : _parent(&parent), _index(index) {
 }
 
 TwoDARow::~TwoDARow() {
 }
 
 const Common::UString &TwoDARow::getString(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultString;
-
-	return cell;
+	return _parent->getString(_index, column);
 }
 
 const Common::UString &TwoDARow::getString(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultString;
-
-	return cell;
+	return _parent->getString(_index, _parent->headerToColumn(column));
 }
 
 int32_t TwoDARow::getInt(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultInt;
-
-	return _parent->parseInt(cell);
+	return _parent->getInt(_index, column);
 }
 
 int32_t TwoDARow::getInt(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultInt;
-
-	return _parent->parseInt(cell);
+	return _parent->getInt(_index, _parent->headerToColumn(column));
 }
 
 float TwoDARow::getFloat(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultFloat;
-
-	return _parent->parseFloat(cell);
+	return _parent->getFloat(_index, column);
 }
 
 float TwoDARow::getFloat(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultFloat;
-
-	return _parent->parseFloat(cell);
+	return _parent->getFloat(_index, _parent->headerToColumn(column));
 }
 
 bool TwoDARow::empty(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return true;
-
-	return false;
+	return _parent->isEmpty(_index, column);
 }
 
 bool TwoDARow::empty(const Common::UString &column) const {
 	return empty(_parent->headerToColumn(column));
 }
 
-static const Common::UString kEmpty;
-const Common::UString &TwoDARow::getCell(size_t n) const {
-	if (n >= _data.size())
-		return kEmpty;
-
-	return _data[n];
-}
-
 
 TwoDAFile::TwoDAFile(Common::SeekableReadStream &twoda) :
-	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this) {
+	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this, SIZE_MAX) {
 
 	load(twoda);
 }
 
 TwoDAFile::TwoDAFile(const GDAFile &gda) :
-	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this) {
+	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this, SIZE_MAX) {
 
 	load(gda);
 }
@@ -161,6 +125,8 @@ void TwoDAFile::load(Common::SeekableReadStream &twoda) {
 		else if (_version == kVersion2b)
 			read2b(twoda); // Binary
 
+		finishColumns();
+
 		// Create the map to quickly translate headers to column indices
 		createHeaderMap();
 
@@ -224,6 +190,8 @@ void TwoDAFile::readHeaders2a(Common::SeekableReadStream &twoda,
 		tokenize.nextChunk(twoda);
 
 	tokenize.nextChunk(twoda);
+
+	createColumns();
 }
 
 void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
@@ -233,9 +201,9 @@ void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
 
 	const size_t columnCount = _headers.size();
 
-	while (!twoda.eos()) {
-		std::unique_ptr<TwoDARow> row(new TwoDARow(*this));
+	std::vector<Common::UString> cells;
 
+	while (!twoda.eos()) {
 		/* Skip the first token, which is the row index, possibly indented.
 		 * The row index is implicit in the data and its use in the 2DA
 		 * file is only meant as a guideline for people editing the file by
@@ -244,7 +212,8 @@ void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
 		tokenize.skipToken(twoda);
 
 		// Read all the cells in the row
-		size_t count = tokenize.getTokens(twoda, row->_data, columnCount, columnCount, "****");
+		cells.clear();
+		size_t count = tokenize.getTokens(twoda, cells, columnCount, columnCount, "****");
 
 		// And move to the next line
 		tokenize.nextChunk(twoda);
@@ -253,7 +222,7 @@ void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
 		if (count == 0)
 			continue;
 
-		_rows.emplace_back(std::move(row));
+		addRow(cells);
 	}
 }
 
@@ -272,6 +241,8 @@ void TwoDAFile::readHeaders2b(Common::SeekableReadStream &twoda) {
 
 		header = tokenize.getToken(twoda);
 	}
+
+	createColumns();
 }
 
 void TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
@@ -282,7 +253,10 @@ void TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
 	 */
 
 	const uint32_t rowCount = twoda.readUint32LE();
+
 	_rows.resize(rowCount);
+	for (size_t i = 0; i < rowCount; i++)
+		_rows[i].reset(new TwoDARow(*this, i));
 
 	Common::StreamTokenizer tokenize(Common::StreamTokenizer::kRuleHeed);
 
@@ -318,19 +292,28 @@ void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda) {
 
 	const size_t dataOffset = twoda.pos();
 
-	for (size_t i = 0; i < rowCount; i++) {
-		_rows[i].reset(new TwoDARow(*this));
+	// Cells sharing a data offset share a string, so only read each offset once
+	std::unordered_map<uint32_t, uint32_t> offsetStrings;
 
-		_rows[i]->_data.resize(columnCount);
+	for (size_t j = 0; j < columnCount; j++)
+		_columns[j]->cells.resize(rowCount);
 
+	for (size_t i = 0; i < rowCount; i++) {
 		for (size_t j = 0; j < columnCount; j++) {
-			const size_t offset = dataOffset + offsets[i * columnCount + j];
+			const uint32_t offset = offsets[i * columnCount + j];
+
+			std::unordered_map<uint32_t, uint32_t>::const_iterator string = offsetStrings.find(offset);
+			if (string == offsetStrings.end()) {
+				twoda.seek(dataOffset + offset);
 
-			twoda.seek(offset);
+				Common::UString cell = tokenize.getToken(twoda);
+				if (cell.empty())
+					cell = "****";
 
-			_rows[i]->_data[j] = tokenize.getToken(twoda);
-			if (_rows[i]->_data[j].empty())
-				_rows[i]->_data[j] = "****";
+				string = offsetStrings.insert(std::make_pair(offset, addString(cell))).first;
+			}
+
+			_columns[j]->cells[i] = string->second;
 		}
 	}
 }
@@ -340,6 +323,45 @@ void TwoDAFile::createHeaderMap() {
 		_headerMap.insert(std::make_pair(_headers[i], i));
 }
 
+void TwoDAFile::createColumns() {
+	_columns.resize(_headers.size());
+	for (size_t i = 0; i < _columns.size(); i++)
+		_columns[i] = std::make_unique<Column>();
+}
+
+uint32_t TwoDAFile::addString(const Common::UString &str) {
+	std::pair<StringMap::iterator, bool> string = _stringMap.insert(std::make_pair(str, (uint32_t) _strings.size()));
+	if (string.second)
+		_strings.push_back(str);
+
+	return string.first->second;
+}
+
+void TwoDAFile::addRow(const std::vector<Common::UString> &cells) {
+	assert(cells.size() == _columns.size());
+
+	_rows.emplace_back(new TwoDARow(*this, _rows.size()));
+
+	for (size_t i = 0; i < cells.size(); i++)
+		_columns[i]->cells.push_back(addString(cells[i]));
+}
+
+void TwoDAFile::finishColumns() {
+	// Mark the empty cells in each column
+	for (std::vector<std::unique_ptr<Column>>::iterator c = _columns.begin(); c != _columns.end(); ++c) {
+		Column &column = **c;
+
+		column.nulls.resize((column.cells.size() + 63) / 64, 0);
+
+		for (size_t i = 0; i < column.cells.size(); i++)
+			if (isEmpty(_strings[column.cells[i]]))
+				column.nulls[i / 64] |= UINT64_C(1) << (i % 64);
+	}
+
+	// We don't need to look up strings anymore
+	StringMap().swap(_stringMap);
+}
+
 void TwoDAFile::load(const GDAFile &gda) {
 	try {
 
@@ -353,31 +375,33 @@ void TwoDAFile::load(const GDAFile &gda) {
 			_headers[i] = headerString ? headerString : Common::String::format("[%u]", headers[i].hash);
 		}
 
-		_rows.resize(gda.getRowCount());
+		createColumns();
+
+		std::vector<Common::UString> cells(gda.getColumnCount());
+
 		for (size_t i = 0; i < gda.getRowCount(); i++) {
 			const GFF4Struct *row = gda.getRow(i);
 
-			_rows[i].reset(new TwoDARow(*this));
-			_rows[i]->_data.resize(gda.getColumnCount());
-
 			for (size_t j = 0; j < gda.getColumnCount(); j++) {
+				cells[j].clear();
+
 				if (row) {
 					switch (headers[j].type) {
 						case GDAFile::kTypeString:
 						case GDAFile::kTypeResource:
-							_rows[i]->_data[j] = row->getString(headers[j].field);
+							cells[j] = row->getString(headers[j].field);
 							break;
 
 						case GDAFile::kTypeInt:
-							_rows[i]->_data[j] = Common::String::format("%d", (int) row->getSint(headers[j].field));
+							cells[j] = Common::String::format("%d", (int) row->getSint(headers[j].field));
 							break;
 
 						case GDAFile::kTypeFloat:
-							_rows[i]->_data[j] = Common::String::format("%f", row->getDouble(headers[j].field));
+							cells[j] = Common::String::format("%f", row->getDouble(headers[j].field));
 							break;
 
 						case GDAFile::kTypeBool:
-							_rows[i]->_data[j] = Common::String::format("%u", (uint) row->getUint(headers[j].field));
+							cells[j] = Common::String::format("%u", (uint) row->getUint(headers[j].field));
 							break;
 
 						default:
@@ -385,12 +409,16 @@ void TwoDAFile::load(const GDAFile &gda) {
 					}
 				}
 
-				if (_rows[i]->_data[j].empty())
-					_rows[i]->_data[j] = "****";
+				if (cells[j].empty())
+					cells[j] = "****";
 
 			}
+
+			addRow(cells);
 		}
 
+		finishColumns();
+
 	} catch (Common::Exception &e) {
 		e.add("Failed reading GDA file");
 		throw;
@@ -430,16 +458,25 @@ const TwoDARow &TwoDAFile::getRow(size_t row) const {
 
 const TwoDARow &TwoDAFile::getRow(const Common::UString &header, const Common::UString &value) const {
 	size_t columnIndex = headerToColumn(header);
-	if (columnIndex == kFieldIDInvalid)
+	if ((columnIndex == kFieldIDInvalid) || (columnIndex >= _columns.size()))
 		return _emptyRow;
 
-	for (auto &row : _rows) {
-		if (row->getString(columnIndex).equalsIgnoreCase(value))
-			return *row.get();
-	}
+	const Column &column = *_columns[columnIndex];
+
+	std::call_once(column.indexed, [this, &column, columnIndex]() {
+		column.rows.reserve(_rows.size());
 
-	// No such row
-	return _emptyRow;
+		// Only the first row with a certain value is indexed
+		for (size_t i = 0; i < _rows.size(); i++)
+			column.rows.insert(std::make_pair(getString(i, columnIndex), i));
+	});
+
+	RowMap::const_iterator row = column.rows.find(value);
+	if (row == column.rows.end())
+		// No such row
+		return _emptyRow;
+
+	return *_rows[row->second].get();
 }
 
 void TwoDAFile::writeASCII(Common::WriteStream &out) const {
@@ -462,9 +499,9 @@ void TwoDAFile::writeASCII(Common::WriteStream &out) const {
 		colLength[i + 1] = _headers[i].size();
 
 	for (size_t i = 0; i < _rows.size(); i++) {
-		for (size_t j = 0; j < _rows[i]->_data.size(); j++) {
-			const bool   needQuote = _rows[i]->_data[j].contains(' ');
-			const size_t length    = needQuote ? _rows[i]->_data[j].size() + 2 : _rows[i]->_data[j].size();
+		for (size_t j = 0; j < _columns.size(); j++) {
+			const bool   needQuote = getCell(i, j).contains(' ');
+			const size_t length    = needQuote ? getCell(i, j).size() + 2 : getCell(i, j).size();
 
 			colLength[j + 1] = MAX<size_t>(colLength[j + 1], length);
 		}
@@ -484,14 +521,14 @@ void TwoDAFile::writeASCII(Common::WriteStream &out) const {
 	for (size_t i = 0; i < _rows.size(); i++) {
 		out.writeString(Common::String::format("%*u", (int)colLength[0], (uint)i));
 
-		for (size_t j = 0; j < _rows[i]->_data.size(); j++) {
-			const bool needQuote = _rows[i]->_data[j].contains(' ');
+		for (size_t j = 0; j < _columns.size(); j++) {
+			const bool needQuote = getCell(i, j).contains(' ');
 
 			Common::UString cellString;
 			if (needQuote)
-				cellString = Common::String::format("\"%s\"", _rows[i]->_data[j].c_str());
+				cellString = Common::String::format("\"%s\"", getCell(i, j).c_str());
 			else
-				cellString = _rows[i]->_data[j];
+				cellString = getCell(i, j);
 
 			out.writeString(Common::String::format(" %-*s", (int)colLength[j + 1], cellString.c_str()));
 
@@ -643,19 +680,19 @@ void TwoDAFile::writeCSV(Common::WriteStream &out) const {
 	// Write array
 
 	for (size_t i = 0; i < _rows.size(); i++) {
-		for (size_t j = 0; j < _rows[i]->_data.size(); j++) {
-			const bool needQuote = _rows[i]->_data[j].contains(',');
+		for (size_t j = 0; j < _columns.size(); j++) {
+			const bool needQuote = getCell(i, j).contains(',');
 
 			if (needQuote)
 				out.writeByte('"');
 
-			if (_rows[i]->_data[j] != "****")
-				out.writeString(_rows[i]->_data[j]);
+			if (getCell(i, j) != "****")
+				out.writeString(getCell(i, j));
 
 			if (needQuote)
 				out.writeByte('"');
 
-			if (j < (_rows[i]->_data.size() - 1))
+			if (j < (_columns.size() - 1))
 				out.writeByte(',');
 		}
 
@@ -676,6 +713,67 @@ bool TwoDAFile::writeCSV(const Common::UString &fileName) const {
 	return true;
 }
 
+const Common::UString &TwoDAFile::getCell(size_t row, size_t column) const {
+	static const Common::UString kEmpty;
+
+	if ((row >= _rows.size()) || (column >= _columns.size()))
+		return kEmpty;
+
+	return _strings[_columns[column]->cells[row]];
+}
+
+bool TwoDAFile::isEmpty(size_t row, size_t column) const {
+	if ((row >= _rows.size()) || (column >= _columns.size()))
+		return true;
+
+	return (_columns[column]->nulls[row / 64] & (UINT64_C(1) << (row % 64))) != 0;
+}
+
+const Common::UString &TwoDAFile::getString(size_t row, size_t column) const {
+	if (isEmpty(row, column))
+		return _defaultString;
+
+	return _strings[_columns[column]->cells[row]];
+}
+
+int32_t TwoDAFile::getInt(size_t row, size_t column) const {
+	if ((row >= _rows.size()) || (column >= _columns.size()))
+		return _defaultInt;
+
+	const Column &c = *_columns[column];
+
+	// Parse the whole column the first time it's read as ints
+	std::call_once(c.intsParsed, [this, &c, column]() {
+		c.ints.resize(c.cells.size());
+
+		for (size_t i = 0; i < c.cells.size(); i++)
+			c.ints[i] = isEmpty(i, column) ? _defaultInt : parseInt(_strings[c.cells[i]]);
+	});
+
+	return c.ints[row];
+}
+
+float TwoDAFile::getFloat(size_t row, size_t column) const {
+	if ((row >= _rows.size()) || (column >= _columns.size()))
+		return _defaultFloat;
+
+	const Column &c = *_columns[column];
+
+	// Parse the whole column the first time it's read as floats
+	std::call_once(c.floatsParsed, [this, &c, column]() {
+		c.floats.resize(c.cells.size());
+
+		for (size_t i = 0; i < c.cells.size(); i++)
+			c.floats[i] = isEmpty(i, column) ? _defaultFloat : parseFloat(_strings[c.cells[i]]);
+	});
+
+	return c.floats[row];
+}
+
+bool TwoDAFile::isEmpty(const Common::UString &str) {
+	return str.empty() || (str == "****");
+}
+
 int32_t TwoDAFile::parseInt(const Common::UString &str) {
 	if (str.empty())
 		return 0;
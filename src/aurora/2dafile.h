@@ -27,7 +27,8 @@
 
 #include <memory>
 #include <vector>
-#include <map>
+#include <unordered_map>
+#include <mutex>
 
 #include <boost/noncopyable.hpp>
 
@@ -56,6 +57,9 @@ class GDAFile;
  *  For convenience's sake, there are also methods to directly parse
  *  the cell strings into integer or floating point values.
  *
+ *  A row does not hold any data itself. It is only a view into the
+ *  columns of its parent 2DA.
+ *
  *  See also class TwoDAFile.
  */
 class TwoDARow : boost::noncopyable {
@@ -83,13 +87,10 @@ public:
 	bool empty(const Common::UString &column) const;
 
 private:
-	TwoDAFile *_parent; ///< The parent 2DA.
-
-	std::vector<Common::UString> _data;
+	const TwoDAFile *_parent; ///< The parent 2DA.
+	size_t _index; ///< The index of this row within the parent 2DA.
 
-	TwoDARow(TwoDAFile &parent);
-
-	const Common::UString &getCell(size_t n) const;
+	TwoDARow(const TwoDAFile &parent, size_t index);
 
 	friend class TwoDAFile;
 };
@@ -117,6 +118,11 @@ private:
  *  be read and modified with a simple text editor. The binary
  *  version cannot.
  *
+ *  Internally, the cells are stored by column, as indices into a
+ *  pool of distinct cell strings. The first time a column is read
+ *  as ints or floats, the whole column is parsed once, so that all
+ *  further reads of it are just a lookup into an array.
+ *
  *  See also classes TwoDARow and TwoDARegistry.
  */
 class TwoDAFile : boost::noncopyable, public AuroraFile {
@@ -140,7 +146,12 @@ public:
 	/** Get a row. */
 	const TwoDARow &getRow(size_t row) const;
 
-	/** Get a row whose value in the column named header is the given string value. */
+	/** Get a row whose value in the column named header is the given string value.
+	 *
+	 *  The comparison is case-insensitive. If several rows match, the first one is
+	 *  returned. The first lookup in a column creates a hash index over the column,
+	 *  so all further lookups in it are cheap.
+	 */
 	const TwoDARow &getRow(const Common::UString &header, const Common::UString &value) const;
 
 	// .--- 2DA file writers
@@ -161,7 +172,26 @@ public:
 	// '---
 
 private:
-	typedef std::map<Common::UString, size_t, Common::UString::iless> HeaderMap;
+	typedef std::unordered_map<Common::UString, size_t, Common::hashUStringCaseInsensitive,
+	                           Common::equalsUStringInsensitive> HeaderMap;
+	typedef std::unordered_map<Common::UString, uint32_t, Common::hashUStringCaseSensitive> StringMap;
+	typedef std::unordered_map<Common::UString, size_t, Common::hashUStringCaseInsensitive,
+	                           Common::equalsUStringInsensitive> RowMap;
+
+	/** A column of cells. */
+	struct Column {
+		std::vector<uint32_t> cells; ///< The cells, as indices into the string pool.
+		std::vector<uint64_t> nulls; ///< Bitmap of the cells that are empty.
+
+		mutable std::once_flag intsParsed;   ///< Have the cells been parsed as ints yet?
+		mutable std::once_flag floatsParsed; ///< Have the cells been parsed as floats yet?
+
+		mutable std::vector<int32_t> ints;  ///< The cells parsed as ints, empty cells set to the default.
+		mutable std::vector<float>  floats; ///< The cells parsed as floats, empty cells set to the default.
+
+		mutable std::once_flag indexed; ///< Has the row index been created yet?
+		mutable RowMap rows;            ///< Index of the first row for each cell string.
+	};
 
 	Common::UString _defaultString; ///< The default string to return should a cell not exist.
 	int32_t         _defaultInt;    ///< The default int to return should a cell not exist.
@@ -173,6 +203,12 @@ private:
 	TwoDARow _emptyRow;
 	std::vector<std::unique_ptr<TwoDARow>> _rows;
 
+	std::vector<Common::UString> _strings; ///< The pool of all distinct cell strings.
+	std::vector<std::unique_ptr<Column>> _columns;
+
+	/** Maps cell strings to their index in the pool. Only used while loading. */
+	StringMap _stringMap;
+
 	// Loading helpers
 	void load(Common::SeekableReadStream &twoda);
 	void read2a(Common::SeekableReadStream &twoda);
@@ -193,6 +229,22 @@ private:
 
 	void createHeaderMap();
 
+	// Columnar storage helpers
+	void createColumns();
+	uint32_t addString(const Common::UString &str);
+	void addRow(const std::vector<Common::UString> &cells);
+	void finishColumns();
+
+	// Cell access, for TwoDARow
+	const Common::UString &getCell(size_t row, size_t column) const;
+	bool isEmpty(size_t row, size_t column) const;
+
+	const Common::UString &getString(size_t row, size_t column) const;
+	int32_t getInt(size_t row, size_t column) const;
+	float getFloat(size_t row, size_t column) const;
+
+	static bool isEmpty(const Common::UString &str);
+
 	static int32_t parseInt(const Common::UString &str);
 	static float parseFloat(const Common::UString &str);
 
@@ -22,8 +22,14 @@
  *  The global 2DA registry.
  */
 
+#include <thread>
+#include <chrono>
+#include <exception>
+
+#include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/readstream.h"
+#include "src/common/thread.h"
 
 #include "src/aurora/2dareg.h"
 #include "src/aurora/types.h"
@@ -35,7 +41,25 @@ DECLARE_SINGLETON(Aurora::TwoDARegistry)
 
 namespace Aurora {
 
+/** The maximum number of threads parsing tables in warmup(). */
+static const size_t kMaxWarmupThreads = 8;
+
+struct TwoDARegistry::WarmupJob {
+	Common::UString name;
+	bool isGDA { false };
+
+	std::unique_ptr<Common::SeekableReadStream> stream; ///< The opened table resource.
+
+	std::unique_ptr<TwoDAFile> twoda; ///< The parsed 2DA.
+	std::unique_ptr<GDAFile>   gda;   ///< The parsed GDA.
+
+	TableStats stats;
+	std::exception_ptr error; ///< The reason the parsing failed.
+};
+
+
 TwoDARegistry::TwoDARegistry() {
+	clear();
 }
 
 TwoDARegistry::~TwoDARegistry() {
@@ -43,92 +67,344 @@ TwoDARegistry::~TwoDARegistry() {
 }
 
 void TwoDARegistry::clear() {
-	_twodas.clear();
-	_gdas.clear();
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	publish(std::make_shared<const Tables>());
+
+	_stats = Stats();
+}
+
+std::shared_ptr<const TwoDARegistry::Tables> TwoDARegistry::getTables() const {
+	return std::atomic_load(&_tables);
+}
+
+void TwoDARegistry::publish(std::shared_ptr<const Tables> tables) {
+	// The old snapshot, and the tables only it references, go away with its last reader
+	std::atomic_store(&_tables, std::move(tables));
 }
 
 const TwoDAFile &TwoDARegistry::get2DA(const Common::UString &name) {
-	TwoDAMap::const_iterator twoda = _twodas.find(name);
-	if (twoda != _twodas.end())
+	const std::shared_ptr<const Tables> tables = getTables();
+
+	TwoDAMap::const_iterator twoda = tables->twodas.find(name);
+	if (twoda != tables->twodas.end())
 		// Entry exists => return
 		return *twoda->second;
 
 	// Entry doesn't exist => load and add
-	std::unique_ptr<TwoDAFile> new2DA = load2DA(name);
-	return *(_twodas[name] = std::move(new2DA));
+	std::lock_guard<std::mutex> lock(_mutex);
+	return *findOrLoad2DA(name);
 }
 
 const GDAFile &TwoDARegistry::getGDA(const Common::UString &name) {
-	GDAMap::const_iterator gda = _gdas.find(name);
-	if (gda != _gdas.end())
+	const std::shared_ptr<const Tables> tables = getTables();
+
+	GDAMap::const_iterator gda = tables->gdas.find(name);
+	if (gda != tables->gdas.end())
 		// Entry exists => return
 		return *gda->second;
 
 	// Entry doesn't exist => load and add
-	std::unique_ptr<GDAFile> newGDA = loadGDA(name);
-	return *(_gdas[name] = std::move(newGDA));
+	std::lock_guard<std::mutex> lock(_mutex);
+	return *findOrLoadGDA(name, false);
 }
 
 const GDAFile &TwoDARegistry::getMGDA(const Common::UString &prefix) {
-	GDAMap::const_iterator gda = _gdas.find(prefix);
-	if (gda != _gdas.end())
+	const std::shared_ptr<const Tables> tables = getTables();
+
+	GDAMap::const_iterator gda = tables->gdas.find(prefix);
+	if (gda != tables->gdas.end())
 		// Entry exists => return
 		return *gda->second;
 
 	// Entry doesn't exist => load and add
-	std::unique_ptr<GDAFile> newGDA = loadMGDA(prefix);
-	return *(_gdas[prefix] = std::move(newGDA));
+	std::lock_guard<std::mutex> lock(_mutex);
+	return *findOrLoadGDA(prefix, true);
+}
+
+std::shared_ptr<const TwoDAFile> TwoDARegistry::get2DAShared(const Common::UString &name) {
+	const std::shared_ptr<const Tables> tables = getTables();
+
+	TwoDAMap::const_iterator twoda = tables->twodas.find(name);
+	if (twoda != tables->twodas.end())
+		return twoda->second;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	return findOrLoad2DA(name);
+}
+
+std::shared_ptr<const GDAFile> TwoDARegistry::getGDAShared(const Common::UString &name) {
+	const std::shared_ptr<const Tables> tables = getTables();
+
+	GDAMap::const_iterator gda = tables->gdas.find(name);
+	if (gda != tables->gdas.end())
+		return gda->second;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	return findOrLoadGDA(name, false);
+}
+
+std::shared_ptr<const TwoDAFile> TwoDARegistry::findOrLoad2DA(const Common::UString &name) {
+	// Another thread might have loaded the 2DA while we were waiting for the lock
+	const std::shared_ptr<const Tables> tables = getTables();
+
+	TwoDAMap::const_iterator twoda = tables->twodas.find(name);
+	if (twoda != tables->twodas.end())
+		return twoda->second;
+
+	TableStats stats;
+	std::shared_ptr<const TwoDAFile> new2DA = load2DA(name, stats);
+
+	std::unique_ptr<Tables> newTables = std::make_unique<Tables>(*tables);
+	newTables->twodas[name] = new2DA;
+
+	publish(std::move(newTables));
+
+	_stats.twodas[name] = stats;
+
+	return new2DA;
+}
+
+std::shared_ptr<const GDAFile> TwoDARegistry::findOrLoadGDA(const Common::UString &name, bool multiple) {
+	// Another thread might have loaded the GDA while we were waiting for the lock
+	const std::shared_ptr<const Tables> tables = getTables();
+
+	GDAMap::const_iterator gda = tables->gdas.find(name);
+	if (gda != tables->gdas.end())
+		return gda->second;
+
+	TableStats stats;
+	std::shared_ptr<const GDAFile> newGDA = multiple ? loadMGDA(name, stats) : loadGDA(name, stats);
+
+	std::unique_ptr<Tables> newTables = std::make_unique<Tables>(*tables);
+	newTables->gdas[name] = newGDA;
+
+	publish(std::move(newTables));
+
+	_stats.gdas[name] = stats;
+
+	return newGDA;
 }
 
 void TwoDARegistry::add2DA(const Common::UString &name) {
-	TwoDAMap::iterator twoda = _twodas.find(name);
-	if (twoda != _twodas.end())
-		// Entry exists => remove first
-		_twodas.erase(twoda);
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	// Load and add, replacing an existing entry
+	TableStats stats;
+	std::shared_ptr<const TwoDAFile> new2DA = load2DA(name, stats);
+
+	std::unique_ptr<Tables> newTables = std::make_unique<Tables>(*getTables());
+	newTables->twodas[name] = new2DA;
 
-	// Load and add
-	_twodas[name] = load2DA(name);
+	publish(std::move(newTables));
+
+	_stats.twodas[name] = stats;
 }
 
 void TwoDARegistry::remove2DA(const Common::UString &name) {
-	TwoDAMap::iterator twoda = _twodas.find(name);
-	if (twoda == _twodas.end())
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	const std::shared_ptr<const Tables> tables = getTables();
+	if (tables->twodas.find(name) == tables->twodas.end())
 		// Doesn't exist, nothing to do
 		return;
 
-	_twodas.erase(twoda);
+	std::unique_ptr<Tables> newTables = std::make_unique<Tables>(*tables);
+	newTables->twodas.erase(name);
+
+	publish(std::move(newTables));
+
+	_stats.twodas.erase(name);
 }
 
 void TwoDARegistry::addGDA(const Common::UString &name) {
-	GDAMap::iterator gda = _gdas.find(name);
-	if (gda != _gdas.end())
-		// Entry exists => remove first
-		_gdas.erase(gda);
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	// Load and add, replacing an existing entry
+	TableStats stats;
+	std::shared_ptr<const GDAFile> newGDA = loadGDA(name, stats);
+
+	std::unique_ptr<Tables> newTables = std::make_unique<Tables>(*getTables());
+	newTables->gdas[name] = newGDA;
+
+	publish(std::move(newTables));
 
-	// Load and add
-	_gdas[name] = loadGDA(name);
+	_stats.gdas[name] = stats;
 }
 
 void TwoDARegistry::addMGDA(const Common::UString &prefix) {
-	GDAMap::iterator gda = _gdas.find(prefix);
-	if (gda != _gdas.end())
-		// Entry exists => remove first
-		_gdas.erase(gda);
+	std::lock_guard<std::mutex> lock(_mutex);
 
-	// Load and add
-	_gdas[prefix] = loadMGDA(prefix);
+	// Load and add, replacing an existing entry
+	TableStats stats;
+	std::shared_ptr<const GDAFile> newGDA = loadMGDA(prefix, stats);
+
+	std::unique_ptr<Tables> newTables = std::make_unique<Tables>(*getTables());
+	newTables->gdas[prefix] = newGDA;
+
+	publish(std::move(newTables));
+
+	_stats.gdas[prefix] = stats;
 }
 
 void TwoDARegistry::removeGDA(const Common::UString &name) {
-	GDAMap::iterator gda = _gdas.find(name);
-	if (gda == _gdas.end())
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	const std::shared_ptr<const Tables> tables = getTables();
+	if (tables->gdas.find(name) == tables->gdas.end())
 		// Doesn't exist, nothing to do
 		return;
 
-	_gdas.erase(gda);
+	std::unique_ptr<Tables> newTables = std::make_unique<Tables>(*tables);
+	newTables->gdas.erase(name);
+
+	publish(std::move(newTables));
+
+	_stats.gdas.erase(name);
+}
+
+void TwoDARegistry::warmup(const std::vector<Common::UString> &twodas, const std::vector<Common::UString> &gdas) {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	const std::shared_ptr<const Tables> tables = getTables();
+
+	std::vector<WarmupJob> jobs;
+	jobs.reserve(twodas.size() + gdas.size());
+
+	// The resources are opened here, since the resource manager isn't thread-safe
+	for (size_t i = 0; i < (twodas.size() + gdas.size()); i++) {
+		const bool isGDA = i >= twodas.size();
+		const Common::UString &name = isGDA ? gdas[i - twodas.size()] : twodas[i];
+
+		if (isGDA ? (tables->gdas.find(name) != tables->gdas.end()) : (tables->twodas.find(name) != tables->twodas.end()))
+			continue;
+
+		bool duplicate = false;
+		for (std::vector<WarmupJob>::const_iterator j = jobs.begin(); j != jobs.end(); ++j)
+			duplicate = duplicate || ((j->isGDA == isGDA) && (j->name == name));
+
+		if (duplicate)
+			continue;
+
+		const std::chrono::steady_clock::time_point openStart = std::chrono::steady_clock::now();
+
+		WarmupJob job;
+
+		job.name  = name;
+		job.isGDA = isGDA;
+
+		try {
+			job.stream.reset(ResMan.getResource(name, isGDA ? kFileTypeGDA : kFileType2DA));
+			if (!job.stream)
+				throw Common::Exception("No such %s", isGDA ? "GDA" : "2DA");
+
+		} catch (...) {
+			Common::exceptionDispatcherWarning("Failed warming up %s \"%s\"", isGDA ? "GDA" : "2DA", name.c_str());
+
+			_stats.failed++;
+			continue;
+		}
+
+		job.stats.warmup = true;
+		job.stats.size   = job.stream->size();
+		job.stats.time   = std::chrono::duration<double>(std::chrono::steady_clock::now() - openStart).count();
+
+		jobs.push_back(std::move(job));
+	}
+
+	if (jobs.empty())
+		return;
+
+	// Parse on a few worker threads, and on this one
+	const size_t count = MIN(CLIP<size_t>(std::thread::hardware_concurrency(), 1, kMaxWarmupThreads), jobs.size());
+
+	std::atomic<size_t> next(0);
+
+	std::vector<std::thread> workers;
+	for (size_t i = 1; i < count; i++) {
+		workers.emplace_back([&jobs, &next]() {
+			Common::Thread::setCurrentThreadName("TwoDAWarmup");
+
+			runWarmupJobs(jobs, next);
+		});
+	}
+
+	runWarmupJobs(jobs, next);
+
+	for (std::vector<std::thread>::iterator w = workers.begin(); w != workers.end(); ++w)
+		w->join();
+
+	// Publish all successfully parsed tables at once
+	std::unique_ptr<Tables> newTables = std::make_unique<Tables>(*tables);
+
+	for (std::vector<WarmupJob>::iterator j = jobs.begin(); j != jobs.end(); ++j) {
+		if (j->error) {
+			try {
+				std::rethrow_exception(j->error);
+			} catch (...) {
+				Common::exceptionDispatcherWarning("Failed warming up %s \"%s\"",
+				                                   j->isGDA ? "GDA" : "2DA", j->name.c_str());
+			}
+
+			_stats.failed++;
+			continue;
+		}
+
+		if (j->isGDA) {
+			newTables->gdas[j->name] = std::move(j->gda);
+			_stats.gdas[j->name] = j->stats;
+		} else {
+			newTables->twodas[j->name] = std::move(j->twoda);
+			_stats.twodas[j->name] = j->stats;
+		}
+	}
+
+	publish(std::move(newTables));
+
+	_stats.warmups++;
+	_stats.workers     = count;
+	_stats.warmupTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void TwoDARegistry::runWarmupJobs(std::vector<WarmupJob> &jobs, std::atomic<size_t> &next) {
+	for (size_t i = next++; i < jobs.size(); i = next++) {
+		WarmupJob &job = jobs[i];
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		try {
+			if (job.isGDA) {
+				job.gda = std::make_unique<GDAFile>(job.stream.release());
+
+				job.stats.rows    = job.gda->getRowCount();
+				job.stats.columns = job.gda->getColumnCount();
+			} else {
+				job.twoda = std::make_unique<TwoDAFile>(*job.stream);
+				job.stream.reset();
+
+				job.stats.rows    = job.twoda->getRowCount();
+				job.stats.columns = job.twoda->getColumnCount();
+			}
+
+		} catch (...) {
+			job.error = std::current_exception();
+		}
+
+		job.stats.time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
 }
 
-std::unique_ptr<TwoDAFile> TwoDARegistry::load2DA(const Common::UString &name) {
+TwoDARegistry::Stats TwoDARegistry::getStats() {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	return _stats;
+}
+
+std::unique_ptr<TwoDAFile> TwoDARegistry::load2DA(const Common::UString &name, TableStats &stats) {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
 	std::unique_ptr<Common::SeekableReadStream> twodaFile;
 	std::unique_ptr<TwoDAFile> twoda;
 
@@ -144,10 +420,17 @@ std::unique_ptr<TwoDAFile> TwoDARegistry::load2DA(const Common::UString &name) {
 		throw;
 	}
 
+	stats.rows    = twoda->getRowCount();
+	stats.columns = twoda->getColumnCount();
+	stats.size    = twodaFile->size();
+	stats.time    = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
 	return twoda;
 }
 
-std::unique_ptr<GDAFile> TwoDARegistry::loadGDA(const Common::UString &name) {
+std::unique_ptr<GDAFile> TwoDARegistry::loadGDA(const Common::UString &name, TableStats &stats) {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
 	std::unique_ptr<Common::SeekableReadStream> gdaFile;
 	std::unique_ptr<GDAFile> gda;
 
@@ -156,6 +439,8 @@ std::unique_ptr<GDAFile> TwoDARegistry::loadGDA(const Common::UString &name) {
 		if (!gdaFile)
 			throw Common::Exception("No such GDA");
 
+		stats.size = gdaFile->size();
+
 		gda = std::make_unique<GDAFile>(gdaFile.release());
 
 	} catch (Common::Exception &e) {
@@ -163,15 +448,21 @@ std::unique_ptr<GDAFile> TwoDARegistry::loadGDA(const Common::UString &name) {
 		throw;
 	}
 
+	stats.rows    = gda->getRowCount();
+	stats.columns = gda->getColumnCount();
+	stats.time    = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
 	return gda;
 }
 
-std::unique_ptr<GDAFile> TwoDARegistry::loadMGDA(Common::UString prefix) {
+std::unique_ptr<GDAFile> TwoDARegistry::loadMGDA(Common::UString prefix, TableStats &stats) {
 	/* Load multiple GDAs with the same prefix, and merge them together into a single GDA. */
 
 	if (prefix.empty())
 		throw Common::Exception("Trying to load MGDA \"\"");
 
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
 	prefix.makeLower();
 
 	std::list<ResourceManager::ResourceID> gdas;
@@ -191,6 +482,8 @@ std::unique_ptr<GDAFile> TwoDARegistry::loadMGDA(Common::UString prefix) {
 			if (!stream)
 				throw Common::Exception("No such GDA \"%s\"", g->name.c_str());
 
+			stats.size += stream->size();
+
 			// If this is the first GDA, plain load it. Otherwise, merge it into the first one
 			if (!gda)
 				gda = std::make_unique<GDAFile>(stream.release());
@@ -206,6 +499,10 @@ std::unique_ptr<GDAFile> TwoDARegistry::loadMGDA(Common::UString prefix) {
 		throw;
 	}
 
+	stats.rows    = gda->getRowCount();
+	stats.columns = gda->getColumnCount();
+	stats.time    = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
 	return gda;
 }
 
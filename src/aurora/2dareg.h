@@ -26,7 +26,10 @@
 #define AURORA_2DAREG_H
 
 #include <map>
+#include <vector>
 #include <memory>
+#include <atomic>
+#include <mutex>
 
 #include "src/common/singleton.h"
 #include "src/common/ustring.h"
@@ -56,12 +59,56 @@ class GDAFile;
  *
  *  All 2DA and GDA files are directly and automatically loaded from
  *  the ResourceManager.
+ *
+ *  To avoid stalling on the first use of a whole bunch of tables, the
+ *  engines can hand a list of tables to warmup() while loading a module.
+ *  These are then parsed in parallel on a pool of worker threads.
+ *
+ *  Looking up an already loaded table doesn't take the registry's mutex:
+ *  the loaded tables are published as an immutable snapshot, which is
+ *  replaced as a whole whenever a table is added or removed. A snapshot
+ *  only holds shared pointers to the tables, so replacing it copies the
+ *  two maps, but not the tables themselves. That is one map node per
+ *  loaded table for every table loaded lazily; warmup() publishes all
+ *  its tables at once. An old snapshot is freed as soon as no reader is
+ *  looking at it anymore.
+ *
+ *  A removed or replaced table is freed once it's not in the current
+ *  snapshot anymore and nobody holds a shared pointer to it. References
+ *  returned by get2DA() and friends are therefore only valid until the
+ *  table is removed, replaced or cleared. Use get2DAShared() and
+ *  getGDAShared() to hold onto a table beyond that.
  */
 class TwoDARegistry : public Common::Singleton<TwoDARegistry> {
 public:
+	/** Loading statistics of a single 2DA or GDA. */
+	struct TableStats {
+		bool   warmup  { false }; ///< Was this table loaded by warmup()?
+		size_t rows    { 0 };     ///< Number of rows in the table.
+		size_t columns { 0 };     ///< Number of columns in the table.
+		size_t size    { 0 };     ///< Size of the table's file(s), in bytes.
+		double time    { 0 };     ///< Time spent loading the table, in seconds.
+	};
+
+	/** Loading statistics of all current 2DAs and GDAs. */
+	struct Stats {
+		size_t warmups    { 0 }; ///< Number of warmup() calls.
+		size_t workers    { 0 }; ///< Number of threads used by the last warmup.
+		size_t failed     { 0 }; ///< Number of tables that failed to warm up.
+		double warmupTime { 0 }; ///< Total wall-clock time spent in warmup(), in seconds.
+
+		std::map<Common::UString, TableStats> twodas; ///< Statistics per 2DA.
+		std::map<Common::UString, TableStats> gdas;   ///< Statistics per (multiple) GDA.
+	};
+
 	TwoDARegistry();
 	~TwoDARegistry();
 
+	/** Remove all 2DAs and GDAs, and reset the statistics.
+	 *
+	 *  This invalidates all references returned by the getters, so it must
+	 *  not be called while another thread might still look at a table.
+	 */
 	void clear();
 
 	/** Get a certain 2DA, loading it if necessary. */
@@ -73,6 +120,16 @@ public:
 	/** Get a certain multiple GDA, loading it if necessary. */
 	const GDAFile &getMGDA(const Common::UString &prefix);
 
+	/** Get shared ownership of a certain 2DA, loading it if necessary.
+	 *
+	 *  Unlike the reference returned by get2DA(), the 2DA stays alive past
+	 *  its removal and clear() for as long as the returned pointer does.
+	 */
+	std::shared_ptr<const TwoDAFile> get2DAShared(const Common::UString &name);
+
+	/** Get shared ownership of a certain GDA, loading it if necessary. */
+	std::shared_ptr<const GDAFile> getGDAShared(const Common::UString &name);
+
 	/** Add a certain 2DA to the registry, reloading it if necessary. */
 	void add2DA(const Common::UString &name);
 	/** Remove a certain 2DA from the registry. */
@@ -85,16 +142,61 @@ public:
 	/** Remove a certain GDA from the registry. */
 	void removeGDA(const Common::UString &name);
 
+	/** Load all these 2DAs and GDAs that aren't loaded yet, in parallel.
+	 *
+	 *  The resources are opened on the calling thread, but the parsing is
+	 *  spread over a pool of worker threads, with the calling thread helping
+	 *  out. This returns once all tables are loaded.
+	 *
+	 *  Tables that don't exist or fail to parse are skipped with a warning.
+	 *  Getting them later on throws, like it would have without warmup.
+	 */
+	void warmup(const std::vector<Common::UString> &twodas,
+	            const std::vector<Common::UString> &gdas = std::vector<Common::UString>());
+
+	/** Return the loading statistics of all current 2DAs and GDAs. */
+	Stats getStats();
+
 private:
-	typedef std::map<Common::UString, std::unique_ptr<TwoDAFile>> TwoDAMap;
-	typedef std::map<Common::UString, std::unique_ptr<GDAFile>> GDAMap;
+	typedef std::map<Common::UString, std::shared_ptr<const TwoDAFile>> TwoDAMap;
+	typedef std::map<Common::UString, std::shared_ptr<const GDAFile>> GDAMap;
+
+	/** An immutable snapshot of all loaded tables. */
+	struct Tables {
+		TwoDAMap twodas;
+		GDAMap   gdas;
+	};
+
+	/** A table to be parsed by warmup(). */
+	struct WarmupJob;
+
+	/** The current snapshot of all loaded tables.
+	 *
+	 *  Only ever accessed through std::atomic_load() and std::atomic_store(),
+	 *  so that it can be read without locking _mutex.
+	 */
+	std::shared_ptr<const Tables> _tables;
+
+	Stats _stats;
+
+	/** Protects loading tables, publishing snapshots and the statistics. */
+	std::mutex _mutex;
+
+	/** Return the current snapshot of all loaded tables. */
+	std::shared_ptr<const Tables> getTables() const;
+	/** Publish a new snapshot of all loaded tables, replacing the current one. */
+	void publish(std::shared_ptr<const Tables> tables);
+
+	/** Find a 2DA in the current snapshot, or load and publish it. Call with _mutex locked. */
+	std::shared_ptr<const TwoDAFile> findOrLoad2DA(const Common::UString &name);
+	/** Find a (multiple) GDA in the current snapshot, or load and publish it. Call with _mutex locked. */
+	std::shared_ptr<const GDAFile>   findOrLoadGDA(const Common::UString &name, bool multiple);
 
-	TwoDAMap _twodas;
-	GDAMap   _gdas;
+	std::unique_ptr<TwoDAFile> load2DA(const Common::UString &name, TableStats &stats);
+	std::unique_ptr<GDAFile>   loadGDA(const Common::UString &name, TableStats &stats);
+	std::unique_ptr<GDAFile>   loadMGDA(Common::UString prefix, TableStats &stats);
 
-	std::unique_ptr<TwoDAFile> load2DA(const Common::UString &name);
-	std::unique_ptr<GDAFile>   loadGDA(const Common::UString &name);
-	std::unique_ptr<GDAFile>   loadMGDA(Common::UString prefix);
+	static void runWarmupJobs(std::vector<WarmupJob> &jobs, std::atomic<size_t> &next);
 };
 
 } // End of namespace Aurora
@@ -22,7 +22,14 @@
  *  Handling various archive files.
  */
 
+#include <cstring>
+
+#include <memory>
+
 #include "src/common/system.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+#include "src/common/mappedfile.h"
 
 #include "src/aurora/archive.h"
 
@@ -64,4 +71,37 @@ uint32_t Archive::findResource(const Common::UString &name, FileType type) const
 	return 0xFFFFFFFF;
 }
 
+Common::MemoryReadStream *Archive::readSection(Common::SeekableReadStream &stream,
+                                               size_t offset, size_t size, bool tryNoCopy) const {
+
+	// Mapped archives directly hand out views into the mapping
+	Common::MemoryReadStream *view = Common::MappedReadStream::createView(stream, offset, offset + size);
+	if (view)
+		return view;
+
+	// In-memory archives can be read without touching the stream position
+	const Common::MemoryReadStream *memory = dynamic_cast<const Common::MemoryReadStream *>(&stream);
+	if (memory) {
+		if ((offset > memory->size()) || ((memory->size() - offset) < size))
+			throw Common::Exception("Archive section out of range (%u + %u, %u)",
+			                        (uint) offset, (uint) size, (uint) memory->size());
+
+		const byte *data = memory->getData() + offset;
+		if (tryNoCopy)
+			return new Common::MemoryReadStream(data, size);
+
+		std::unique_ptr<byte[]> copy = std::make_unique<byte[]>(size);
+		std::memcpy(copy.get(), data, size);
+
+		return new Common::MemoryReadStream(std::move(copy), size);
+	}
+
+	// Everything else has to be seeked, so only one thread at a time
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	stream.seek(offset);
+
+	return stream.readStream(size);
+}
+
 } // End of namespace Aurora
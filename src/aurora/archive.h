@@ -26,6 +26,7 @@
 #define AURORA_ARCHIVE_H
 
 #include <list>
+#include <mutex>
 
 #include <boost/noncopyable.hpp>
 
@@ -37,6 +38,7 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class MemoryReadStream;
 }
 
 namespace Aurora {
@@ -66,9 +68,13 @@ public:
 	virtual uint32_t getResourceSize(uint32_t index) const;
 
 	/** Return a stream of the resource's contents.
+	 *
+	 *  The returned streams are independent of each other and of the archive
+	 *  itself, so several threads can get and read resources at the same time.
 	 *
 	 *  @param  index The index of the resource we want.
-	 *  @param  tryNoCopy Try to return a SeekableSubReadStream of the archive instead of copying.
+	 *  @param  tryNoCopy Try to return a view into the archive instead of copying.
+	 *                    Such a view might not outlive the archive.
 	 *  @return A (sub)stream of the resource's contents.
 	 */
 	virtual Common::SeekableReadStream *getResource(uint32_t index, bool tryNoCopy = false) const = 0;
@@ -80,6 +86,19 @@ public:
 	uint32_t findResource(uint64_t hash) const;
 	/** Return the index of the resource matching the name and type, or 0xFFFFFFFF if not found. */
 	uint32_t findResource(const Common::UString &name, FileType type) const;
+
+protected:
+	/** Mutex securing access to the archive stream, for archives that need to seek it. */
+	mutable std::mutex _mutex;
+
+	/** Return a stream of the section [offset, offset + size) of the archive stream.
+	 *
+	 *  For memory-mapped and in-memory archive streams, this never touches the
+	 *  stream position and, if possible, doesn't copy. Otherwise, the section
+	 *  is read into memory while holding the archive mutex.
+	 */
+	Common::MemoryReadStream *readSection(Common::SeekableReadStream &stream,
+	                                      size_t offset, size_t size, bool tryNoCopy) const;
 };
 
 } // End of namespace Aurora
@@ -718,13 +718,10 @@ uint32_t ERFFile::getResourceSize(uint32_t index) const {
 Common::SeekableReadStream *ERFFile::getResource(uint32_t index, bool tryNoCopy) const {
 	const IResource &res = getIResource(index);
 
-	if (tryNoCopy && (_header.encryption == kEncryptionNone) && (_header.compression == kCompressionNone))
-		return new Common::SeekableSubReadStream(_erf.get(), res.offset, res.offset + res.packedSize);
-
-	_erf->seek(res.offset);
+	const bool isPlain = (_header.encryption == kEncryptionNone) && (_header.compression == kCompressionNone);
 
 	// Read
-	Common::MemoryReadStream *stream = _erf->readStream(res.packedSize);
+	Common::MemoryReadStream *stream = readSection(*_erf, res.offset, res.packedSize, tryNoCopy && isPlain);
 
 	// Decrypt
 	if (_header.encryption != kEncryptionNone)
@@ -46,7 +46,7 @@ namespace Aurora {
 const size_t GDAFile::kInvalidColumn;
 const size_t GDAFile::kInvalidRow;
 
-GDAFile::GDAFile(Common::SeekableReadStream *gda) : _columns(0), _rowCount(0) {
+GDAFile::GDAFile(Common::SeekableReadStream *gda) : _columns(0), _rowCount(0), _hasRowIDMap(false) {
 	assert(gda);
 
 	load(gda);
@@ -94,11 +94,27 @@ const GFF4Struct *GDAFile::getRow(size_t row) const {
 }
 
 size_t GDAFile::findRow(uint32_t id) const {
+	if (!_hasRowIDMap)
+		createRowIDMap();
+
+	RowIDMap::const_iterator row = _rowIDMap.find(id);
+	if (row == _rowIDMap.end())
+		return kInvalidRow;
+
+	return row->second;
+}
+
+void GDAFile::createRowIDMap() const {
+	_rowIDMap.clear();
+	_hasRowIDMap = true;
+
 	size_t idColumn = findColumn("ID");
 	if (idColumn == kInvalidColumn)
-		return kInvalidRow;
+		return;
+
+	_rowIDMap.reserve(_rowCount);
 
-	// Go through all rows of all GFF4s, and look for the ID
+	// Go through all rows of all GFF4s, and remember the first row for each ID
 
 	size_t gff4 = 0;
 	for (size_t i = 0, j = 0; i < _rowCount; i++, j++) {
@@ -109,11 +125,13 @@ size_t GDAFile::findRow(uint32_t id) const {
 			j = 0;
 		}
 
-		if ((*_rows[gff4])[j] && ((*_rows[gff4])[j]->getUint(idColumn) == id))
-			return i;
-	}
+		if (!(*_rows[gff4])[j])
+			continue;
 
-	return kInvalidRow;
+		const uint64_t rowID = (*_rows[gff4])[j]->getUint(idColumn);
+		if (rowID <= UINT32_MAX)
+			_rowIDMap.insert(std::make_pair((uint32_t) rowID, i));
+	}
 }
 
 size_t GDAFile::findColumn(const Common::UString &name) const {
@@ -319,6 +337,9 @@ void GDAFile::add(Common::SeekableReadStream *gda) {
 		_rowStarts.push_back(_rowCount);
 		_rowCount += _rows.back()->size();
 
+		// The new rows aren't in the ID index yet
+		_hasRowIDMap = false;
+
 		Columns columns = &top.getList(kGFF4G2DAColumnList);
 		if (columns->size() != _columns->size())
 			throw Common::Exception("Column counts don't match (%u vs. %u)",
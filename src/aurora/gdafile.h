@@ -28,6 +28,7 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 #include <boost/noncopyable.hpp>
 
@@ -113,7 +114,12 @@ public:
 	/** Get a row as a GFF4 struct. */
 	const GFF4Struct *getRow(size_t row) const;
 
-	/** Find a row by its ID value. */
+	/** Find a row by its ID value.
+	 *
+	 *  If several rows have the same ID, the first one is returned. The first
+	 *  lookup creates a hash index over the ID column, so all further lookups
+	 *  are cheap.
+	 */
 	size_t findRow(uint32_t id) const;
 
 	/** Find a column by its name. */
@@ -142,6 +148,8 @@ private:
 	typedef std::map<uint32_t, size_t> ColumnHashMap;
 	typedef std::map<Common::UString, size_t> ColumnNameMap;
 
+	typedef std::unordered_map<uint32_t, size_t> RowIDMap;
+
 
 	GFF4s _gff4s;
 
@@ -157,9 +165,14 @@ private:
 	mutable ColumnHashMap _columnHashMap;
 	mutable ColumnNameMap _columnNameMap;
 
+	mutable RowIDMap _rowIDMap; ///< Index of the first row for each ID.
+	mutable bool _hasRowIDMap;  ///< Has the ID index been created yet?
+
 
 	void load(Common::SeekableReadStream *gda);
 
+	void createRowIDMap() const;
+
 	Type identifyType(const Columns &columns, const Row &rows, size_t column) const;
 
 	const GFF4Struct *getRowColumn(size_t row, uint32_t hash, size_t &column) const;
@@ -27,12 +27,17 @@
  */
 
 #include <cassert>
+#include <cstring>
 
+#include <algorithm>
+
+#include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
 #include "src/common/encoding.h"
 #include "src/common/ustring.h"
 #include "src/common/strutil.h"
+#include "src/common/hash.h"
 
 #include "src/aurora/gff3file.h"
 #include "src/aurora/util.h"
@@ -64,7 +69,7 @@ void GFF3File::Header::read(Common::SeekableReadStream &gff3) {
 
 
 GFF3File::GFF3File(Common::SeekableReadStream *gff3, uint32_t id, bool repairNWNPremium) :
-	_stream(gff3), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
+	_stream(gff3), _data(0), _size(0), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
 
 	assert(_stream);
 
@@ -72,7 +77,7 @@ GFF3File::GFF3File(Common::SeekableReadStream *gff3, uint32_t id, bool repairNWN
 }
 
 GFF3File::GFF3File(const Common::UString &gff3, FileType type, uint32_t id, bool repairNWNPremium) :
-	_repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
+	_data(0), _size(0), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
 
 	_stream.reset(ResMan.getResource(gff3, type));
 	if (!_stream)
@@ -97,7 +102,9 @@ const GFF3Struct &GFF3File::getTopLevel() const {
 void GFF3File::load(uint32_t id) {
 	try {
 
+		loadData();
 		loadHeader(id);
+		loadLabels();
 		loadStructs();
 		loadLists();
 
@@ -107,6 +114,24 @@ void GFF3File::load(uint32_t id) {
 	}
 }
 
+void GFF3File::loadData() {
+	/* We decode all field values directly out of memory, so that reading
+	 * a field never has to modify the stream. If the stream already is in
+	 * memory, or a mapped file, we can use its data as-is. Otherwise, we
+	 * read it into memory first. */
+
+	Common::MemoryReadStream *memory = dynamic_cast<Common::MemoryReadStream *>(_stream.get());
+	if (!memory) {
+		_stream->seek(0);
+
+		memory = _stream->readStream(_stream->size());
+		_stream.reset(memory);
+	}
+
+	_data = memory->getData();
+	_size = memory->size();
+}
+
 void GFF3File::loadHeader(uint32_t id) {
 	if (_repairNWNPremium) {
 		/* The GFF3 files in the encrypted premium module archive for Neverwinter
@@ -180,6 +205,26 @@ void GFF3File::loadHeader(uint32_t id) {
 		throw Common::Exception("GFF3 header broken: section offset points outside stream");
 }
 
+void GFF3File::loadLabels() {
+	/* Read all field labels once. The structs only keep the index of
+	 * their fields' labels, together with the label's hash. */
+
+	static const uint32_t kLabelSize = 16;
+
+	if ((_header.labelOffset + (uint64_t) _header.labelCount * kLabelSize) > _stream->size())
+		throw Common::Exception("GFF3 header broken: label table points outside stream");
+
+	_stream->seek(_header.labelOffset);
+
+	_labels.reserve(_header.labelCount);
+	_labelHashes.reserve(_header.labelCount);
+
+	for (uint32_t i = 0; i < _header.labelCount; i++) {
+		_labels.push_back(Common::readStringFixed(*_stream, Common::kEncodingASCII, kLabelSize));
+		_labelHashes.push_back(GFF3Label::hash(_labels.back()));
+	}
+}
+
 void GFF3File::loadStructs() {
 	static const uint32_t kStructSize = 12;
 
@@ -272,21 +317,62 @@ const GFF3List &GFF3File::getList(uint32_t i) const {
 	return _lists[listIndex];
 }
 
+const Common::UString &GFF3File::getLabel(uint32_t i) const {
+	if (i >= _labels.size())
+		throw Common::Exception("GFF3: Label index out of range (%u >= %u)", i, (uint) _labels.size());
+
+	return _labels[i];
+}
+
 Common::SeekableReadStream &GFF3File::getStream(uint32_t offset) const {
 	_stream->seek(offset);
 
 	return *_stream;
 }
 
-Common::SeekableReadStream &GFF3File::getFieldData() const {
-	return getStream(_header.fieldDataOffset);
+const byte *GFF3File::getFieldData(uint32_t offset, size_t size) const {
+	const uint64_t begin = (uint64_t) _header.fieldDataOffset + offset;
+	if ((begin + size) > _size)
+		throw Common::Exception("GFF3: Field data out of range (%u + %u > %u)",
+		                        (uint) begin, (uint) size, (uint) _size);
+
+	return _data + begin;
 }
 
 
-GFF3Struct::Field::Field() : type(kFieldTypeNone), data(0), extended(false) {
+GFF3Label::GFF3Label(const char *label) : _label(label), _hash(hash(_label)) {
 }
 
-GFF3Struct::Field::Field(FieldType t, uint32_t d) : type(t), data(d) {
+GFF3Label::GFF3Label(const Common::UString &label) : _label(label), _hash(hash(_label)) {
+}
+
+const Common::UString &GFF3Label::getString() const {
+	return _label;
+}
+
+uint32_t GFF3Label::getHash() const {
+	return _hash;
+}
+
+uint32_t GFF3Label::hash(const Common::UString &label) {
+	/* Labels are plain ASCII, so we can skip the UTF-8 decoding of
+	 * Common::hashStringFNV32() and hash the raw bytes directly. */
+
+	uint32_t hash = 0x811C9DC5;
+
+	for (const char *c = label.c_str(); *c; c++)
+		hash = Common::hashFNV32(hash, (byte) *c);
+
+	return hash;
+}
+
+
+GFF3Struct::Field::Field() : type(kFieldTypeNone), data(0), label(0), hash(0), position(0), extended(false) {
+}
+
+GFF3Struct::Field::Field(FieldType t, uint32_t d, uint32_t l, uint32_t h, uint32_t p) :
+	type(t), data(d), label(l), hash(h), position(p) {
+
 	// These field types need extended field data
 	extended = (type == kFieldTypeUint64     ) ||
 	           (type == kFieldTypeSint64     ) ||
@@ -323,6 +409,8 @@ void GFF3Struct::load(uint32_t offset) {
 		readField (data, _fieldIndex);
 	else if (_fieldCount > 1)
 		readFields(data, _fieldIndex, _fieldCount);
+
+	sortFields();
 }
 
 void GFF3Struct::readField(Common::SeekableReadStream &data, uint32_t index) {
@@ -339,13 +427,12 @@ void GFF3Struct::readField(Common::SeekableReadStream &data, uint32_t index) {
 	const uint32_t fieldLabel = data.readUint32LE();
 	const uint32_t fieldData  = data.readUint32LE();
 
-	// Read the name
-	Common::UString fieldName = readLabel(data, fieldLabel);
-
-	// And add the field to the map and name list
-	_fields[fieldName] = Field((FieldType) fieldType, fieldData);
+	// Make sure the label exists
+	_parent->getLabel(fieldLabel);
 
-	_fieldNames.push_back(fieldName);
+	// And add the field, referencing the GFF3's label
+	_fields.push_back(Field((FieldType) fieldType, fieldData, fieldLabel,
+	                        _parent->_labelHashes[fieldLabel], _fields.size()));
 }
 
 void GFF3Struct::readFields(Common::SeekableReadStream &data, uint32_t index, uint32_t count) {
@@ -362,6 +449,7 @@ void GFF3Struct::readFields(Common::SeekableReadStream &data, uint32_t index, ui
 	readIndices(data, indices, count);
 
 	// Read the fields
+	_fields.reserve(count);
 	for (std::vector<uint32_t>::const_iterator i = indices.begin(); i != indices.end(); ++i)
 		readField(data, *i);
 }
@@ -373,19 +461,38 @@ void GFF3Struct::readIndices(Common::SeekableReadStream &data,
 		indices.push_back(data.readUint32LE());
 }
 
-Common::UString GFF3Struct::readLabel(Common::SeekableReadStream &data, uint32_t index) const {
-	data.seek(_parent->_header.labelOffset + index * 16);
+void GFF3Struct::sortFields() {
+	/* Sort the fields by the hash of their label, so that we can binary-search them.
+	 * The sort is stable, so fields with colliding hashes stay in file order. */
+
+	std::stable_sort(_fields.begin(), _fields.end(), [](const Field &a, const Field &b) {
+		return a.hash < b.hash;
+	});
+
+	/* A field label might appear more than once within a struct. Like a map would,
+	 * only keep the last field with the same label. */
 
-	return Common::readStringFixed(data, Common::kEncodingASCII, 16);
+	for (size_t i = 0; i < _fields.size(); ) {
+		bool overridden = false;
+
+		for (size_t j = i + 1; (j < _fields.size()) && (_fields[j].hash == _fields[i].hash); j++) {
+			if (_parent->_labels[_fields[j].label] == _parent->_labels[_fields[i].label]) {
+				overridden = true;
+				break;
+			}
+		}
+
+		if (overridden)
+			_fields.erase(_fields.begin() + i);
+		else
+			i++;
+	}
 }
 
-Common::SeekableReadStream &GFF3Struct::getData(const Field &field) const {
+const byte *GFF3Struct::getFieldData(const Field &field, size_t size) const {
 	assert(field.extended);
 
-	Common::SeekableReadStream &data = _parent->getFieldData();
-	data.skip(field.data);
-
-	return data;
+	return _parent->getFieldData(field.data, size);
 }
 
 // --- Field properties ---
@@ -398,8 +505,23 @@ bool GFF3Struct::hasField(const Common::UString &field) const {
 	return getField(field) != 0;
 }
 
-const std::vector<Common::UString> &GFF3Struct::getFieldNames() const {
-	return _fieldNames;
+bool GFF3Struct::hasField(const GFF3Label &field) const {
+	return getField(field) != 0;
+}
+
+std::vector<Common::UString> GFF3Struct::getFieldNames() const {
+	FieldArray fields = _fields;
+	std::sort(fields.begin(), fields.end(), [](const Field &a, const Field &b) {
+		return a.position < b.position;
+	});
+
+	std::vector<Common::UString> fieldNames;
+	fieldNames.reserve(fields.size());
+
+	for (FieldArray::const_iterator f = fields.begin(); f != fields.end(); ++f)
+		fieldNames.push_back(_parent->_labels[f->label]);
+
+	return fieldNames;
 }
 
 GFF3Struct::FieldType GFF3Struct::getFieldType(const Common::UString &field) const {
@@ -410,18 +532,46 @@ GFF3Struct::FieldType GFF3Struct::getFieldType(const Common::UString &field) con
 	return f->type;
 }
 
+GFF3Struct::FieldType GFF3Struct::getFieldType(const GFF3Label &field) const {
+	const Field *f = getField(field);
+	if (!f)
+		return kFieldTypeNone;
+
+	return f->type;
+}
+
 // --- Field value reader helpers ---
 
+const GFF3Struct::Field *GFF3Struct::getField(const Common::UString &name, uint32_t hash) const {
+	FieldArray::const_iterator f = std::lower_bound(_fields.begin(), _fields.end(), hash,
+			[](const Field &field, uint32_t h) {
+		return field.hash < h;
+	});
+
+	for (; (f != _fields.end()) && (f->hash == hash); ++f)
+		if (_parent->_labels[f->label] == name)
+			return &*f;
+
+	return 0;
+}
+
 const GFF3Struct::Field *GFF3Struct::getField(const Common::UString &name) const {
-	FieldMap::const_iterator field = _fields.find(name);
-	if (field == _fields.end())
-		return 0;
+	return getField(name, GFF3Label::hash(name));
+}
 
-	return &field->second;
+const GFF3Struct::Field *GFF3Struct::getField(const GFF3Label &name) const {
+	return getField(name.getString(), name.getHash());
 }
 
 char GFF3Struct::getChar(const Common::UString &field, char def) const {
-	const Field *f = getField(field);
+	return getChar(getField(field), def);
+}
+
+char GFF3Struct::getChar(const GFF3Label &field, char def) const {
+	return getChar(getField(field), def);
+}
+
+char GFF3Struct::getChar(const Field *f, char def) const {
 	if (!f)
 		return def;
 	if (f->type != kFieldTypeChar)
@@ -431,7 +581,14 @@ char GFF3Struct::getChar(const Common::UString &field, char def) const {
 }
 
 uint64_t GFF3Struct::getUint(const Common::UString &field, uint64_t def) const {
-	const Field *f = getField(field);
+	return getUint(getField(field), def);
+}
+
+uint64_t GFF3Struct::getUint(const GFF3Label &field, uint64_t def) const {
+	return getUint(getField(field), def);
+}
+
+uint64_t GFF3Struct::getUint(const Field *f, uint64_t def) const {
 	if (!f)
 		return def;
 
@@ -449,26 +606,33 @@ uint64_t GFF3Struct::getUint(const Common::UString &field, uint64_t def) const {
 	if (f->type == kFieldTypeSint32)
 		return (uint64_t) ((int64_t) ((int32_t) ((uint32_t) f->data)));
 	if (f->type == kFieldTypeUint64)
-		return (uint64_t) getData(*f).readUint64LE();
+		return (uint64_t) READ_LE_UINT64(getFieldData(*f, 8));
 	if (f->type == kFieldTypeSint64)
-		return ( int64_t) getData(*f).readUint64LE();
+		return ( int64_t) READ_LE_UINT64(getFieldData(*f, 8));
 
 	// StrRef, a numerical reference to a string in a talk table
 	if (f->type == kFieldTypeStrRef) {
-		Common::SeekableReadStream &data = getData(*f);
+		const byte *data = getFieldData(*f, 8);
 
-		const uint32_t size = data.readUint32LE();
+		const uint32_t size = READ_LE_UINT32(data);
 		if (size != 4)
 			Common::Exception("StrRef field with invalid size (%d)", size);
 
-		return (uint64_t) data.readUint32LE();
+		return (uint64_t) READ_LE_UINT32(data + 4);
 	}
 
 	throw Common::Exception("GFF3: Field is not an int type");
 }
 
 int64_t GFF3Struct::getSint(const Common::UString &field, int64_t def) const {
-	const Field *f = getField(field);
+	return getSint(getField(field), def);
+}
+
+int64_t GFF3Struct::getSint(const GFF3Label &field, int64_t def) const {
+	return getSint(getField(field), def);
+}
+
+int64_t GFF3Struct::getSint(const Field *f, int64_t def) const {
 	if (!f)
 		return def;
 
@@ -486,37 +650,48 @@ int64_t GFF3Struct::getSint(const Common::UString &field, int64_t def) const {
 	if (f->type == kFieldTypeSint32)
 		return (int64_t) ((int32_t) ((uint32_t) f->data));
 	if (f->type == kFieldTypeUint64)
-		return (int64_t) getData(*f).readUint64LE();
+		return (int64_t) READ_LE_UINT64(getFieldData(*f, 8));
 	if (f->type == kFieldTypeSint64)
-		return (int64_t) getData(*f).readUint64LE();
+		return (int64_t) READ_LE_UINT64(getFieldData(*f, 8));
 
 	// StrRef, a numerical reference to a string in a talk table
 	if (f->type == kFieldTypeStrRef) {
-		Common::SeekableReadStream &data = getData(*f);
+		const byte *data = getFieldData(*f, 8);
 
-		const uint32_t size = data.readUint32LE();
+		const uint32_t size = READ_LE_UINT32(data);
 		if (size != 4)
 			Common::Exception("GFF3: StrRef field with invalid size (%d)", size);
 
-		return (int64_t) ((uint64_t) data.readUint32LE());
+		return (int64_t) ((uint64_t) READ_LE_UINT32(data + 4));
 	}
 
 	throw Common::Exception("GFF3: Field is not an int type");
 }
 
 bool GFF3Struct::getBool(const Common::UString &field, bool def) const {
-	return getUint(field, def) != 0;
+	return getUint(getField(field), def) != 0;
+}
+
+bool GFF3Struct::getBool(const GFF3Label &field, bool def) const {
+	return getUint(getField(field), def) != 0;
 }
 
 double GFF3Struct::getDouble(const Common::UString &field, double def) const {
-	const Field *f = getField(field);
+	return getDouble(getField(field), def);
+}
+
+double GFF3Struct::getDouble(const GFF3Label &field, double def) const {
+	return getDouble(getField(field), def);
+}
+
+double GFF3Struct::getDouble(const Field *f, double def) const {
 	if (!f)
 		return def;
 
 	if (f->type == kFieldTypeFloat)
 		return convertIEEEFloat(f->data);
 	if (f->type == kFieldTypeDouble)
-		return getData(*f).readIEEEDoubleLE();
+		return convertIEEEDouble(READ_LE_UINT64(getFieldData(*f, 8)));
 
 	throw Common::Exception("GFF3: Field is not a double type");
 }
@@ -524,16 +699,24 @@ double GFF3Struct::getDouble(const Common::UString &field, double def) const {
 Common::UString GFF3Struct::getString(const Common::UString &field,
                                       const Common::UString &def) const {
 
-	const Field *f = getField(field);
+	return getString(getField(field), def);
+}
+
+Common::UString GFF3Struct::getString(const GFF3Label &field,
+                                      const Common::UString &def) const {
+
+	return getString(getField(field), def);
+}
+
+Common::UString GFF3Struct::getString(const Field *f, const Common::UString &def) const {
 	if (!f)
 		return def;
 
 	// Direct string
 	if (f->type == kFieldTypeExoString) {
-		Common::SeekableReadStream &data = getData(*f);
+		const uint32_t length = READ_LE_UINT32(getFieldData(*f, 4));
 
-		const uint32_t length = data.readUint32LE();
-		return Common::readStringFixed(data, Common::kEncodingASCII, length);
+		return Common::readString(getFieldData(*f, 4 + length) + 4, length, Common::kEncodingASCII);
 	}
 
 	// ResRef, resource reference, a shorter string
@@ -544,16 +727,15 @@ Common::UString GFF3Struct::getString(const Common::UString &field,
 		 * however, this limit has been lifted, and a full 255 characters
 		 * are available in ResRef string fields. */
 
-		Common::SeekableReadStream &data = getData(*f);
+		const uint32_t length = *getFieldData(*f, 1);
 
-		const uint32_t length = data.readByte();
-		return Common::readStringFixed(data, Common::kEncodingASCII, length);
+		return Common::readString(getFieldData(*f, 1 + length) + 1, length, Common::kEncodingASCII);
 	}
 
 	// LocString, a localized string
 	if (f->type == kFieldTypeLocString) {
 		LocString locString;
-		getLocString(field, locString);
+		getLocString(f, locString);
 
 		return locString.getString();
 	}
@@ -565,7 +747,7 @@ Common::UString GFF3Struct::getString(const Common::UString &field,
 	    (f->type == kFieldTypeUint64) ||
 	    (f->type == kFieldTypeStrRef)) {
 
-		return Common::composeString(getUint(field));
+		return Common::composeString(getUint(f, 0));
 	}
 
 	// Signed integer type, compose a string representation
@@ -574,21 +756,21 @@ Common::UString GFF3Struct::getString(const Common::UString &field,
 	    (f->type == kFieldTypeSint32) ||
 	    (f->type == kFieldTypeSint64)) {
 
-		return Common::composeString(getSint(field));
+		return Common::composeString(getSint(f, 0));
 	}
 
 	// Floating point type, compose a string representation
 	if ((f->type == kFieldTypeFloat) ||
 	    (f->type == kFieldTypeDouble)) {
 
-		return Common::composeString(getDouble(field));
+		return Common::composeString(getDouble(f, 0.0));
 	}
 
 	// Vector, consisting of 3 floats
 	if (f->type == kFieldTypeVector) {
 		float x = 0.0, y = 0.0, z = 0.0;
 
-		getVector(field, x, y, z);
+		getVector(f, x, y, z);
 		return Common::composeString(x) + "/" +
 		       Common::composeString(y) + "/" +
 		       Common::composeString(z);
@@ -598,7 +780,7 @@ Common::UString GFF3Struct::getString(const Common::UString &field,
 	if (f->type == kFieldTypeOrientation) {
 		float a = 0.0, b = 0.0, c = 0.0, d = 0.0;
 
-		getOrientation(field, a, b, c, d);
+		getOrientation(f, a, b, c, d);
 		return Common::composeString(a) + "/" +
 		       Common::composeString(b) + "/" +
 		       Common::composeString(c) + "/" +
@@ -609,7 +791,14 @@ Common::UString GFF3Struct::getString(const Common::UString &field,
 }
 
 bool GFF3Struct::getLocString(const Common::UString &field, LocString &str) const {
-	const Field *f = getField(field);
+	return getLocString(getField(field), str);
+}
+
+bool GFF3Struct::getLocString(const GFF3Label &field, LocString &str) const {
+	return getLocString(getField(field), str);
+}
+
+bool GFF3Struct::getLocString(const Field *f, LocString &str) const {
 	if (!f || (f->type != kFieldTypeLocString))
 		return false;
 
@@ -617,10 +806,8 @@ bool GFF3Struct::getLocString(const Common::UString &field, LocString &str) cons
 
 	try {
 
-		Common::SeekableReadStream &data = getData(*f);
-
-		const uint32_t size = data.readUint32LE();
-		Common::SeekableSubReadStream locStringData(&data, data.pos(), data.pos() + size);
+		const uint32_t size = READ_LE_UINT32(getFieldData(*f, 4));
+		Common::MemoryReadStream locStringData(getFieldData(*f, 4 + size) + 4, size);
 
 		locString.readLocString(locStringData);
 
@@ -633,7 +820,14 @@ bool GFF3Struct::getLocString(const Common::UString &field, LocString &str) cons
 }
 
 Common::SeekableReadStream *GFF3Struct::getData(const Common::UString &field) const {
-	const Field *f = getField(field);
+	return getData(getField(field));
+}
+
+Common::SeekableReadStream *GFF3Struct::getData(const GFF3Label &field) const {
+	return getData(getField(field));
+}
+
+Common::SeekableReadStream *GFF3Struct::getData(const Field *f) const {
 	if (!f)
 		return 0;
 	if ((f->type != kFieldTypeVoid) &&
@@ -641,89 +835,111 @@ Common::SeekableReadStream *GFF3Struct::getData(const Common::UString &field) co
 	    (f->type != kFieldTypeResRef))
 		throw Common::Exception("GFF3: Field is not a data type");
 
-	Common::SeekableReadStream &data = getData(*f);
-
-	uint32_t size = 0;
+	uint32_t sizeSize = 0;
 	if      ((f->type == kFieldTypeVoid) || (f->type == kFieldTypeExoString))
-		size = data.readUint32LE();
+		sizeSize = 4;
 	else if ( f->type == kFieldTypeResRef)
-		size = data.readByte();
+		sizeSize = 1;
 	else
 		throw Common::Exception("GFF3: Field is not a data type");
 
-	return data.readStream(size);
-}
+	const byte *sizeData = getFieldData(*f, sizeSize);
+	const uint32_t size = (sizeSize == 4) ? READ_LE_UINT32(sizeData) : *sizeData;
 
-void GFF3Struct::getVector(const Common::UString &field,
-                           float &x, float &y, float &z) const {
+	std::unique_ptr<byte[]> data = std::make_unique<byte[]>(size);
+	std::memcpy(data.get(), getFieldData(*f, sizeSize + size) + sizeSize, size);
 
-	const Field *f = getField(field);
+	return new Common::MemoryReadStream(std::move(data), size);
+}
+
+template<typename T>
+void GFF3Struct::getVector(const Field *f, T &x, T &y, T &z) const {
 	if (!f)
 		return;
 	if (f->type != kFieldTypeVector)
 		throw Common::Exception("GFF3: Field is not a vector type");
 
-	Common::SeekableReadStream &data = getData(*f);
+	const byte *data = getFieldData(*f, 12);
 
-	x = data.readIEEEFloatLE();
-	y = data.readIEEEFloatLE();
-	z = data.readIEEEFloatLE();
+	x = convertIEEEFloat(READ_LE_UINT32(data + 0));
+	y = convertIEEEFloat(READ_LE_UINT32(data + 4));
+	z = convertIEEEFloat(READ_LE_UINT32(data + 8));
 }
 
-void GFF3Struct::getOrientation(const Common::UString &field,
-                                float &a, float &b, float &c, float &d) const {
-
-	const Field *f = getField(field);
+template<typename T>
+void GFF3Struct::getOrientation(const Field *f, T &a, T &b, T &c, T &d) const {
 	if (!f)
 		return;
 	if (f->type != kFieldTypeOrientation)
 		throw Common::Exception("GFF3: Field is not an orientation type");
 
-	Common::SeekableReadStream &data = getData(*f);
+	const byte *data = getFieldData(*f, 16);
+
+	a = convertIEEEFloat(READ_LE_UINT32(data +  0));
+	b = convertIEEEFloat(READ_LE_UINT32(data +  4));
+	c = convertIEEEFloat(READ_LE_UINT32(data +  8));
+	d = convertIEEEFloat(READ_LE_UINT32(data + 12));
+}
+
+void GFF3Struct::getVector(const Common::UString &field,
+                           float &x, float &y, float &z) const {
+
+	getVector(getField(field), x, y, z);
+}
+
+void GFF3Struct::getVector(const GFF3Label &field,
+                           float &x, float &y, float &z) const {
+
+	getVector(getField(field), x, y, z);
+}
+
+void GFF3Struct::getOrientation(const Common::UString &field,
+                                float &a, float &b, float &c, float &d) const {
+
+	getOrientation(getField(field), a, b, c, d);
+}
+
+void GFF3Struct::getOrientation(const GFF3Label &field,
+                                float &a, float &b, float &c, float &d) const {
 
-	a = data.readIEEEFloatLE();
-	b = data.readIEEEFloatLE();
-	c = data.readIEEEFloatLE();
-	d = data.readIEEEFloatLE();
+	getOrientation(getField(field), a, b, c, d);
 }
 
 void GFF3Struct::getVector(const Common::UString &field,
                            double &x, double &y, double &z) const {
 
-	const Field *f = getField(field);
-	if (!f)
-		return;
-	if (f->type != kFieldTypeVector)
-		throw Common::Exception("GFF3: Field is not a vector type");
+	getVector(getField(field), x, y, z);
+}
 
-	Common::SeekableReadStream &data = getData(*f);
+void GFF3Struct::getVector(const GFF3Label &field,
+                           double &x, double &y, double &z) const {
 
-	x = data.readIEEEFloatLE();
-	y = data.readIEEEFloatLE();
-	z = data.readIEEEFloatLE();
+	getVector(getField(field), x, y, z);
 }
 
 void GFF3Struct::getOrientation(const Common::UString &field,
                                 double &a, double &b, double &c, double &d) const {
 
-	const Field *f = getField(field);
-	if (!f)
-		return;
-	if (f->type != kFieldTypeOrientation)
-		throw Common::Exception("GFF3: Field is not an orientation type");
+	getOrientation(getField(field), a, b, c, d);
+}
 
-	Common::SeekableReadStream &data = getData(*f);
+void GFF3Struct::getOrientation(const GFF3Label &field,
+                                double &a, double &b, double &c, double &d) const {
 
-	a = data.readIEEEFloatLE();
-	b = data.readIEEEFloatLE();
-	c = data.readIEEEFloatLE();
-	d = data.readIEEEFloatLE();
+	getOrientation(getField(field), a, b, c, d);
 }
 
 // --- Struct reader ---
 
 const GFF3Struct &GFF3Struct::getStruct(const Common::UString &field) const {
-	const Field *f = getField(field);
+	return getStruct(getField(field));
+}
+
+const GFF3Struct &GFF3Struct::getStruct(const GFF3Label &field) const {
+	return getStruct(getField(field));
+}
+
+const GFF3Struct &GFF3Struct::getStruct(const Field *f) const {
 	if (!f)
 		throw Common::Exception("GFF3: No such field");
 	if (f->type != kFieldTypeStruct)
@@ -736,7 +952,14 @@ const GFF3Struct &GFF3Struct::getStruct(const Common::UString &field) const {
 // --- Struct list reader ---
 
 const GFF3List &GFF3Struct::getList(const Common::UString &field) const {
-	const Field *f = getField(field);
+	return getList(getField(field));
+}
+
+const GFF3List &GFF3Struct::getList(const GFF3Label &field) const {
+	return getList(getField(field));
+}
+
+const GFF3List &GFF3Struct::getList(const Field *f) const {
 	if (!f)
 		throw Common::Exception("GFF3: No such field");
 	if (f->type != kFieldTypeList)
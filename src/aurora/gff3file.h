@@ -26,7 +26,6 @@
 #define AURORA_GFF3FILE_H
 
 #include <vector>
-#include <map>
 #include <memory>
 
 #include <boost/noncopyable.hpp>
@@ -78,6 +77,13 @@ class GFF3Struct;
  *  LocStrings is different. Since xoreos has more flexible handling of
  *  language IDs anyway, this doesn't concern us.
  *
+ *  The whole GFF3 is kept in one contiguous block of memory. If the stream
+ *  given to the GFF3File is a MemoryReadStream (or a MappedReadStream), its
+ *  data is used directly. Otherwise, the stream is read into memory once.
+ *  Once loaded, field values are decoded straight out of this memory and
+ *  never touch the stream, so a GFF3File can be read from several threads
+ *  at the same time.
+ *
  *  See also: GFF4File in gff4file.h for the later V4.0/V4.1 versions of
  *  the GFF format.
  */
@@ -123,6 +129,9 @@ private:
 
 	std::unique_ptr<Common::SeekableReadStream> _stream;
 
+	const byte *_data; ///< The whole GFF3, owned by _stream.
+	size_t      _size; ///< The size of the whole GFF3 in bytes.
+
 	Header _header; ///< The GFF3's header.
 
 	/** Should we try to read GFF3 files found in Neverwinter Nights premium modules? */
@@ -136,29 +145,64 @@ private:
 	/** To convert list offsets found in GFF3 to real indices. */
 	std::vector<uint32_t> _listOffsetToIndex;
 
+	/** All field labels, read once and shared by all structs. */
+	std::vector<Common::UString> _labels;
+	/** The hashes of all field labels. */
+	std::vector<uint32_t> _labelHashes;
+
 
 	// .--- Loading helpers
 	void load(uint32_t id);
+	void loadData();
 	void loadHeader(uint32_t id);
+	void loadLabels();
 	void loadStructs();
 	void loadLists();
 	// '---
 
 	// .--- Helper methods called by GFF3Struct
-	/** Return the GFF3 stream. */
+	/** Return the GFF3 stream. Only used while loading. */
 	Common::SeekableReadStream &getStream(uint32_t offset) const;
-	/** Return the GFF3 stream seeked to the start of the field data. */
-	Common::SeekableReadStream &getFieldData() const;
+	/** Return size bytes of field data, starting at this offset into the field data section. */
+	const byte *getFieldData(uint32_t offset, size_t size) const;
 
 	/** Return a struct within the GFF3. */
 	const GFF3Struct &getStruct(uint32_t i) const;
 	/** Return a list within the GFF3. */
 	const GFF3List   &getList  (uint32_t i) const;
+
+	/** Return a field label within the GFF3. */
+	const Common::UString &getLabel(uint32_t i) const;
 	// '---
 
 	friend class GFF3Struct;
 };
 
+/** A GFF3 field label, hashed in advance.
+ *
+ *  Looking up a field by a string label has to hash the string first.
+ *  Code that repeatedly queries the same fields can instead construct
+ *  a GFF3Label once, for example as a static constant, and use it for
+ *  all of these queries.
+ */
+class GFF3Label {
+public:
+	explicit GFF3Label(const char *label);
+	explicit GFF3Label(const Common::UString &label);
+
+	/** Return the label string. */
+	const Common::UString &getString() const;
+	/** Return the hash of the label string. */
+	uint32_t getHash() const;
+
+	/** Calculate the hash of a label string. */
+	static uint32_t hash(const Common::UString &label);
+
+private:
+	Common::UString _label;
+	uint32_t _hash;
+};
+
 /** A struct within a GFF3. */
 class GFF3Struct {
 public:
@@ -201,12 +245,14 @@ public:
 	size_t getFieldCount() const;
 	/** Does this specific field exist? */
 	bool hasField(const Common::UString &field) const;
+	bool hasField(const GFF3Label       &field) const;
 
-	/** Return a list of all field names in this struct. */
-	const std::vector<Common::UString> &getFieldNames() const;
+	/** Return a list of all field names in this struct, in file order. */
+	std::vector<Common::UString> getFieldNames() const;
 
 	/** Return the type of this field, or kFieldTypeNone if such a field doesn't exist. */
 	FieldType getFieldType(const Common::UString &field) const;
+	FieldType getFieldType(const GFF3Label       &field) const;
 
 
 	// .--- Read field values
@@ -235,9 +281,38 @@ public:
 	Common::SeekableReadStream *getData(const Common::UString &field) const;
 	// '---
 
+	// .--- Read field values, by pre-hashed label
+	char   getChar(const GFF3Label &field, char   def = '\0' ) const;
+	uint64_t getUint(const GFF3Label &field, uint64_t def = 0    ) const;
+	 int64_t getSint(const GFF3Label &field,  int64_t def = 0    ) const;
+	bool   getBool(const GFF3Label &field, bool   def = false) const;
+
+	double getDouble(const GFF3Label &field, double def = 0.0) const;
+
+	Common::UString getString(const GFF3Label &field,
+	                          const Common::UString &def = "") const;
+
+	bool getLocString(const GFF3Label &field, LocString &str) const;
+
+	void getVector     (const GFF3Label &field,
+	                    float &x, float &y, float &z          ) const;
+	void getOrientation(const GFF3Label &field,
+	                    float &a, float &b, float &c, float &d) const;
+
+	void getVector     (const GFF3Label &field,
+	                    double &x, double &y, double &z           ) const;
+	void getOrientation(const GFF3Label &field,
+	                    double &a, double &b, double &c, double &d) const;
+
+	Common::SeekableReadStream *getData(const GFF3Label &field) const;
+	// '---
+
 	// .--- Structs and lists of structs
 	const GFF3Struct &getStruct(const Common::UString &field) const;
 	const GFF3List   &getList  (const Common::UString &field) const;
+
+	const GFF3Struct &getStruct(const GFF3Label &field) const;
+	const GFF3List   &getList  (const GFF3Label &field) const;
 	// '---
 
 private:
@@ -245,13 +320,16 @@ private:
 	struct Field {
 		FieldType type;     ///< Type of the field.
 		uint32_t  data;     ///< Data of the field.
+		uint32_t  label;    ///< Index of the field's label in the GFF3.
+		uint32_t  hash;     ///< Hash of the field's label.
+		uint32_t  position; ///< Position of the field within the struct.
 		bool      extended; ///< Does this field need extended data?
 
 		Field();
-		Field(FieldType t, uint32_t d);
+		Field(FieldType t, uint32_t d, uint32_t l, uint32_t h, uint32_t p);
 	};
 
-	typedef std::map<Common::UString, Field> FieldMap;
+	typedef std::vector<Field> FieldArray;
 
 
 	const GFF3File *_parent; ///< The parent GFF3.
@@ -260,10 +338,7 @@ private:
 	uint32_t _fieldIndex; ///< Field / Field indices index.
 	uint32_t _fieldCount; ///< Field count.
 
-	FieldMap _fields; ///< The fields, indexed by their label.
-
-	/** The names of all fields in this struct. */
-	std::vector<Common::UString> _fieldNames;
+	FieldArray _fields; ///< The fields, sorted by the hash of their label.
 
 
 	// .--- Loader
@@ -276,14 +351,38 @@ private:
 	void readIndices(Common::SeekableReadStream &data,
 	                 std::vector<uint32_t> &indices, uint32_t count) const;
 
-	Common::UString readLabel(Common::SeekableReadStream &data, uint32_t index) const;
+	/** Sort the fields by label hash and drop fields overridden by a later one. */
+	void sortFields();
 	// '---
 
 	// .--- Field and field data accessors
+	/** Returns the field with this label and label hash. */
+	const Field *getField(const Common::UString &name, uint32_t hash) const;
 	/** Returns the field with this tag. */
 	const Field *getField(const Common::UString &name) const;
-	/** Returns the extended field data for this field. */
-	Common::SeekableReadStream &getData(const Field &field) const;
+	/** Returns the field with this pre-hashed tag. */
+	const Field *getField(const GFF3Label &name) const;
+	/** Returns size bytes of the extended field data for this field. */
+	const byte *getFieldData(const Field &field, size_t size) const;
+	// '---
+
+	// .--- Field value readers
+	char     getChar  (const Field *f, char     def) const;
+	uint64_t getUint  (const Field *f, uint64_t def) const;
+	 int64_t getSint  (const Field *f,  int64_t def) const;
+	double   getDouble(const Field *f, double   def) const;
+
+	Common::UString getString(const Field *f, const Common::UString &def) const;
+
+	bool getLocString(const Field *f, LocString &str) const;
+
+	template<typename T> void getVector     (const Field *f, T &x, T &y, T &z) const;
+	template<typename T> void getOrientation(const Field *f, T &a, T &b, T &c, T &d) const;
+
+	Common::SeekableReadStream *getData(const Field *f) const;
+
+	const GFF3Struct &getStruct(const Field *f) const;
+	const GFF3List   &getList  (const Field *f) const;
 	// '---
 
 	friend class GFF3File;
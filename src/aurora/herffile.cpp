@@ -159,12 +159,7 @@ uint32_t HERFFile::getResourceSize(uint32_t index) const {
 Common::SeekableReadStream *HERFFile::getResource(uint32_t index, bool tryNoCopy) const {
 	const IResource &res = getIResource(index);
 
-	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_herf.get(), res.offset, res.offset + res.size);
-
-	_herf->seek(res.offset);
-
-	return _herf->readStream(res.size);
+	return readSection(*_herf, res.offset, res.size, tryNoCopy);
 }
 
 Common::HashAlgo HERFFile::getNameHashAlgo() const {
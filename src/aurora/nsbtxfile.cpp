@@ -330,6 +330,9 @@ Common::SeekableReadStream *NSBTXFile::getResource(uint32_t index, bool UNUSED(t
 
 	Common::MemoryWriteStreamDynamic stream(true, getITEXSize(_textures[index]));
 
+	// The texture is converted straight from the archive stream
+	std::lock_guard<std::mutex> lock(_mutex);
+
 	ReadContext ctx(*_nsbtx, _textures[index], stream);
 	writeITEXHeader(ctx);
 
@@ -85,6 +85,12 @@ FunctionContext FunctionManager::createContext(const Common::UString &function)
 }
 
 void FunctionManager::call(const Common::UString &function, FunctionContext &ctx) const {
+	// Formatting the parameters is costly, so don't even start if nobody's going to see it
+	if (!DebugMan.isEnabled(Common::kDebugEngineScripts, 2)) {
+		find(function).func(ctx);
+		return;
+	}
+
 	debugCN(Common::kDebugEngineScripts, 5, "%s %s(%s)", formatType(ctx.getReturn().getType()).c_str(),
 	        ctx.getName().c_str(), formatParams(ctx).c_str());
 
@@ -102,7 +108,17 @@ FunctionContext FunctionManager::createContext(uint32_t function) const {
 	return find(function).ctx;
 }
 
+void FunctionManager::resetContext(uint32_t function, FunctionContext &ctx) const {
+	ctx = find(function).ctx;
+}
+
 void FunctionManager::call(uint32_t function, FunctionContext &ctx) const {
+	// Formatting the parameters is costly, so don't even start if nobody's going to see it
+	if (!DebugMan.isEnabled(Common::kDebugEngineScripts, 2)) {
+		find(function).func(ctx);
+		return;
+	}
+
 	debugCN(Common::kDebugEngineScripts, 5, "%s %s(%s)", formatType(ctx.getReturn().getType()).c_str(),
 	        ctx.getName().c_str(), formatParams(ctx).c_str());
 
@@ -55,6 +55,8 @@ public:
 	void call(const Common::UString &function, FunctionContext &ctx) const;
 
 	FunctionContext createContext(uint32_t function) const;
+	/** Reset an existing context for calling this function, reusing its storage. */
+	void resetContext(uint32_t function, FunctionContext &ctx) const;
 	void call(uint32_t function, FunctionContext &ctx) const;
 
 private:
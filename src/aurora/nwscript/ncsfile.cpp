@@ -37,20 +37,17 @@
 #include "src/common/maths.h"
 #include "src/common/ustring.h"
 #include "src/common/readstream.h"
-#include "src/common/encoding.h"
+#include "src/common/memreadstream.h"
 #include "src/common/debug.h"
 
-#include "src/aurora/resman.h"
-
 #include "src/aurora/nwscript/ncsfile.h"
+#include "src/aurora/nwscript/ncsprogram.h"
+#include "src/aurora/nwscript/programcache.h"
 #include "src/aurora/nwscript/object.h"
 #include "src/aurora/nwscript/functionman.h"
 
 using Common::kDebugScripts;
 
-static const uint32_t kNCSTag    = MKTAG('N', 'C', 'S', ' ');
-static const uint32_t kVersion10 = MKTAG('V', '1', '.', '0');
-
 static const uint32_t kScriptObjectSelf        = 0x00000000;
 static const uint32_t kScriptObjectInvalid     = 0x00000001;
 static const uint32_t kScriptObjectInvalid2    = 0xFFFFFFFF;
@@ -89,7 +86,7 @@ Variable NCSStack::pop() {
 	if (_stackPtr == -1)
 		throw Common::Exception("NCSStack: Stack underflow");
 
-	return at(_stackPtr--);
+	return std::move(at(_stackPtr--));
 }
 
 void NCSStack::push(const Variable &obj) {
@@ -104,6 +101,18 @@ void NCSStack::push(const Variable &obj) {
 	_stackPtr++;
 }
 
+void NCSStack::push(Variable &&obj) {
+	if (_stackPtr == 0x7FFFFFFF) // Like this will ever happen :P
+		throw Common::Exception("NCSStack: Stack overflow");
+
+	if (_stackPtr == (int32_t)size() - 1)
+		push_back(std::move(obj));
+	else
+		at(_stackPtr + 1) = std::move(obj);
+
+	_stackPtr++;
+}
+
 Variable &NCSStack::getRelSP(int32_t pos) {
 	if ((pos > -4) || ((pos % 4) != 0))
 		throw Common::Exception("NCSStack::get(): Illegal position %d", pos);
@@ -156,7 +165,13 @@ void NCSStack::setStackPtr(int32_t pos) {
 	if ((pos > 0) || ((pos % 4) != 0))
 		throw Common::Exception("NCSStack::setStackPtr(): Illegal position %d", pos);
 
-	_stackPtr = (pos / -4) - 1;
+	const int32_t stackPtr = (pos / -4) - 1;
+
+	// Let go of the values popped off the stack, so that they aren't shared needlessly
+	for (int32_t i = stackPtr + 1; i <= _stackPtr; i++)
+		at(i).setType(kTypeVoid);
+
+	_stackPtr = stackPtr;
 
 	if ((int32_t)size() < (_stackPtr + 1))
 		resize(_stackPtr + 1);
@@ -190,102 +205,57 @@ void NCSStack::print() const {
 }
 
 
-#define OPCODE(x) { &NCSFile::x, #x }
-#define OPCODE0() { 0, "" }
-
-void NCSFile::setupOpcodes() {
-	static const Opcode opcodes[] = {
+static const char *getOpcodeName(Opcode opcode) {
+	static const char * const kOpcodeNames[] = {
 		// 0x00
-		OPCODE(o_nop), // Doesn't exist
-		OPCODE(o_cpdownsp),
-		OPCODE(o_rsadd),
-		OPCODE(o_cptopsp),
+		"NOP",           "CPDOWNSP",      "RSADD",         "CPTOPSP",
 		// 0x04
-		OPCODE(o_const),
-		OPCODE(o_action),
-		OPCODE(o_logand),
-		OPCODE(o_logor),
+		"CONST",         "ACTION",        "LOGAND",        "LOGOR",
 		// 0x08
-		OPCODE(o_incor),
-		OPCODE(o_excor),
-		OPCODE(o_booland),
-		OPCODE(o_eq),
+		"INCOR",         "EXCOR",         "BOOLAND",       "EQ",
 		// 0x0C
-		OPCODE(o_neq),
-		OPCODE(o_geq),
-		OPCODE(o_gt),
-		OPCODE(o_lt),
+		"NEQ",           "GEQ",           "GT",            "LT",
 		// 0x10
-		OPCODE(o_leq),
-		OPCODE(o_shleft),
-		OPCODE(o_shright),
-		OPCODE(o_ushright),
+		"LEQ",           "SHLEFT",        "SHRIGHT",       "USHRIGHT",
 		// 0x14
-		OPCODE(o_add),
-		OPCODE(o_sub),
-		OPCODE(o_mul),
-		OPCODE(o_div),
+		"ADD",           "SUB",           "MUL",           "DIV",
 		// 0x18
-		OPCODE(o_mod),
-		OPCODE(o_neg),
-		OPCODE(o_comp),
-		OPCODE(o_movsp),
+		"MOD",           "NEG",           "COMP",          "MOVSP",
 		// 0x1C
-		OPCODE(o_storestateall),
-		OPCODE(o_jmp),
-		OPCODE(o_jsr),
-		OPCODE(o_jz),
+		"STORESTATEALL", "JMP",           "JSR",           "JZ",
 		// 0x20
-		OPCODE(o_retn),
-		OPCODE(o_destruct),
-		OPCODE(o_not),
-		OPCODE(o_decsp),
+		"RETN",          "DESTRUCT",      "NOT",           "DECSP",
 		// 0x24
-		OPCODE(o_incsp),
-		OPCODE(o_jnz),
-		OPCODE(o_cpdownbp),
-		OPCODE(o_cptopbp),
+		"INCSP",         "JNZ",           "CPDOWNBP",      "CPTOPBP",
 		// 0x28
-		OPCODE(o_decbp),
-		OPCODE(o_incbp),
-		OPCODE(o_savebp),
-		OPCODE(o_restorebp),
+		"DECBP",         "INCBP",         "SAVEBP",        "RESTOREBP",
 		// 0x2C
-		OPCODE(o_storestate),
-		OPCODE(o_nop),
-		OPCODE0(),
-		OPCODE0(),
+		"STORESTATE",    "NOP",           "",              "",
 		// 0x30
-		OPCODE(o_writearray),
-		OPCODE0(),
-		OPCODE(o_readarray),
-		OPCODE0(),
+		"WRITEARRAY",    "",              "READARRAY",     "",
 		// 0x34
-		OPCODE0(),
-		OPCODE0(),
-		OPCODE0(),
-		OPCODE(o_getref),
+		"",              "",              "",              "GETREF",
 		// 0x38
-		OPCODE0(),
-		OPCODE(o_getrefarray)
+		"",              "GETREFARRAY"
 	};
 
-	_opcodes = opcodes;
-	_opcodeListSize = ARRAYSIZE(opcodes);
+	if ((size_t)opcode >= ARRAYSIZE(kOpcodeNames))
+		return "BROKEN";
+
+	return kOpcodeNames[opcode];
 }
 
-#undef OPCODE
+NCSFile::NCSFile(Common::SeekableReadStream *ncs) : _pc(0), _instructionCount(0) {
+	assert(ncs);
 
-NCSFile::NCSFile(Common::SeekableReadStream *ncs) : _script(ncs) {
-	assert(_script);
+	std::unique_ptr<Common::SeekableReadStream> stream(ncs);
+	_program = std::make_shared<NCSProgram>(*stream);
 
 	load();
 }
 
-NCSFile::NCSFile(const Common::UString &ncs) : _name(ncs) {
-	_script.reset(ResMan.getResource(ncs, kFileTypeNCS));
-	if (!_script)
-		throw Common::Exception("No such NCS \"%s\"", ncs.c_str());
+NCSFile::NCSFile(const Common::UString &ncs) : _name(ncs), _pc(0), _instructionCount(0) {
+	_program = NCSCache.get(ncs);
 
 	load();
 }
@@ -324,6 +294,10 @@ const Common::UString &NCSFile::getParameterString() const {
 	return _parameterString;
 }
 
+size_t NCSFile::getInstructionCount() const {
+	return _instructionCount;
+}
+
 ScriptState NCSFile::getEmptyState() {
 	ScriptState state;
 
@@ -333,25 +307,9 @@ ScriptState NCSFile::getEmptyState() {
 }
 
 void NCSFile::load() {
-	readHeader(*_script);
-
-	if (_id != kNCSTag)
-		throw Common::Exception("Try to load non-NCS file");
-
-	if (_version != kVersion10)
-		throw Common::Exception("Unsupported NCS file version %08X", _version);
-
-	byte lengthOpcode = _script->readByte();
-	if (lengthOpcode != 0x42)
-		throw Common::Exception("Script size opcode != 0x42 (0x%02X)", lengthOpcode);
-
-	uint32_t length = _script->readUint32BE();
-	if (length > ((uint32_t) _script->size()))
-		throw Common::Exception("Script size %u > stream size %u", length, (uint)_script->size());
-	if (length < ((uint32_t) _script->size()))
-		warning("TODO: NCSFile::load(): Script size %u < stream size %u", length, (uint)_script->size());
-
-	setupOpcodes();
+	// The program already made sure this is a valid NCS, so we only need to read the header
+	Common::MemoryReadStream header(_program->getData(), _program->getSize());
+	readHeader(header);
 
 	reset();
 }
@@ -365,7 +323,8 @@ void NCSFile::reset() {
 	_storedState.setType(kTypeVoid);
 	_return.setType(kTypeVoid);
 
-	_script->seek(13); // 8 byte header + 5 byte program size dummy op
+	_pc = 0;
+	_instructionCount = 0;
 }
 
 const Variable &NCSFile::run(Object *owner, Object *triggerer) {
@@ -386,7 +345,9 @@ const Variable &NCSFile::run(const ScriptState &state, const ObjectReference own
 
 	reset();
 
-	_script->seek(state.offset);
+	if (!_program->findInstruction(state.offset, _pc))
+		throw Common::Exception("NCSFile::run(): No instruction at offset %u in script \"%s\"",
+		                        state.offset, _name.c_str());
 
 	// Push global variables
 	std::vector<class Variable>::const_reverse_iterator var;
@@ -406,8 +367,30 @@ const Variable &NCSFile::execute(const ObjectReference owner, const ObjectRefere
 	_owner     = owner;
 	_triggerer = triggerer;
 
-	while (executeStep())
-		;
+	const std::vector<Instruction> &instructions = _program->getInstructions();
+
+	/* Check for tracing only once per run. Without it, executing an instruction
+	 * is only the dispatch on the pre-decoded opcode, with no debug overhead. */
+	const bool trace = DebugMan.isEnabled(kDebugScripts, 1);
+
+	if (trace) {
+		while (_pc < instructions.size()) {
+			const Instruction &inst = instructions[_pc++];
+
+			traceInstruction(inst);
+			executeInstruction(inst);
+			_instructionCount++;
+
+			_stack.print();
+			debugC(kDebugScripts, 2, "[RETURN: %d]",
+			       _returnOffsets.empty() ? -1 : (int)_returnOffsets.top());
+		}
+	} else {
+		while (_pc < instructions.size()) {
+			executeInstruction(instructions[_pc++]);
+			_instructionCount++;
+		}
+	}
 
 	if (!_stack.empty())
 		_return = _stack.top();
@@ -422,44 +405,82 @@ const Variable &NCSFile::execute(const ObjectReference owner, const ObjectRefere
 	return _return;
 }
 
-bool NCSFile::executeStep() {
-	byte opcode, type;
+void NCSFile::executeInstruction(const Instruction &inst) {
+	switch (inst.opcode) {
+		case kOpcodeNOP0:          o_nop(inst);           break;
+		case kOpcodeCPDOWNSP:      o_cpdownsp(inst);      break;
+		case kOpcodeRSADD:         o_rsadd(inst);         break;
+		case kOpcodeCPTOPSP:       o_cptopsp(inst);       break;
+		case kOpcodeCONST:         o_const(inst);         break;
+		case kOpcodeACTION:        o_action(inst);        break;
+		case kOpcodeLOGAND:        o_logand(inst);        break;
+		case kOpcodeLOGOR:         o_logor(inst);         break;
+		case kOpcodeINCOR:         o_incor(inst);         break;
+		case kOpcodeEXCOR:         o_excor(inst);         break;
+		case kOpcodeBOOLAND:       o_booland(inst);       break;
+		case kOpcodeEQ:            o_eq(inst);            break;
+		case kOpcodeNEQ:           o_neq(inst);           break;
+		case kOpcodeGEQ:           o_geq(inst);           break;
+		case kOpcodeGT:            o_gt(inst);            break;
+		case kOpcodeLT:            o_lt(inst);            break;
+		case kOpcodeLEQ:           o_leq(inst);           break;
+		case kOpcodeSHLEFT:        o_shleft(inst);        break;
+		case kOpcodeSHRIGHT:       o_shright(inst);       break;
+		case kOpcodeUSHRIGHT:      o_ushright(inst);      break;
+		case kOpcodeADD:           o_add(inst);           break;
+		case kOpcodeSUB:           o_sub(inst);           break;
+		case kOpcodeMUL:           o_mul(inst);           break;
+		case kOpcodeDIV:           o_div(inst);           break;
+		case kOpcodeMOD:           o_mod(inst);           break;
+		case kOpcodeNEG:           o_neg(inst);           break;
+		case kOpcodeCOMP:          o_comp(inst);          break;
+		case kOpcodeMOVSP:         o_movsp(inst);         break;
+		case kOpcodeSTORESTATEALL: o_storestateall(inst); break;
+		case kOpcodeJMP:           o_jmp(inst);           break;
+		case kOpcodeJSR:           o_jsr(inst);           break;
+		case kOpcodeJZ:            o_jz(inst);            break;
+		case kOpcodeRETN:          o_retn(inst);          break;
+		case kOpcodeDESTRUCT:      o_destruct(inst);      break;
+		case kOpcodeNOT:           o_not(inst);           break;
+		case kOpcodeDECSP:         o_decsp(inst);         break;
+		case kOpcodeINCSP:         o_incsp(inst);         break;
+		case kOpcodeJNZ:           o_jnz(inst);           break;
+		case kOpcodeCPDOWNBP:      o_cpdownbp(inst);      break;
+		case kOpcodeCPTOPBP:       o_cptopbp(inst);       break;
+		case kOpcodeDECBP:         o_decbp(inst);         break;
+		case kOpcodeINCBP:         o_incbp(inst);         break;
+		case kOpcodeSAVEBP:        o_savebp(inst);        break;
+		case kOpcodeRESTOREBP:     o_restorebp(inst);     break;
+		case kOpcodeSTORESTATE:    o_storestate(inst);    break;
+		case kOpcodeNOP:           o_nop(inst);           break;
+		case kOpcodeWRITEARRAY:    o_writearray(inst);    break;
+		case kOpcodeREADARRAY:     o_readarray(inst);     break;
+		case kOpcodeGETREF:        o_getref(inst);        break;
+		case kOpcodeGETREFARRAY:   o_getrefarray(inst);   break;
 
-	try {
-		opcode = _script->readByte();
-		type   = _script->readByte();
-	} catch (...) {
-		return false;
+		default:
+			o_broken(inst);
+			break;
 	}
-
-	if ((opcode >= _opcodeListSize) || (!_opcodes[opcode].proc))
-		throw Common::Exception("NCSFile::executeStep(): Illegal instruction 0x%02x", opcode);
-
-	debugC(kDebugScripts, 1, "NWScript opcode %s [0x%02X]", _opcodes[opcode].desc, opcode);
-
-	(this->*(_opcodes[opcode].proc))((InstructionType)type);
-
-	_stack.print();
-	debugC(kDebugScripts, 2, "[RETURN: %d]",
-	       _returnOffsets.empty() ? -1 : _returnOffsets.top());
-
-	return true;
 }
 
-void NCSFile::decompile() {
-	uint32_t oldScriptPos = _script->pos();
-	_script->seek(13); // 8 byte header + 5 byte program size dummy op
+void NCSFile::jump(const Instruction &inst) {
+	if (inst.args[0] < 0)
+		throw Common::Exception("NCSFile::jump(): Jump from 0x%08X to an invalid offset", inst.address);
 
-	// TODO
+	_pc = inst.args[0];
+}
 
-	_script->seek(oldScriptPos);
+void NCSFile::traceInstruction(const Instruction &inst) const {
+	debugC(kDebugScripts, 1, "NWScript opcode %s [0x%02X] at 0x%08X",
+	       getOpcodeName(inst.opcode), (uint)inst.opcode, inst.address);
 }
 
 // OPCODES!
 
 /** RSADD: push an empty variable onto the stack. */
-void NCSFile::o_rsadd(InstructionType type) {
-	switch (type) {
+void NCSFile::o_rsadd(const Instruction &inst) {
+	switch (inst.type) {
 		case kInstTypeInt:
 			_stack.push(kTypeInt);
 			break;
@@ -495,26 +516,25 @@ void NCSFile::o_rsadd(InstructionType type) {
 			_stack.push(kTypeArray);
 			break;
 		default:
-			throw Common::Exception("NCSFile::o_rsadd(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_rsadd(): Illegal type %d", inst.type);
 	}
 }
 
 /** CONST: push a constant (predetermined value) variable onto the stack. */
-void NCSFile::o_const(InstructionType type) {
-	switch (type) {
+void NCSFile::o_const(const Instruction &inst) {
+	switch (inst.type) {
 		case kInstTypeInt:
-			_stack.push(_script->readSint32BE());
+			_stack.push(inst.args[0]);
 			break;
 
 		case kInstTypeFloat:
-			_stack.push(_script->readIEEEFloatBE());
+			_stack.push(convertIEEEFloat((uint32_t) inst.args[0]));
 			break;
 
 		case kInstTypeString:
-		case kInstTypeResource: {
-			_stack.push(Common::readStringFixed(*_script, Common::kEncodingASCII, _script->readUint16BE()));
+		case kInstTypeResource:
+			_stack.push(_program->getString(inst.args[0]));
 			break;
-		}
 
 		case kInstTypeObject: {
 			/* The scripts only know of two constant objects:
@@ -525,7 +545,7 @@ void NCSFile::o_const(InstructionType type) {
 			 * magic values. They *should* all have the same effect, though.
 			 */
 
-			uint32_t objectID = _script->readUint32BE();
+			const uint32_t objectID = (uint32_t) inst.args[0];
 
 			if      (objectID == kScriptObjectSelf)
 				_stack.push(_owner);
@@ -542,7 +562,7 @@ void NCSFile::o_const(InstructionType type) {
 		}
 
 		default:
-			throw Common::Exception("NCSFile::o_const(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_const(): Illegal type %d", inst.type);
 	}
 }
 
@@ -620,7 +640,7 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 		case kTypeObject:
 		case kTypeEngineType:
 		case kTypeArray:
-			_stack.push(retVal);
+			_stack.push(std::move(retVal));
 			break;
 
 		case kTypeVector: {
@@ -643,14 +663,15 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 }
 
 /** ACTION: call a game-specific engine function. */
-void NCSFile::o_action(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_action(): Illegal type %d", type);
+void NCSFile::o_action(const Instruction &inst) {
+	if (inst.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_action(): Illegal type %d", inst.type);
 
-	uint16_t routineNumber = _script->readUint16BE();
-	uint8_t  argCount      = _script->readByte();
+	const uint16_t routineNumber = inst.args[0];
+	const uint8_t  argCount      = inst.args[1];
 
-	Aurora::NWScript::FunctionContext ctx = FunctionMan.createContext(routineNumber);
+	FunctionContext &ctx = _functionContext;
+	FunctionMan.resetContext(routineNumber, ctx);
 
 	try {
 		callEngine(ctx, routineNumber, argCount);
@@ -662,9 +683,9 @@ void NCSFile::o_action(InstructionType type) {
 }
 
 /** LOGAND: perform a logical boolean AND (&&). */
-void NCSFile::o_logand(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_logand(): Illegal type %d", type);
+void NCSFile::o_logand(const Instruction &inst) {
+	if (inst.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_logand(): Illegal type %d", inst.type);
 
 	int32_t arg1 = _stack.pop().getInt();
 	int32_t arg2 = _stack.pop().getInt();
@@ -672,9 +693,9 @@ void NCSFile::o_logand(InstructionType type) {
 }
 
 /** LOGOR: perform a logical boolean OR (||). */
-void NCSFile::o_logor(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_logor(): Illegal type %d", type);
+void NCSFile::o_logor(const Instruction &inst) {
+	if (inst.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_logor(): Illegal type %d", inst.type);
 
 	int32_t arg1 = _stack.pop().getInt();
 	int32_t arg2 = _stack.pop().getInt();
@@ -682,9 +703,9 @@ void NCSFile::o_logor(InstructionType type) {
 }
 
 /** INCOR: perform a bit-wise inclusive OR (|). */
-void NCSFile::o_incor(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_incor(): Illegal type %d", type);
+void NCSFile::o_incor(const Instruction &inst) {
+	if (inst.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_incor(): Illegal type %d", inst.type);
 
 	int32_t arg1 = _stack.pop().getInt();
 	int32_t arg2 = _stack.pop().getInt();
@@ -692,9 +713,9 @@ void NCSFile::o_incor(InstructionType type) {
 }
 
 /** EXCOR: perform a bit-wise exclusive OR (^). */
-void NCSFile::o_excor(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_excor(): Illegal type %d", type);
+void NCSFile::o_excor(const Instruction &inst) {
+	if (inst.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_excor(): Illegal type %d", inst.type);
 
 	int32_t arg1 = _stack.pop().getInt();
 	int32_t arg2 = _stack.pop().getInt();
@@ -702,23 +723,37 @@ void NCSFile::o_excor(InstructionType type) {
 }
 
 /** BOOLAND: perform a bit-wise AND (&). */
-void NCSFile::o_booland(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_booland(): Illegal type %d", type);
+void NCSFile::o_booland(const Instruction &inst) {
+	if (inst.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_booland(): Illegal type %d", inst.type);
 
 	int32_t arg1 = _stack.pop().getInt();
 	int32_t arg2 = _stack.pop().getInt();
 	_stack.push(arg1 & arg2);
 }
 
+bool NCSFile::popCompare(size_t n) {
+	// Compare in place, without popping the elements into temporary variables
+
+	const int32_t size = n * 4;
+
+	bool equal = true;
+	for (int32_t pos = -4; equal && (pos >= -size); pos -= 4)
+		equal = _stack.getRelSP(pos) == _stack.getRelSP(pos - size);
+
+	_stack.setStackPtr(_stack.getStackPtr() + 2 * size);
+
+	return equal;
+}
+
 /** EQ: compare the top-most stack elements for equality (==). */
-void NCSFile::o_eq(InstructionType type) {
+void NCSFile::o_eq(const Instruction &inst) {
 	size_t n = 1;
 
-	if (type == kInstTypeStructStruct) {
+	if (inst.type == kInstTypeStructStruct) {
 		// Comparisons between two structs (or two vectors) come with the size of the type
 
-		const size_t size = _script->readUint16BE();
+		const size_t size = inst.args[0];
 
 		if ((size % 4) != 0)
 			throw Common::Exception("NCSFile::o_eq(): size %% 4 != 0");
@@ -726,28 +761,17 @@ void NCSFile::o_eq(InstructionType type) {
 		n = size / 4;
 	}
 
-	std::vector<Variable> args1, args2;
-
-	args1.reserve(n);
-	args2.reserve(n);
-
-	for (size_t i = 0; i < n; i++)
-		args1.push_back(_stack.pop());
-
-	for (size_t i = 0; i < n; i++)
-		args2.push_back(_stack.pop());
-
-	_stack.push(args1 == args2);
+	_stack.push((int32_t) popCompare(n));
 }
 
 /** NEQ: compare the top-most stack elements for inequality (!=). */
-void NCSFile::o_neq(InstructionType type) {
+void NCSFile::o_neq(const Instruction &inst) {
 	size_t n = 1;
 
-	if (type == kInstTypeStructStruct) {
+	if (inst.type == kInstTypeStructStruct) {
 		// Comparisons between two structs (or two vectors) come with the size of the type
 
-		const size_t size = _script->readUint16BE();
+		const size_t size = inst.args[0];
 
 		if ((size % 4) != 0)
 			throw Common::Exception("NCSFile::o_neq(): size %% 4 != 0");
@@ -755,23 +779,12 @@ void NCSFile::o_neq(InstructionType type) {
 		n = size / 4;
 	}
 
-	std::vector<Variable> args1, args2;
-
-	args1.reserve(n);
-	args2.reserve(n);
-
-	for (size_t i = 0; i < n; i++)
-		args1.push_back(_stack.pop());
-
-	for (size_t i = 0; i < n; i++)
-		args2.push_back(_stack.pop());
-
-	_stack.push(args1 != args2);
+	_stack.push((int32_t) !popCompare(n));
 }
 
 /** GEQ: compare the top-most stack elements, greater-or-equal (>=). */
-void NCSFile::o_geq(InstructionType type) {
-	switch (type) {
+void NCSFile::o_geq(const Instruction &inst) {
+	switch (inst.type) {
 		case kInstTypeIntInt:
 			{
 				int32_t arg1 = _stack.pop().getInt();
@@ -789,13 +802,13 @@ void NCSFile::o_geq(InstructionType type) {
 			break;
 
 		default:
-			throw Common::Exception("NCSFile::o_geq(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_geq(): Illegal type %d", inst.type);
 	}
 }
 
 /** GT: compare the top-most stack elements, greater (>). */
-void NCSFile::o_gt(InstructionType type) {
-	switch (type) {
+void NCSFile::o_gt(const Instruction &inst) {
+	switch (inst.type) {
 		case kInstTypeIntInt:
 			{
 				int32_t arg1 = _stack.pop().getInt();
@@ -813,13 +826,13 @@ void NCSFile::o_gt(InstructionType type) {
 			break;
 
 		default:
-			throw Common::Exception("NCSFile::o_gt(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_gt(): Illegal type %d", inst.type);
 	}
 }
 
 /** LT: compare the top-most stack elements, less (<). */
-void NCSFile::o_lt(InstructionType type) {
-	switch (type) {
+void NCSFile::o_lt(const Instruction &inst) {
+	switch (inst.type) {
 		case kInstTypeIntInt:
 			{
 				int32_t arg1 = _stack.pop().getInt();
@@ -837,13 +850,13 @@ void NCSFile::o_lt(InstructionType type) {
 			break;
 
 		default:
-			throw Common::Exception("NCSFile::o_lt(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_lt(): Illegal type %d", inst.type);
 	}
 }
 
 /** LEQ: compare the top-most stack elements, less-or-equal (<=). */
-void NCSFile::o_leq(InstructionType type) {
-	switch (type) {
+void NCSFile::o_leq(const Instruction &inst) {
+	switch (inst.type) {
 		case kInstTypeIntInt:
 			{
 				int32_t arg1 = _stack.pop().getInt();
@@ -861,14 +874,14 @@ void NCSFile::o_leq(InstructionType type) {
 			break;
 
 		default:
-			throw Common::Exception("NCSFile::o_leq(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_leq(): Illegal type %d", inst.type);
 	}
 }
 
 /** SHLEFT: shift the top-most stack element to the left (<<). */
-void NCSFile::o_shleft(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_shleft(): Illegal type %d", type);
+void NCSFile::o_shleft(const Instruction &inst) {
+	if (inst.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_shleft(): Illegal type %d", inst.type);
 
 	int32_t arg1 = _stack.pop().getInt();
 	int32_t arg2 = _stack.pop().getInt();
@@ -876,15 +889,15 @@ void NCSFile::o_shleft(InstructionType type) {
 }
 
 /** SHRIGHT: signed-shift the top-most stack element to the right (>>>). */
-void NCSFile::o_shright(InstructionType type) {
+void NCSFile::o_shright(const Instruction &inst) {
 	/* According to Skywing's NWNScriptLib
 	 * (<https://github.com/SkywingvL/nwn2dev-public/blob/master/NWNScriptLib/NWScriptVM.cpp#L2233>):
 	 * "The operation implemented here is actually a complex sequence that, if
 	 *  the amount to be shifted is negative, involves both a front-loaded and
 	 *  end-loaded negate built on top of a signed shift." */
 
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_shright(): Illegal type %d", type);
+	if (inst.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_shright(): Illegal type %d", inst.type);
 
 	int32_t arg1 = _stack.pop().getInt();
 	int32_t arg2 = _stack.pop().getInt();
@@ -897,14 +910,14 @@ void NCSFile::o_shright(InstructionType type) {
 }
 
 /** USHRIGHT: shift the top-most stack element to the right (>>). */
-void NCSFile::o_ushright(InstructionType type) {
+void NCSFile::o_ushright(const Instruction &inst) {
 	/* According to Skywing's NWNScriptLib
 	 * (<https://github.com/SkywingvL/nwn2dev-public/blob/master/NWNScriptLib/NWScriptVM.cpp#L2272>):
 	 * "While this operator may have originally been intended to implement
 	 *  an unsigned shift, it actually performs an arithmetic (signed) shift." */
 
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_ushright(): Illegal type %d", type);
+	if (inst.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_ushright(): Illegal type %d", inst.type);
 
 	int32_t arg1 = _stack.pop().getInt();
 	int32_t arg2 = _stack.pop().getInt();
@@ -912,9 +925,9 @@ void NCSFile::o_ushright(InstructionType type) {
 }
 
 /** MOD: calculate the remainder (modulo) of an integer division (%). */
-void NCSFile::o_mod(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_mod(): Illegal type %d", type);
+void NCSFile::o_mod(const Instruction &inst) {
+	if (inst.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_mod(): Illegal type %d", inst.type);
 
 	int32_t arg1 = _stack.pop().getInt();
 	int32_t arg2 = _stack.pop().getInt();
@@ -928,8 +941,8 @@ void NCSFile::o_mod(InstructionType type) {
 }
 
 /** NEQ: negate the top-most stack element (unary -). */
-void NCSFile::o_neg(InstructionType type) {
-	switch (type) {
+void NCSFile::o_neg(const Instruction &inst) {
+	switch (inst.type) {
 		case kInstTypeInt:
 			_stack.push(-_stack.pop().getInt());
 			break;
@@ -939,101 +952,96 @@ void NCSFile::o_neg(InstructionType type) {
 			break;
 
 		default:
-			throw Common::Exception("NCSFile::o_neg(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_neg(): Illegal type %d", inst.type);
 	}
 }
 
 /** COMP: calculate the 1-complement of the top-most stack element (~). */
-void NCSFile::o_comp(InstructionType type) {
-	if (type != kInstTypeInt)
-		throw Common::Exception("NCSFile::o_comp(): Illegal type %d", type);
+void NCSFile::o_comp(const Instruction &inst) {
+	if (inst.type != kInstTypeInt)
+		throw Common::Exception("NCSFile::o_comp(): Illegal type %d", inst.type);
 
 	_stack.push(~_stack.pop().getInt());
 }
 
 /** MOVSP: pop elements off the stack. */
-void NCSFile::o_movsp(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_movsp(): Illegal type %d", type);
+void NCSFile::o_movsp(const Instruction &inst) {
+	if (inst.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_movsp(): Illegal type %d", inst.type);
 
-	_stack.setStackPtr(_stack.getStackPtr() - _script->readSint32BE());
+	_stack.setStackPtr(_stack.getStackPtr() - inst.args[0]);
 }
 
 /** JMP: jump directly to a different script offset. */
-void NCSFile::o_jmp(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_jmp(): Illegal type %d", type);
+void NCSFile::o_jmp(const Instruction &inst) {
+	if (inst.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_jmp(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE();
-	_script->skip(offset - 6);
+	jump(inst);
 }
 
 /** JZ: jump conditionally if the top-most stack element is 0. */
-void NCSFile::o_jz(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_jz(): Illegal type %d", type);
-
-	int32_t offset = _script->readSint32BE();
+void NCSFile::o_jz(const Instruction &inst) {
+	if (inst.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_jz(): Illegal type %d", inst.type);
 
 	if (!_stack.pop().getInt())
-		_script->skip(offset - 6);
+		jump(inst);
 }
 
 /** NOT: boolean-negate the top-most stack element (!). */
-void NCSFile::o_not(InstructionType type) {
-	if (type != kInstTypeInt)
-		throw Common::Exception("NCSFile::o_not(): Illegal type %d", type);
+void NCSFile::o_not(const Instruction &inst) {
+	if (inst.type != kInstTypeInt)
+		throw Common::Exception("NCSFile::o_not(): Illegal type %d", inst.type);
 
 	_stack.push(!_stack.pop().getInt());
 }
 
 /** DECSP: decrement the value of a stack element (--). */
-void NCSFile::o_decsp(InstructionType type) {
-	if (type != kInstTypeInt)
-		throw Common::Exception("NCSFile::o_decsp(): Illegal type %d", type);
+void NCSFile::o_decsp(const Instruction &inst) {
+	if (inst.type != kInstTypeInt)
+		throw Common::Exception("NCSFile::o_decsp(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE();
+	const int32_t offset = inst.args[0];
 
 	_stack.setRelSP(offset, _stack.getRelSP(offset).getInt() - 1);
 }
 
 /** INCSP: increment the value of a stack element (++). */
-void NCSFile::o_incsp(InstructionType type) {
-	if (type != kInstTypeInt)
-		throw Common::Exception("NCSFile::o_incsp(): Illegal type %d", type);
+void NCSFile::o_incsp(const Instruction &inst) {
+	if (inst.type != kInstTypeInt)
+		throw Common::Exception("NCSFile::o_incsp(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE();
+	const int32_t offset = inst.args[0];
 
 	_stack.setRelSP(offset, _stack.getRelSP(offset).getInt() + 1);
 }
 
 /** JNZ: jump conditionally if the top-most stack element is not 0. */
-void NCSFile::o_jnz(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_jnz(): Illegal type %d", type);
-
-	int32_t offset = _script->readSint32BE();
+void NCSFile::o_jnz(const Instruction &inst) {
+	if (inst.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_jnz(): Illegal type %d", inst.type);
 
 	if (_stack.pop().getInt())
-		_script->skip(offset - 6);
+		jump(inst);
 }
 
 /** DECBP: decrement the value of a base-pointer stack element (--). */
-void NCSFile::o_decbp(InstructionType type) {
-	if (type != kInstTypeInt)
-		throw Common::Exception("NCSFile::o_decbp(): Illegal type %d", type);
+void NCSFile::o_decbp(const Instruction &inst) {
+	if (inst.type != kInstTypeInt)
+		throw Common::Exception("NCSFile::o_decbp(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE();
+	const int32_t offset = inst.args[0];
 
 	_stack.setRelBP(offset, _stack.getRelBP(offset).getInt() - 1);
 }
 
 /** INCBP: increment the value of a base-pointer stack element (++). */
-void NCSFile::o_incbp(InstructionType type) {
-	if (type != kInstTypeInt)
-		throw Common::Exception("NCSFile::o_incbp(): Illegal type %d", type);
+void NCSFile::o_incbp(const Instruction &inst) {
+	if (inst.type != kInstTypeInt)
+		throw Common::Exception("NCSFile::o_incbp(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE();
+	const int32_t offset = inst.args[0];
 
 	_stack.setRelBP(offset, _stack.getRelBP(offset).getInt() + 1);
 }
@@ -1042,9 +1050,9 @@ void NCSFile::o_incbp(InstructionType type) {
  *
  *  Used to create an anchor point to access global variables.
  */
-void NCSFile::o_savebp(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_savebp(): Illegal type %d", type);
+void NCSFile::o_savebp(const Instruction &inst) {
+	if (inst.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_savebp(): Illegal type %d", inst.type);
 
 	_stack.push(_stack.getBasePtr());
 	_stack.setBasePtr(_stack.getStackPtr());
@@ -1054,25 +1062,25 @@ void NCSFile::o_savebp(InstructionType type) {
  *
  *  Destroy the global variables anchor point after use.
  */
-void NCSFile::o_restorebp(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_restorebp(): Illegal type %d", type);
+void NCSFile::o_restorebp(const Instruction &inst) {
+	if (inst.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_restorebp(): Illegal type %d", inst.type);
 
 	_stack.setBasePtr(_stack.pop().getInt());
 }
 
 /** NOP: no operation. */
-void NCSFile::o_nop(InstructionType UNUSED(type)) {
+void NCSFile::o_nop(const Instruction &UNUSED(inst)) {
 	// Nothing! Yay!
 }
 
 /** CPDOWNSP: copy a value into an existing stack element. */
-void NCSFile::o_cpdownsp(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_cpdownsp(): Illegal type %d", type);
+void NCSFile::o_cpdownsp(const Instruction &inst) {
+	if (inst.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_cpdownsp(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE();
-	int16_t size   = _script->readSint16BE();
+	int32_t offset = inst.args[0];
+	int16_t size   = inst.args[1];
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cpdownsp(): Illegal size %d", size);
@@ -1088,12 +1096,12 @@ void NCSFile::o_cpdownsp(InstructionType type) {
 }
 
 /** CPTOPSP: push a copy of a stack element on top of the stack. */
-void NCSFile::o_cptopsp(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_cptopsp(): Illegal type %d", type);
+void NCSFile::o_cptopsp(const Instruction &inst) {
+	if (inst.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_cptopsp(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE();
-	int16_t size   = _script->readSint16BE();
+	int32_t offset = inst.args[0];
+	int16_t size   = inst.args[1];
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cptopsp(): Illegal size %d", size);
@@ -1106,8 +1114,8 @@ void NCSFile::o_cptopsp(InstructionType type) {
 }
 
 /** ADD: add the top-most stack elements (+). */
-void NCSFile::o_add(InstructionType type) {
-	switch (type) {
+void NCSFile::o_add(const Instruction &inst) {
+	switch (inst.type) {
 		case kInstTypeIntInt: {
 			Variable op2 = _stack.pop();
 			Variable op1 = _stack.pop();
@@ -1141,8 +1149,9 @@ void NCSFile::o_add(InstructionType type) {
 		}
 
 		case kInstTypeStringString: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			// Only reading, so that the strings don't need to be unshared
+			const Variable op2 = _stack.pop();
+			const Variable op1 = _stack.pop();
 
 			_stack.push(op1.getString() + op2.getString());
 			break;
@@ -1163,13 +1172,13 @@ void NCSFile::o_add(InstructionType type) {
 		}
 
 		default:
-			throw Common::Exception("NCSFile::o_add(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_add(): Illegal type %d", inst.type);
 	}
 }
 
 /** SUB: subtract the top-most stack elements (-). */
-void NCSFile::o_sub(InstructionType type) {
-	switch (type) {
+void NCSFile::o_sub(const Instruction &inst) {
+	switch (inst.type) {
 		case kInstTypeIntInt: {
 			Variable op2 = _stack.pop();
 			Variable op1 = _stack.pop();
@@ -1217,13 +1226,13 @@ void NCSFile::o_sub(InstructionType type) {
 		}
 
 		default:
-			throw Common::Exception("NCSFile::o_sub(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_sub(): Illegal type %d", inst.type);
 	}
 }
 
 /** MUL: multiply the top-most stack elements (*). */
-void NCSFile::o_mul(InstructionType type) {
-	switch (type) {
+void NCSFile::o_mul(const Instruction &inst) {
+	switch (inst.type) {
 		case kInstTypeIntInt: {
 			Variable op2 = _stack.pop();
 			Variable op1 = _stack.pop();
@@ -1281,13 +1290,13 @@ void NCSFile::o_mul(InstructionType type) {
 		}
 
 		default:
-			throw Common::Exception("NCSFile::o_mul(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_mul(): Illegal type %d", inst.type);
 	}
 }
 
 /** DIV: divide the top-most stack elements (/). */
-void NCSFile::o_div(InstructionType type) {
-	switch (type) {
+void NCSFile::o_div(const Instruction &inst) {
+	switch (inst.type) {
 		case kInstTypeIntInt: {
 			Variable op2 = _stack.pop();
 			Variable op1 = _stack.pop();
@@ -1366,13 +1375,13 @@ void NCSFile::o_div(InstructionType type) {
 		}
 
 		default:
-			throw Common::Exception("NCSFile::o_div(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_div(): Illegal type %d", inst.type);
 	}
 }
 
 /** STORESTATEALL: unused, obsolete opcode. Hopefully. */
-void NCSFile::o_storestateall(InstructionType type) {
-	uint8_t  offset = (uint8_t) type;
+void NCSFile::o_storestateall(const Instruction &inst) {
+	uint8_t  offset = (uint8_t) inst.type;
 
 	// TODO: NCSFile::o_storestateall(): See o_storestate.
 	//       Supposedly obsolete. Whether it's used anywhere remains to be seen.
@@ -1380,37 +1389,36 @@ void NCSFile::o_storestateall(InstructionType type) {
 }
 
 /** JSR: call a subroutine. */
-void NCSFile::o_jsr(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_jsr(): Illegal type %d", type);
+void NCSFile::o_jsr(const Instruction &inst) {
+	if (inst.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_jsr(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE();
+	// Push the position of the next instruction
+	_returnOffsets.push(_pc);
 
-	// Push the current script position
-	_returnOffsets.push(_script->pos());
-
-	_script->skip(offset - 6);
+	jump(inst);
 }
 
 /** RETN: return from a subroutine call. */
-void NCSFile::o_retn(InstructionType UNUSED(type)) {
-	uint32_t returnAddress = _script->size();
-	if (!_returnOffsets.empty()) {
-		returnAddress = _returnOffsets.top();
-		_returnOffsets.pop();
+void NCSFile::o_retn(const Instruction &UNUSED(inst)) {
+	// Returning from the outermost subroutine ends the script
+	if (_returnOffsets.empty()) {
+		_pc = _program->getInstructions().size();
+		return;
 	}
 
-	_script->seek(returnAddress);
+	_pc = _returnOffsets.top();
+	_returnOffsets.pop();
 }
 
 /** DESTRUCT: remove elements from the stack.
  *
  *  Used to isolate struct elements.
  */
-void NCSFile::o_destruct(InstructionType UNUSED(type)) {
-	int16_t stackSize        = _script->readSint16BE();
-	int16_t dontRemoveOffset = _script->readSint16BE();
-	int16_t dontRemoveSize   = _script->readSint16BE();
+void NCSFile::o_destruct(const Instruction &inst) {
+	int16_t stackSize        = inst.args[0];
+	int16_t dontRemoveOffset = inst.args[1];
+	int16_t dontRemoveSize   = inst.args[2];
 
 	if ((stackSize % 4) != 0)
 		throw Common::Exception("NCSFile::o_destruct(): Illegal stack size %d", stackSize);
@@ -1419,34 +1427,28 @@ void NCSFile::o_destruct(InstructionType UNUSED(type)) {
 	if ((dontRemoveSize % 4) != 0)
 		throw Common::Exception("NCSFile::o_destruct(): Illegal size %d", dontRemoveSize);
 
-	std::vector<Variable> tmp;
-	tmp.reserve(dontRemoveSize / 4);
-
-	while (stackSize > 0) {
+	/* The elements to keep are dontRemoveOffset bytes above the bottom of the
+	 * destructed stack area. Move them down to the bottom, then pop the rest. */
 
-		if ((stackSize <= (dontRemoveOffset + dontRemoveSize)) &&
-		    (stackSize >   dontRemoveOffset))
-			tmp.push_back(_stack.top());
+	const int32_t keepSize = MAX<int32_t>(MIN<int32_t>(dontRemoveSize, stackSize - dontRemoveOffset), 0);
 
-		_stack.pop();
+	if (dontRemoveOffset > 0)
+		for (int32_t pos = -stackSize; pos < (-stackSize + keepSize); pos += 4)
+			_stack.getRelSP(pos) = std::move(_stack.getRelSP(pos + dontRemoveOffset));
 
-		stackSize -= 4;
-	}
-
-	for (std::vector<Variable>::reverse_iterator t = tmp.rbegin(); t != tmp.rend(); ++t)
-		_stack.push(*t);
+	_stack.setStackPtr(_stack.getStackPtr() + stackSize - keepSize);
 }
 
 /** CPDOWNBP: copy a value into an existing base-pointer stack element.
  *
  *  Used to write into a global variable.
  */
-void NCSFile::o_cpdownbp(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_cpdownbp(): Illegal type %d", type);
+void NCSFile::o_cpdownbp(const Instruction &inst) {
+	if (inst.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_cpdownbp(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE() - 4;
-	int16_t size   = _script->readSint16BE();
+	int32_t offset = inst.args[0] - 4;
+	int16_t size   = inst.args[1];
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cpdownbp(): Illegal size %d", size);
@@ -1465,12 +1467,12 @@ void NCSFile::o_cpdownbp(InstructionType type) {
  *
  *  Used to read from a global variable.
  */
-void NCSFile::o_cptopbp(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_cptopbp(): Illegal type %d", type);
+void NCSFile::o_cptopbp(const Instruction &inst) {
+	if (inst.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_cptopbp(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE() - 4;
-	int16_t size   = _script->readSint16BE();
+	int32_t offset = inst.args[0] - 4;
+	int16_t size   = inst.args[1];
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cptopbp(): Illegal size %d", size);
@@ -1488,10 +1490,10 @@ void NCSFile::o_cptopbp(InstructionType type) {
  *  Used to create the "action" variables when calling an engine function that
  *  assigns a function to an object, or delays a function, or similar.
  */
-void NCSFile::o_storestate(InstructionType type) {
-	uint8_t  offset = (uint8_t) type;
-	uint32_t sizeBP = _script->readUint32BE();
-	uint32_t sizeSP = _script->readUint32BE();
+void NCSFile::o_storestate(const Instruction &inst) {
+	uint8_t  offset = (uint8_t) inst.type;
+	uint32_t sizeBP = (uint32_t) inst.args[0];
+	uint32_t sizeSP = (uint32_t) inst.args[1];
 
 	if ((sizeBP % 4) != 0)
 		throw Common::Exception("NCSFile::o_storestate(): Illegal BP size %d", sizeBP);
@@ -1501,7 +1503,7 @@ void NCSFile::o_storestate(InstructionType type) {
 	_storedState.setType(kTypeScriptState);
 	ScriptState &state = _storedState.getScriptState();
 
-	state.offset = _script->pos() - 10 + offset;
+	state.offset = inst.address + offset;
 
 	sizeBP /= 4;
 	sizeSP /= 4;
@@ -1524,12 +1526,12 @@ void NCSFile::o_storestate(InstructionType type) {
  *
  *  The index is popped off the stack, but the value written remains.
  */
-void NCSFile::o_writearray(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_writearray(): Illegal type %d", type);
+void NCSFile::o_writearray(const Instruction &inst) {
+	if (inst.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_writearray(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE();
-	int16_t size   = _script->readSint16BE();
+	int32_t offset = inst.args[0];
+	int16_t size   = inst.args[1];
 
 	if (size != 4)
 		throw Common::Exception("NCSFile::o_writearray(): Invalid size %d", size);
@@ -1559,12 +1561,12 @@ void NCSFile::o_writearray(InstructionType type) {
  *  The index is popped off the stack, and the value read out of the
  *  array is pushed on top.
  */
-void NCSFile::o_readarray(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_readarray(): Illegal type %d", type);
+void NCSFile::o_readarray(const Instruction &inst) {
+	if (inst.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_readarray(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE();
-	int16_t size   = _script->readSint16BE();
+	int32_t offset = inst.args[0];
+	int16_t size   = inst.args[1];
 
 	if (size != 4)
 		throw Common::Exception("NCSFile::o_readarray(): Invalid size %d", size);
@@ -1591,12 +1593,12 @@ void NCSFile::o_readarray(InstructionType type) {
  *  The offset to the variable to create a reference to is passed
  *  as a direct argument to the instruction.
  */
-void NCSFile::o_getref(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_getref(): Illegal type %d", type);
+void NCSFile::o_getref(const Instruction &inst) {
+	if (inst.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_getref(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE();
-	int16_t size   = _script->readSint16BE();
+	int32_t offset = inst.args[0];
+	int16_t size   = inst.args[1];
 
 	if (size != 4)
 		throw Common::Exception("NCSFile::o_getref(): Invalid size %d", size);
@@ -1622,12 +1624,12 @@ void NCSFile::o_getref(InstructionType type) {
  *  The index is popped off the stack, and the reference to the
  *  variable inside the array is pushed on top.
  */
-void NCSFile::o_getrefarray(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_getrefarray(): Illegal type %d", type);
+void NCSFile::o_getrefarray(const Instruction &inst) {
+	if (inst.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_getrefarray(): Illegal type %d", inst.type);
 
-	int32_t offset = _script->readSint32BE();
-	int16_t size   = _script->readSint16BE();
+	int32_t offset = inst.args[0];
+	int16_t size   = inst.args[1];
 
 	if (size != 4)
 		throw Common::Exception("NCSFile::o_getrefarray(): Invalid size %d", size);
@@ -1645,6 +1647,12 @@ void NCSFile::o_getrefarray(InstructionType type) {
 	_stack.top().setReference(&*array[index]);
 }
 
+/** Not an actual opcode: the bytecode couldn't be decoded at this point. */
+void NCSFile::o_broken(const Instruction &inst) {
+	throw Common::Exception("NCSFile::o_broken(): Broken instruction at 0x%08X: %s",
+	                        inst.address, _program->getString(inst.args[0]).getString().c_str());
+}
+
 } // End of namespace NWScript
 
 } // End of namespace Aurora
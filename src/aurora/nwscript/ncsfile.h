@@ -38,6 +38,8 @@
 #include "src/aurora/nwscript/variable.h"
 #include "src/aurora/nwscript/variablecontainer.h"
 #include "src/aurora/nwscript/objectref.h"
+#include "src/aurora/nwscript/functioncontext.h"
+#include "src/aurora/nwscript/ncsprogram.h"
 
 namespace Common {
 	class UString;
@@ -60,6 +62,7 @@ public:
 	Variable &top();
 	Variable pop();
 	void push(const Variable &obj);
+	void push(Variable &&obj);
 
 	Variable &getRelSP(int32_t pos);
 	void setRelSP(int32_t pos, const Variable &obj);
@@ -80,12 +83,19 @@ private:
 	int32_t _basePtr;
 };
 
-#define DECLARE_OPCODE(x) void x(InstructionType type)
+#define DECLARE_OPCODE(x) void x(const Instruction &inst)
 
-/** An NCS, BioWare's NWN Compile Script. */
+/** An NCS, BioWare's NWN Compile Script.
+ *
+ *  An NCSFile holds the state of running a script: its stack, environment
+ *  and the objects it runs on. The bytecode itself is an NCSProgram, which
+ *  is shared with all other NCSFile instances running the same script.
+ */
 class NCSFile : public AuroraFile {
 public:
+	/** Load the script's bytecode out of this stream, taking it over. */
 	NCSFile(Common::SeekableReadStream *ncs);
+	/** Use the script's bytecode out of the program cache. */
 	NCSFile(const Common::UString &ncs);
 	~NCSFile();
 
@@ -125,64 +135,23 @@ public:
 	/** Get the string parameter. */
 	const Common::UString &getParameterString() const;
 
+	/** Return the number of instructions executed in the last run. */
+	size_t getInstructionCount() const;
+
 	static ScriptState getEmptyState();
 
 private:
-	enum InstructionType {
-		// Unary
-		kInstTypeNone        =  0,
-		kInstTypeDirect      =  1,
-		kInstTypeInt         =  3,
-		kInstTypeFloat       =  4,
-		kInstTypeString      =  5,
-		kInstTypeObject      =  6,
-		kInstTypeResource    = 96,
-		kInstTypeEngineType0 = 16, // NWN:     effect        DA: event
-		kInstTypeEngineType1 = 17, // NWN:     event         DA: location
-		kInstTypeEngineType2 = 18, // NWN:     location      DA: command
-		kInstTypeEngineType3 = 19, // NWN:     talent        DA: effect
-		kInstTypeEngineType4 = 20, // NWN:     itemproperty  DA: itemproperty
-		kInstTypeEngineType5 = 21, // Witcher: mod           DA: player
-
-		// Arrays
-		kInstTypeIntArray          = 64,
-		kInstTypeFloatArray        = 65,
-		kInstTypeStringArray       = 66,
-		kInstTypeObjectArray       = 67,
-		kInstTypeResourceArray     = 68,
-		kInstTypeEngineType0Array  = 80,
-		kInstTypeEngineType1Array  = 81,
-		kInstTypeEngineType2Array  = 82,
-		kInstTypeEngineType3Array  = 83,
-		kInstTypeEngineType4Array  = 84,
-		kInstTypeEngineType5Array  = 85,
-
-		// Binary
-		kInstTypeIntInt                 = 32,
-		kInstTypeFloatFloat             = 33,
-		kInstTypeObjectObject           = 34,
-		kInstTypeStringString           = 35,
-		kInstTypeStructStruct           = 36,
-		kInstTypeIntFloat               = 37,
-		kInstTypeFloatInt               = 38,
-		kInstTypeEngineType0EngineType0 = 48,
-		kInstTypeEngineType1EngineType1 = 49,
-		kInstTypeEngineType2EngineType2 = 50,
-		kInstTypeEngineType3EngineType3 = 51,
-		kInstTypeEngineType4EngineType4 = 52,
-		kInstTypeEngineType5EngineType5 = 53,
-		kInstTypeVectorVector           = 58,
-		kInstTypeVectorFloat            = 59,
-		kInstTypeFloatVector            = 60
-	};
-
 	Common::UString _name;
 
 	std::vector<int> _parameters;
 	Common::UString _parameterString;
 
 	NCSStack _stack;
-	std::unique_ptr<Common::SeekableReadStream> _script;
+
+	std::shared_ptr<const NCSProgram> _program; ///< The script's bytecode.
+
+	size_t _pc;                ///< Index of the next instruction to execute.
+	size_t _instructionCount;  ///< Number of instructions executed in the current run.
 
 	Variable _return;
 
@@ -191,18 +160,12 @@ private:
 
 	VariableContainer _env;
 
-	std::stack<uint32_t> _returnOffsets;
+	std::stack<size_t> _returnOffsets; ///< Instruction indices to return to.
 
 	Variable _storedState;
 
-	typedef void (NCSFile::*OpcodeProc)(InstructionType type);
-	struct Opcode {
-		OpcodeProc proc;
-		const char *desc;
-	};
-	const Opcode *_opcodes;
-	size_t _opcodeListSize;
-	void setupOpcodes();
+	/** The context for calling engine functions, reused to not allocate new parameters for every call. */
+	FunctionContext _functionContext;
 
 	void load();
 
@@ -212,13 +175,19 @@ private:
 	const Variable &execute(const ObjectReference owner = ObjectReference(),
 	                        const ObjectReference triggerer = ObjectReference());
 
-	/** Execute one script step. */
-	bool executeStep();
+	/** Execute one instruction. */
+	void executeInstruction(const Instruction &inst);
+	/** Continue execution at the target of this jump instruction. */
+	void jump(const Instruction &inst);
 
-	void decompile(); // TODO
+	/** Print the instruction that's about to be executed. */
+	void traceInstruction(const Instruction &inst) const;
 
 	void callEngine(Aurora::NWScript::FunctionContext &ctx, uint32_t function, uint8_t argCount);
 
+	/** Pop two times this many elements off the stack, and compare the two halves. */
+	bool popCompare(size_t n);
+
 	// Opcode declarations
 	DECLARE_OPCODE(o_nop);
 	DECLARE_OPCODE(o_cpdownsp);
@@ -269,6 +238,7 @@ private:
 	DECLARE_OPCODE(o_readarray);
 	DECLARE_OPCODE(o_getref);
 	DECLARE_OPCODE(o_getrefarray);
+	DECLARE_OPCODE(o_broken);
 };
 
 #undef DECLARE_OPCODE
@@ -0,0 +1,293 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  The bytecode of a BioWare NWN Compiled Script.
+ */
+
+#include <cassert>
+#include <algorithm>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
+#include "src/common/encoding.h"
+
+#include "src/aurora/aurorafile.h"
+
+#include "src/aurora/nwscript/ncsprogram.h"
+
+static const uint32_t kNCSTag    = MKTAG('N', 'C', 'S', ' ');
+static const uint32_t kVersion10 = MKTAG('V', '1', '.', '0');
+
+static const uint32_t kCodeStart = 13; // 8 byte header + 5 byte program size dummy op
+
+namespace Aurora {
+
+namespace NWScript {
+
+NCSProgram::NCSProgram(Common::SeekableReadStream &ncs, const Common::UString &name) :
+	_name(name), _size(0) {
+
+	try {
+		load(ncs);
+	} catch (Common::Exception &e) {
+		e.add("Failed loading NCS \"%s\"", _name.c_str());
+		throw;
+	}
+}
+
+NCSProgram::~NCSProgram() {
+}
+
+const Common::UString &NCSProgram::getName() const {
+	return _name;
+}
+
+const byte *NCSProgram::getData() const {
+	return _data.get();
+}
+
+size_t NCSProgram::getSize() const {
+	return _size;
+}
+
+const std::vector<Instruction> &NCSProgram::getInstructions() const {
+	return _instructions;
+}
+
+const Variable &NCSProgram::getString(size_t index) const {
+	assert(index < _strings.size());
+
+	return _strings[index];
+}
+
+bool NCSProgram::findInstruction(uint32_t address, size_t &index) const {
+	if (address == _size) {
+		index = _instructions.size();
+		return true;
+	}
+
+	std::vector<Instruction>::const_iterator inst =
+		std::lower_bound(_instructions.begin(), _instructions.end(), address,
+		                 [](const Instruction &i, uint32_t a) { return i.address < a; });
+
+	if ((inst == _instructions.end()) || (inst->address != address))
+		return false;
+
+	index = inst - _instructions.begin();
+	return true;
+}
+
+void NCSProgram::load(Common::SeekableReadStream &ncs) {
+	ncs.seek(0);
+
+	uint32_t id, version;
+	AuroraFile::readHeader(ncs, id, version);
+
+	if (id != kNCSTag)
+		throw Common::Exception("Try to load non-NCS file");
+
+	if (version != kVersion10)
+		throw Common::Exception("Unsupported NCS file version %08X", version);
+
+	byte lengthOpcode = ncs.readByte();
+	if (lengthOpcode != 0x42)
+		throw Common::Exception("Script size opcode != 0x42 (0x%02X)", lengthOpcode);
+
+	uint32_t length = ncs.readUint32BE();
+	if (length > ((uint32_t) ncs.size()))
+		throw Common::Exception("Script size %u > stream size %u", length, (uint)ncs.size());
+	if (length < ((uint32_t) ncs.size()))
+		warning("TODO: NCSProgram::load(): Script size %u < stream size %u", length, (uint)ncs.size());
+
+	_size = ncs.size();
+	_data = std::make_unique<byte[]>(_size);
+
+	ncs.seek(0);
+	if (ncs.read(_data.get(), _size) != _size)
+		throw Common::Exception(Common::kReadError);
+
+	decode();
+}
+
+void NCSProgram::decode() {
+	Common::MemoryReadStream ncs(_data.get(), _size);
+	ncs.seek(kCodeStart);
+
+	/* NCS bytecode is a plain sequence of variable-length instructions,
+	 * without any data mixed in, so we can decode it in one linear pass.
+	 *
+	 * If we find something we can't decode, we can't know where the next
+	 * instruction would start, so we stop there. Since the script might
+	 * never actually reach that point, we only remember the error in a
+	 * broken instruction, which throws when it's executed. */
+
+	while ((ncs.size() - ncs.pos()) >= 2) {
+		Instruction inst;
+
+		inst.address = ncs.pos();
+
+		try {
+			decodeInstruction(ncs, inst);
+		} catch (Common::Exception &e) {
+			inst.opcode  = kOpcodeBroken;
+			inst.args[0] = _strings.size();
+
+			_strings.push_back(Common::UString(e.what()));
+			_instructions.push_back(inst);
+			break;
+		}
+
+		_instructions.push_back(inst);
+	}
+
+	resolveJumps();
+}
+
+void NCSProgram::decodeInstruction(Common::SeekableReadStream &ncs, Instruction &inst) {
+	inst.opcode = (Opcode) ncs.readByte();
+	inst.type   = (InstructionType) ncs.readByte();
+
+	inst.args[0] = 0;
+	inst.args[1] = 0;
+	inst.args[2] = 0;
+
+	switch (inst.opcode) {
+		case kOpcodeNOP0:
+		case kOpcodeRSADD:
+		case kOpcodeLOGAND:
+		case kOpcodeLOGOR:
+		case kOpcodeINCOR:
+		case kOpcodeEXCOR:
+		case kOpcodeBOOLAND:
+		case kOpcodeGEQ:
+		case kOpcodeGT:
+		case kOpcodeLT:
+		case kOpcodeLEQ:
+		case kOpcodeSHLEFT:
+		case kOpcodeSHRIGHT:
+		case kOpcodeUSHRIGHT:
+		case kOpcodeADD:
+		case kOpcodeSUB:
+		case kOpcodeMUL:
+		case kOpcodeDIV:
+		case kOpcodeMOD:
+		case kOpcodeNEG:
+		case kOpcodeCOMP:
+		case kOpcodeSTORESTATEALL:
+		case kOpcodeRETN:
+		case kOpcodeNOT:
+		case kOpcodeSAVEBP:
+		case kOpcodeRESTOREBP:
+		case kOpcodeNOP:
+			break;
+
+		case kOpcodeCPDOWNSP:
+		case kOpcodeCPTOPSP:
+		case kOpcodeCPDOWNBP:
+		case kOpcodeCPTOPBP:
+		case kOpcodeWRITEARRAY:
+		case kOpcodeREADARRAY:
+		case kOpcodeGETREF:
+		case kOpcodeGETREFARRAY:
+			inst.args[0] = ncs.readSint32BE();
+			inst.args[1] = ncs.readSint16BE();
+			break;
+
+		case kOpcodeCONST:
+			switch (inst.type) {
+				case kInstTypeInt:
+				case kInstTypeFloat:
+				case kInstTypeObject:
+					inst.args[0] = ncs.readSint32BE();
+					break;
+
+				case kInstTypeString:
+				case kInstTypeResource:
+					inst.args[0] = _strings.size();
+					_strings.push_back(Common::readStringFixed(ncs, Common::kEncodingASCII, ncs.readUint16BE()));
+					break;
+
+				default:
+					throw Common::Exception("Illegal CONST type %d", inst.type);
+			}
+			break;
+
+		case kOpcodeACTION:
+			inst.args[0] = ncs.readUint16BE();
+			inst.args[1] = ncs.readByte();
+			break;
+
+		case kOpcodeEQ:
+		case kOpcodeNEQ:
+			// Comparisons between two structs (or two vectors) come with the size of the type
+			if (inst.type == kInstTypeStructStruct)
+				inst.args[0] = ncs.readUint16BE();
+			break;
+
+		case kOpcodeMOVSP:
+		case kOpcodeJMP:
+		case kOpcodeJSR:
+		case kOpcodeJZ:
+		case kOpcodeJNZ:
+		case kOpcodeDECSP:
+		case kOpcodeINCSP:
+		case kOpcodeDECBP:
+		case kOpcodeINCBP:
+			inst.args[0] = ncs.readSint32BE();
+			break;
+
+		case kOpcodeDESTRUCT:
+			inst.args[0] = ncs.readSint16BE();
+			inst.args[1] = ncs.readSint16BE();
+			inst.args[2] = ncs.readSint16BE();
+			break;
+
+		case kOpcodeSTORESTATE:
+			inst.args[0] = ncs.readUint32BE();
+			inst.args[1] = ncs.readUint32BE();
+			break;
+
+		default:
+			throw Common::Exception("Illegal instruction 0x%02X", (uint)inst.opcode);
+	}
+}
+
+void NCSProgram::resolveJumps() {
+	// Jump offsets are relative to the start of the jump instruction
+
+	for (std::vector<Instruction>::iterator inst = _instructions.begin(); inst != _instructions.end(); ++inst) {
+		if ((inst->opcode != kOpcodeJMP) && (inst->opcode != kOpcodeJSR) &&
+		    (inst->opcode != kOpcodeJZ)  && (inst->opcode != kOpcodeJNZ))
+			continue;
+
+		size_t target;
+		if (findInstruction(inst->address + inst->args[0], target))
+			inst->args[0] = target;
+		else
+			inst->args[0] = -1;
+	}
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
@@ -0,0 +1,239 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  The bytecode of a BioWare NWN Compiled Script.
+ */
+
+#ifndef AURORA_NWSCRIPT_NCSPROGRAM_H
+#define AURORA_NWSCRIPT_NCSPROGRAM_H
+
+#include <memory>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+
+#include "src/aurora/nwscript/variable.h"
+
+namespace Common {
+	class SeekableReadStream;
+}
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** The type argument of an NCS instruction. */
+enum InstructionType {
+	// Unary
+	kInstTypeNone        =  0,
+	kInstTypeDirect      =  1,
+	kInstTypeInt         =  3,
+	kInstTypeFloat       =  4,
+	kInstTypeString      =  5,
+	kInstTypeObject      =  6,
+	kInstTypeResource    = 96,
+	kInstTypeEngineType0 = 16, // NWN:     effect        DA: event
+	kInstTypeEngineType1 = 17, // NWN:     event         DA: location
+	kInstTypeEngineType2 = 18, // NWN:     location      DA: command
+	kInstTypeEngineType3 = 19, // NWN:     talent        DA: effect
+	kInstTypeEngineType4 = 20, // NWN:     itemproperty  DA: itemproperty
+	kInstTypeEngineType5 = 21, // Witcher: mod           DA: player
+
+	// Arrays
+	kInstTypeIntArray          = 64,
+	kInstTypeFloatArray        = 65,
+	kInstTypeStringArray       = 66,
+	kInstTypeObjectArray       = 67,
+	kInstTypeResourceArray     = 68,
+	kInstTypeEngineType0Array  = 80,
+	kInstTypeEngineType1Array  = 81,
+	kInstTypeEngineType2Array  = 82,
+	kInstTypeEngineType3Array  = 83,
+	kInstTypeEngineType4Array  = 84,
+	kInstTypeEngineType5Array  = 85,
+
+	// Binary
+	kInstTypeIntInt                 = 32,
+	kInstTypeFloatFloat             = 33,
+	kInstTypeObjectObject           = 34,
+	kInstTypeStringString           = 35,
+	kInstTypeStructStruct           = 36,
+	kInstTypeIntFloat               = 37,
+	kInstTypeFloatInt               = 38,
+	kInstTypeEngineType0EngineType0 = 48,
+	kInstTypeEngineType1EngineType1 = 49,
+	kInstTypeEngineType2EngineType2 = 50,
+	kInstTypeEngineType3EngineType3 = 51,
+	kInstTypeEngineType4EngineType4 = 52,
+	kInstTypeEngineType5EngineType5 = 53,
+	kInstTypeVectorVector           = 58,
+	kInstTypeVectorFloat            = 59,
+	kInstTypeFloatVector            = 60
+};
+
+/** The opcode of an NCS instruction. */
+enum Opcode {
+	kOpcodeNOP0          = 0x00, ///< Doesn't exist.
+	kOpcodeCPDOWNSP      = 0x01,
+	kOpcodeRSADD         = 0x02,
+	kOpcodeCPTOPSP       = 0x03,
+	kOpcodeCONST         = 0x04,
+	kOpcodeACTION        = 0x05,
+	kOpcodeLOGAND        = 0x06,
+	kOpcodeLOGOR         = 0x07,
+	kOpcodeINCOR         = 0x08,
+	kOpcodeEXCOR         = 0x09,
+	kOpcodeBOOLAND       = 0x0A,
+	kOpcodeEQ            = 0x0B,
+	kOpcodeNEQ           = 0x0C,
+	kOpcodeGEQ           = 0x0D,
+	kOpcodeGT            = 0x0E,
+	kOpcodeLT            = 0x0F,
+	kOpcodeLEQ           = 0x10,
+	kOpcodeSHLEFT        = 0x11,
+	kOpcodeSHRIGHT       = 0x12,
+	kOpcodeUSHRIGHT      = 0x13,
+	kOpcodeADD           = 0x14,
+	kOpcodeSUB           = 0x15,
+	kOpcodeMUL           = 0x16,
+	kOpcodeDIV           = 0x17,
+	kOpcodeMOD           = 0x18,
+	kOpcodeNEG           = 0x19,
+	kOpcodeCOMP          = 0x1A,
+	kOpcodeMOVSP         = 0x1B,
+	kOpcodeSTORESTATEALL = 0x1C,
+	kOpcodeJMP           = 0x1D,
+	kOpcodeJSR           = 0x1E,
+	kOpcodeJZ            = 0x1F,
+	kOpcodeRETN          = 0x20,
+	kOpcodeDESTRUCT      = 0x21,
+	kOpcodeNOT           = 0x22,
+	kOpcodeDECSP         = 0x23,
+	kOpcodeINCSP         = 0x24,
+	kOpcodeJNZ           = 0x25,
+	kOpcodeCPDOWNBP      = 0x26,
+	kOpcodeCPTOPBP       = 0x27,
+	kOpcodeDECBP         = 0x28,
+	kOpcodeINCBP         = 0x29,
+	kOpcodeSAVEBP        = 0x2A,
+	kOpcodeRESTOREBP     = 0x2B,
+	kOpcodeSTORESTATE    = 0x2C,
+	kOpcodeNOP           = 0x2D,
+	kOpcodeWRITEARRAY    = 0x30,
+	kOpcodeREADARRAY     = 0x32,
+	kOpcodeGETREF        = 0x37,
+	kOpcodeGETREFARRAY   = 0x39,
+
+	kOpcodeBroken        = 0xFF  ///< Pseudo-opcode: the bytecode couldn't be decoded here.
+};
+
+/** A decoded NCS instruction.
+ *
+ *  The meaning of the arguments depends on the opcode:
+ *  - CONST: the integer value, the bit pattern of the float value,
+ *           the index of the string value in the program's string
+ *           table, or the raw object ID
+ *  - ACTION: the engine function number and the argument count
+ *  - JMP, JSR, JZ, JNZ: the index of the target instruction,
+ *                       or -1 if the target isn't an instruction
+ *  - CPDOWNSP, CPTOPSP, CPDOWNBP, CPTOPBP, WRITEARRAY, READARRAY,
+ *    GETREF, GETREFARRAY: the stack offset and the size
+ *  - MOVSP, DECSP, INCSP, DECBP, INCBP: the stack offset
+ *  - EQ, NEQ: the size of the compared structs
+ *  - DESTRUCT: the stack size, the offset and size of the kept elements
+ *  - STORESTATE: the base pointer and stack pointer sizes
+ *  - Broken: the index of the error message in the string table
+ */
+struct Instruction {
+	uint32_t address; ///< The offset of the instruction within the NCS.
+
+	Opcode opcode;
+	InstructionType type;
+
+	int32_t args[3];
+};
+
+/** The validated bytecode of an NCS, BioWare's NWN Compiled Script.
+ *
+ *  On load, the bytecode is decoded into an array of fixed-size instructions,
+ *  with all operands read and all jump offsets resolved into instruction
+ *  indices, so that the NCSFile never has to parse bytecode while running.
+ *
+ *  A program is immutable once loaded, so any number of NCSFile instances,
+ *  each holding the state of one script execution, can share it. Like the
+ *  variables of these scripts, it must not be shared across threads. See the
+ *  ProgramCache for keeping programs around between executions.
+ */
+class NCSProgram : boost::noncopyable {
+public:
+	/** Read the bytecode out of this stream, checking the NCS header. */
+	NCSProgram(Common::SeekableReadStream &ncs, const Common::UString &name = "");
+	~NCSProgram();
+
+	/** Return the name of the script this program was loaded from. */
+	const Common::UString &getName() const;
+
+	/** Return the whole program, including the NCS header. */
+	const byte *getData() const;
+	/** Return the size of the whole program in bytes. */
+	size_t getSize() const;
+
+	/** Return the decoded instructions. */
+	const std::vector<Instruction> &getInstructions() const;
+	/** Return the string out of the program's string table.
+	 *
+	 *  The strings are held as variables, so that pushing a string constant
+	 *  onto the stack only shares the string instead of copying it.
+	 */
+	const Variable &getString(size_t index) const;
+
+	/** Find the index of the instruction starting at this offset within the NCS.
+	 *
+	 *  The end of the NCS is mapped onto the number of instructions, i.e.
+	 *  one past the last instruction. Returns false if there's no instruction
+	 *  starting at this offset.
+	 */
+	bool findInstruction(uint32_t address, size_t &index) const;
+
+private:
+	Common::UString _name;
+
+	std::unique_ptr<byte[]> _data;
+	size_t _size;
+
+	std::vector<Instruction> _instructions;
+	std::vector<Variable> _strings;
+
+	void load(Common::SeekableReadStream &ncs);
+	void decode();
+
+	void decodeInstruction(Common::SeekableReadStream &ncs, Instruction &inst);
+	void resolveJumps();
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+#endif // AURORA_NWSCRIPT_NCSPROGRAM_H
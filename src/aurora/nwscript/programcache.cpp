@@ -0,0 +1,127 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A cache of loaded NWScript programs.
+ */
+
+#include "src/common/error.h"
+#include "src/common/readstream.h"
+
+#include "src/aurora/resman.h"
+
+#include "src/aurora/nwscript/programcache.h"
+#include "src/aurora/nwscript/ncsprogram.h"
+
+DECLARE_SINGLETON(Aurora::NWScript::ProgramCache)
+
+namespace Aurora {
+
+namespace NWScript {
+
+ProgramCache::ProgramCache() : _capacity(kDefaultCapacity), _hits(0), _misses(0) {
+}
+
+ProgramCache::~ProgramCache() {
+}
+
+void ProgramCache::clear() {
+	_entryMap.clear();
+	_entries.clear();
+
+	_hits   = 0;
+	_misses = 0;
+}
+
+void ProgramCache::setCapacity(size_t capacity) {
+	_capacity = capacity;
+
+	prune();
+}
+
+size_t ProgramCache::getCapacity() const {
+	return _capacity;
+}
+
+size_t ProgramCache::getSize() const {
+	return _entries.size();
+}
+
+size_t ProgramCache::getHits() const {
+	return _hits;
+}
+
+size_t ProgramCache::getMisses() const {
+	return _misses;
+}
+
+std::shared_ptr<const NCSProgram> ProgramCache::get(const Common::UString &name) {
+	const Common::UString key = name.toLower();
+	const uint32_t generation = ResMan.getGeneration();
+
+	EntryMap::iterator e = _entryMap.find(key);
+	if (e != _entryMap.end()) {
+		if (e->second->generation == generation) {
+			// Move the program to the front of the recently used list
+			_entries.splice(_entries.begin(), _entries, e->second);
+
+			_hits++;
+			return e->second->program;
+		}
+
+		// The resources changed since we loaded it, so the program might be outdated
+		_entries.erase(e->second);
+		_entryMap.erase(e);
+	}
+
+	_misses++;
+
+	std::unique_ptr<Common::SeekableReadStream> ncs(ResMan.getResource(name, kFileTypeNCS));
+	if (!ncs)
+		throw Common::Exception("No such NCS \"%s\"", name.c_str());
+
+	std::shared_ptr<const NCSProgram> program = std::make_shared<NCSProgram>(*ncs, name);
+
+	if (_capacity == 0)
+		return program;
+
+	_entries.push_front(Entry());
+	_entries.front().name       = key;
+	_entries.front().generation = generation;
+	_entries.front().program    = program;
+
+	_entryMap.insert(std::make_pair(key, _entries.begin()));
+
+	prune();
+
+	return program;
+}
+
+void ProgramCache::prune() {
+	// Throw out the least recently used programs until we're within our capacity
+	while (_entries.size() > _capacity) {
+		_entryMap.erase(_entries.back().name);
+		_entries.pop_back();
+	}
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
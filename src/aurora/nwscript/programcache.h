@@ -0,0 +1,111 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A cache of loaded NWScript programs.
+ */
+
+#ifndef AURORA_NWSCRIPT_PROGRAMCACHE_H
+#define AURORA_NWSCRIPT_PROGRAMCACHE_H
+
+#include <list>
+#include <map>
+#include <memory>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/singleton.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+class NCSProgram;
+
+/** A cache of loaded NWScript programs.
+ *
+ *  Scripts are run a lot, often many times a second for heartbeats and
+ *  other events, and each run used to load the NCS out of the resource
+ *  manager anew. The cache instead keeps the most recently used programs
+ *  around, up to a set capacity, and hands them out to the NCSFile
+ *  instances running them.
+ *
+ *  A cached program is reloaded when the resource manager's generation
+ *  changed since it was loaded, for example because a module was loaded.
+ */
+class ProgramCache : public Common::Singleton<ProgramCache> {
+public:
+	/** The default maximum number of cached programs. */
+	static const size_t kDefaultCapacity = 512;
+
+	ProgramCache();
+	~ProgramCache();
+
+	/** Remove all cached programs and reset the statistics. */
+	void clear();
+
+	/** Set the maximum number of cached programs. */
+	void setCapacity(size_t capacity);
+	/** Return the maximum number of cached programs. */
+	size_t getCapacity() const;
+
+	/** Return the number of currently cached programs. */
+	size_t getSize() const;
+
+	/** Return the program of this named script, loading it if it's not cached. */
+	std::shared_ptr<const NCSProgram> get(const Common::UString &name);
+
+	/** Return the number of requests that were served out of the cache. */
+	size_t getHits() const;
+	/** Return the number of requests that needed to load the program. */
+	size_t getMisses() const;
+
+private:
+	/** A cached program. */
+	struct Entry {
+		Common::UString name; ///< The lower-case name of the script.
+		uint32_t generation;  ///< The resource manager generation when loaded.
+
+		std::shared_ptr<const NCSProgram> program;
+	};
+
+	/** All cached programs, most recently used first. */
+	typedef std::list<Entry> EntryList;
+	typedef std::map<Common::UString, EntryList::iterator> EntryMap;
+
+	EntryList _entries;
+	EntryMap  _entryMap;
+
+	size_t _capacity;
+
+	size_t _hits;
+	size_t _misses;
+
+	void prune();
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+/** Shortcut for accessing the NWScript program cache. */
+#define NCSCache Aurora::NWScript::ProgramCache::instance()
+
+#endif // AURORA_NWSCRIPT_PROGRAMCACHE_H
@@ -33,6 +33,9 @@ src_aurora_nwscript_libnwscript_la_SOURCES += \
     src/aurora/nwscript/objectcontainer.h \
     src/aurora/nwscript/functionman.h \
     src/aurora/nwscript/ncsfile.h \
+    src/aurora/nwscript/ncsprogram.h \
+    src/aurora/nwscript/programcache.h \
+    src/aurora/nwscript/scheduler.h \
     src/aurora/nwscript/objectref.h \
     src/aurora/nwscript/objectman.h \
     $(EMPTY)
@@ -45,6 +48,9 @@ src_aurora_nwscript_libnwscript_la_SOURCES += \
     src/aurora/nwscript/objectcontainer.cpp \
     src/aurora/nwscript/functionman.cpp \
     src/aurora/nwscript/ncsfile.cpp \
+    src/aurora/nwscript/ncsprogram.cpp \
+    src/aurora/nwscript/programcache.cpp \
+    src/aurora/nwscript/scheduler.cpp \
     src/aurora/nwscript/objectref.cpp \
     src/aurora/nwscript/objectman.cpp \
     $(EMPTY)
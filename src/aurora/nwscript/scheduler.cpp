@@ -0,0 +1,219 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A scheduler for delayed NWScript script continuations.
+ */
+
+#include <algorithm>
+
+#include "src/common/util.h"
+
+#include "src/aurora/nwscript/scheduler.h"
+
+DECLARE_SINGLETON(Aurora::NWScript::ScriptScheduler)
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** The longest delay we accept, so that all time differences fit into a signed 32-bit value. */
+static const uint32_t kMaxDelay = 0x7FFFFFFF;
+
+static bool isBefore(uint32_t a, uint32_t b) {
+	return ((int32_t) (a - b)) < 0;
+}
+
+static bool compareSequence(const DelayedScript &a, const DelayedScript &b) {
+	return a.sequence < b.sequence;
+}
+
+
+ScriptScheduler::Stats::Stats() : queueDepth(0), maxQueueDepth(0), scheduled(0), fired(0),
+	batches(0), maxBatchSize(0), totalLatency(0), maxLatency(0) {
+
+}
+
+
+ScriptScheduler::ScriptScheduler() : _tick(0), _sequence(0) {
+	std::fill(_levelSizes, _levelSizes + kLevelCount, 0);
+}
+
+ScriptScheduler::~ScriptScheduler() {
+}
+
+void ScriptScheduler::clear() {
+	for (size_t level = 0; level < kLevelCount; level++) {
+		if (_levelSizes[level] == 0)
+			continue;
+
+		for (size_t slot = 0; slot < kSlotCount; slot++)
+			_slots[level][slot].clear();
+
+		_levelSizes[level] = 0;
+	}
+
+	_stats.queueDepth = 0;
+}
+
+void ScriptScheduler::schedule(uint32_t now, uint32_t delay, const Common::UString &script,
+                               const ScriptState &state, const ObjectReference &owner,
+                               const ObjectReference &triggerer) {
+
+	// With nothing waiting, we're free to move the wheels to the current time
+	if (_stats.queueDepth == 0)
+		_tick = now;
+
+	DelayedScript delayed;
+
+	delayed.script    = script;
+	delayed.state     = state;
+	delayed.owner     = owner;
+	delayed.triggerer = triggerer;
+	delayed.timestamp = now + MIN(delay, kMaxDelay);
+	delayed.sequence  = _sequence++;
+
+	place(delayed);
+
+	_stats.scheduled++;
+	_stats.queueDepth++;
+	_stats.maxQueueDepth = MAX(_stats.maxQueueDepth, _stats.queueDepth);
+}
+
+size_t ScriptScheduler::collect(uint32_t now, std::vector<DelayedScript> &batch) {
+	const size_t batchStart = batch.size();
+
+	while (!isBefore(now, _tick)) {
+		if (_stats.queueDepth == 0) {
+			_tick = now + 1;
+			break;
+		}
+
+		const size_t index = _tick & (kSlotCount - 1);
+
+		// The lowest level wrapped around, refill it from the levels above
+		if (index == 0) {
+			for (size_t level = 1; level < kLevelCount; level++) {
+				cascade(level);
+
+				if (((_tick >> (level * kLevelBits)) & (kSlotCount - 1)) != 0)
+					break;
+			}
+		}
+
+		// Nothing on the lowest level, skip ahead to where it wraps around
+		if (_levelSizes[0] == 0) {
+			const uint32_t next = (_tick | (kSlotCount - 1)) + 1;
+			if (isBefore(now, next)) {
+				_tick = now + 1;
+				break;
+			}
+
+			_tick = next;
+			continue;
+		}
+
+		Slot &slot = _slots[0][index];
+		if (!slot.empty()) {
+			// Scripts cascaded down from above might have been scheduled before ones already here
+			if (!std::is_sorted(slot.begin(), slot.end(), compareSequence))
+				std::sort(slot.begin(), slot.end(), compareSequence);
+
+			for (Slot::iterator s = slot.begin(); s != slot.end(); ++s) {
+				const uint32_t latency = now - s->timestamp;
+
+				_stats.totalLatency += latency;
+				_stats.maxLatency    = MAX(_stats.maxLatency, latency);
+
+				batch.push_back(std::move(*s));
+			}
+
+			_levelSizes[0]    -= slot.size();
+			_stats.queueDepth -= slot.size();
+
+			// Clearing keeps the slot's memory around for the next time it's used
+			slot.clear();
+		}
+
+		_tick++;
+	}
+
+	const size_t count = batch.size() - batchStart;
+	if (count > 0) {
+		_stats.fired  += count;
+		_stats.batches++;
+
+		_stats.maxBatchSize = MAX(_stats.maxBatchSize, count);
+	}
+
+	return count;
+}
+
+size_t ScriptScheduler::getQueueDepth() const {
+	return _stats.queueDepth;
+}
+
+ScriptScheduler::Stats ScriptScheduler::getStats() const {
+	return _stats;
+}
+
+void ScriptScheduler::resetStats() {
+	const size_t queueDepth = _stats.queueDepth;
+
+	_stats = Stats();
+
+	_stats.queueDepth    = queueDepth;
+	_stats.maxQueueDepth = queueDepth;
+}
+
+void ScriptScheduler::place(DelayedScript &script) {
+	// Scripts that are already due go into the very next tick
+	const uint32_t tick = isBefore(script.timestamp, _tick) ? _tick : script.timestamp;
+	const uint32_t distance = tick - _tick;
+
+	size_t level = 0;
+	while ((level < (kLevelCount - 1)) && ((distance >> ((level + 1) * kLevelBits)) != 0))
+		level++;
+
+	const size_t index = (tick >> (level * kLevelBits)) & (kSlotCount - 1);
+
+	_slots[level][index].push_back(std::move(script));
+	_levelSizes[level]++;
+}
+
+void ScriptScheduler::cascade(size_t level) {
+	const size_t index = (_tick >> (level * kLevelBits)) & (kSlotCount - 1);
+
+	Slot scripts;
+	scripts.swap(_slots[level][index]);
+
+	_levelSizes[level] -= scripts.size();
+
+	for (Slot::iterator s = scripts.begin(); s != scripts.end(); ++s)
+		place(*s);
+
+	// A cascaded script always ends up on a lower level, so the slot is still empty
+	scripts.clear();
+	scripts.swap(_slots[level][index]);
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
@@ -0,0 +1,158 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A scheduler for delayed NWScript script continuations.
+ */
+
+#ifndef AURORA_NWSCRIPT_SCHEDULER_H
+#define AURORA_NWSCRIPT_SCHEDULER_H
+
+#include <vector>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/singleton.h"
+
+#include "src/aurora/nwscript/variable.h"
+#include "src/aurora/nwscript/objectref.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** A script continuation, waiting to be run at a later time. */
+struct DelayedScript {
+	Common::UString script; ///< The name of the script to continue.
+	ScriptState state;      ///< The state to continue the script in.
+
+	ObjectReference owner;     ///< The object owning the script.
+	ObjectReference triggerer; ///< The object that triggered the script.
+
+	uint32_t timestamp; ///< The time in milliseconds at which the script is due.
+	size_t sequence;    ///< Running count, to keep same-time scripts in order.
+};
+
+/** A scheduler for delayed NWScript script continuations.
+ *
+ *  DelayCommand(), AssignCommand() and ActionDoCommand() capture the state
+ *  of the running script and have it continue at a later time. Busy modules
+ *  can keep thousands of these waiting, for AI heartbeats and spawn systems.
+ *
+ *  The scheduler keeps them in a hierarchical timing wheel: four levels of
+ *  256 slots, with a resolution of one millisecond on the lowest level and
+ *  256 times coarser on each level above. Scheduling a script drops it into
+ *  the slot its due time falls into, and whenever the lowest level wraps
+ *  around, the next slot of the level above is spread out over the level
+ *  below. Both scheduling and expiring a script are therefore O(1).
+ *
+ *  The scheduler does not run the scripts itself. Instead, once per frame,
+ *  the module collects the whole batch of scripts that are due and runs them.
+ *  This also means that scripts scheduled while running a batch are never
+ *  part of that same batch.
+ *
+ *  Times are given in milliseconds, as returned by EventMan.getTimestamp().
+ */
+class ScriptScheduler : public Common::Singleton<ScriptScheduler> {
+public:
+	/** Statistics about the scheduled scripts. */
+	struct Stats {
+		size_t queueDepth;    ///< Number of currently waiting scripts.
+		size_t maxQueueDepth; ///< Highest number of waiting scripts.
+
+		size_t scheduled; ///< Number of scripts scheduled.
+		size_t fired;     ///< Number of scripts that became due.
+
+		size_t batches;      ///< Number of non-empty batches collected.
+		size_t maxBatchSize; ///< Largest number of scripts in one batch.
+
+		uint64_t totalLatency; ///< Sum of the times scripts were collected after they were due.
+		uint32_t maxLatency;   ///< Longest time a script was collected after it was due.
+
+		Stats();
+	};
+
+	ScriptScheduler();
+	~ScriptScheduler();
+
+	/** Remove all waiting scripts. */
+	void clear();
+
+	/** Schedule a script to continue after a delay.
+	 *
+	 *  @param now       The current time.
+	 *  @param delay     The delay in milliseconds after which the script is due.
+	 *  @param script    The name of the script to continue.
+	 *  @param state     The state to continue the script in.
+	 *  @param owner     The object owning the script.
+	 *  @param triggerer The object that triggered the script.
+	 */
+	void schedule(uint32_t now, uint32_t delay, const Common::UString &script, const ScriptState &state,
+	              const ObjectReference &owner, const ObjectReference &triggerer);
+
+	/** Move all scripts that are due at this time into a batch.
+	 *
+	 *  The scripts are appended to the batch in the order they became due,
+	 *  scripts due at the same time in the order they were scheduled.
+	 *
+	 *  @return The number of scripts that were due.
+	 */
+	size_t collect(uint32_t now, std::vector<DelayedScript> &batch);
+
+	/** Return the number of currently waiting scripts. */
+	size_t getQueueDepth() const;
+
+	/** Return statistics about the scheduled scripts. */
+	Stats getStats() const;
+	/** Reset the statistics, apart from the current queue depth. */
+	void resetStats();
+
+private:
+	static const size_t kLevelBits  = 8;
+	static const size_t kLevelCount = 4;
+	static const size_t kSlotCount  = 1 << kLevelBits;
+
+	typedef std::vector<DelayedScript> Slot;
+
+	/** The wheels, lowest level first. */
+	Slot _slots[kLevelCount][kSlotCount];
+	/** The number of scripts on each level. */
+	size_t _levelSizes[kLevelCount];
+
+	/** The next tick the lowest level will expire. */
+	uint32_t _tick;
+	size_t _sequence;
+
+	Stats _stats;
+
+	/** Put a script into the slot matching its due time. */
+	void place(DelayedScript &script);
+	/** Spread a slot of a higher level out over the levels below. */
+	void cascade(size_t level);
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+/** Shortcut for accessing the NWScript script scheduler. */
+#define ScriptSched Aurora::NWScript::ScriptScheduler::instance()
+
+#endif // AURORA_NWSCRIPT_SCHEDULER_H
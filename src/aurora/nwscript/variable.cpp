@@ -23,6 +23,7 @@
  */
 
 #include <cassert>
+#include <utility>
 
 #include <boost/make_shared.hpp>
 
@@ -32,11 +33,49 @@
 #include "src/aurora/nwscript/variable.h"
 #include "src/aurora/nwscript/enginetype.h"
 #include "src/aurora/nwscript/objectref.h"
+#include "src/aurora/nwscript/object.h"
+#include "src/aurora/nwscript/objectman.h"
 
 namespace Aurora {
 
 namespace NWScript {
 
+template<typename T>
+struct Variable::Shared {
+	uint32_t refCount;
+	T value;
+
+	Shared(const T &v) : refCount(1), value(v) {
+	}
+};
+
+template<>
+struct Variable::Shared<EngineType *> {
+	uint32_t refCount;
+	EngineType *value;
+
+	Shared(EngineType *v) : refCount(1), value(v) {
+	}
+
+	~Shared() {
+		delete value;
+	}
+};
+
+template<typename T>
+static T *acquire(T *shared) {
+	if (shared)
+		shared->refCount++;
+
+	return shared;
+}
+
+template<typename T>
+static void release(T *shared) {
+	if (shared && (--shared->refCount == 0))
+		delete shared;
+}
+
 Variable::Variable(Type type) : _type(kTypeVoid) {
 	setType(type);
 }
@@ -93,6 +132,10 @@ Variable::Variable(const Variable &var) : _type(kTypeVoid) {
 	*this = var;
 }
 
+Variable::Variable(Variable &&var) : _type(kTypeVoid) {
+	*this = std::move(var);
+}
+
 Variable::~Variable() {
 	try {
 		setType(kTypeVoid);
@@ -104,11 +147,9 @@ void Variable::setType(Type type) {
 	_array.reset();
 
 	if      (_type == kTypeString)
-		delete _value._string;
-	else if (_type == kTypeObject)
-		delete _value._object;
+		release(_value._string);
 	else if (_type == kTypeEngineType)
-		delete _value._engineType;
+		release(_value._engineType);
 	else if (_type == kTypeScriptState)
 		delete _value._scriptState;
 
@@ -132,11 +173,12 @@ void Variable::setType(Type type) {
 			break;
 
 		case kTypeString:
-			_value._string = new Common::UString;
+			// An empty string doesn't hold a value at all
+			_value._string = 0;
 			break;
 
 		case kTypeObject:
-			_value._object = new ObjectReference;
+			_value._object = kObjectIDInvalid;
 			break;
 
 		case kTypeVector:
@@ -167,15 +209,31 @@ Variable &Variable::operator=(const Variable &var) {
 	if (&var == this)
 		return *this;
 
+	if (var._type == kTypeString) {
+		SharedString *string = acquire(var._value._string);
+
+		setType(kTypeVoid);
+
+		_type          = kTypeString;
+		_value._string = string;
+
+		return *this;
+	}
+
+	if (var._type == kTypeEngineType) {
+		SharedEngineType *engineType = acquire(var._value._engineType);
+
+		setType(kTypeVoid);
+
+		_type              = kTypeEngineType;
+		_value._engineType = engineType;
+
+		return *this;
+	}
+
 	setType(var._type);
 
-	if      (_type == kTypeString)
-		*_value._string = *var._value._string;
-	else if (_type == kTypeObject)
-		*_value._object = *var._value._object;
-	else if (_type == kTypeEngineType)
-		*this = var._value._engineType;
-	else if (_type == kTypeScriptState)
+	if      (_type == kTypeScriptState)
 		*_value._scriptState = *var._value._scriptState;
 	else if (_type == kTypeArray)
 		_array = var._array;
@@ -185,6 +243,21 @@ Variable &Variable::operator=(const Variable &var) {
 	return *this;
 }
 
+Variable &Variable::operator=(Variable &&var) {
+	if (&var == this)
+		return *this;
+
+	setType(kTypeVoid);
+
+	_type  = var._type;
+	_value = var._value;
+	_array = std::move(var._array);
+
+	var._type = kTypeVoid;
+
+	return *this;
+}
+
 Variable &Variable::operator=(int32_t value) {
 	if (_type != kTypeInt)
 		throw Common::Exception("Can't assign an int value to a non-int variable");
@@ -207,7 +280,13 @@ Variable &Variable::operator=(const Common::UString &value) {
 	if (_type != kTypeString)
 		throw Common::Exception("Can't assign a string value to a non-string variable");
 
-	*_value._string = value;
+	if (_value._string && (_value._string->refCount == 1)) {
+		_value._string->value = value;
+		return *this;
+	}
+
+	release(_value._string);
+	_value._string = value.empty() ? 0 : new SharedString(value);
 
 	return *this;
 }
@@ -216,7 +295,7 @@ Variable &Variable::operator=(Object *value) {
 	if (_type != kTypeObject)
 		throw Common::Exception("Can't assign an object value to a non-object variable");
 
-	*_value._object = value;
+	_value._object = value ? value->getID() : kObjectIDInvalid;
 
 	return *this;
 }
@@ -225,7 +304,7 @@ Variable &Variable::operator=(const ObjectReference &value) {
 	if (_type != kTypeObject)
 		throw Common::Exception("Can't assign an object value to a non-object variable");
 
-	*_value._object = value;
+	_value._object = value.getId();
 
 	return *this;
 }
@@ -234,9 +313,9 @@ Variable &Variable::operator=(const EngineType *value) {
 	if (_type != kTypeEngineType)
 		throw Common::Exception("Can't assign an engine-type value to a non-engine-type variable");
 
-	EngineType *engineType = value ? value->clone() : 0;
+	SharedEngineType *engineType = value ? new SharedEngineType(value->clone()) : 0;
 
-	delete _value._engineType;
+	release(_value._engineType);
 
 	_value._engineType = engineType;
 
@@ -267,10 +346,10 @@ bool Variable::operator==(const Variable &var) const {
 			return _value._float == var._value._float;
 
 		case kTypeString:
-			return *_value._string == *var._value._string;
+			return (_value._string == var._value._string) || (getString() == var.getString());
 
 		case kTypeObject:
-			return *_value._object == *var._value._object;
+			return _value._object == var._value._object;
 
 		case kTypeVector:
 			return _value._vector[0] == var._value._vector[0] &&
@@ -313,28 +392,64 @@ const Common::UString &Variable::getString() const {
 	if (_type != kTypeString)
 		throw Common::Exception("Can't get a string value from a non-string variable");
 
-	return *_value._string;
+	if (!_value._string) {
+		static const Common::UString kEmptyString;
+		return kEmptyString;
+	}
+
+	return _value._string->value;
 }
 
 Common::UString &Variable::getString() {
 	if (_type != kTypeString)
 		throw Common::Exception("Can't get a string value from a non-string variable");
 
-	return *_value._string;
+	// The string might be modified, so it needs a value of its own
+	if (!_value._string) {
+		_value._string = new SharedString("");
+	} else if (_value._string->refCount > 1) {
+		SharedString *string = new SharedString(_value._string->value);
+
+		release(_value._string);
+		_value._string = string;
+	}
+
+	return _value._string->value;
 }
 
 Object *Variable::getObject() const {
 	if (_type != kTypeObject)
 		throw Common::Exception("Can't get an object value from a non-object variable");
 
-	return **_value._object;
+	if (_value._object == kObjectIDInvalid)
+		return 0;
+
+	return ObjectMan.findObject(_value._object);
+}
+
+const EngineType *Variable::getEngineType() const {
+	if (_type != kTypeEngineType)
+		throw Common::Exception("Can't get an engine-type value from a non-engine-type variable");
+
+	return _value._engineType ? _value._engineType->value : 0;
 }
 
-EngineType *Variable::getEngineType() const {
+EngineType *Variable::getEngineType() {
 	if (_type != kTypeEngineType)
 		throw Common::Exception("Can't get an engine-type value from a non-engine-type variable");
 
-	return _value._engineType;
+	if (!_value._engineType)
+		return 0;
+
+	// The engine type might be modified, so it can't be shared anymore
+	if (_value._engineType->refCount > 1) {
+		SharedEngineType *engineType = new SharedEngineType(_value._engineType->value->clone());
+
+		release(_value._engineType);
+		_value._engineType = engineType;
+	}
+
+	return _value._engineType->value;
 }
 
 void Variable::setVector(float x, float y, float z) {
@@ -53,6 +53,17 @@ struct ScriptState {
 	std::vector<class Variable> locals;
 };
 
+/** A value within NWScript.
+ *
+ *  Integers, floats, vectors and object IDs are held directly within the
+ *  variable, so creating, copying and destroying such a variable never
+ *  touches the heap. The same goes for empty strings.
+ *
+ *  Other strings and engine types are held out of line, reference-counted and
+ *  shared between copies of a variable until one of the copies wants to
+ *  modify it (copy-on-write). Since the reference counts aren't atomic,
+ *  variables sharing a value must not be used by different threads.
+ */
 class Variable {
 public:
 	typedef std::vector< boost::shared_ptr<Variable> > Array;
@@ -67,11 +78,13 @@ public:
 	Variable(const EngineType &value);
 	Variable(float x, float y, float z);
 	Variable(const Variable &var);
+	Variable(Variable &&var);
 	~Variable();
 
 	void setType(Type type);
 
 	Variable &operator=(const Variable &var);
+	Variable &operator=(Variable &&var);
 
 	Variable &operator=(int32_t value);
 	Variable &operator=(float value);
@@ -91,7 +104,8 @@ public:
 	Common::UString &getString();
 	const Common::UString &getString() const;
 	Object *getObject() const;
-	EngineType *getEngineType() const;
+	const EngineType *getEngineType() const;
+	EngineType *getEngineType();
 
 	void setVector(float  x, float  y, float  z);
 	void getVector(float &x, float &y, float &z) const;
@@ -110,16 +124,22 @@ public:
 	void setReference(Variable *reference);
 
 private:
+	/** A reference-counted value, shared between copies of a variable. */
+	template<typename T> struct Shared;
+
+	typedef Shared<Common::UString> SharedString;
+	typedef Shared<EngineType *>    SharedEngineType;
+
 	Type _type;
 
 	union {
 		int32_t _int;
 		float _float;
-		Common::UString *_string;
-		ObjectReference *_object;
+		uint32_t _object; ///< The ID of the object.
 		float _vector[3];
+		SharedString *_string; ///< 0 for an empty string.
+		SharedEngineType *_engineType; ///< 0 for an empty engine type.
 		ScriptState *_scriptState;
-		EngineType *_engineType;
 		Variable *_reference;
 	} _value;
 
@@ -191,10 +191,13 @@ Common::SeekableReadStream *OBBFile::getResource(uint32_t index, bool UNUSED(try
 
 	const IResource &res = getIResource(index);
 
-	_obb->seek(res.offset);
-
 	std::unique_ptr<byte[]> data = std::make_unique<byte[]>(res.uncompressedSize);
 
+	// We don't know the compressed size, so we have to read straight from the archive
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_obb->seek(res.offset);
+
 	size_t offset = 0;
 	size_t bytesLeft = res.uncompressedSize;
 
@@ -55,6 +55,9 @@ Common::SeekableReadStream *PEFile::getResource(uint32_t index, bool UNUSED(tryN
 
 	std::advance(iter, index);
 
+	// The PE resources are read straight from the executable
+	std::lock_guard<std::mutex> lock(_mutex);
+
 	switch (iter->type) {
 		case kFileTypeBMP: {
 			std::unique_ptr<Common::SeekableReadStream> stream(_peFile->getResource(Common::kPEBitmap, _peIDs.at(index)));
@@ -25,6 +25,7 @@
 #include <cassert>
 
 #include <memory>
+#include <algorithm>
 
 #include <boost/scope_exit.hpp>
 
@@ -33,6 +34,7 @@
 #include "src/common/readstream.h"
 #include "src/common/filepath.h"
 #include "src/common/readfile.h"
+#include "src/common/mappedfile.h"
 #include "src/common/writefile.h"
 
 #include "src/aurora/resman.h"
@@ -58,6 +60,21 @@ DECLARE_SINGLETON(Aurora::ResourceManager)
 
 namespace Aurora {
 
+/** Initial number of slots in the resource index. Must be a power of 2. */
+static const size_t kResourceIndexMinSize = 1024;
+/** Slot index signaling that no slot has been found. */
+static const size_t kResourceSlotNone = SIZE_MAX;
+
+/** Return the preferred slot of a hash within the resource index.
+ *
+ *  The names are hashed with different algorithms, depending on the game,
+ *  and some of them (like DJB2) only ever fill the lower 32 bits. We
+ *  therefore spread the hash over all bits with a Fibonacci hashing step.
+ */
+static inline size_t getResourceSlot(uint64_t hash, size_t mask) {
+	return ((size_t) ((hash * UINT64_C(0x9E3779B97F4A7C15)) >> 32)) & mask;
+}
+
 ResourceManager::KnownArchive::KnownArchive() :
 	type(kArchiveMAX), resource(0), opened(0) {
 
@@ -108,7 +125,7 @@ bool ResourceManager::Resource::operator<(const Resource &right) const {
 
 
 ResourceManager::ResourceManager() : _hasSmall(false),
-	_hashAlgo(Common::kHashFNV64) {
+	_hashAlgo(Common::kHashFNV64), _resourceIndexSize(0), _generation(0) {
 
 	// These file types are archives
 
@@ -200,8 +217,13 @@ void ResourceManager::clearResources() {
 	_openedArchives.clear();
 
 	_resources.clear();
+	_resourceIndex.clear();
+	_resourceIndexSize = 0;
+	_shadowed.clear();
 
 	_changes.clear();
+
+	_generation++;
 }
 
 void ResourceManager::setRIMsAreERFs(bool rimsAreERFs) {
@@ -299,7 +321,20 @@ Common::SeekableReadStream *ResourceManager::openArchiveStream(const KnownArchiv
 	if (!archive.resource)
 		throw Common::Exception("Archive without resource reference");
 
-	return getResource(*archive.resource, true);
+	/* Archives that are plain files on disk are mapped into memory. The archive
+	 * classes then hand out resource streams that are views into that mapping,
+	 * without copying and without sharing a file position between readers.
+	 *
+	 * If mapping fails for whatever reason, we fall back to reading the file. */
+	const Resource &res = *archive.resource;
+	if ((res.source == kSourceFile) && !res.isSmall) {
+		try {
+			return new Common::MappedReadStream(res.path);
+		} catch (...) {
+		}
+	}
+
+	return getResource(res, true);
 }
 
 void ResourceManager::indexArchive(const Common::UString &file, uint32_t priority,
@@ -593,11 +628,10 @@ void ResourceManager::undo(Common::ChangeID &changeID) {
 			resChange->resIt->selfArchive.first->erase(resChange->resIt->selfArchive.second);
 		}
 
-		// Remove the resource, and the name list too if it's empty
-		resChange->hashIt->second.erase(resChange->resIt);
+		// Remove the resource from the index, then remove the resource itself
+		removeIndex(*resChange->resIt, resChange->hash);
 
-		if (resChange->hashIt->second.empty())
-			_resources.erase(resChange->hashIt);
+		_resources.erase(resChange->resIt);
 	}
 
 	// Now we can remove the change set from our list of change sets
@@ -607,42 +641,53 @@ void ResourceManager::undo(Common::ChangeID &changeID) {
 	changeID.clear();
 }
 
+uint32_t ResourceManager::getGeneration() const {
+	return _generation;
+}
+
 void ResourceManager::addTypeAlias(FileType alias, FileType realType) {
 	_typeAliases[alias] = realType;
+
+	_generation++;
 }
 
 void ResourceManager::blacklist(const Common::UString &name, FileType type) {
-	ResourceMap::iterator resList = _resources.find(getHash(name, type));
-	if (resList == _resources.end())
-		return;
+	std::vector<Resource *> resources;
+	findResources(getHash(name, type), resources);
+
+	for (std::vector<Resource *>::iterator res = resources.begin(); res != resources.end(); ++res)
+		(*res)->priority = 0;
 
-	for (ResourceList::iterator res = resList->second.begin(); res != resList->second.end(); ++res)
-		res->priority = 0;
+	_generation++;
 }
 
 void ResourceManager::declareResource(const Common::UString &name, FileType type) {
 	bool isSmall = false;
 
-	ResourceMap::iterator resList = _resources.find(getHash(name, type));
-	if (resList == _resources.end()) {
+	std::vector<Resource *> resources;
+	findResources(getHash(name, type), resources);
+
+	if (resources.empty()) {
 		if (_hasSmall) {
 			Common::UString smallName = TypeMan.addFileType(TypeMan.setFileType(name, type), kFileTypeSMALL);
 
-			resList = _resources.find(getHash(smallName));
+			findResources(getHash(smallName), resources);
 			isSmall = true;
 		}
 
-		if (resList == _resources.end())
+		if (resources.empty())
 			return;
 	}
 
-	for (ResourceList::iterator r = resList->second.begin(); r != resList->second.end(); ++r) {
-		r->name    = name;
-		r->type    = type;
-		r->isSmall = isSmall;
+	for (std::vector<Resource *>::iterator r = resources.begin(); r != resources.end(); ++r) {
+		(*r)->name    = name;
+		(*r)->type    = type;
+		(*r)->isSmall = isSmall;
 
-		checkResourceIsArchive(*r, 0);
+		checkResourceIsArchive(**r, 0);
 	}
+
+	_generation++;
 }
 
 void ResourceManager::declareResource(const Common::UString &name) {
@@ -802,31 +847,24 @@ Common::SeekableReadStream *ResourceManager::getResource(ResourceType resType,
 void ResourceManager::getAvailableResources(FileType type,
 		std::list<ResourceID> &list) const {
 
-	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r) {
-		if (!r->second.empty() && (r->second.front().type == type)) {
-			list.push_back(ResourceID());
-
-			list.back().name = r->second.front().name;
-			list.back().type = r->second.front().type;
-			list.back().hash = r->first;
-		}
-	}
+	getAvailableResources(std::vector<FileType>(1, type), list);
 }
 
 void ResourceManager::getAvailableResources(const std::vector<FileType> &types,
 		std::list<ResourceID> &list) const {
 
-	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r) {
-		for (std::vector<FileType>::const_iterator t = types.begin(); t != types.end(); ++t) {
-			if (!r->second.empty() && (r->second.front().type == *t)) {
-				list.push_back(ResourceID());
+	std::vector<ResourceSlot> slots;
+	getSortedIndex(slots);
 
-				list.back().name = r->second.front().name;
-				list.back().type = r->second.front().type;
-				list.back().hash = r->first;
-			}
-		}
+	for (std::vector<ResourceSlot>::const_iterator s = slots.begin(); s != slots.end(); ++s) {
+		if (std::find(types.begin(), types.end(), s->winner->type) == types.end())
+			continue;
+
+		list.push_back(ResourceID());
 
+		list.back().name = s->winner->name;
+		list.back().type = s->winner->type;
+		list.back().hash = s->hash;
 	}
 }
 
@@ -902,17 +940,23 @@ inline uint64_t ResourceManager::getHash(const Common::UString &name) const {
 	return Common::hashString(name.toLower(), _hashAlgo);
 }
 
-void ResourceManager::checkHashCollision(const Resource &resource, ResourceMap::const_iterator resList) {
-	if (resource.name.empty() || resList->second.empty())
+void ResourceManager::checkHashCollision(const Resource &resource, uint64_t hash) {
+	if (resource.name.empty())
+		return;
+
+	std::vector<Resource *> resources;
+	findResources(hash, resources);
+
+	if (resources.empty())
 		return;
 
 	Common::UString newName = TypeMan.setFileType(resource.name, resource.type).toLower();
 
-	for (ResourceList::const_iterator r = resList->second.begin(); r != resList->second.end(); ++r) {
-		if (r->name.empty())
+	for (std::vector<Resource *>::const_iterator r = resources.begin(); r != resources.end(); ++r) {
+		if ((*r)->name.empty())
 			continue;
 
-		Common::UString oldName = TypeMan.setFileType(r->name, r->type).toLower();
+		Common::UString oldName = TypeMan.setFileType((*r)->name, (*r)->type).toLower();
 		if (oldName != newName) {
 			warning("ResourceManager: Found hash collision: %s (\"%s\" and \"%s\")",
 					Common::formatHash(getHash(oldName)).c_str(), oldName.c_str(), newName.c_str());
@@ -952,37 +996,26 @@ bool ResourceManager::checkResourceIsArchive(Resource &resource, Change *change)
 	return true;
 }
 
-void ResourceManager::addResource(Resource &resource, uint64_t hash, Change *change) {
-	ResourceMap::iterator resList = _resources.find(hash);
-	if (resList == _resources.end()) {
-		// We don't have a resource with this name yet, create a new resource list for it
-
-		std::pair<ResourceMap::iterator, bool> result;
-
-		result = _resources.insert(std::make_pair(hash, ResourceList()));
-
-		resList = result.first;
-	}
-
+void ResourceManager::addResource(const Resource &resource, uint64_t hash, Change *change) {
 #ifdef CHECK_HASH_COLLISION
-	checkHashCollision(resource, resList);
+	checkHashCollision(resource, hash);
 #endif
 
 	// Add the resource to the list
-	resList->second.push_back(resource);
-	Resource *res = &resList->second.back();
+	_resources.push_back(resource);
+	Resource *res = &_resources.back();
 
 	checkResourceIsArchive(*res, change);
 
 	// Remember the resource in the change set
 	if (change) {
 		change->_change->resources.push_back(ResourceChange());
-		change->_change->resources.back().hashIt = resList;
-		change->_change->resources.back().resIt  = --resList->second.end();
+		change->_change->resources.back().hash  = hash;
+		change->_change->resources.back().resIt = --_resources.end();
 	}
 
-	// Resort the list by priority
-	resList->second.sort();
+	// And put it into the index, possibly overruling a resource of lower priority
+	insertIndex(*res, hash);
 }
 
 void ResourceManager::addResource(const Common::UString &path, Change *change, uint32_t priority) {
@@ -1015,12 +1048,165 @@ void ResourceManager::addResources(const Common::FileList &files, Change *change
 		addResource(*file, change, priority);
 }
 
+size_t ResourceManager::findSlot(uint64_t hash) const {
+	if (_resourceIndex.empty())
+		return kResourceSlotNone;
+
+	const size_t mask = _resourceIndex.size() - 1;
+
+	for (size_t i = getResourceSlot(hash, mask); _resourceIndex[i].winner; i = (i + 1) & mask)
+		if (_resourceIndex[i].hash == hash)
+			return i;
+
+	return kResourceSlotNone;
+}
+
+void ResourceManager::insertIndex(Resource &resource, uint64_t hash) {
+	_generation++;
+
+	const size_t slot = findSlot(hash);
+	if (slot != kResourceSlotNone) {
+		ResourceSlot &winner = _resourceIndex[slot];
+
+		/* We already have a resource with this hash. Of the two, the one with the
+		 * higher priority wins; with equal priorities, the one added last wins.
+		 * The loser is put into the shadowed resources, so that it can take over
+		 * again when the winner is removed. */
+
+		if (resource.priority >= winner.winner->priority) {
+			_shadowed.insert(std::make_pair(hash, winner.winner));
+			winner.winner = &resource;
+		} else
+			_shadowed.insert(std::make_pair(hash, &resource));
+
+		return;
+	}
+
+	// Keep the index at most half full
+	if (((_resourceIndexSize + 1) * 2) > _resourceIndex.size())
+		growIndex();
+
+	const size_t mask = _resourceIndex.size() - 1;
+
+	size_t i = getResourceSlot(hash, mask);
+	while (_resourceIndex[i].winner)
+		i = (i + 1) & mask;
+
+	_resourceIndex[i].hash   = hash;
+	_resourceIndex[i].winner = &resource;
+
+	_resourceIndexSize++;
+}
+
+void ResourceManager::removeIndex(Resource &resource, uint64_t hash) {
+	_generation++;
+
+	const size_t slot = findSlot(hash);
+	if (slot == kResourceSlotNone)
+		return;
+
+	std::pair<ShadowedResources::iterator, ShadowedResources::iterator> shadowed = _shadowed.equal_range(hash);
+
+	if (_resourceIndex[slot].winner != &resource) {
+		// Not the winner, so it has to be one of the shadowed resources
+
+		for (ShadowedResources::iterator s = shadowed.first; s != shadowed.second; ++s) {
+			if (s->second == &resource) {
+				_shadowed.erase(s);
+				break;
+			}
+		}
+
+		return;
+	}
+
+	// Find the shadowed resource that takes over: the highest priority, the last shadowed of equals
+	ShadowedResources::iterator successor = shadowed.second;
+	for (ShadowedResources::iterator s = shadowed.first; s != shadowed.second; ++s)
+		if ((successor == shadowed.second) || (s->second->priority >= successor->second->priority))
+			successor = s;
+
+	if (successor == shadowed.second) {
+		// No other resource with this hash left
+		eraseSlot(slot);
+		return;
+	}
+
+	_resourceIndex[slot].winner = successor->second;
+	_shadowed.erase(successor);
+}
+
+void ResourceManager::growIndex() {
+	ResourceIndex oldIndex(MAX<size_t>(kResourceIndexMinSize, _resourceIndex.size() * 2));
+	oldIndex.swap(_resourceIndex);
+
+	const size_t mask = _resourceIndex.size() - 1;
+
+	for (ResourceIndex::const_iterator s = oldIndex.begin(); s != oldIndex.end(); ++s) {
+		if (!s->winner)
+			continue;
+
+		size_t i = getResourceSlot(s->hash, mask);
+		while (_resourceIndex[i].winner)
+			i = (i + 1) & mask;
+
+		_resourceIndex[i] = *s;
+	}
+}
+
+void ResourceManager::eraseSlot(size_t slot) {
+	/* Backward-shift deletion: move up every following slot of the same
+	 * probing cluster that would otherwise become unreachable. This way,
+	 * we don't need any tombstones. */
+
+	const size_t mask = _resourceIndex.size() - 1;
+
+	for (size_t i = (slot + 1) & mask; _resourceIndex[i].winner; i = (i + 1) & mask) {
+		const size_t preferred = getResourceSlot(_resourceIndex[i].hash, mask);
+
+		if (((i - preferred) & mask) >= ((i - slot) & mask)) {
+			_resourceIndex[slot] = _resourceIndex[i];
+			slot = i;
+		}
+	}
+
+	_resourceIndex[slot] = ResourceSlot();
+
+	_resourceIndexSize--;
+}
+
+void ResourceManager::findResources(uint64_t hash, std::vector<Resource *> &resources) {
+	const size_t slot = findSlot(hash);
+	if (slot == kResourceSlotNone)
+		return;
+
+	resources.push_back(_resourceIndex[slot].winner);
+
+	std::pair<ShadowedResources::iterator, ShadowedResources::iterator> shadowed = _shadowed.equal_range(hash);
+	for (ShadowedResources::iterator s = shadowed.first; s != shadowed.second; ++s)
+		resources.push_back(s->second);
+}
+
+void ResourceManager::getSortedIndex(std::vector<ResourceSlot> &slots) const {
+	slots.reserve(_resourceIndexSize);
+
+	for (ResourceIndex::const_iterator s = _resourceIndex.begin(); s != _resourceIndex.end(); ++s)
+		if (s->winner)
+			slots.push_back(*s);
+
+	std::sort(slots.begin(), slots.end());
+}
+
 const ResourceManager::Resource *ResourceManager::getRes(uint64_t hash) const {
-	ResourceMap::const_iterator r = _resources.find(hash);
-	if ((r == _resources.end()) || r->second.empty() || (r->second.back().priority == 0))
+	const size_t slot = findSlot(hash);
+	if (slot == kResourceSlotNone)
 		return 0;
 
-	return &r->second.back();
+	const Resource *res = _resourceIndex[slot].winner;
+	if (res->priority == 0)
+		return 0;
+
+	return res;
 }
 
 const ResourceManager::Resource *ResourceManager::getRes(const Common::UString &name,
@@ -1060,15 +1246,15 @@ void ResourceManager::dumpResourcesList(const Common::UString &fileName) const {
 	file.writeString("                Name                 |        Hash        |     Size    \n");
 	file.writeString("-------------------------------------|--------------------|-------------\n");
 
-	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r) {
-		if (r->second.empty())
-			continue;
+	std::vector<ResourceSlot> slots;
+	getSortedIndex(slots);
 
-		const Resource &res = r->second.back();
+	for (std::vector<ResourceSlot>::const_iterator s = slots.begin(); s != slots.end(); ++s) {
+		const Resource &res = *s->winner;
 
 		const Common::UString &name = res.name;
 		const Common::UString   ext = TypeMan.setFileType("", res.type);
-		const uint64_t         hash = r->first;
+		const uint64_t         hash = s->hash;
 		const uint32_t         size = getResourceSize(res);
 
 		const Common::UString line =
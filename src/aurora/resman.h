@@ -180,6 +180,15 @@ public:
 	/** Undo the changes done in the specified change ID. */
 	void undo(Common::ChangeID &changeID);
 
+	/** Return the current generation of the known resources.
+	 *
+	 *  The generation changes whenever resources are added or removed, or when
+	 *  anything else happens that might change which resource is returned for
+	 *  a name. Caches of data read out of resources can compare it against the
+	 *  generation they were filled in to see whether they went stale.
+	 */
+	uint32_t getGeneration() const;
+
 	/** Blacklist a specific resource.
 	 *
 	 *  That resource will never be returned when asked for. The ResourceManager
@@ -425,10 +434,23 @@ private:
 		bool operator<(const Resource &right) const;
 	};
 
-	/** List of resources, sorted by priority. */
+	/** List of all known resources. Never reordered, so pointers into it stay valid. */
 	typedef std::list<Resource> ResourceList;
-	/** Map over resources, indexed by their hashed name. */
-	typedef std::map<uint64_t, ResourceList> ResourceMap;
+
+	/** A slot in the resource index. */
+	struct ResourceSlot {
+		uint64_t  hash;   ///< The hashed name of the resource.
+		Resource *winner; ///< The highest-priority resource with that hash. 0 for empty slots.
+
+		ResourceSlot() : hash(0), winner(0) { }
+
+		bool operator<(const ResourceSlot &right) const { return hash < right.hash; }
+	};
+
+	/** Flat, open-addressing hash index over the resources, holding the winning resource of each hash. */
+	typedef std::vector<ResourceSlot> ResourceIndex;
+	/** Resources shadowed by a higher-priority resource with the same hash, in order of shadowing. */
+	typedef std::multimap<uint64_t, Resource *> ShadowedResources;
 	// '---
 
 	// .--- Changes
@@ -438,7 +460,7 @@ private:
 	typedef OpenedArchives::iterator OpenedArchiveChange;
 	/** A change produced by indexing archive resources. */
 	struct ResourceChange {
-		ResourceMap::iterator  hashIt;
+		uint64_t               hash;
 		ResourceList::iterator resIt;
 	};
 
@@ -491,8 +513,12 @@ private:
 	/** The current type aliases, changing one type to another. */
 	std::map<FileType, FileType> _typeAliases;
 
-	ResourceMap   _resources; ///< All currently known resources.
-	ChangeSetList _changes;   ///< Changes produced by indexing the currently known resources.
+	ResourceList      _resources;         ///< All currently known resources.
+	ResourceIndex     _resourceIndex;     ///< Index over the winning resources.
+	size_t            _resourceIndexSize; ///< Number of used slots in the resource index.
+	ShadowedResources _shadowed;          ///< Resources overruled by higher-priority ones.
+	ChangeSetList     _changes;           ///< Changes produced by indexing the currently known resources.
+	uint32_t          _generation;        ///< Changes whenever the known resources change.
 
 	FileTypeSet  _archiveTypeTypes [kArchiveMAX];  ///< All valid archive types file types.
 	FileTypeList _resourceTypeTypes[kResourceMAX]; ///< All valid resource type file types.
@@ -520,12 +546,25 @@ private:
 
 	bool checkResourceIsArchive(Resource &resource, Change *change);
 
-	void addResource(Resource &resource, uint64_t hash, Change *change);
+	void addResource(const Resource &resource, uint64_t hash, Change *change);
 	void addResource(const Common::UString &path, Change *change, uint32_t priority);
 
 	void addResources(const Common::FileList &files, Change *change, uint32_t priority);
 	// '---
 
+	// .--- Resource index
+	size_t findSlot(uint64_t hash) const;
+
+	void insertIndex(Resource &resource, uint64_t hash);
+	void removeIndex(Resource &resource, uint64_t hash);
+
+	void growIndex();
+	void eraseSlot(size_t slot);
+
+	void findResources(uint64_t hash, std::vector<Resource *> &resources);
+	void getSortedIndex(std::vector<ResourceSlot> &slots) const;
+	// '---
+
 	// .--- Finding and getting resources
 	const Resource *getRes(uint64_t hash) const;
 	const Resource *getRes(const Common::UString &name, const std::vector<FileType> &types) const;
@@ -548,7 +587,7 @@ private:
 	inline uint64_t getHash(const Common::UString &name, FileType type) const;
 	inline uint64_t getHash(const Common::UString &name) const;
 
-	void checkHashCollision(const Resource &resource, ResourceMap::const_iterator resList);
+	void checkHashCollision(const Resource &resource, uint64_t hash);
 
 	Change *newChangeSet(Common::ChangeID &changeID);
 	// '---
@@ -48,13 +48,7 @@ const Archive::ResourceList &TheWitcherSaveFile::getResources() const {
 Common::SeekableReadStream *TheWitcherSaveFile::getResource(uint32_t index, bool tryNoCopy) const {
 	IResource resource = _resources[index];
 
-	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_tws.get(), resource.offset, resource.offset + resource.length);
-	else {
-		_tws->seek(resource.offset);
-		Common::SeekableReadStream *readStream = _tws->readStream(resource.length);
-		return readStream;
-	}
+	return readSection(*_tws, resource.offset, resource.length, tryNoCopy);
 }
 
 void TheWitcherSaveFile::load() {
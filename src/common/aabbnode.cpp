@@ -137,6 +137,16 @@ void AABBNode::absolutize() {
 	_rightChild->absolutize();
 }
 
+void AABBNode::getLeaves(std::vector<AABBNode *> &leaves) {
+	if (!hasChildren()) {
+		leaves.push_back(this);
+		return;
+	}
+
+	_leftChild->getLeaves(leaves);
+	_rightChild->getLeaves(leaves);
+}
+
 void AABBNode::getNodes(float x1, float y1, float z1, float x2, float y2, float z2, std::vector<AABBNode *> &nodes) {
 	if (!isIn(x1, y1, z1, x2, y2, z2))
 		return;
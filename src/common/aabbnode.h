@@ -66,6 +66,8 @@ public:
 	/** Apply the origin transformations directly to the coordinates and its children. */
 	void absolutize();
 
+	/** Get all leaves of the AABB, left ones first. */
+	void getLeaves(std::vector<AABBNode *> &leaves);
 	/** Get the nodes that go through a given segment. */
 	void getNodes(float x1, float y1, float z1, float x2, float y2, float z2, std::vector<AABBNode *> &nodes);
 	/** Get the nodes at a given point in the XY plane. */
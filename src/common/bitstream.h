@@ -27,12 +27,17 @@
 
 #include <cassert>
 
+#include <memory>
+
 #include <boost/noncopyable.hpp>
 
 #include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/endianness.h"
 #include "src/common/disposableptr.h"
 #include "src/common/error.h"
 #include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
 
 namespace Common {
 
@@ -63,9 +68,19 @@ public:
 	/** Read a multi-bit value from the bit stream. */
 	virtual uint32_t getBits(size_t n) = 0;
 
+	/** Read a multi-bit value from the bit stream, without consuming the bits.
+	 *
+	 *  The bits are ordered in the same way as with getBits(). Bits past the
+	 *  end of the stream are read as 0.
+	 */
+	virtual uint32_t peekBits(size_t n) = 0;
+
 	/** Add a bit to the n-bit value x, making it an (n+1)-bit value. */
 	virtual void addBit(uint32_t &x, size_t n) = 0;
 
+	/** Are the bits handed out in the order of MSB to LSB? */
+	virtual bool isMSBFirst() const = 0;
+
 protected:
 	BitStream() {
 	}
@@ -198,6 +213,42 @@ public:
 		return v;
 	}
 
+	/** Read a multi-bit value from the bit stream, without consuming the bits. */
+	uint32_t peekBits(size_t n) {
+		if (n == 0)
+			return 0;
+
+		if (n > 32)
+			throw Exception("Too many bits requested to be read");
+
+		// The bits left in the current value
+		uint64_t bits = (_inValue == 0) ? 0 : _value;
+		size_t   have = (_inValue == 0) ? 0 : (valueBits - _inValue);
+
+		if (have < n) {
+			// Look ahead into the following values, then go back again
+			const size_t streamPos = _stream->pos();
+
+			while ((have < n) && ((_stream->size() - _stream->pos()) >= (valueBits / 8))) {
+				const uint64_t next = readData();
+
+				if (isMSB2LSB)
+					bits |= (next << (64 - valueBits)) >> have;
+				else
+					bits |= next << have;
+
+				have += valueBits;
+			}
+
+			_stream->seek(streamPos);
+		}
+
+		if (isMSB2LSB)
+			return (uint32_t) (bits >> (64 - n));
+
+		return (uint32_t) (bits & ((1ULL << n) - 1));
+	}
+
 	/** Add a bit to the n-bit value x, making it an (n+1)-bit value. */
 	void addBit(uint32_t &x, size_t n) {
 		if (n >= 32)
@@ -217,10 +268,42 @@ public:
 		_inValue = 0;
 	}
 
+	/** Are the bits handed out in the order of MSB to LSB? */
+	bool isMSBFirst() const {
+		return isMSB2LSB;
+	}
+
 	/** Skip the specified amount of bits. */
 	void skip(size_t n) {
-		while (n-- > 0)
-			getBit();
+		while (n > 0) {
+			if (_inValue == 0) {
+				// Skip over whole values directly in the data stream
+				if (n >= valueBits) {
+					const size_t values = n / valueBits;
+					if ((size() - pos()) < (values * valueBits))
+						throw Exception("BitStream::skip(): End of bit stream reached");
+
+					_stream->skip(values * (valueBits / 8));
+					n -= values * valueBits;
+					continue;
+				}
+
+				readValue();
+			}
+
+			// Skip over the bits in the current value
+			const size_t count = MIN<size_t>(n, valueBits - _inValue);
+
+			if (count >= 64)
+				_value = 0;
+			else if (isMSB2LSB)
+				_value <<= count;
+			else
+				_value >>= count;
+
+			_inValue = (_inValue + count) % valueBits;
+			n -= count;
+		}
 	}
 
 	/** Return the stream position in bits. */
@@ -242,6 +325,245 @@ public:
 	}
 };
 
+/**
+ * A template implementing a bit stream over a contiguous memory buffer.
+ *
+ * It supports the same data memory layouts as BitStreamImpl, but instead of
+ * reading data values from the stream one at a time, it refills a 64-bit
+ * cache straight out of the memory of a MemoryReadStream. Other streams are
+ * read into a buffer first.
+ *
+ * Bits are read from the cache without virtual calls, and getBits(), peekBits()
+ * and skip() take constant time. When used through the concrete type, all of
+ * these can be inlined.
+ *
+ * Unlike BitStreamImpl, the position of the underlying data stream is not
+ * moved along with the bit stream's position.
+ */
+template<int valueBits, bool isLE, bool isMSB2LSB>
+class BufferedBitStreamImpl final : boost::noncopyable, public BitStream {
+private:
+	/** Is the order of the bytes within a value opposite to the order we read the bits in? */
+	static const bool kSwapValues = (valueBits > 8) && (isLE == isMSB2LSB);
+
+	DisposablePtr<SeekableReadStream> _stream; ///< The input stream.
+
+	std::unique_ptr<byte[]> _buffer; ///< Our own copy of the data, if we needed one.
+
+	const byte *_data;    ///< The data.
+	size_t      _size;    ///< The size of the data in bytes, rounded down to whole values.
+	size_t      _dataPos; ///< Position of the next byte to move into the cache.
+
+	/** The cache. When reading MSB first, the next bit is the MSB, otherwise the LSB. */
+	uint64_t _cache;
+	/** The number of valid bits in the cache. */
+	size_t   _cacheBits;
+
+	void init() {
+		assert(_stream);
+
+		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32) && (valueBits != 64))
+			throw Exception("BitStream: Invalid memory layout %d, %d, %d", valueBits, isLE, isMSB2LSB);
+
+		const size_t start = _stream->pos();
+
+		_size = _stream->size() & ~((size_t) ((valueBits >> 3) - 1));
+
+		const MemoryReadStream *memory = dynamic_cast<const MemoryReadStream *>(_stream.get());
+		if (memory && !kSwapValues) {
+			_data = memory->getData();
+		} else {
+			_buffer = std::make_unique<byte[]>(_size);
+
+			_stream->seek(0);
+			if (_stream->read(_buffer.get(), _size) != _size)
+				throw Exception(kReadError);
+
+			_stream->seek(start);
+
+			/* If the bytes within a value are in the opposite order to how we read the bits,
+			 * we swap them. Then we can read the whole buffer as a simple stream of bytes. */
+			if (kSwapValues)
+				for (byte *value = _buffer.get(); value < (_buffer.get() + _size); value += valueBits >> 3)
+					for (size_t i = 0; i < (valueBits >> 4); i++)
+						std::swap(value[i], value[(valueBits >> 3) - 1 - i]);
+
+			_data = _buffer.get();
+		}
+
+		_dataPos   = MIN(start, _size);
+		_cache     = 0;
+		_cacheBits = 0;
+	}
+
+	/** Move as many bytes into the cache as fit. */
+	inline void refill() {
+		if ((_dataPos + 8) <= _size) {
+			/* Read a full 64-bit word and put all of it into the cache. Only the whole
+			 * bytes are counted as valid; the bits after those are the correct stream
+			 * bits too, so the next refill can safely combine with them again. */
+
+			if (isMSB2LSB)
+				_cache |= READ_BE_UINT64(_data + _dataPos) >> _cacheBits;
+			else
+				_cache |= READ_LE_UINT64(_data + _dataPos) << _cacheBits;
+
+			_dataPos   += (63 - _cacheBits) >> 3;
+			_cacheBits |= 56;
+
+			return;
+		}
+
+		// Near the end of the data, go byte by byte
+		while ((_cacheBits <= 56) && (_dataPos < _size)) {
+			if (isMSB2LSB)
+				_cache |= ((uint64_t) _data[_dataPos++]) << (56 - _cacheBits);
+			else
+				_cache |= ((uint64_t) _data[_dataPos++]) << _cacheBits;
+
+			_cacheBits += 8;
+		}
+	}
+
+	/** Remove n bits, n <= _cacheBits, from the cache. */
+	inline void consume(size_t n) {
+		if (isMSB2LSB)
+			_cache <<= n;
+		else
+			_cache >>= n;
+
+		_cacheBits -= n;
+	}
+
+	/** Return the next n bits, 0 < n <= 32, from the cache. */
+	inline uint32_t peekCache(size_t n) const {
+		if (isMSB2LSB)
+			return (uint32_t) (_cache >> (64 - n));
+
+		return (uint32_t) (_cache & ((1ULL << n) - 1));
+	}
+
+public:
+	/** Create a bit stream using this input data stream and optionally delete it on destruction. */
+	BufferedBitStreamImpl(SeekableReadStream *stream, bool disposeAfterUse = false) :
+		_stream(stream, disposeAfterUse), _data(0), _size(0), _dataPos(0), _cache(0), _cacheBits(0) {
+
+		init();
+	}
+
+	/** Create a bit stream using this input data stream. */
+	BufferedBitStreamImpl(SeekableReadStream &stream) :
+		_stream(&stream, false), _data(0), _size(0), _dataPos(0), _cache(0), _cacheBits(0) {
+
+		init();
+	}
+
+	~BufferedBitStreamImpl() {
+	}
+
+	/** Read a bit from the bit stream. */
+	inline uint32_t getBit() {
+		return getBits(1);
+	}
+
+	/** Read a multi-bit value from the bit stream. */
+	inline uint32_t getBits(size_t n) {
+		if (n == 0)
+			return 0;
+
+		if (n > 32)
+			throw Exception("Too many bits requested to be read");
+
+		if (_cacheBits < n) {
+			refill();
+
+			if (_cacheBits < n)
+				throw Exception("BitStream::getBits(): End of bit stream reached");
+		}
+
+		const uint32_t v = peekCache(n);
+		consume(n);
+
+		return v;
+	}
+
+	/** Read a multi-bit value from the bit stream, without consuming the bits. */
+	inline uint32_t peekBits(size_t n) {
+		if (n == 0)
+			return 0;
+
+		if (n > 32)
+			throw Exception("Too many bits requested to be read");
+
+		if (_cacheBits < n)
+			refill();
+
+		// Past the end of the data, the cache is padded with 0 bits
+		return peekCache(n);
+	}
+
+	/** Add a bit to the n-bit value x, making it an (n+1)-bit value. */
+	inline void addBit(uint32_t &x, size_t n) {
+		if (n >= 32)
+			throw Exception("Too many bits requested to be read");
+
+		if (isMSB2LSB)
+			x = (x << 1) | getBit();
+		else
+			x = (x & ~(1 << n)) | (getBit() << n);
+	}
+
+	/** Are the bits handed out in the order of MSB to LSB? */
+	bool isMSBFirst() const {
+		return isMSB2LSB;
+	}
+
+	/** Rewind the bit stream back to the start. */
+	void rewind() {
+		_dataPos   = 0;
+		_cache     = 0;
+		_cacheBits = 0;
+	}
+
+	/** Skip the specified amount of bits. */
+	inline void skip(size_t n) {
+		if (n <= _cacheBits) {
+			consume(n);
+			return;
+		}
+
+		if ((size() - pos()) < n)
+			throw Exception("BitStream::skip(): End of bit stream reached");
+
+		// Jump directly to the byte, then skip the remaining bits within it
+		const size_t newPos = pos() + n;
+
+		_dataPos   = newPos >> 3;
+		_cache     = 0;
+		_cacheBits = 0;
+
+		if ((newPos & 7) != 0) {
+			refill();
+			consume(newPos & 7);
+		}
+	}
+
+	/** Return the stream position in bits. */
+	size_t pos() const {
+		return _dataPos * 8 - _cacheBits;
+	}
+
+	/** Return the stream size in bits. */
+	size_t size() const {
+		return _size * 8;
+	}
+
+	bool eos() const {
+		return pos() >= size();
+	}
+};
+
+
 // typedefs for various memory layouts.
 
 /** 8-bit data, MSB to LSB. */
@@ -276,6 +598,38 @@ typedef BitStreamImpl<64, false, true > BitStream64BEMSB;
 /** 64-bit big-endian data, LSB to MSB. */
 typedef BitStreamImpl<64, false, false> BitStream64BELSB;
 
+/** Buffered 8-bit data, MSB to LSB. */
+typedef BufferedBitStreamImpl<8, false, true > BufferedBitStream8MSB;
+/** Buffered 8-bit data, LSB to MSB. */
+typedef BufferedBitStreamImpl<8, false, false> BufferedBitStream8LSB;
+
+/** Buffered 16-bit little-endian data, MSB to LSB. */
+typedef BufferedBitStreamImpl<16, true , true > BufferedBitStream16LEMSB;
+/** Buffered 16-bit little-endian data, LSB to MSB. */
+typedef BufferedBitStreamImpl<16, true , false> BufferedBitStream16LELSB;
+/** Buffered 16-bit big-endian data, MSB to LSB. */
+typedef BufferedBitStreamImpl<16, false, true > BufferedBitStream16BEMSB;
+/** Buffered 16-bit big-endian data, LSB to MSB. */
+typedef BufferedBitStreamImpl<16, false, false> BufferedBitStream16BELSB;
+
+/** Buffered 32-bit little-endian data, MSB to LSB. */
+typedef BufferedBitStreamImpl<32, true , true > BufferedBitStream32LEMSB;
+/** Buffered 32-bit little-endian data, LSB to MSB. */
+typedef BufferedBitStreamImpl<32, true , false> BufferedBitStream32LELSB;
+/** Buffered 32-bit big-endian data, MSB to LSB. */
+typedef BufferedBitStreamImpl<32, false, true > BufferedBitStream32BEMSB;
+/** Buffered 32-bit big-endian data, LSB to MSB. */
+typedef BufferedBitStreamImpl<32, false, false> BufferedBitStream32BELSB;
+
+/** Buffered 64-bit little-endian data, MSB to LSB. */
+typedef BufferedBitStreamImpl<64, true , true > BufferedBitStream64LEMSB;
+/** Buffered 64-bit little-endian data, LSB to MSB. */
+typedef BufferedBitStreamImpl<64, true , false> BufferedBitStream64LELSB;
+/** Buffered 64-bit big-endian data, MSB to LSB. */
+typedef BufferedBitStreamImpl<64, false, true > BufferedBitStream64BEMSB;
+/** Buffered 64-bit big-endian data, LSB to MSB. */
+typedef BufferedBitStreamImpl<64, false, false> BufferedBitStream64BELSB;
+
 } // End of namespace Common
 
 #endif // COMMON_BITSTREAM_H
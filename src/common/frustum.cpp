@@ -0,0 +1,121 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A view frustum, for visibility tests.
+ */
+
+#include "external/glm/geometric.hpp"
+
+#include "src/common/frustum.h"
+#include "src/common/boundingbox.h"
+
+namespace Common {
+
+Frustum::Frustum() {
+	set(glm::mat4());
+}
+
+Frustum::Frustum(const glm::mat4 &projection, const glm::mat4 &modelview) {
+	set(projection, modelview);
+}
+
+void Frustum::set(const glm::mat4 &projection, const glm::mat4 &modelview) {
+	set(projection * modelview);
+}
+
+void Frustum::set(const glm::mat4 &clip) {
+	/* A point p is within the frustum if each of its clip coordinates c = clip * p
+	 * lies between -c.w and c.w. Each of these six conditions is a plane equation,
+	 * made out of the fourth row of the matrix plus or minus one of the others.
+	 * See Gribb & Hartmann, "Fast Extraction of Viewing Frustum Planes from the
+	 * World-View-Projection Matrix". */
+
+	const glm::vec4 row0(clip[0][0], clip[1][0], clip[2][0], clip[3][0]);
+	const glm::vec4 row1(clip[0][1], clip[1][1], clip[2][1], clip[3][1]);
+	const glm::vec4 row2(clip[0][2], clip[1][2], clip[2][2], clip[3][2]);
+	const glm::vec4 row3(clip[0][3], clip[1][3], clip[2][3], clip[3][3]);
+
+	_planes[kPlaneLeft  ] = row3 + row0;
+	_planes[kPlaneRight ] = row3 - row0;
+	_planes[kPlaneBottom] = row3 + row1;
+	_planes[kPlaneTop   ] = row3 - row1;
+	_planes[kPlaneNear  ] = row3 + row2;
+	_planes[kPlaneFar   ] = row3 - row2;
+
+	for (int i = 0; i < kPlaneMAX; i++) {
+		const float length = glm::length(glm::vec3(_planes[i]));
+		if (length > 0.0f)
+			_planes[i] /= length;
+	}
+}
+
+const glm::vec4 &Frustum::getPlane(Plane plane) const {
+	return _planes[plane];
+}
+
+bool Frustum::isIn(float x, float y, float z) const {
+	return isIn(x, y, z, 0.0f);
+}
+
+bool Frustum::isIn(float x, float y, float z, float radius) const {
+	for (int i = 0; i < kPlaneMAX; i++) {
+		const glm::vec4 &p = _planes[i];
+
+		if ((p.x * x + p.y * y + p.z * z + p.w) < -radius)
+			return false;
+	}
+
+	return true;
+}
+
+bool Frustum::isIn(float minX, float minY, float minZ, float maxX, float maxY, float maxZ) const {
+	/* For each plane, only test the corner of the box that lies furthest along the
+	 * plane's normal. If even that one is behind the plane, the whole box is.
+	 *
+	 * This is conservative: a large box near a corner of the frustum might be
+	 * outside of it, yet not be completely behind any single plane. */
+
+	for (int i = 0; i < kPlaneMAX; i++) {
+		const glm::vec4 &p = _planes[i];
+
+		const float x = (p.x >= 0.0f) ? maxX : minX;
+		const float y = (p.y >= 0.0f) ? maxY : minY;
+		const float z = (p.z >= 0.0f) ? maxZ : minZ;
+
+		if ((p.x * x + p.y * y + p.z * z + p.w) < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+bool Frustum::isIn(const BoundingBox &box) const {
+	if (box.empty())
+		return false;
+
+	float minX, minY, minZ, maxX, maxY, maxZ;
+	box.getMin(minX, minY, minZ);
+	box.getMax(maxX, maxY, maxZ);
+
+	return isIn(minX, minY, minZ, maxX, maxY, maxZ);
+}
+
+} // End of namespace Common
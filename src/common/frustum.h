@@ -0,0 +1,90 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A view frustum, for visibility tests.
+ */
+
+#ifndef COMMON_FRUSTUM_H
+#define COMMON_FRUSTUM_H
+
+#include "external/glm/vec4.hpp"
+#include "external/glm/mat4x4.hpp"
+
+namespace Common {
+
+class BoundingBox;
+
+/** The volume of space visible through a camera, bounded by six planes.
+ *
+ *  The planes are extracted from a combined projection and modelview matrix,
+ *  so the frustum lies in world space and objects can be tested against it
+ *  with their world space bounds. Since the far plane is included, this also
+ *  rejects objects beyond the view distance.
+ */
+class Frustum {
+public:
+	enum Plane {
+		kPlaneLeft   = 0,
+		kPlaneRight     ,
+		kPlaneBottom    ,
+		kPlaneTop       ,
+		kPlaneNear      ,
+		kPlaneFar       ,
+		kPlaneMAX
+	};
+
+	/** Create a frustum for an identity projection, i.e. the cube [-1, 1]. */
+	Frustum();
+	/** Create the frustum of a camera with this projection and modelview matrix. */
+	Frustum(const glm::mat4 &projection, const glm::mat4 &modelview);
+
+	/** Recreate the frustum for a camera with this projection and modelview matrix. */
+	void set(const glm::mat4 &projection, const glm::mat4 &modelview);
+	/** Recreate the frustum for this combined projection * modelview matrix. */
+	void set(const glm::mat4 &clip);
+
+	/** Return a frustum plane, as (normal.x, normal.y, normal.z, distance).
+	 *
+	 *  The normal is of unit length and points into the frustum.
+	 */
+	const glm::vec4 &getPlane(Plane plane) const;
+
+	/** Is that point within the frustum? */
+	bool isIn(float x, float y, float z) const;
+	/** Does that sphere intersect the frustum? */
+	bool isIn(float x, float y, float z, float radius) const;
+	/** Does that axis-aligned box intersect the frustum? */
+	bool isIn(float minX, float minY, float minZ, float maxX, float maxY, float maxZ) const;
+
+	/** Does that bounding box intersect the frustum?
+	 *
+	 *  The test is made against the world space, axis-aligned extents of the box.
+	 *  An empty bounding box is never within the frustum.
+	 */
+	bool isIn(const BoundingBox &box) const;
+
+private:
+	glm::vec4 _planes[kPlaneMAX];
+};
+
+} // End of namespace Common
+
+#endif // COMMON_FRUSTUM_H
@@ -24,6 +24,8 @@
 
 #include <cassert>
 
+#include <map>
+
 #include "src/common/huffman.h"
 #include "src/common/util.h"
 #include "src/common/error.h"
@@ -31,7 +33,20 @@
 
 namespace Common {
 
-Huffman::Symbol::Symbol(uint32_t c, uint32_t s) : code(c), symbol(s) {
+/** The maximal number of bits looked up in one table. */
+static const size_t kHuffmanTableBits = 9;
+
+/** Reverse the order of the lowest n bits of x. */
+static inline uint32_t reverseBits(uint32_t x, size_t n) {
+	uint32_t r = 0;
+	for (size_t i = 0; i < n; i++, x >>= 1)
+		r = (r << 1) | (x & 1);
+
+	return r;
+}
+
+
+Huffman::TableEntry::TableEntry() : value(0), length(0) {
 }
 
 
@@ -59,18 +74,89 @@ void Huffman::init(uint8_t maxLength, size_t codeCount, const uint32_t *codes,
 
 	assert(maxLength <= 32);
 
-	_codes.resize(maxLength);
+	_maxLength = maxLength;
+	_tableBits = MIN<size_t>(maxLength, kHuffmanTableBits);
+
 	_symbols.resize(codeCount);
+	setSymbols(symbols);
+
+	/* The bit streams build the codes differently, depending on the order they
+	 * read the bits in: when reading LSB first, the first bit read ends up in
+	 * the LSB of the code. So we need separate tables for both orders. */
+
+	CodeList codesMSB, codesLSB;
+	codesMSB.reserve(codeCount);
+	codesLSB.reserve(codeCount);
 
 	for (size_t i = 0; i < codeCount; i++) {
-		// The symbol. If none were specified, just assume it's identical to the code index
-		uint32_t symbol = symbols ? symbols[i] : i;
+		assert((lengths[i] > 0) && (lengths[i] <= maxLength));
 
-		// Put the code and symbol into the correct list
-		_codes[lengths[i] - 1].push_back(Symbol(codes[i], symbol));
+		const uint32_t code = (lengths[i] < 32) ? (codes[i] & ((1U << lengths[i]) - 1)) : codes[i];
 
-		// And put the pointer to the symbol/code struct into the symbol list.
-		_symbols[i] = &_codes[lengths[i] - 1].back();
+		codesMSB.push_back(Code{ code                         , lengths[i], (uint32_t) i });
+		codesLSB.push_back(Code{ reverseBits(code, lengths[i]), lengths[i], (uint32_t) i });
+	}
+
+	_tables[0].resize(1 << _tableBits);
+	_tables[1].resize(1 << _tableBits);
+
+	buildTable(_tables[0], 0, _tableBits, 0, codesLSB, false);
+	buildTable(_tables[1], 0, _tableBits, 0, codesMSB, true);
+}
+
+void Huffman::buildTable(Table &table, size_t offset, size_t tableBits, size_t consumed,
+                         const CodeList &codes, bool msbFirst) {
+
+	/* The table is indexed by the next tableBits bits of the stream, as returned by peekBits().
+	 * When reading MSB first, the bit read first is the MSB of the index, otherwise it's the LSB. */
+
+	// Gather the codes that are too long for this table, by their first bits
+	std::map<uint32_t, CodeList> longCodes;
+	for (CodeList::const_iterator c = codes.begin(); c != codes.end(); ++c) {
+		const size_t left = c->length - consumed;
+		if (left > tableBits)
+			longCodes[(c->code >> (left - tableBits)) & ((1U << tableBits) - 1)].push_back(*c);
+	}
+
+	// Create the secondary tables for the long codes
+	for (std::map<uint32_t, CodeList>::const_iterator l = longCodes.begin(); l != longCodes.end(); ++l) {
+		size_t maxLeft = 0;
+		for (CodeList::const_iterator c = l->second.begin(); c != l->second.end(); ++c)
+			maxLeft = MAX<size_t>(maxLeft, c->length - consumed - tableBits);
+
+		const size_t subBits   = MIN<size_t>(maxLeft, kHuffmanTableBits);
+		const size_t subOffset = table.size();
+
+		table.resize(subOffset + (1 << subBits));
+
+		TableEntry &entry = table[offset + (msbFirst ? l->first : reverseBits(l->first, tableBits))];
+
+		entry.value  = subOffset;
+		entry.length = -((int8_t) subBits);
+
+		buildTable(table, subOffset, subBits, consumed + tableBits, l->second, msbFirst);
+	}
+
+	/* Fill in the codes that end within this table. Like the search in the order of
+	 * the code lengths we did before, shorter codes take precedence over longer ones,
+	 * and earlier codes over later ones, for malformed code lists. So we fill the
+	 * table in the reverse order, overwriting as needed. */
+	for (size_t left = tableBits; left > 0; left--) {
+		for (CodeList::const_reverse_iterator c = codes.rbegin(); c != codes.rend(); ++c) {
+			if ((size_t) (c->length - consumed) != left)
+				continue;
+
+			const uint32_t prefix = (c->code & ((1U << left) - 1)) << (tableBits - left);
+
+			for (uint32_t fill = 0; fill < (1U << (tableBits - left)); fill++) {
+				const uint32_t index = prefix | fill;
+
+				TableEntry &entry = table[offset + (msbFirst ? index : reverseBits(index, tableBits))];
+
+				entry.value  = c->index;
+				entry.length = (int8_t) left;
+			}
+		}
 	}
 }
 
@@ -79,18 +165,38 @@ Huffman::~Huffman() {
 
 void Huffman::setSymbols(const uint32_t *symbols) {
 	for (size_t i = 0; i < _symbols.size(); i++)
-		_symbols[i]->symbol = symbols ? *symbols++ : i;
+		_symbols[i] = symbols ? *symbols++ : i;
 }
 
 uint32_t Huffman::getSymbol(BitStream &bits) const {
-	uint32_t code = 0;
+	const bool   msbFirst = bits.isMSBFirst();
+	const Table &table    = _tables[msbFirst ? 1 : 0];
+
+	const uint32_t peek = bits.peekBits(_maxLength);
+
+	size_t offset    = 0;
+	size_t tableBits = _tableBits;
+	size_t consumed  = 0;
+
+	while (true) {
+		const uint32_t mask  = (1U << tableBits) - 1;
+		const uint32_t index = msbFirst ? ((peek >> (_maxLength - consumed - tableBits)) & mask) :
+		                                  ((peek >> consumed) & mask);
+
+		const TableEntry &entry = table[offset + index];
+
+		if (entry.length > 0) {
+			bits.skip(consumed + entry.length);
+
+			return _symbols[entry.value];
+		}
 
-	for (size_t i = 0; i < _codes.size(); i++) {
-		bits.addBit(code, i);
+		if (entry.length == 0)
+			break;
 
-		for (CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode)
-			if (code == cCode->code)
-				return cCode->symbol;
+		consumed += tableBits;
+		offset    = entry.value;
+		tableBits = -entry.length;
 	}
 
 	throw Exception("Unknown Huffman code");
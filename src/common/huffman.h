@@ -28,7 +28,6 @@
 #include <cstddef>
 
 #include <vector>
-#include <list>
 
 #include "src/common/types.h"
 
@@ -45,7 +44,12 @@ struct HuffmanTable {
 	const uint32_t *symbols; ///< The symbols, 0 if identical to the codes.
 };
 
-/** Decode a Huffman'd bitstream. */
+/** Decode a Huffman'd bitstream.
+ *
+ *  The codes are decoded with multi-level lookup tables: the next few bits of
+ *  the stream are peeked and looked up in the main table, which directly
+ *  yields short codes. Longer codes are continued in secondary tables.
+ */
 class Huffman {
 public:
 	/** Construct a Huffman decoder.
@@ -68,25 +72,42 @@ public:
 	uint32_t getSymbol(BitStream &bits) const;
 
 private:
-	struct Symbol {
-		uint32_t code;
-		uint32_t symbol;
+	/** An entry in a lookup table. */
+	struct TableEntry {
+		/** Index of the code for code entries, or the offset of the secondary table. */
+		uint32_t value;
+		/** Length of the code within this table, the negative number of bits of the secondary table, or 0 if invalid. */
+		int8_t length;
+
+		TableEntry();
+	};
 
-		Symbol(uint32_t c, uint32_t s);
+	/** A code, with its bits in reading order. */
+	struct Code {
+		uint32_t code;   ///< The code's bits, the bit read first at the MSB.
+		uint8_t  length; ///< The code's length.
+		uint32_t index;  ///< The index of the code.
 	};
 
-	typedef std::list<Symbol>     CodeList;
-	typedef std::vector<CodeList> CodeLists;
-	typedef std::vector<Symbol *> SymbolList;
+	typedef std::vector<TableEntry> Table;
+	typedef std::vector<Code>       CodeList;
 
-	/** Lists of codes and their symbols, sorted by code length. */
-	CodeLists _codes;
+	/** The maximal code length. */
+	uint8_t _maxLength;
+	/** The number of bits looked up in the main table. */
+	uint8_t _tableBits;
 
-	/** Sorted list of pointers to the symbols. */
-	SymbolList _symbols;
+	/** The lookup tables, for bit streams reading LSB first (0) and MSB first (1). */
+	Table _tables[2];
+
+	/** The symbols, indexed by their code's index. */
+	std::vector<uint32_t> _symbols;
 
 	void init(uint8_t maxLength, size_t codeCount, const uint32_t *codes,
 	          const uint8_t *lengths, const uint32_t *symbols);
+
+	static void buildTable(Table &table, size_t offset, size_t tableBits, size_t consumed,
+	                       const CodeList &codes, bool msbFirst);
 };
 
 } // End of namespace Common
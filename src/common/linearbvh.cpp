@@ -0,0 +1,214 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** @file
+ *  A flattened bounding volume hierarchy over axis-aligned boxes.
+ */
+
+#include <algorithm>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/aabbnode.h"
+#include "src/common/linearbvh.h"
+
+namespace Common {
+
+struct LinearBVH::BuildLeaf {
+	float min[3];    ///< Minimal values of the leaf's box.
+	float max[3];    ///< Maximal values of the leaf's box.
+	float center[3]; ///< Center of the leaf's box.
+
+	uint32_t order; ///< The position of the leaf in the source trees.
+};
+
+
+LinearBVH::LinearBVH() {
+}
+
+LinearBVH::~LinearBVH() {
+}
+
+void LinearBVH::clear() {
+	_nodes.clear();
+	_leaves.clear();
+}
+
+bool LinearBVH::empty() const {
+	return _leaves.empty();
+}
+
+size_t LinearBVH::getLeafCount() const {
+	return _leaves.size();
+}
+
+size_t LinearBVH::getNodeCount() const {
+	return _nodes.size();
+}
+
+void LinearBVH::build(const std::vector<AABBNode *> &trees) {
+	clear();
+
+	std::vector<AABBNode *> nodes;
+	for (std::vector<AABBNode *>::const_iterator t = trees.begin(); t != trees.end(); ++t)
+		if (*t)
+			(*t)->getLeaves(nodes);
+
+	if (nodes.empty())
+		return;
+
+	// Leaves are stored as the complement of their order in a signed integer
+	if (nodes.size() > 0x7FFFFFFF)
+		throw Exception("LinearBVH: Too many leaves (%u)", (uint) nodes.size());
+
+	std::vector<BuildLeaf> leaves(nodes.size());
+	_leaves.resize(nodes.size());
+
+	for (size_t i = 0; i < nodes.size(); i++) {
+		BuildLeaf &leaf = leaves[i];
+
+		nodes[i]->getMin(leaf.min[0], leaf.min[1], leaf.min[2]);
+		nodes[i]->getMax(leaf.max[0], leaf.max[1], leaf.max[2]);
+
+		for (int axis = 0; axis < 3; axis++)
+			leaf.center[axis] = (leaf.min[axis] + leaf.max[axis]) * 0.5f;
+
+		leaf.order = i;
+
+		_leaves[i] = nodes[i]->getProperty();
+	}
+
+	// A node holds four children, and we split down to single leaves
+	_nodes.reserve(nodes.size() / 2 + 1);
+
+	_nodes.emplace_back();
+	buildNode(0, leaves, 0, leaves.size(), 1);
+}
+
+void LinearBVH::buildNode(size_t node, std::vector<BuildLeaf> &leaves, size_t first, size_t last, size_t depth) {
+	if (depth > kMaxDepth)
+		throw Exception("LinearBVH: Hierarchy too deep");
+
+	// Divide the leaves into up to four groups, one for each child
+	size_t bounds[5];
+	size_t groupCount = 0;
+
+	if ((last - first) <= 4) {
+		for (size_t i = first; i <= last; i++)
+			bounds[groupCount++] = i;
+
+		groupCount--;
+	} else {
+		const size_t middle = splitLeaves(leaves, first, last);
+
+		bounds[0] = first;
+		bounds[1] = splitLeaves(leaves, first, middle);
+		bounds[2] = middle;
+		bounds[3] = splitLeaves(leaves, middle, last);
+		bounds[4] = last;
+
+		groupCount = 4;
+	}
+
+	Node data;
+	for (int i = 0; i < 4; i++) {
+		data.minX[i] = data.minY[i] = data.minZ[i] = 0.0f;
+		data.maxX[i] = data.maxY[i] = data.maxZ[i] = 0.0f;
+
+		data.child[i] = 0;
+		data.order[i] = UINT32_MAX;
+	}
+
+	size_t innerChildren[4];
+
+	for (size_t g = 0; g < groupCount; g++) {
+		const BuildLeaf &firstLeaf = leaves[bounds[g]];
+
+		float min[3] = { firstLeaf.min[0], firstLeaf.min[1], firstLeaf.min[2] };
+		float max[3] = { firstLeaf.max[0], firstLeaf.max[1], firstLeaf.max[2] };
+
+		uint32_t order = firstLeaf.order;
+
+		for (size_t i = bounds[g] + 1; i < bounds[g + 1]; i++) {
+			for (int axis = 0; axis < 3; axis++) {
+				min[axis] = MIN(min[axis], leaves[i].min[axis]);
+				max[axis] = MAX(max[axis], leaves[i].max[axis]);
+			}
+
+			order = MIN(order, leaves[i].order);
+		}
+
+		data.minX[g] = min[0];
+		data.minY[g] = min[1];
+		data.minZ[g] = min[2];
+		data.maxX[g] = max[0];
+		data.maxY[g] = max[1];
+		data.maxZ[g] = max[2];
+
+		data.order[g] = order;
+
+		if ((bounds[g + 1] - bounds[g]) == 1) {
+			data.child[g] = ~((int32_t) order);
+			continue;
+		}
+
+		innerChildren[g] = _nodes.size();
+		data.child[g]    = _nodes.size();
+
+		_nodes.emplace_back();
+	}
+
+	// Building the children adds more nodes, so only hold on to indices
+	_nodes[node] = data;
+
+	for (size_t g = 0; g < groupCount; g++)
+		if ((bounds[g + 1] - bounds[g]) > 1)
+			buildNode(innerChildren[g], leaves, bounds[g], bounds[g + 1], depth + 1);
+}
+
+size_t LinearBVH::splitLeaves(std::vector<BuildLeaf> &leaves, size_t first, size_t last) {
+	float min[3] = { leaves[first].center[0], leaves[first].center[1], leaves[first].center[2] };
+	float max[3] = { min[0], min[1], min[2] };
+
+	for (size_t i = first + 1; i < last; i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			min[axis] = MIN(min[axis], leaves[i].center[axis]);
+			max[axis] = MAX(max[axis], leaves[i].center[axis]);
+		}
+	}
+
+	int axis = 0;
+	if ((max[1] - min[1]) > (max[axis] - min[axis]))
+		axis = 1;
+	if ((max[2] - min[2]) > (max[axis] - min[axis]))
+		axis = 2;
+
+	const size_t middle = first + (last - first) / 2;
+
+	std::nth_element(leaves.begin() + first, leaves.begin() + middle, leaves.begin() + last,
+	                 [axis](const BuildLeaf &a, const BuildLeaf &b) {
+		return a.center[axis] < b.center[axis];
+	});
+
+	return middle;
+}
+
+} // End of namespace Common
@@ -0,0 +1,281 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** @file
+ *  A flattened bounding volume hierarchy over axis-aligned boxes.
+ */
+
+#ifndef COMMON_LINEARBVH_H
+#define COMMON_LINEARBVH_H
+
+#include <vector>
+
+#include "src/common/types.h"
+
+namespace Common {
+
+class AABBNode;
+
+/** A flattened, 4-wide bounding volume hierarchy.
+ *
+ *  The hierarchy is built once over the leaves of a set of AABBNode trees
+ *  and then only queried. All nodes live in one contiguous array, and each
+ *  node holds the boxes of its up to four children in a structure-of-arrays
+ *  layout, so that all four boxes are tested by a loop the compiler can turn
+ *  into SIMD instructions.
+ *
+ *  The queries look for the first leaf, in the order the leaves had in the
+ *  source trees, whose box contains a point or is hit by a segment and which
+ *  is accepted by a filter. This gives the same result as walking the source
+ *  trees in order and stopping at the first accepted leaf, but subtrees that
+ *  can't hold an earlier leaf than one already found are skipped. The queries
+ *  don't allocate any memory.
+ */
+class LinearBVH {
+public:
+	LinearBVH();
+	~LinearBVH();
+
+	/** Remove all nodes and leaves. */
+	void clear();
+
+	/** Build the hierarchy over all leaves of these trees. Null trees are skipped.
+	 *
+	 *  The leaves keep the order they have when walking the trees in turn, left
+	 *  children first. Their properties are what the queries return.
+	 */
+	void build(const std::vector<AABBNode *> &trees);
+
+	/** Does the hierarchy contain no leaves? */
+	bool empty() const;
+
+	/** Return the number of leaves in the hierarchy. */
+	size_t getLeafCount() const;
+	/** Return the number of nodes in the hierarchy. */
+	size_t getNodeCount() const;
+
+	/** Find the first leaf containing this point in the XY plane that is accepted by the filter.
+	 *
+	 *  @param  x       The x component of the point.
+	 *  @param  y       The y component of the point.
+	 *  @param  filter  Called with the property of a candidate leaf, returns whether to accept it.
+	 *  @return The property of the found leaf, or UINT32_MAX if none was found.
+	 */
+	template<typename Filter>
+	uint32_t findPoint(float x, float y, Filter filter) const;
+
+	/** Find the first leaf whose box is hit by this segment that is accepted by the filter.
+	 *
+	 *  @param  x1      The x component of the start of the segment.
+	 *  @param  y1      The y component of the start of the segment.
+	 *  @param  z1      The z component of the start of the segment.
+	 *  @param  x2      The x component of the end of the segment.
+	 *  @param  y2      The y component of the end of the segment.
+	 *  @param  z2      The z component of the end of the segment.
+	 *  @param  filter  Called with the property of a candidate leaf, returns whether to accept it.
+	 *  @return The property of the found leaf, or UINT32_MAX if none was found.
+	 */
+	template<typename Filter>
+	uint32_t findSegment(float x1, float y1, float z1, float x2, float y2, float z2, Filter filter) const;
+
+private:
+	/** The maximum depth of the hierarchy. */
+	static const size_t kMaxDepth  = 32;
+	/** The size of the traversal stack. Each level adds at most 3 entries. */
+	static const size_t kStackSize = 3 * kMaxDepth + 2;
+
+	/** A node with up to four children. */
+	struct Node {
+		float minX[4], minY[4], minZ[4]; ///< Minimal values of the children's boxes.
+		float maxX[4], maxY[4], maxZ[4]; ///< Maximal values of the children's boxes.
+
+		/** The children. An index into the nodes, or the bitwise complement of a leaf's order. */
+		int32_t child[4];
+		/** The smallest leaf order within each child. UINT32_MAX for unused children. */
+		uint32_t order[4];
+	};
+
+	/** A segment, prepared for the slab test. */
+	struct Segment {
+		float origin[3];   ///< The start of the segment.
+		float invDir[3];   ///< The inverse of the segment's direction.
+		bool  parallel[3]; ///< Is the segment parallel to this axis' slabs?
+	};
+
+	/** A leaf while building the hierarchy. */
+	struct BuildLeaf;
+
+	std::vector<Node>     _nodes;  ///< All nodes, the root first.
+	std::vector<uint32_t> _leaves; ///< The properties of all leaves, by their order.
+
+	void buildNode(size_t node, std::vector<BuildLeaf> &leaves, size_t first, size_t last, size_t depth);
+	/** Split the leaves in half along the longest extent of their centers. */
+	static size_t splitLeaves(std::vector<BuildLeaf> &leaves, size_t first, size_t last);
+
+	/** Return a bit mask of the children whose boxes contain this point in the XY plane. */
+	static uint32_t testPoint(const Node &node, float x, float y);
+	/** Return a bit mask of the children whose boxes are hit by this segment. */
+	static uint32_t testSegment(const Node &node, const Segment &segment);
+
+	/** Walk the hierarchy, visiting the children matched by the test earliest leaf order first. */
+	template<typename Test, typename Filter>
+	uint32_t find(Test test, Filter filter) const;
+};
+
+inline uint32_t LinearBVH::testPoint(const Node &node, float x, float y) {
+	uint32_t mask = 0;
+
+	for (int i = 0; i < 4; i++)
+		mask |= ((uint32_t) ((node.minX[i] <= x) & (x <= node.maxX[i]) &
+		                     (node.minY[i] <= y) & (y <= node.maxY[i]))) << i;
+
+	return mask;
+}
+
+inline uint32_t LinearBVH::testSegment(const Node &node, const Segment &segment) {
+	const float *mins[3] = { node.minX, node.minY, node.minZ };
+	const float *maxs[3] = { node.maxX, node.maxY, node.maxZ };
+
+	float tNear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	float tFar [4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	for (int axis = 0; axis < 3; axis++) {
+		const float o = segment.origin[axis];
+
+		if (segment.parallel[axis]) {
+			// The segment never crosses this axis' slabs, so it has to lie between them
+			for (int i = 0; i < 4; i++)
+				tFar[i] = ((o < mins[axis][i]) | (o > maxs[axis][i])) ? -1.0f : tFar[i];
+
+			continue;
+		}
+
+		const float d = segment.invDir[axis];
+
+		for (int i = 0; i < 4; i++) {
+			const float t0 = (mins[axis][i] - o) * d;
+			const float t1 = (maxs[axis][i] - o) * d;
+
+			const float tMin = (t0 < t1) ? t0 : t1;
+			const float tMax = (t0 < t1) ? t1 : t0;
+
+			tNear[i] = (tMin > tNear[i]) ? tMin : tNear[i];
+			tFar [i] = (tMax < tFar [i]) ? tMax : tFar [i];
+		}
+	}
+
+	uint32_t mask = 0;
+	for (int i = 0; i < 4; i++)
+		mask |= ((uint32_t) (tNear[i] <= tFar[i])) << i;
+
+	return mask;
+}
+
+template<typename Test, typename Filter>
+uint32_t LinearBVH::find(Test test, Filter filter) const {
+	if (_nodes.empty())
+		return UINT32_MAX;
+
+	// The order of the earliest accepted leaf so far
+	uint32_t found = UINT32_MAX;
+
+	// The children still to visit, with the smallest leaf order within them
+	int32_t  stackChild[kStackSize];
+	uint32_t stackOrder[kStackSize];
+
+	stackChild[0] = 0;
+	stackOrder[0] = 0;
+
+	size_t stackSize = 1;
+
+	while (stackSize > 0) {
+		stackSize--;
+
+		const int32_t  child = stackChild[stackSize];
+		const uint32_t order = stackOrder[stackSize];
+
+		// Nothing in here can come before what we already found
+		if (order >= found)
+			continue;
+
+		if (child < 0) {
+			if (filter(_leaves[order]))
+				found = order;
+
+			continue;
+		}
+
+		const Node &node = _nodes[child];
+
+		const uint32_t mask = test(node);
+
+		// Sort the matching children by their order, the latest first
+		int hits[4];
+		int hitCount = 0;
+
+		for (int i = 0; i < 4; i++) {
+			if (!(mask & (1 << i)) || (node.order[i] >= found))
+				continue;
+
+			int j = hitCount++;
+			for (; (j > 0) && (node.order[hits[j - 1]] < node.order[i]); j--)
+				hits[j] = hits[j - 1];
+
+			hits[j] = i;
+		}
+
+		// Push them so that the earliest one is visited next
+		for (int i = 0; i < hitCount; i++) {
+			stackChild[stackSize  ] = node.child[hits[i]];
+			stackOrder[stackSize++] = node.order[hits[i]];
+		}
+	}
+
+	return (found == UINT32_MAX) ? UINT32_MAX : _leaves[found];
+}
+
+template<typename Filter>
+uint32_t LinearBVH::findPoint(float x, float y, Filter filter) const {
+	return find([x, y](const Node &node) { return testPoint(node, x, y); }, filter);
+}
+
+template<typename Filter>
+uint32_t LinearBVH::findSegment(float x1, float y1, float z1, float x2, float y2, float z2,
+                                Filter filter) const {
+
+	const float start[3] = { x1, y1, z1 };
+	const float end  [3] = { x2, y2, z2 };
+
+	Segment segment;
+	for (int axis = 0; axis < 3; axis++) {
+		const float d = end[axis] - start[axis];
+
+		segment.origin  [axis] = start[axis];
+		segment.parallel[axis] = d == 0.0f;
+		segment.invDir  [axis] = (d == 0.0f) ? 0.0f : (1.0f / d);
+	}
+
+	return find([&segment](const Node &node) { return testSegment(node, segment); }, filter);
+}
+
+} // End of namespace Common
+
+#endif // COMMON_LINEARBVH_H
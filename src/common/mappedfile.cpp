@@ -0,0 +1,210 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Implementing the stream reading interfaces for memory-mapped files.
+ */
+
+#include "src/common/system.h"
+
+#if defined(WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include <boost/filesystem/path.hpp>
+
+#include "src/common/mappedfile.h"
+#include "src/common/error.h"
+#include "src/common/ustring.h"
+
+namespace Common {
+
+/** The largest file we map. Same limit as in ReadFile. */
+static const uint64_t kMaxMappedSize = 0x7FFFFFFFULL;
+
+MappedFile::MappedFile() : _data(0), _size(0)
+#if defined(WIN32)
+	, _handle(INVALID_HANDLE_VALUE), _mapping(0)
+#endif
+	{
+}
+
+MappedFile::MappedFile(const UString &fileName) : _data(0), _size(0)
+#if defined(WIN32)
+	, _handle(INVALID_HANDLE_VALUE), _mapping(0)
+#endif
+	{
+
+	if (!open(fileName))
+		throw Exception("Can't map file \"%s\"", fileName.c_str());
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#if defined(WIN32)
+
+bool MappedFile::open(const UString &fileName) {
+	close();
+
+	_handle = CreateFileW(boost::filesystem::path(fileName.c_str()).c_str(), GENERIC_READ, FILE_SHARE_READ,
+	                      0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (_handle == INVALID_HANDLE_VALUE) {
+		close();
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(_handle, &fileSize) || (fileSize.QuadPart <= 0) ||
+	    ((uint64_t) fileSize.QuadPart > kMaxMappedSize)) {
+
+		close();
+		return false;
+	}
+
+	_size = (size_t) fileSize.QuadPart;
+
+	_mapping = CreateFileMappingW(_handle, 0, PAGE_READONLY, 0, 0, 0);
+	if (!_mapping) {
+		close();
+		return false;
+	}
+
+	_data = static_cast<const byte *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!_data) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::close() {
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mapping)
+		CloseHandle(_mapping);
+	if (_handle != INVALID_HANDLE_VALUE)
+		CloseHandle(_handle);
+
+	_data    = 0;
+	_size    = 0;
+	_mapping = 0;
+	_handle  = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::open(const UString &fileName) {
+	close();
+
+	const int fd = ::open(boost::filesystem::path(fileName.c_str()).c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat fileStat;
+	if ((fstat(fd, &fileStat) != 0) || !S_ISREG(fileStat.st_mode) ||
+	    (fileStat.st_size <= 0) || ((uint64_t) fileStat.st_size > kMaxMappedSize)) {
+
+		::close(fd);
+		return false;
+	}
+
+	void *data = mmap(0, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping keeps its own reference to the file
+	::close(fd);
+
+	if (data == MAP_FAILED)
+		return false;
+
+	_data = static_cast<const byte *>(data);
+	_size = (size_t) fileStat.st_size;
+
+	return true;
+}
+
+void MappedFile::close() {
+	if (_data)
+		munmap(const_cast<byte *>(_data), _size);
+
+	_data = 0;
+	_size = 0;
+}
+
+#endif
+
+bool MappedFile::isOpen() const {
+	return _data != 0;
+}
+
+const byte *MappedFile::getData() const {
+	return _data;
+}
+
+size_t MappedFile::getSize() const {
+	return _size;
+}
+
+
+MappedReadStream::MappedReadStream(const UString &fileName) : MappedReadStream(mapFile(fileName)) {
+}
+
+MappedReadStream::MappedReadStream(const std::shared_ptr<MappedFile> &file) :
+	MemoryReadStream(file->getData(), file->getSize()), _file(file) {
+
+}
+
+MappedReadStream::MappedReadStream(const std::shared_ptr<MappedFile> &file, const byte *data, size_t size) :
+	MemoryReadStream(data, size), _file(file) {
+
+}
+
+MappedReadStream::~MappedReadStream() {
+}
+
+std::shared_ptr<MappedFile> MappedReadStream::mapFile(const UString &fileName) {
+	return std::make_shared<MappedFile>(fileName);
+}
+
+MappedReadStream *MappedReadStream::getView(size_t begin, size_t end) const {
+	if ((begin > end) || (end > size()))
+		throw Exception("Invalid view into mapped file (%u - %u, %u)", (uint) begin, (uint) end, (uint) size());
+
+	return new MappedReadStream(_file, getData() + begin, end - begin);
+}
+
+MappedReadStream *MappedReadStream::createView(const SeekableReadStream &stream, size_t begin, size_t end) {
+	const MappedReadStream *mapped = dynamic_cast<const MappedReadStream *>(&stream);
+	if (!mapped)
+		return 0;
+
+	return mapped->getView(begin, end);
+}
+
+} // End of namespace Common
@@ -0,0 +1,113 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Implementing the stream reading interfaces for memory-mapped files.
+ */
+
+#ifndef COMMON_MAPPEDFILE_H
+#define COMMON_MAPPEDFILE_H
+
+#include <cstddef>
+
+#include <memory>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/memreadstream.h"
+
+namespace Common {
+
+class UString;
+
+/** A read-only memory mapping of a whole file. */
+class MappedFile : boost::noncopyable {
+public:
+	MappedFile();
+	MappedFile(const UString &fileName);
+	~MappedFile();
+
+	/** Try to map the file with the given fileName into memory.
+	 *
+	 *  Empty files and files that are too big can't be mapped.
+	 *
+	 *  @param  fileName the name of the file to map
+	 *  @return true if the file was mapped successfully, false otherwise
+	 */
+	bool open(const UString &fileName);
+
+	/** Unmap the file, if mapped. */
+	void close();
+
+	/** Checks if the object mapped a file successfully.
+	 *
+	 *  @return true if any file is mapped, false otherwise.
+	 */
+	bool isOpen() const;
+
+	/** Return the start of the mapped file data. */
+	const byte *getData() const;
+	/** Return the size of the mapped file. */
+	size_t getSize() const;
+
+private:
+	const byte *_data; ///< The mapped file data.
+	size_t      _size; ///< The file's size.
+
+#if defined(WIN32)
+	void *_handle;  ///< The file handle.
+	void *_mapping; ///< The file mapping handle.
+#endif
+};
+
+/** A read stream over a memory-mapped file, or over a section of one.
+ *
+ *  Reading never copies the file data, and views created by getView() each
+ *  have their own, independent position within the mapping. The mapping
+ *  stays valid as long as there's still a stream referencing it.
+ */
+class MappedReadStream : public MemoryReadStream {
+public:
+	/** Map a whole file. Throws if the file can't be mapped. */
+	MappedReadStream(const UString &fileName);
+	~MappedReadStream();
+
+	/** Create a new stream over the section [begin, end) of this stream. */
+	MappedReadStream *getView(size_t begin, size_t end) const;
+
+	/** Create a view into the section [begin, end) of a stream, if that stream is mapped.
+	 *
+	 *  @return A new view into the mapping, or 0 if the stream is not a MappedReadStream.
+	 */
+	static MappedReadStream *createView(const SeekableReadStream &stream, size_t begin, size_t end);
+
+private:
+	MappedReadStream(const std::shared_ptr<MappedFile> &file);
+	MappedReadStream(const std::shared_ptr<MappedFile> &file, const byte *data, size_t size);
+
+	std::shared_ptr<MappedFile> _file;
+
+	static std::shared_ptr<MappedFile> mapFile(const UString &fileName);
+};
+
+} // End of namespace Common
+
+#endif // COMMON_MAPPEDFILE_H
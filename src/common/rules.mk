@@ -62,6 +62,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/stringmap.h \
     src/common/readline.h \
     src/common/readfile.h \
+    src/common/mappedfile.h \
     src/common/writefile.h \
     src/common/filepath.h \
     src/common/filelist.h \
@@ -70,6 +71,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/bitstreamwriter.h \
     src/common/huffman.h \
     src/common/boundingbox.h \
+    src/common/frustum.h \
     src/common/configfile.h \
     src/common/configman.h \
     src/common/foxpro.h \
@@ -82,6 +84,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/timestamp.h \
     src/common/geometry.h \
     src/common/aabbnode.h \
+    src/common/linearbvh.h \
     src/common/random.h \
     src/common/mutex.h \
     src/common/semaphore.h \
@@ -122,11 +125,13 @@ src_common_libcommon_la_SOURCES += \
     src/common/stringmap.cpp \
     src/common/readline.cpp \
     src/common/readfile.cpp \
+    src/common/mappedfile.cpp \
     src/common/writefile.cpp \
     src/common/filepath.cpp \
     src/common/filelist.cpp \
     src/common/huffman.cpp \
     src/common/boundingbox.cpp \
+    src/common/frustum.cpp \
     src/common/configfile.cpp \
     src/common/configman.cpp \
     src/common/foxpro.cpp \
@@ -138,6 +143,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/rational.cpp \
     src/common/timestamp.cpp \
     src/common/aabbnode.cpp \
+    src/common/linearbvh.cpp \
     src/common/random.cpp \
     src/common/semaphore.cpp \
     src/common/serializationstream.cpp \
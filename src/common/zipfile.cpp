@@ -30,6 +30,7 @@
 #include "src/common/strutil.h"
 #include "src/common/encoding.h"
 #include "src/common/memreadstream.h"
+#include "src/common/mappedfile.h"
 #include "src/common/deflate.h"
 
 namespace Common {
@@ -158,19 +159,31 @@ size_t ZipFile::getFileSize(uint32_t index) const {
 	return getIFile(index).size;
 }
 
-SeekableReadStream *ZipFile::getFile(uint32_t index, bool tryNoCopy) const {
+SeekableReadStream *ZipFile::getFile(uint32_t index, bool UNUSED(tryNoCopy)) const {
 	const IFile &file = getIFile(index);
 
 	uint16_t compMethod;
 	uint32_t compSize;
 	uint32_t realSize;
 
-	getFileProperties(*_zip, file, compMethod, compSize, realSize);
+	std::unique_ptr<SeekableReadStream> compStream;
 
-	if (tryNoCopy && (compMethod == 0))
-		return new SeekableSubReadStream(_zip.get(), _zip->pos(), _zip->pos() + compSize);
+	{
+		// Reading the local file header needs seeking, so only one thread at a time
+		std::lock_guard<std::mutex> lock(_mutex);
 
-	return decompressFile(*_zip, compMethod, compSize, realSize);
+		getFileProperties(*_zip, file, compMethod, compSize, realSize);
+
+		// A memory-mapped archive can directly hand out a view into the mapping
+		compStream.reset(MappedReadStream::createView(*_zip, _zip->pos(), _zip->pos() + compSize));
+		if (!compStream)
+			compStream.reset(_zip->readStream(compSize));
+	}
+
+	if (compMethod == 0)
+		return compStream.release();
+
+	return decompressFile(*compStream, compMethod, compSize, realSize);
 }
 
 SeekableReadStream *ZipFile::decompressFile(SeekableReadStream &zip, uint32_t method,
@@ -29,6 +29,7 @@
 #include <vector>
 
 #include <memory>
+#include <mutex>
 
 #include <boost/noncopyable.hpp>
 
@@ -59,7 +60,10 @@ public:
 	/** Return the size of a file. */
 	size_t getFileSize(uint32_t index) const;
 
-	/** Return a stream of the file's contents. */
+	/** Return a stream of the file's contents.
+	 *
+	 *  Several threads can get files from the same ZIP at the same time.
+	 */
 	SeekableReadStream *getFile(uint32_t index, bool tryNoCopy = false) const;
 
 private:
@@ -73,6 +77,9 @@ private:
 
 	std::unique_ptr<SeekableReadStream> _zip;
 
+	/** Mutex securing access to the ZIP stream. */
+	mutable std::mutex _mutex;
+
 	/** External list of file names and types. */
 	FileList _files;
 
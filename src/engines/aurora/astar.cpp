@@ -31,7 +31,7 @@
 
 namespace Engines {
 
-AStar::AStar(Engines::Pathfinding* pathfinding) : _pathfinding(pathfinding) {
+AStar::AStar(Engines::Pathfinding* pathfinding) : _pathfinding(pathfinding), _generation(0) {
 }
 
 AStar::~AStar() {
@@ -48,6 +48,9 @@ bool AStar::Node::operator<(const Node &node) const {
 	return G + H < node.G + node.H;
 }
 
+AStar::NodeState::NodeState() : generation(0), heapIndex(kNotInHeap), closed(false) {
+}
+
 bool AStar::findPath(float startX, float startY, float endX, float endY,
                      std::vector<uint32_t> &facePath, float width, uint32_t maxIteration) {
 
@@ -68,39 +71,46 @@ bool AStar::findPath(float startX, float startY, float endX, float endY,
 		return true;
 	}
 
+	newGeneration();
+
+	if (_states.size() < _pathfinding->_facesCount)
+		_states.resize(_pathfinding->_facesCount);
+
 	// Init nodes and lists.
-	Node startNode = Node(startFace, startX, startY);
-	Node endNode   = Node(endFace, endX, endY);
+	Node endNode = Node(endFace, endX, endY);
+
+	Node &startNode = getState(startFace).node;
+	startNode = Node(startFace, startX, startY);
 
 	startNode.G = 0.f;
 	startNode.H = getHeuristic(startNode, endNode);
 	// Get track of the closest node near the end in case of the unavailable path.
-	Node closestToEnd = startNode;
+	uint32_t closestToEnd = startFace;
 
-	std::vector<Node> openList;
-	std::vector<Node> closedList;
-	openList.push_back(startNode);
+	pushOpen(startFace);
 
 	// Searching...
 	for (uint32_t it = 0; it < maxIteration; ++it) {
-		if (openList.empty())
+		if (_openHeap.empty())
 			break;
 
-		Node current = openList.front();
+		NodeState &currentState = _states[popOpen()];
+		currentState.closed = true;
+
+		// Copy, since adding new states below might move the state table
+		Node current = currentState.node;
 
 		if (current.face == endNode.face) {
-			reconstructPath(current, closedList, facePath);
+			reconstructPath(current, facePath);
 			return true;
 		}
 
-		openList.erase(openList.begin());
-		closedList.push_back(current);
+		_pathfinding->getAdjacentFaces(current.face, current.parent, _adjFaces);
+		for (std::vector<uint32_t>::const_iterator a = _adjFaces.begin(); a != _adjFaces.end(); ++a) {
+			NodeState &adjState = getState(*a);
 
-		std::vector<uint32_t> adjFaces;
-		_pathfinding->getAdjacentFaces(current.face, current.parent, adjFaces);
-		for (std::vector<uint32_t>::iterator a = adjFaces.begin(); a != adjFaces.end(); ++a) {
 			// Check if it has been already evaluated.
-			if (hasNode(*a, closedList))
+			if (adjState.closed)
 				continue;
 
 			// Check if the creature can go through to the adjacent face.
@@ -112,85 +122,160 @@ bool AStar::findPath(float startX, float startY, float endX, float endY,
 			float gScore = current.G + getGValue(current, *a, x, y);
 
 			// Check if it is a new node.
-			Node *adjNode = getNode(*a, openList);
-			bool isThere = adjNode != 0;
-			if (!isThere) {
-				adjNode = new Node(*a, x, y);
-				adjNode->parent = current.face;
-			} else if (gScore >= adjNode->G) {
+			const bool isThere = adjState.heapIndex != kNotInHeap;
+			if (isThere && (gScore >= adjState.node.G))
 				continue;
-			}
-
-			// adjNode is the best node up to now, update/add.
-			adjNode->parent = current.face;
-			adjNode->G = gScore;
-			adjNode->H = getHeuristic(*adjNode, endNode);
-			if (adjNode->H < closestToEnd.H)
-				closestToEnd = *adjNode;
-			if (!isThere) {
-				openList.push_back(*adjNode);
-				delete adjNode;
-			}
-
-			std::sort(openList.begin(), openList.end());
+
+			// adjState is the best node up to now, update/add.
+			Node &adjNode = adjState.node;
+			if (!isThere)
+				adjNode = Node(*a, x, y);
+
+			adjNode.parent = current.face;
+			adjNode.G = gScore;
+			adjNode.H = getHeuristic(adjNode, endNode);
+			if (adjNode.H < _states[closestToEnd].node.H)
+				closestToEnd = *a;
+
+			if (isThere)
+				siftUp(adjState.heapIndex);
+			else
+				pushOpen(*a);
 		}
 	}
 
-	reconstructPath(closestToEnd, closedList, facePath);
+	reconstructPath(_states[closestToEnd].node, facePath);
 	return false;
 }
 
-float AStar::getGValue(Node &previousNode, uint32_t face, float &x, float &y) const {
-	_pathfinding->getAdjacencyCenter(previousNode.face, face, x, y);
-	return getEuclideanDistance(previousNode.x,previousNode.y, x, y);
+void AStar::newGeneration() {
+	_openHeap.clear();
+
+	if (++_generation != 0)
+		return;
+
+	// The generation counter wrapped around. Really reset all states, once
+	for (std::vector<NodeState>::iterator s = _states.begin(); s != _states.end(); ++s)
+		s->generation = 0;
+
+	_generation = 1;
 }
 
-float AStar::getHeuristic(Node &node, Node &endNode) const {
-	// Naive estimation.
-	return getEuclideanDistance(node.x,node.y, endNode.x,endNode.y);
+AStar::NodeState &AStar::getState(uint32_t face) {
+	if (face >= _states.size())
+		_states.resize(face + 1);
+
+	NodeState &state = _states[face];
+	if (state.generation != _generation) {
+		state.generation = _generation;
+		state.heapIndex  = kNotInHeap;
+		state.closed     = false;
+	}
+
+	return state;
 }
 
-AStar::Node *AStar::getNode(uint32_t face, std::vector<Node> &nodes) const {
-	for (std::vector<Node>::iterator n = nodes.begin(); n != nodes.end(); ++n) {
-		if ((*n).face == face) {
-			return &(*n);
-		}
+bool AStar::isBetter(uint32_t a, uint32_t b) const {
+	const Node &nodeA = _states[a].node;
+	const Node &nodeB = _states[b].node;
+
+	const float fA = nodeA.G + nodeA.H;
+	const float fB = nodeB.G + nodeB.H;
+	if (fA != fB)
+		return fA < fB;
+
+	// On ties, prefer the node closer to the end
+	return nodeA.H < nodeB.H;
+}
+
+void AStar::pushOpen(uint32_t face) {
+	_states[face].heapIndex = _openHeap.size();
+	_openHeap.push_back(face);
+
+	siftUp(_openHeap.size() - 1);
+}
+
+uint32_t AStar::popOpen() {
+	const uint32_t face = _openHeap.front();
+	_states[face].heapIndex = kNotInHeap;
+
+	const uint32_t last = _openHeap.back();
+	_openHeap.pop_back();
+
+	if (!_openHeap.empty()) {
+		_openHeap[0] = last;
+		_states[last].heapIndex = 0;
+
+		siftDown(0);
 	}
 
-	return 0;
+	return face;
 }
 
-bool AStar::hasNode(uint32_t face, std::vector<Node> &nodes) const {
-	for (std::vector<Node>::iterator n = nodes.begin(); n != nodes.end(); ++n) {
-		if ((*n).face == face) {
-			return true;
-		}
+void AStar::siftUp(uint32_t index) {
+	const uint32_t face = _openHeap[index];
+
+	while (index > 0) {
+		const uint32_t parent = (index - 1) / 2;
+		if (!isBetter(face, _openHeap[parent]))
+			break;
+
+		_openHeap[index] = _openHeap[parent];
+		_states[_openHeap[index]].heapIndex = index;
+
+		index = parent;
 	}
 
-	return false;
+	_openHeap[index] = face;
+	_states[face].heapIndex = index;
+}
+
+void AStar::siftDown(uint32_t index) {
+	const uint32_t face = _openHeap[index];
+	const uint32_t size = _openHeap.size();
+
+	while (true) {
+		uint32_t child = 2 * index + 1;
+		if (child >= size)
+			break;
+
+		if (((child + 1) < size) && isBetter(_openHeap[child + 1], _openHeap[child]))
+			child++;
+
+		if (!isBetter(_openHeap[child], face))
+			break;
+
+		_openHeap[index] = _openHeap[child];
+		_states[_openHeap[index]].heapIndex = index;
+
+		index = child;
+	}
+
+	_openHeap[index] = face;
+	_states[face].heapIndex = index;
+}
+
+float AStar::getGValue(Node &previousNode, uint32_t face, float &x, float &y) const {
+	_pathfinding->getAdjacencyCenter(previousNode.face, face, x, y);
+	return getEuclideanDistance(previousNode.x,previousNode.y, x, y);
+}
+
+float AStar::getHeuristic(Node &node, Node &endNode) const {
+	// Naive estimation.
+	return getEuclideanDistance(node.x,node.y, endNode.x,endNode.y);
 }
 
 float AStar::getEuclideanDistance(float xA, float yA, float xB, float yB) const {
 	return sqrt(pow(xA - xB, 2.f) + pow(yA - yB, 2.f));
 }
 
-void AStar::reconstructPath(Node &endNode, std::vector<Node> &closedList, std::vector<uint32_t> &path) {
-	Node &cNode = endNode;
+void AStar::reconstructPath(const Node &endNode, std::vector<uint32_t> &path) {
 	path.push_back(endNode.face);
-	path.push_back(endNode.parent);
-
-	while (cNode.parent != UINT32_MAX) {
-		for (std::vector<Node>::iterator n = closedList.begin(); n != closedList.end(); ++n) {
-			if (cNode.parent != (*n).face)
-				continue;
 
-			cNode = (*n);
-			if (cNode.parent != UINT32_MAX)
-				path.push_back(cNode.parent);
+	// All faces on the path were visited in this query, so their parents are still valid
+	for (uint32_t face = endNode.parent; face != UINT32_MAX; face = _states[face].node.parent)
+		path.push_back(face);
 
-			break;
-		}
-	}
 	std::reverse(path.begin(), path.end());
 }
 
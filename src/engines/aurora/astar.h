@@ -93,16 +93,50 @@ protected:
 	/** Compute the euclidean distance (usual distance) between two points in th XY plan. */
 	float getEuclideanDistance(float xA, float yA, float xB, float yB) const;
 
-	/** Find a node in a vector of nodes. */
-	Node *getNode(uint32_t face, std::vector<Node> &nodes) const;
-	/** Check if a vector of nodes contains a specific node. */
-	bool hasNode(uint32_t face, std::vector<Node> &nodes) const;
-
 	Pathfinding *_pathfinding; ///< Pathfinding object that contains the walkmesh.
 
 private:
-	/** Reconstruct the path of faces from the closed list and the end node. */
-	void reconstructPath(Node &endNode, std::vector<Node> &closedList, std::vector<uint32_t> &path);
+	static const uint32_t kNotInHeap = UINT32_MAX; ///< Marks a node that's not in the open heap.
+
+	/** The search state of a face.
+	 *
+	 *  The states are indexed by face and kept between queries. A state only
+	 *  belongs to the current query if its generation matches; all others count
+	 *  as unvisited. That way, we never need to clear the table.
+	 */
+	struct NodeState {
+		uint32_t generation; ///< The query that last visited this face.
+		uint32_t heapIndex;  ///< Position in the open heap, or kNotInHeap.
+		bool closed;         ///< Has the node been fully evaluated?
+
+		Node node;
+
+		NodeState();
+	};
+
+	std::vector<NodeState> _states; ///< The search states of all faces, indexed by face.
+	uint32_t _generation;           ///< The generation of the current query.
+
+	/** The open list, as a binary min-heap of faces ordered by G + H. */
+	std::vector<uint32_t> _openHeap;
+
+	std::vector<uint32_t> _adjFaces; ///< Scratch buffer for adjacent faces.
+
+	/** Start a new query, invalidating all node states. */
+	void newGeneration();
+	/** Return the state of a face, resetting it if it belongs to an older query. */
+	NodeState &getState(uint32_t face);
+
+	/** Is the node of face a better candidate for evaluation than the node of face b? */
+	bool isBetter(uint32_t a, uint32_t b) const;
+
+	void pushOpen(uint32_t face);
+	uint32_t popOpen();
+	void siftUp(uint32_t index);
+	void siftDown(uint32_t index);
+
+	/** Reconstruct the path of faces by following the parents from the end node. */
+	void reconstructPath(const Node &endNode, std::vector<uint32_t> &path);
 };
 
 } // End of namespace Engines
@@ -37,8 +37,12 @@
 #include "src/common/readline.h"
 #include "src/common/configman.h"
 
+#include "src/aurora/util.h"
 #include "src/aurora/resman.h"
 #include "src/aurora/talkman.h"
+#include "src/aurora/2dareg.h"
+
+#include "src/aurora/nwscript/scheduler.h"
 
 #include "src/graphics/graphics.h"
 #include "src/graphics/font.h"
@@ -63,6 +67,7 @@
 #include "src/graphics/mesh/meshman.h"
 #include "src/graphics/shader/surfaceman.h"
 #include "src/graphics/shader/materialman.h"
+#include "src/graphics/render/renderman.h"
 
 
 static const uint32_t kDoubleClickTime = 500;
@@ -816,6 +821,19 @@ Console::Console(Engine &engine, const Common::UString &font, int fontHeight) :
 	registerCommand("setcamera"  , std::bind(&Console::cmdSetCamera  , this, std::placeholders::_1),
 			"Usage: setcamera <posX> <posY> <posZ> [<orientX> <orientY> <orientZ>]\n"
 			"Set the camera position (and orientation)");
+	registerCommand("culling"    , std::bind(&Console::cmdCulling    , this, std::placeholders::_1),
+			"Usage: culling [<true/false>]\nEnable/Disable frustum culling of world objects and\n"
+			"print how many were drawn and culled in the last frame");
+	registerCommand("texdecode"  , std::bind(&Console::cmdTexDecode  , this, std::placeholders::_1),
+			"Usage: texdecode\nPrint statistics of the background texture decoding");
+	registerCommand("scriptqueue", std::bind(&Console::cmdScriptQueue, this, std::placeholders::_1),
+			"Usage: scriptqueue [reset]\nPrint statistics of the delayed scripts, or reset them");
+	registerCommand("animstats"  , std::bind(&Console::cmdAnimStats  , this, std::placeholders::_1),
+			"Usage: animstats\nPrint statistics of the animation thread");
+	registerCommand("renderstats", std::bind(&Console::cmdRenderStats, this, std::placeholders::_1),
+			"Usage: renderstats\nPrint the draw calls and instancing batches of the last frame");
+	registerCommand("twodastats" , std::bind(&Console::cmdTwoDAStats , this, std::placeholders::_1),
+			"Usage: twodastats\nPrint the load times and sizes of all loaded 2DAs and GDAs");
 
 	_console->print("Console ready...");
 }
@@ -1520,6 +1538,107 @@ void Console::cmdSetCamera(const CommandLine &cl) {
 	CameraMan.update();
 }
 
+void Console::cmdCulling(const CommandLine &cl) {
+	if (!cl.args.empty()) {
+		bool enabled = true;
+		try {
+			Common::parseString(cl.args, enabled);
+		} catch (...) {
+			printCommandHelp(cl.cmd);
+			return;
+		}
+
+		GfxMan.setFrustumCulling(enabled);
+	}
+
+	uint32_t drawn = 0, culled = 0;
+	GfxMan.getWorldObjectCount(drawn, culled);
+
+	printf("Frustum culling %s", GfxMan.getFrustumCulling() ? "enabled" : "disabled");
+	printf("World objects drawn: %u, culled: %u", drawn, culled);
+}
+
+void Console::cmdTexDecode(const CommandLine &UNUSED(cl)) {
+	const Graphics::Aurora::TextureManager::DecodeStats stats = TextureMan.getDecodeStats();
+
+	printf("Decoding threads: %u", (uint) stats.workers);
+	printf("Queue depth: %u (max %u)", (uint) stats.queueDepth, (uint) stats.maxQueueDepth);
+
+	for (std::map<::Aurora::FileType, Graphics::Aurora::TextureManager::DecodeFormatStats>::const_iterator f =
+	     stats.formats.begin(); f != stats.formats.end(); ++f) {
+
+		const Common::UString format = TypeMan.addFileType("", f->first);
+		const size_t decoded = f->second.count + f->second.failed;
+
+		printf("%s: %u decoded, %u failed, %.3f ms total, %.3f ms average", format.c_str(),
+		       (uint) f->second.count, (uint) f->second.failed, f->second.time * 1000.0,
+		       (decoded > 0) ? (f->second.time * 1000.0 / decoded) : 0.0);
+	}
+}
+
+void Console::cmdScriptQueue(const CommandLine &cl) {
+	if (cl.args == "reset") {
+		ScriptSched.resetStats();
+		return;
+	}
+
+	const Aurora::NWScript::ScriptScheduler::Stats stats = ScriptSched.getStats();
+
+	printf("Queue depth: %u (max %u)", (uint) stats.queueDepth, (uint) stats.maxQueueDepth);
+	printf("Scheduled: %u, fired: %u", (uint) stats.scheduled, (uint) stats.fired);
+	printf("Batches: %u (max %u scripts)", (uint) stats.batches, (uint) stats.maxBatchSize);
+	printf("Latency to fire: %.3f ms average, %u ms max",
+	       (stats.fired > 0) ? ((double) stats.totalLatency / stats.fired) : 0.0, (uint) stats.maxLatency);
+}
+
+void Console::cmdAnimStats(const CommandLine &UNUSED(cl)) {
+	const Graphics::Aurora::AnimationThread::Stats stats = GfxMan.getAnimationStats();
+
+	printf("Animation threads: %u", (uint) stats.workers);
+	printf("Passes: %u, models updated: %u (%u in the last pass)", (uint) stats.passes,
+	       (uint) stats.modelsUpdated, (uint) stats.lastModelsUpdated);
+	printf("Pass time: %.3f ms last, %.3f ms average, %.3f ms max", stats.lastPassTime * 1000.0,
+	       (stats.passes > 0) ? (stats.totalPassTime * 1000.0 / stats.passes) : 0.0, stats.maxPassTime * 1000.0);
+}
+
+void Console::cmdRenderStats(const CommandLine &UNUSED(cl)) {
+	const Graphics::Render::RenderQueue::Stats &stats = RenderMan.getStats();
+
+	printf("Objects: %u, draw calls: %u", (uint) stats.objects, (uint) stats.drawCalls);
+	printf("Instanced: %u objects in %u draw calls (%.2f average, %u max)", (uint) stats.instancedObjects,
+	       (uint) stats.instancedDrawCalls,
+	       (stats.instancedDrawCalls > 0) ? ((double) stats.instancedObjects / stats.instancedDrawCalls) : 0.0,
+	       (uint) stats.maxBatchSize);
+}
+
+void Console::cmdTwoDAStats(const CommandLine &UNUSED(cl)) {
+	const Aurora::TwoDARegistry::Stats stats = TwoDAReg.getStats();
+
+	printf("Warmups: %u, %.3f ms total, %u threads last, %u tables failed", (uint) stats.warmups,
+	       stats.warmupTime * 1000.0, (uint) stats.workers, (uint) stats.failed);
+
+	for (int i = 0; i < 2; i++) {
+		const std::map<Common::UString, Aurora::TwoDARegistry::TableStats> &tables = (i == 0) ? stats.twodas : stats.gdas;
+
+		size_t size = 0;
+		double time = 0.0;
+
+		for (std::map<Common::UString, Aurora::TwoDARegistry::TableStats>::const_iterator t = tables.begin();
+		     t != tables.end(); ++t) {
+
+			printf("%s.%s: %u rows, %u columns, %u bytes, %.3f ms%s", t->first.c_str(), (i == 0) ? "2da" : "gda",
+			       (uint) t->second.rows, (uint) t->second.columns, (uint) t->second.size,
+			       t->second.time * 1000.0, t->second.warmup ? " (warmup)" : "");
+
+			size += t->second.size;
+			time += t->second.time;
+		}
+
+		printf("%u %s: %u bytes, %.3f ms total", (uint) tables.size(), (i == 0) ? "2DAs" : "GDAs",
+		       (uint) size, time * 1000.0);
+	}
+}
+
 void Console::printFullHelp() {
 	print("Available commands (help <command> for further help on each command):");
 
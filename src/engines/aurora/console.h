@@ -315,6 +315,12 @@ private:
 	void cmdGetString  (const CommandLine &cl);
 	void cmdGetCamera  (const CommandLine &cl);
 	void cmdSetCamera  (const CommandLine &cl);
+	void cmdCulling    (const CommandLine &cl);
+	void cmdTexDecode  (const CommandLine &cl);
+	void cmdScriptQueue(const CommandLine &cl);
+	void cmdAnimStats  (const CommandLine &cl);
+	void cmdRenderStats(const CommandLine &cl);
+	void cmdTwoDAStats (const CommandLine &cl);
 
 	void updateHelpArguments();
 
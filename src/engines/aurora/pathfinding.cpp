@@ -381,7 +381,23 @@ float Pathfinding::getHeight(float x, float y, bool onlyWalkable) const {
 	return FLT_MIN;
 }
 
+void Pathfinding::buildBVH() {
+	_bvh.build(_aabbTrees);
+}
+
 uint32_t Pathfinding::findFace(float x, float y, bool onlyWalkable) {
+	if (!_bvh.empty()) {
+		const glm::vec3 point(x, y, 0.f);
+
+		return _bvh.findPoint(x, y, [this, &point, onlyWalkable](uint32_t face) {
+			// Check walkability
+			if (onlyWalkable && !faceWalkable(face))
+				return false;
+
+			return inFace(face, point);
+		});
+	}
+
 	for (std::vector<Common::AABBNode *>::iterator it = _aabbTrees.begin(); it != _aabbTrees.end(); ++it) {
 		if (*it == 0)
 			continue;
@@ -409,6 +425,26 @@ uint32_t Pathfinding::findFace(float x, float y, bool onlyWalkable) {
 
 bool Pathfinding::findIntersection(float x1, float y1, float z1, float x2, float y2, float z2,
                                    glm::vec3 &intersect, bool onlyWalkable) const {
+	if (!_bvh.empty()) {
+		const glm::vec3 start(x1, y1, z1);
+		const glm::vec3 end(x2, y2, z2);
+
+		const uint32_t face = _bvh.findSegment(x1, y1, z1, x2, y2, z2,
+		                                       [this, &start, &end, &intersect, onlyWalkable](uint32_t f) {
+			glm::vec3 faceIntersect;
+			if (!inFace(f, start, end, faceIntersect))
+				return false;
+
+			if (onlyWalkable && !faceWalkable(f))
+				return false;
+
+			intersect = faceIntersect;
+			return true;
+		});
+
+		return face != UINT32_MAX;
+	}
+
 	for (size_t it = 0; it < _aabbTrees.size(); ++it) {
 		if (_aabbTrees[it] == 0)
 			continue;
@@ -523,12 +559,19 @@ bool Pathfinding::close(glm::vec3 &pointA, glm::vec3 &pointB) const {
 	return glm::distance(pointA, pointB) < _epsilon;
 }
 
+void Pathfinding::getFaceVertices(uint32_t faceID, glm::vec3 (&vertices)[4], bool xyPlane) const {
+	const uint32_t count = MIN<uint32_t>(_polygonEdges, 4);
+
+	for (uint32_t v = 0; v < count; ++v)
+		getVertex(_faces[faceID * _polygonEdges + v], vertices[v], xyPlane);
+}
+
 bool Pathfinding::inFace(uint32_t faceID, glm::vec3 point) const {
 	// Ensure we are in the XY plane.
 	point[2] = 0.f;
 
-	std::vector<glm::vec3> vertices;
-	getVertices(faceID, vertices);
+	glm::vec3 vertices[4];
+	getFaceVertices(faceID, vertices, true);
 
 	if (_polygonEdges == 3) {
 		return Common::intersectTrianglePoint2D(point, vertices[0], vertices[1], vertices[2]);
@@ -544,8 +587,8 @@ bool Pathfinding::inFace(uint32_t faceID, glm::vec3 point) const {
 }
 
 bool Pathfinding::inFace(uint32_t faceID, glm::vec3 lineStart, glm::vec3 lineEnd, glm::vec3 &intersect) const {
-	std::vector<glm::vec3> vertices;
-	getVertices(faceID, vertices, false);
+	glm::vec3 vertices[4];
+	getFaceVertices(faceID, vertices, false);
 
 	glm::vec3 direction = glm::normalize(lineEnd - lineStart);
 	glm::vec2 baryPosition;
@@ -28,6 +28,7 @@
 #include "external/glm/vec3.hpp"
 
 #include "src/common/ustring.h"
+#include "src/common/linearbvh.h"
 
 #include "src/graphics/renderable.h"
 
@@ -124,6 +125,12 @@ protected:
 	virtual void findCenter(std::vector<glm::vec3> &vertices, float &centerX, float &centerY) const;
 	/** Are two points close? Use the _epsilon value to evaluate the proximity.*/
 	bool close(glm::vec3 &pointA, glm::vec3 &pointB) const;
+	/** Build the flattened hierarchy over all faces in the AABB trees.
+	 *
+	 *  Must be called again whenever the AABB trees change. Until then,
+	 *  findFace() and findIntersection() walk the AABB trees one by one.
+	 */
+	void buildBVH();
 
 	uint32_t _polygonEdges;  ///< The number of edge a walkmesh face has.
 	uint32_t _verticesCount; ///< The total number of vertices in the walkmesh.
@@ -137,10 +144,13 @@ protected:
 	std::vector<uint32_t> _faceProperty; ///< The property of each faces. Usually used to state the walkability.
 
 	std::vector<Common::AABBNode *> _aabbTrees; ///< The set of AABB trees in the walkmesh.
+	Common::LinearBVH _bvh; ///< All faces of the AABB trees in one flattened hierarchy.
 	bool _pathVisible;
 	bool _walkmeshVisible;
 
 private:
+	/** Get the vertices of a face, without allocating memory. Only the first 4 are returned. */
+	void getFaceVertices(uint32_t faceID, glm::vec3 (&vertices)[4], bool xyPlane) const;
 	/** Is a point in a specific face? */
 	bool inFace(uint32_t faceID, glm::vec3 point) const;
 	/** Is a line in a specific face? */
@@ -38,6 +38,7 @@ src_engines_aurora_libaurora_la_SOURCES += \
     src/engines/aurora/astar.h \
     src/engines/aurora/localpathfinding.h \
     src/engines/aurora/objectwalkmesh.h \
+    src/engines/aurora/spatialindex.h \
     $(EMPTY)
 
 src_engines_aurora_libaurora_la_SOURCES += \
@@ -55,4 +56,5 @@ src_engines_aurora_libaurora_la_SOURCES += \
     src/engines/aurora/pathfinding.cpp \
     src/engines/aurora/astar.cpp \
     src/engines/aurora/localpathfinding.cpp \
+    src/engines/aurora/spatialindex.cpp \
     $(EMPTY)
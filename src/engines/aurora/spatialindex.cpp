@@ -0,0 +1,357 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A uniform grid indexing the objects within an area by position.
+ */
+
+#include <cassert>
+#include <cmath>
+
+#include <algorithm>
+
+#include "src/engines/aurora/spatialindex.h"
+
+namespace Engines {
+
+/** Cell coordinates are clamped to this, so that ring arithmetic can't overflow. */
+static const int32_t kMaxCellCoord = 1 << 28;
+
+bool SpatialIndex::Nearest::operator<(const Nearest &n) const {
+	if (distance != n.distance)
+		return distance < n.distance;
+
+	return order < n.order;
+}
+
+
+SpatialIndex::SpatialIndex(float cellSize) : _cellSize(cellSize), _nextOrder(0) {
+	assert(_cellSize > 0.0f);
+
+	clear();
+}
+
+SpatialIndex::~SpatialIndex() {
+}
+
+void SpatialIndex::clear() {
+	_entries.clear();
+	_freeList.clear();
+	_entryMap.clear();
+
+	_points.clear();
+	_regions.clear();
+	_largeRegions.clear();
+
+	_minCellX = _minCellY = INT32_MAX;
+	_maxCellX = _maxCellY = INT32_MIN;
+}
+
+size_t SpatialIndex::size() const {
+	return _entryMap.size();
+}
+
+bool SpatialIndex::has(const Aurora::NWScript::Object &object) const {
+	return _entryMap.find(&object) != _entryMap.end();
+}
+
+int32_t SpatialIndex::getCellCoord(float v) const {
+	const float c = std::floor(v / _cellSize);
+
+	if (!(c >= -kMaxCellCoord))
+		return -kMaxCellCoord;
+	if (c >= kMaxCellCoord)
+		return kMaxCellCoord;
+
+	return (int32_t) c;
+}
+
+uint64_t SpatialIndex::getCellKey(int32_t x, int32_t y) {
+	return (((uint64_t) (uint32_t) x) << 32) | ((uint64_t) (uint32_t) y);
+}
+
+const SpatialIndex::Cell *SpatialIndex::getPointCell(int32_t x, int32_t y) const {
+	CellMap::const_iterator cell = _points.find(getCellKey(x, y));
+	if (cell == _points.end())
+		return 0;
+
+	return &cell->second;
+}
+
+float SpatialIndex::getRingDistance(float x, float y, int32_t cX, int32_t cY, int32_t ring) const {
+	if (ring == 0)
+		return 0.0f;
+
+	/* Every cell of the ring lies at least ring cells away from (cX, cY) in
+	 * either x or y. The distance to the nearest of the four inner edges of
+	 * the ring is therefore a lower bound for all positions within it. */
+
+	const float left   = x - (cX - ring + 1) * _cellSize;
+	const float right  = (cX + ring) * _cellSize - x;
+	const float bottom = y - (cY - ring + 1) * _cellSize;
+	const float top    = (cY + ring) * _cellSize - y;
+
+	return MAX(MIN(MIN(left, right), MIN(bottom, top)), 0.0f);
+}
+
+uint32_t SpatialIndex::addEntry(Aurora::NWScript::Object &object, uint32_t type, float x, float y, float z) {
+	remove(object);
+
+	uint32_t index;
+	if (!_freeList.empty()) {
+		index = _freeList.back();
+		_freeList.pop_back();
+	} else {
+		index = _entries.size();
+		_entries.emplace_back();
+	}
+
+	Entry &entry = _entries[index];
+
+	entry.object = &object;
+	entry.type   = type;
+	entry.order  = _nextOrder++;
+
+	entry.x = x;
+	entry.y = y;
+	entry.z = z;
+
+	entry.isRegion = false;
+	entry.isLarge  = false;
+
+	entry.minX = entry.maxX = x;
+	entry.minY = entry.maxY = y;
+
+	_entryMap[&object] = index;
+
+	return index;
+}
+
+void SpatialIndex::add(Aurora::NWScript::Object &object, uint32_t type, float x, float y, float z) {
+	const uint32_t index = addEntry(object, type, x, y, z);
+
+	insertPoint(index);
+}
+
+void SpatialIndex::addRegion(Aurora::NWScript::Object &object, uint32_t type, float x, float y, float z,
+                             float minX, float minY, float maxX, float maxY) {
+
+	const uint32_t index = addEntry(object, type, x, y, z);
+
+	Entry &entry = _entries[index];
+
+	entry.isRegion = true;
+
+	entry.minX = MIN(minX, maxX);
+	entry.minY = MIN(minY, maxY);
+	entry.maxX = MAX(minX, maxX);
+	entry.maxY = MAX(minY, maxY);
+
+	insertPoint(index);
+	insertRegion(index);
+}
+
+void SpatialIndex::move(const Aurora::NWScript::Object &object, float x, float y, float z) {
+	EntryMap::const_iterator e = _entryMap.find(&object);
+	if (e == _entryMap.end())
+		return;
+
+	const uint32_t index = e->second;
+	Entry &entry = _entries[index];
+
+	const bool movedCell = (getCellCoord(x) != getCellCoord(entry.x)) ||
+	                       (getCellCoord(y) != getCellCoord(entry.y));
+
+	if (movedCell)
+		removePoint(index);
+
+	if (entry.isRegion && ((x != entry.x) || (y != entry.y))) {
+		removeRegion(index);
+
+		entry.minX += x - entry.x;
+		entry.maxX += x - entry.x;
+		entry.minY += y - entry.y;
+		entry.maxY += y - entry.y;
+
+		entry.x = x;
+		entry.y = y;
+
+		insertRegion(index);
+	}
+
+	entry.x = x;
+	entry.y = y;
+	entry.z = z;
+
+	if (movedCell)
+		insertPoint(index);
+}
+
+void SpatialIndex::remove(const Aurora::NWScript::Object &object) {
+	EntryMap::iterator e = _entryMap.find(&object);
+	if (e == _entryMap.end())
+		return;
+
+	const uint32_t index = e->second;
+
+	removePoint(index);
+	if (_entries[index].isRegion)
+		removeRegion(index);
+
+	_entries[index].object = 0;
+
+	_entryMap.erase(e);
+	_freeList.push_back(index);
+}
+
+void SpatialIndex::insertPoint(uint32_t index) {
+	const Entry &entry = _entries[index];
+
+	const int32_t cellX = getCellCoord(entry.x);
+	const int32_t cellY = getCellCoord(entry.y);
+
+	Cell &cell = _points[getCellKey(cellX, cellY)];
+
+	cell.types |= entry.type;
+	cell.entries.push_back(index);
+
+	_minCellX = MIN(_minCellX, cellX);
+	_minCellY = MIN(_minCellY, cellY);
+	_maxCellX = MAX(_maxCellX, cellX);
+	_maxCellY = MAX(_maxCellY, cellY);
+}
+
+void SpatialIndex::removePoint(uint32_t index) {
+	const Entry &entry = _entries[index];
+
+	removeFromCell(_points, getCellKey(getCellCoord(entry.x), getCellCoord(entry.y)), index, _entries);
+}
+
+void SpatialIndex::insertRegion(uint32_t index) {
+	Entry &entry = _entries[index];
+
+	const int32_t minX = getCellCoord(entry.minX);
+	const int32_t minY = getCellCoord(entry.minY);
+	const int32_t maxX = getCellCoord(entry.maxX);
+	const int32_t maxY = getCellCoord(entry.maxY);
+
+	const uint64_t cellCount = ((uint64_t) (maxX - minX + 1)) * ((uint64_t) (maxY - minY + 1));
+
+	entry.isLarge = cellCount > kMaxRegionCells;
+	if (entry.isLarge) {
+		_largeRegions.push_back(index);
+		return;
+	}
+
+	for (int32_t y = minY; y <= maxY; y++) {
+		for (int32_t x = minX; x <= maxX; x++) {
+			Cell &cell = _regions[getCellKey(x, y)];
+
+			cell.types |= entry.type;
+			cell.entries.push_back(index);
+		}
+	}
+}
+
+void SpatialIndex::removeRegion(uint32_t index) {
+	const Entry &entry = _entries[index];
+
+	if (entry.isLarge) {
+		_largeRegions.erase(std::remove(_largeRegions.begin(), _largeRegions.end(), index), _largeRegions.end());
+		return;
+	}
+
+	const int32_t minX = getCellCoord(entry.minX);
+	const int32_t minY = getCellCoord(entry.minY);
+	const int32_t maxX = getCellCoord(entry.maxX);
+	const int32_t maxY = getCellCoord(entry.maxY);
+
+	for (int32_t y = minY; y <= maxY; y++)
+		for (int32_t x = minX; x <= maxX; x++)
+			removeFromCell(_regions, getCellKey(x, y), index, _entries);
+}
+
+void SpatialIndex::removeFromCell(CellMap &cells, uint64_t key, uint32_t index,
+                                  const std::vector<Entry> &entries) {
+
+	CellMap::iterator c = cells.find(key);
+	if (c == cells.end())
+		return;
+
+	Cell &cell = c->second;
+
+	std::vector<uint32_t>::iterator e = std::find(cell.entries.begin(), cell.entries.end(), index);
+	if (e == cell.entries.end())
+		return;
+
+	*e = cell.entries.back();
+	cell.entries.pop_back();
+
+	if (cell.entries.empty()) {
+		cells.erase(c);
+		return;
+	}
+
+	cell.types = 0;
+	for (uint32_t i : cell.entries)
+		cell.types |= entries[i].type;
+}
+
+void SpatialIndex::findRegions(float x, float y, uint32_t types,
+                               std::vector<Aurora::NWScript::Object *> &regions) const {
+
+	regions.clear();
+
+	std::vector<std::pair<uint32_t, Aurora::NWScript::Object *>> found;
+
+	auto test = [&](uint32_t index) {
+		const Entry &entry = _entries[index];
+
+		if (!(entry.type & types))
+			return;
+
+		if ((x < entry.minX) || (x > entry.maxX) || (y < entry.minY) || (y > entry.maxY))
+			return;
+
+		found.push_back(std::make_pair(entry.order, entry.object));
+	};
+
+	CellMap::const_iterator cell = _regions.find(getCellKey(getCellCoord(x), getCellCoord(y)));
+	if ((cell != _regions.end()) && (cell->second.types & types))
+		for (uint32_t index : cell->second.entries)
+			test(index);
+
+	for (uint32_t index : _largeRegions)
+		test(index);
+
+	std::sort(found.begin(), found.end());
+
+	regions.reserve(found.size());
+	for (const auto &f : found)
+		regions.push_back(f.second);
+}
+
+void SpatialIndex::findNearest(float x, float y, float z, uint32_t types, size_t count,
+                               std::vector<Aurora::NWScript::Object *> &objects, float radius) const {
+
+	findNearest(x, y, z, types, count, radius, objects, [](Aurora::NWScript::Object *) { return true; });
+}
+
+} // End of namespace Engines
@@ -0,0 +1,296 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A uniform grid indexing the objects within an area by position.
+ */
+
+#ifndef ENGINES_AURORA_SPATIALINDEX_H
+#define ENGINES_AURORA_SPATIALINDEX_H
+
+#include <limits>
+#include <utility>
+#include <vector>
+#include <unordered_map>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+
+namespace Aurora {
+	namespace NWScript {
+		class Object;
+	}
+}
+
+namespace Engines {
+
+/** A uniform grid over the ground plane of an area, indexing the objects within.
+ *
+ *  Each object is stored with its position and its object type bit. A region,
+ *  like a trigger, additionally covers a rectangle on the ground. The grid then
+ *  answers which regions contain a point, and which objects are nearest to a
+ *  point, without looking at every object in the area.
+ *
+ *  Only the x and y coordinates decide where in the grid an object goes.
+ *  Distances, however, are measured in all three dimensions.
+ *
+ *  The index does not own the objects. Whoever adds an object has to remove
+ *  it again, or clear the index, before the object is destroyed.
+ */
+class SpatialIndex : boost::noncopyable {
+public:
+	static const uint32_t kTypeAll = 0xFFFFFFFF; ///< Type mask matching every object.
+
+	SpatialIndex(float cellSize = 10.0f);
+	~SpatialIndex();
+
+	/** Remove all objects. */
+	void clear();
+
+	/** Return the number of objects in the index. */
+	size_t size() const;
+	/** Is this object in the index? */
+	bool has(const Aurora::NWScript::Object &object) const;
+
+	/** Add an object at this position. If it's already in the index, it's moved there. */
+	void add(Aurora::NWScript::Object &object, uint32_t type, float x, float y, float z);
+	/** Add a region at this position, covering this rectangle on the ground. */
+	void addRegion(Aurora::NWScript::Object &object, uint32_t type, float x, float y, float z,
+	               float minX, float minY, float maxX, float maxY);
+
+	/** Move an object to a new position. A region's rectangle moves along with it.
+	 *
+	 *  Objects that aren't in the index are ignored.
+	 */
+	void move(const Aurora::NWScript::Object &object, float x, float y, float z);
+
+	/** Remove an object. Objects that aren't in the index are ignored. */
+	void remove(const Aurora::NWScript::Object &object);
+
+	/** Find all regions of these types whose rectangle contains this point.
+	 *
+	 *  The regions are returned in the order they were added.
+	 */
+	void findRegions(float x, float y, uint32_t types,
+	                 std::vector<Aurora::NWScript::Object *> &regions) const;
+
+	/** Find the objects of these types nearest to this point.
+	 *
+	 *  Returns, ordered by distance, up to count objects that are no further
+	 *  away from the point than radius, and for which the filter returns true.
+	 *  Objects with the same distance are ordered by when they were added.
+	 */
+	template<typename Filter>
+	void findNearest(float x, float y, float z, uint32_t types, size_t count, float radius,
+	                 std::vector<Aurora::NWScript::Object *> &objects, Filter filter) const;
+
+	/** Find the objects of these types nearest to this point. */
+	void findNearest(float x, float y, float z, uint32_t types, size_t count,
+	                 std::vector<Aurora::NWScript::Object *> &objects,
+	                 float radius = std::numeric_limits<float>::infinity()) const;
+
+private:
+	/** Regions covering more cells than this are kept out of the grid. */
+	static const size_t kMaxRegionCells = 256;
+
+	struct Entry {
+		Aurora::NWScript::Object *object;
+
+		uint32_t type;  ///< The object type bit.
+		uint32_t order; ///< When the object was added, to keep results stable.
+
+		float x, y, z; ///< The object's position.
+
+		bool isRegion; ///< Does the object cover a rectangle?
+		bool isLarge;  ///< Is the region kept out of the grid?
+
+		float minX, minY, maxX, maxY; ///< The rectangle a region covers.
+	};
+
+	/** A cell of the grid, holding entry indices. */
+	struct Cell {
+		uint32_t types; ///< All types found in this cell.
+
+		std::vector<uint32_t> entries;
+
+		Cell() : types(0) { }
+	};
+
+	/** A candidate in a nearest object search. */
+	struct Nearest {
+		float distance; ///< Squared distance to the search point.
+		uint32_t order;
+		Aurora::NWScript::Object *object;
+
+		bool operator<(const Nearest &n) const;
+	};
+
+	typedef std::unordered_map<uint64_t, Cell> CellMap;
+	typedef std::unordered_map<const Aurora::NWScript::Object *, uint32_t> EntryMap;
+
+	float _cellSize;
+
+	std::vector<Entry> _entries;     ///< All entries, indexed by their entry index.
+	std::vector<uint32_t> _freeList; ///< Indices of unused entries.
+
+	EntryMap _entryMap; ///< The entry index of each object.
+
+	CellMap _points;  ///< Entries, by the cell of their position.
+	CellMap _regions; ///< Region entries, by all cells their rectangle overlaps.
+
+	std::vector<uint32_t> _largeRegions; ///< Regions too large to put into the grid.
+
+	uint32_t _nextOrder;
+
+	/** The range of cells that ever held a position, to stop nearest searches. */
+	int32_t _minCellX, _minCellY, _maxCellX, _maxCellY;
+
+	int32_t getCellCoord(float v) const;
+	static uint64_t getCellKey(int32_t x, int32_t y);
+
+	/** Return the cell holding the positions at these cell coordinates, or 0. */
+	const Cell *getPointCell(int32_t x, int32_t y) const;
+
+	/** Return the smallest horizontal distance from a point in cell (cX, cY) to the ring of cells. */
+	float getRingDistance(float x, float y, int32_t cX, int32_t cY, int32_t ring) const;
+
+	uint32_t addEntry(Aurora::NWScript::Object &object, uint32_t type, float x, float y, float z);
+
+	void insertPoint(uint32_t index);
+	void removePoint(uint32_t index);
+	void insertRegion(uint32_t index);
+	void removeRegion(uint32_t index);
+
+	static void removeFromCell(CellMap &cells, uint64_t key, uint32_t index,
+	                           const std::vector<Entry> &entries);
+
+	/** Consider an entry as a candidate for a nearest object search. */
+	template<typename Filter>
+	void addNearest(const Entry &entry, float x, float y, float z, float radius2, size_t count,
+	                std::vector<Nearest> &nearest, Filter &filter) const;
+};
+
+template<typename Filter>
+void SpatialIndex::addNearest(const Entry &entry, float x, float y, float z, float radius2, size_t count,
+                              std::vector<Nearest> &nearest, Filter &filter) const {
+
+	const float dX = entry.x - x;
+	const float dY = entry.y - y;
+	const float dZ = entry.z - z;
+
+	Nearest candidate;
+	candidate.distance = dX * dX + dY * dY + dZ * dZ;
+	candidate.order    = entry.order;
+	candidate.object   = entry.object;
+
+	if (candidate.distance > radius2)
+		return;
+
+	if ((nearest.size() >= count) && !(candidate < nearest.back()))
+		return;
+
+	if (!filter(entry.object))
+		return;
+
+	// Insertion sort; the number of objects asked for is usually tiny
+	if (nearest.size() >= count)
+		nearest.pop_back();
+
+	nearest.push_back(candidate);
+	for (size_t i = nearest.size() - 1; (i > 0) && (nearest[i] < nearest[i - 1]); i--)
+		std::swap(nearest[i], nearest[i - 1]);
+}
+
+template<typename Filter>
+void SpatialIndex::findNearest(float x, float y, float z, uint32_t types, size_t count, float radius,
+                               std::vector<Aurora::NWScript::Object *> &objects, Filter filter) const {
+
+	objects.clear();
+	if ((count == 0) || _entryMap.empty() || !(radius >= 0.0f))
+		return;
+
+	const float radius2 = radius * radius;
+
+	std::vector<Nearest> nearest;
+	nearest.reserve(MIN<size_t>(count, _entryMap.size()));
+
+	/* Walk the rings of cells around the point's cell, from the inside out. We
+	 * can stop once no position in the next ring can be closer than the furthest
+	 * object we already found, or beyond the radius, or once we left all cells
+	 * that ever held an object. */
+
+	const int32_t cX = getCellCoord(x);
+	const int32_t cY = getCellCoord(y);
+
+	const int32_t maxRing = MAX(MAX(cX - _minCellX, _maxCellX - cX), MAX(cY - _minCellY, _maxCellY - cY));
+
+	for (int32_t ring = 0; ring <= maxRing; ring++) {
+		const float ringDistance = getRingDistance(x, y, cX, cY, ring);
+		const float ringDistance2 = ringDistance * ringDistance;
+
+		if (ringDistance2 > radius2)
+			break;
+		if ((nearest.size() >= count) && (ringDistance2 > nearest.back().distance))
+			break;
+
+		const int32_t minY = MAX(cY - ring, _minCellY);
+		const int32_t maxY = MIN(cY + ring, _maxCellY);
+
+		auto visitCell = [&](int32_t cellX, int32_t cellY) {
+			const Cell *cell = getPointCell(cellX, cellY);
+			if (!cell || !(cell->types & types))
+				return;
+
+			for (uint32_t index : cell->entries) {
+				const Entry &entry = _entries[index];
+				if (entry.type & types)
+					addNearest(entry, x, y, z, radius2, count, nearest, filter);
+			}
+		};
+
+		for (int32_t cellY = minY; cellY <= maxY; cellY++) {
+			// The top and bottom row of the ring are full, the others only have their two ends
+			if ((cellY == (cY - ring)) || (cellY == (cY + ring))) {
+				const int32_t minX = MAX(cX - ring, _minCellX);
+				const int32_t maxX = MIN(cX + ring, _maxCellX);
+
+				for (int32_t cellX = minX; cellX <= maxX; cellX++)
+					visitCell(cellX, cellY);
+
+				continue;
+			}
+
+			if ((cX - ring) >= _minCellX)
+				visitCell(cX - ring, cellY);
+			if ((cX + ring) <= _maxCellX)
+				visitCell(cX + ring, cellY);
+		}
+	}
+
+	objects.reserve(nearest.size());
+	for (const Nearest &n : nearest)
+		objects.push_back(n.object);
+}
+
+} // End of namespace Engines
+
+#endif // ENGINES_AURORA_SPATIALINDEX_H
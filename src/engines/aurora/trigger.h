@@ -42,6 +42,9 @@ public:
 	void setVisible(bool visible);
 	bool contains(float x, float y) const;
 
+	/** Return the box around the trigger's polygon. */
+	const Common::BoundingBox &getBoundingBox() const;
+
 	// .--- Renderable
 	void calculateDistance();
 	void render(Graphics::RenderPass pass);
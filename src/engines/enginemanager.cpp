@@ -42,6 +42,8 @@
 #include "src/aurora/talkman.h"
 #include "src/aurora/2dareg.h"
 
+#include "src/aurora/nwscript/programcache.h"
+
 #include "src/graphics/graphics.h"
 
 #include "src/graphics/aurora/cursorman.h"
@@ -278,6 +280,7 @@ void EngineManager::cleanup() const {
 		LangMan.clear();
 		TalkMan.clear();
 		TwoDAReg.clear();
+		NCSCache.clear();
 		ResMan.clear();
 
 		ConfigMan.setGame();
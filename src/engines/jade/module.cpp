@@ -26,6 +26,8 @@
 #include "src/common/error.h"
 #include "src/common/ustring.h"
 
+#include "src/aurora/nwscript/scheduler.h"
+
 #include "src/graphics/camera.h"
 
 #include "src/events/events.h"
@@ -43,11 +45,6 @@ namespace Engines {
 
 namespace Jade {
 
-bool Module::Action::operator<(const Action &s) const {
-	return timestamp < s.timestamp;
-}
-
-
 Module::Module(::Engines::Console &console) : _console(&console), _hasModule(false),
 	_running(false), _exit(false) {
 
@@ -157,7 +154,7 @@ void Module::unload(bool completeUnload) {
 	}
 
 	_eventQueue.clear();
-	_delayedActions.clear();
+	ScriptSched.clear();
 
 	_newModule.clear();
 	_hasModule = false;
@@ -298,20 +295,11 @@ void Module::handleEvents() {
 }
 
 void Module::handleActions() {
-	uint32_t now = EventMan.getTimestamp();
-
-	while (!_delayedActions.empty()) {
-		ActionQueue::iterator action = _delayedActions.begin();
+	std::vector<Aurora::NWScript::DelayedScript> scripts;
+	ScriptSched.collect(EventMan.getTimestamp(), scripts);
 
-		if (now < action->timestamp)
-			break;
-
-		if (action->type == kActionScript)
-			ScriptContainer::runScript(action->script, action->state,
-			                           action->owner, action->triggerer);
-
-		_delayedActions.erase(action);
-	}
+	for (std::vector<Aurora::NWScript::DelayedScript>::iterator s = scripts.begin(); s != scripts.end(); ++s)
+		ScriptContainer::runScript(s->script, s->state, s->owner, s->triggerer);
 }
 
 void Module::movePC(float x, float y, float z) {
@@ -353,16 +341,7 @@ void Module::delayScript(const Common::UString &script,
                          const Aurora::NWScript::ScriptState &state,
                          Aurora::NWScript::Object *owner,
                          Aurora::NWScript::Object *triggerer, uint32_t delay) {
-	Action action;
-
-	action.type      = kActionScript;
-	action.script    = script;
-	action.state     = state;
-	action.owner     = owner;
-	action.triggerer = triggerer;
-	action.timestamp = EventMan.getTimestamp() + delay;
-
-	_delayedActions.insert(action);
+	ScriptSched.schedule(EventMan.getTimestamp(), delay, script, state, owner, triggerer);
 }
 
 } // End of namespace Jade
@@ -26,7 +26,6 @@
 #define ENGINES_JADE_MODULE_H
 
 #include <list>
-#include <set>
 
 #include <memory>
 #include "src/common/ustring.h"
@@ -133,27 +132,7 @@ public:
 	// '---
 
 private:
-	enum ActionType {
-		kActionNone   = 0,
-		kActionScript = 1
-	};
-
-	struct Action {
-		ActionType type;
-
-		Common::UString script;
-
-		Aurora::NWScript::ScriptState state;
-		Aurora::NWScript::ObjectReference owner;
-		Aurora::NWScript::ObjectReference triggerer;
-
-		uint32_t timestamp;
-
-		bool operator<(const Action &s) const;
-	};
-
 	typedef std::list<Events::Event> EventQueue;
-	typedef std::multiset<Action> ActionQueue;
 
 
 	::Engines::Console *_console;
@@ -173,8 +152,7 @@ private:
 
 	std::unique_ptr<Area> _area; ///< The current module's area.
 
-	EventQueue  _eventQueue;
-	ActionQueue _delayedActions;
+	EventQueue _eventQueue;
 
 
 	// .--- Unloading
@@ -23,6 +23,8 @@
  */
 
 #include <memory>
+#include <limits>
+
 #include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/readstream.h"
@@ -126,6 +128,8 @@ void Area::clear() {
 	_triggers.clear();
 	_situatedObjects.clear();
 	_activeTrigger = 0;
+
+	_spatialIndex.clear();
 }
 
 uint32_t Area::getMusicDayTrack() const {
@@ -435,6 +439,7 @@ void Area::loadObject(std::unique_ptr<Object> &&object) {
 	if (!_objects.back()->isStatic())
 		addToObjectMap(_objects.back().get());
 
+	addToSpatialIndex(*_objects.back());
 	notifyObjectMoved(*_objects.back());
 }
 
@@ -629,10 +634,12 @@ void Area::toggleTriggers() {
 void Area::evaluateTriggers(float x, float y) {
 	Trigger *trigger = 0;
 
-	for (std::vector<Trigger *>::iterator it = _triggers.begin();
-			it != _triggers.end();
-			++it) {
-		Trigger *t = *it;
+	// Only the triggers whose bounding box contains the point can contain it
+	std::vector<Aurora::NWScript::Object *> candidates;
+	_spatialIndex.findRegions(x, y, kObjectTypeTrigger, candidates);
+
+	for (Aurora::NWScript::Object *candidate : candidates) {
+		Trigger *t = static_cast<Trigger *>(candidate);
 		if (t->contains(x, y)) {
 			trigger = t;
 			break;
@@ -667,8 +674,8 @@ void Area::showAllRooms() {
 }
 
 void Area::notifyObjectMoved(Object &o) {
-	float x, y, _;
-	o.getPosition(x, y, _);
+	float x, y, z;
+	o.getPosition(x, y, z);
 	o.setRoom(_pathfinding->getRoomAt(x, y));
 
 	if (o.getType() == kObjectTypeCreature)
@@ -767,33 +774,30 @@ Object *Area::getObjectByTag(const Common::UString &tag) {
 	return nullptr;
 }
 
-Creature *Area::getNearestCreature(const Object *target, int UNUSED(nth), const CreatureSearchCriteria &criteria) const {
-	// TODO: Find Nth nearest using all criterias
+Creature *Area::getNearestCreature(const Object *target, int nth, const CreatureSearchCriteria &criteria) const {
+	// TODO: Find nearest using all criterias
 
-	Creature *result = 0;
-	float lowestDistance = 0.0f;
+	if (!target)
+		return 0;
+
+	const size_t count = MAX(nth, 1);
 
 	float x, y, z;
 	target->getPosition(x, y, z);
-	glm::vec3 targetPosition(x, y, z);
 
-	for (auto c = _creatures.begin(); c != _creatures.end(); ++c) {
-		if (*c == target || (*c)->isDead())
-			continue;
+	std::vector<Aurora::NWScript::Object *> creatures;
+	_spatialIndex.findNearest(x, y, z, kObjectTypeCreature, count, std::numeric_limits<float>::infinity(),
+	                          creatures, [&](Aurora::NWScript::Object *object) {
 
-		if (!(*c)->matchSearchCriteria(target, criteria))
-			continue;
+		const Creature *creature = static_cast<Creature *>(object);
 
-		(*c)->getPosition(x, y, z);
-		float dist = glm::distance(targetPosition, glm::vec3(x, y, z));
+		return (creature != target) && !creature->isDead() && creature->matchSearchCriteria(target, criteria);
+	});
 
-		if ((result == 0) || (dist < lowestDistance)) {
-			result = *c;
-			lowestDistance = dist;
-		}
-	}
+	if (creatures.size() < count)
+		return 0;
 
-	return result;
+	return static_cast<Creature *>(creatures.back());
 }
 
 const std::vector<Creature *> &Area::getCreatures() const {
@@ -836,6 +840,30 @@ void Area::addToObjectMap(Object *object) {
 		_objectMap.insert(std::make_pair(*id, object));
 }
 
+void Area::addToSpatialIndex(Object &object) {
+	float x, y, z;
+	object.getPosition(x, y, z);
+
+	// From now on, the object keeps its entry updated whenever it moves
+	object.setSpatialIndex(&_spatialIndex);
+
+	// Triggers cover the area of their polygon
+	if (object.getType() == kObjectTypeTrigger) {
+		const Common::BoundingBox &box = static_cast<Trigger &>(object).getBoundingBox();
+
+		if (!box.empty()) {
+			float minX, minY, minZ, maxX, maxY, maxZ;
+			box.getMin(minX, minY, minZ);
+			box.getMax(maxX, maxY, maxZ);
+
+			_spatialIndex.addRegion(object, object.getType(), x, y, z, minX, minY, maxX, maxY);
+			return;
+		}
+	}
+
+	_spatialIndex.add(object, object.getType(), x, y, z);
+}
+
 void Area::removeObject(Object *object) {
 	if (object == _activeObject) {
 		_activeObject->leave();
@@ -847,6 +875,9 @@ void Area::removeObject(Object *object) {
 	if (crit != _creatures.end())
 		_creatures.erase(crit);
 
+	_spatialIndex.remove(*object);
+	object->setSpatialIndex(0);
+
 	std::vector<Trigger *>::iterator tit = std::find(_triggers.begin(), _triggers.end(), object);
 	if (tit != _triggers.end())
 		_triggers.erase(tit);
@@ -43,6 +43,8 @@
 #include "src/events/types.h"
 #include "src/events/notifyable.h"
 
+#include "src/engines/aurora/spatialindex.h"
+
 #include "src/engines/kotorbase/object.h"
 #include "src/engines/kotorbase/trigger.h"
 
@@ -226,6 +228,9 @@ private:
 	ObjectList _objects;   ///< List of all objects in the area.
 	ObjectMap  _objectMap; ///< Map of all non-static objects in the area.
 
+	/** Positions of all objects in the area, and the regions covered by triggers. */
+	Engines::SpatialIndex _spatialIndex;
+
 	std::vector<Creature *> _creatures;
 
 	Object *_activeObject; ///< The currently active (highlighted) object.
@@ -268,6 +273,8 @@ private:
 	void loadProperties(const Aurora::GFF3Struct &props);
 
 	void loadObject(std::unique_ptr<Object> &&object);
+	/** Add an object to the spatial index, at its current position. */
+	void addToSpatialIndex(Object &object);
 
 	void loadWaypoints (const Aurora::GFF3List &list);
 	void loadPlaceables(const Aurora::GFF3List &list);
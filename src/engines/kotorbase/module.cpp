@@ -22,6 +22,8 @@
  *  The context needed to run a module in KotOR games.
  */
 
+#include <iterator>
+
 #include "src/common/util.h"
 #include "src/common/maths.h"
 #include "src/common/error.h"
@@ -39,6 +41,8 @@
 #include "src/aurora/2dareg.h"
 #include "src/aurora/2dafile.h"
 
+#include "src/aurora/nwscript/scheduler.h"
+
 #include "src/graphics/camera.h"
 
 #include "src/graphics/aurora/model.h"
@@ -68,14 +72,16 @@
 
 #include "src/engines/kotor/gui/chargen/chargeninfo.h"
 
+/** 2DAs needed by the area and the objects in it, parsed in parallel before loading the area. */
+static const char * const kWarmup2DAs[] = {
+	"appearance", "placeables", "genericdoors", "doortypes", "placeableobjsnds", "ambientmusic",
+	"ambientsound", "baseitems", "heads", "portraits", "creaturespeed", "camerastyle"
+};
+
 namespace Engines {
 
 namespace KotORBase {
 
-bool Module::Action::operator<(const Action &s) const {
-	return timestamp < s.timestamp;
-}
-
 Module::DelayedConversation::DelayedConversation(const Common::UString &_name, Aurora::NWScript::Object *_owner) :
 		name(_name),
 		owner(_owner) {
@@ -216,6 +222,9 @@ void Module::showMenu() {
 void Module::load() {
 	loadTexturePack();
 	loadResources();
+
+	TwoDAReg.warmup(std::vector<Common::UString>(std::begin(kWarmup2DAs), std::end(kWarmup2DAs)));
+
 	loadIFO();
 	loadArea();
 	loadPC();
@@ -372,7 +381,7 @@ void Module::unload(bool completeUnload) {
 	unloadResources();
 
 	_eventQueue.clear();
-	_delayedActions.clear();
+	ScriptSched.clear();
 
 	_newModule.clear();
 	_hasModule = false;
@@ -761,20 +770,11 @@ void Module::notifyCombatRoundEnded(int UNUSED(round)) {
 }
 
 void Module::handleActions() {
-	uint32_t now = EventMan.getTimestamp();
-
-	while (!_delayedActions.empty()) {
-		ActionQueue::iterator action = _delayedActions.begin();
-
-		if (now < action->timestamp)
-			break;
-
-		if (action->type == kActionScript)
-			ScriptContainer::runScript(action->script, action->state,
-			                           action->owner, action->triggerer);
+	std::vector<Aurora::NWScript::DelayedScript> scripts;
+	ScriptSched.collect(EventMan.getTimestamp(), scripts);
 
-		_delayedActions.erase(action);
-	}
+	for (std::vector<Aurora::NWScript::DelayedScript>::iterator s = scripts.begin(); s != scripts.end(); ++s)
+		ScriptContainer::runScript(s->script, s->state, s->owner, s->triggerer);
 }
 
 void Module::moveParty(float x, float y, float z) {
@@ -982,16 +982,7 @@ void Module::delayScript(const Common::UString &script,
                          const Aurora::NWScript::ScriptState &state,
                          Aurora::NWScript::Object *owner,
                          Aurora::NWScript::Object *triggerer, uint32_t delay) {
-	Action action;
-
-	action.type      = kActionScript;
-	action.script    = script;
-	action.state     = state;
-	action.owner     = owner;
-	action.triggerer = triggerer;
-	action.timestamp = EventMan.getTimestamp() + delay;
-
-	_delayedActions.insert(action);
+	ScriptSched.schedule(EventMan.getTimestamp(), delay, script, state, owner, triggerer);
 }
 
 void Module::signalUserDefinedEvent(Object *owner, int number) {
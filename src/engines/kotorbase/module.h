@@ -26,7 +26,6 @@
 #define ENGINES_KOTORBASE_MODULE_H
 
 #include <list>
-#include <set>
 
 #include <memory>
 #include "src/common/ustring.h"
@@ -265,27 +264,7 @@ protected:
 	virtual KotORBase::Creature *createCreature(const Common::UString &resRef) const = 0;
 
 private:
-	enum ActionType {
-		kActionNone   = 0,
-		kActionScript = 1
-	};
-
-	struct Action {
-		ActionType type;
-
-		Common::UString script;
-
-		Aurora::NWScript::ScriptState state;
-		Aurora::NWScript::ObjectReference owner;
-		Aurora::NWScript::ObjectReference triggerer;
-
-		uint32_t timestamp;
-
-		bool operator<(const Action &s) const;
-	};
-
 	typedef std::list<Events::Event> EventQueue;
-	typedef std::multiset<Action> ActionQueue;
 
 	// Global values
 
@@ -338,8 +317,7 @@ private:
 
 	std::unique_ptr<Graphics::Aurora::FadeQuad> _fade;
 
-	EventQueue  _eventQueue;
-	ActionQueue _delayedActions;
+	EventQueue _eventQueue;
 
 	PartyLeaderController _partyLeaderController;
 	PartyController _partyController;
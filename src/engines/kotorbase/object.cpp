@@ -34,6 +34,7 @@
 #include "src/sound/sound.h"
 
 #include "src/engines/aurora/util.h"
+#include "src/engines/aurora/spatialindex.h"
 
 #include "src/engines/kotorbase/object.h"
 #include "src/engines/kotorbase/location.h"
@@ -45,6 +46,7 @@ namespace KotORBase {
 Object::Object(ObjectType type) :
 		_type(type),
 		_room(0),
+		_areaIndex(0),
 		_static(false),
 		_usable(true),
 		_faction(kFactionInvalid),
@@ -151,6 +153,13 @@ void Object::setPosition(float x, float y, float z) {
 	_position[0] = x;
 	_position[1] = y;
 	_position[2] = z;
+
+	if (_areaIndex)
+		_areaIndex->move(*this, x, y, z);
+}
+
+void Object::setSpatialIndex(SpatialIndex *spatialIndex) {
+	_areaIndex = spatialIndex;
 }
 
 void Object::setOrientation(float x, float y, float z, float angle) {
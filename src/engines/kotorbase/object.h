@@ -37,6 +37,8 @@
 
 namespace Engines {
 
+class SpatialIndex;
+
 namespace KotORBase {
 
 class Room;
@@ -104,6 +106,8 @@ public:
 
 	/** Set the object's position within its area. */
 	virtual void setPosition(float x, float y, float z);
+	/** Set the index of object positions within the object's area, to keep updated on moves. */
+	void setSpatialIndex(SpatialIndex *spatialIndex);
 	/** Set the object's orientation. */
 	virtual void setOrientation(float x, float y, float z, float angle);
 
@@ -189,6 +193,8 @@ protected:
 	Common::UString _portrait;    ///< The object's portrait.
 	const Room *_room;            ///< Room the object is in.
 
+	SpatialIndex *_areaIndex; ///< The index of object positions of the object's area.
+
 	bool _static; ///< Is the object static?
 	bool _usable; ///< Is the object usable?
 
@@ -103,6 +103,8 @@ void Pathfinding::connectRooms() {
 			}
 		}
 	}
+
+	buildBVH();
 }
 
 uint32_t Pathfinding::getFaceFromEdge(uint32_t edge, uint32_t room) const {
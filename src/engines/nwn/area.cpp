@@ -98,6 +98,8 @@ void Area::clear() {
 	delete _pathfinding;
 
 	// Delete objects
+	_spatialIndex.clear();
+
 	for (auto &object : _objects)
 		_module->removeObject(*object);
 
@@ -509,6 +511,28 @@ void Area::unloadTiles() {
 	}
 }
 
+void Area::addToSpatialIndex(NWN::Object &object) {
+	float x, y, z;
+	object.getPosition(x, y, z);
+
+	_spatialIndex.add(object, object.getType(), x, y, z);
+}
+
+void Area::removeFromSpatialIndex(NWN::Object &object) {
+	_spatialIndex.remove(object);
+}
+
+void Area::notifyObjectMoved(NWN::Object &object) {
+	float x, y, z;
+	object.getPosition(x, y, z);
+
+	_spatialIndex.move(object, x, y, z);
+}
+
+const SpatialIndex &Area::getSpatialIndex() const {
+	return _spatialIndex;
+}
+
 void Area::loadObject(std::unique_ptr<NWN::Object> &&object) {
 	object->setArea(this);
 
@@ -43,6 +43,8 @@
 #include "src/events/types.h"
 #include "src/events/notifyable.h"
 
+#include "src/engines/aurora/spatialindex.h"
+
 #include "src/engines/nwn/tileset.h"
 #include "src/engines/nwn/object.h"
 
@@ -114,6 +116,17 @@ public:
 	/** Forcibly remove the focus from the currently highlighted object. */
 	void removeFocus();
 
+	// Object positions
+
+	/** Add an object to the index of object positions. */
+	void addToSpatialIndex(NWN::Object &object);
+	/** Remove an object from the index of object positions. */
+	void removeFromSpatialIndex(NWN::Object &object);
+	/** Notify the area that an object within has moved. */
+	void notifyObjectMoved(NWN::Object &object);
+
+	/** Return the index of the positions of all objects in the area. */
+	const SpatialIndex &getSpatialIndex() const;
 
 	/** Return the localized name of an area. */
 	static Common::UString getName(const Common::UString &resRef);
@@ -196,6 +209,8 @@ private:
 	ObjectList _objects;   ///< List of all objects in the area.
 	ObjectMap  _objectMap; ///< Map of all non-static objects in the area.
 
+	SpatialIndex _spatialIndex; ///< The positions of all objects in the area.
+
 	/** The currently active (highlighted) object. */
 	NWN::Object *_activeObject;
 
@@ -22,6 +22,8 @@
  *  The context needed to run a Neverwinter Nights module.
  */
 
+#include <iterator>
+
 #include "src/common/util.h"
 #include "src/common/maths.h"
 #include "src/common/error.h"
@@ -39,6 +41,8 @@
 #include "src/aurora/erffile.h"
 #include "src/aurora/resman.h"
 
+#include "src/aurora/nwscript/scheduler.h"
+
 #include "src/graphics/camera.h"
 
 #include "src/graphics/aurora/textureman.h"
@@ -94,15 +98,17 @@ static const GenderToken kGenderTokens[] = {
 	{"<bitch/bastard>"  , 1757, 1739}
 };
 
+/** 2DAs needed by the areas and the objects in them, parsed in parallel before loading the areas. */
+static const char * const kWarmup2DAs[] = {
+	"appearance", "placeables", "genericdoors", "doortypes", "placeableobjsnds", "ambientmusic",
+	"ambientsound", "soundset", "portraits", "classes", "racialtypes", "feat", "skills", "spells",
+	"phenotype", "gender", "packages", "masterfeats", "domains", "spellschools", "iprp_abilities"
+};
+
 namespace Engines {
 
 namespace NWN {
 
-bool Module::Action::operator<(const Action &s) const {
-	return timestamp < s.timestamp;
-}
-
-
 Module::Module(::Engines::Console &console, const Version &gameVersion) : Object(kObjectTypeModule),
 	_console(&console), _gameVersion(&gameVersion) {
 
@@ -344,6 +350,9 @@ void Module::enter() {
 
 		loadTLK();
 		loadHAKs();
+
+		TwoDAReg.warmup(std::vector<Common::UString>(std::begin(kWarmup2DAs), std::end(kWarmup2DAs)));
+
 		loadAreas();
 
 	} catch (Common::Exception &e) {
@@ -519,20 +528,11 @@ void Module::handleEvents() {
 }
 
 void Module::handleActions() {
-	uint32_t now = EventMan.getTimestamp();
+	std::vector<Aurora::NWScript::DelayedScript> scripts;
+	ScriptSched.collect(EventMan.getTimestamp(), scripts);
 
-	while (!_delayedActions.empty()) {
-		ActionQueue::iterator action = _delayedActions.begin();
-
-		if (now < action->timestamp)
-			break;
-
-		if (action->type == kActionScript)
-			ScriptContainer::runScript(action->script, action->state,
-			                           action->owner, action->triggerer);
-
-		_delayedActions.erase(action);
-	}
+	for (std::vector<Aurora::NWScript::DelayedScript>::iterator s = scripts.begin(); s != scripts.end(); ++s)
+		ScriptContainer::runScript(s->script, s->state, s->owner, s->triggerer);
 }
 
 void Module::unload(bool completeUnload) {
@@ -555,7 +555,7 @@ void Module::unloadModule() {
 	handleActions();
 
 	_eventQueue.clear();
-	_delayedActions.clear();
+	ScriptSched.clear();
 
 	TwoDAReg.clear();
 
@@ -576,6 +576,8 @@ void Module::unloadPC() {
 	if (!_pc)
 		return;
 
+	_pc->setArea(nullptr);
+
 	removeObject(*_pc);
 
 	removePCTokens();
@@ -673,6 +675,10 @@ void Module::loadSurfaceTypes() {
 void Module::unloadAreas() {
 	_ingameGUI->stopConversation();
 
+	// The PC outlives the areas, so take it out of its area first
+	if (_pc)
+		_pc->setArea(nullptr);
+
 	_areas.clear();
 	_newArea.clear();
 
@@ -768,16 +774,7 @@ void Module::delayScript(const Common::UString &script,
                          const Aurora::NWScript::ScriptState &state,
                          Aurora::NWScript::Object *owner,
                          Aurora::NWScript::Object *triggerer, uint32_t delay) {
-	Action action;
-
-	action.type      = kActionScript;
-	action.script    = script;
-	action.state     = state;
-	action.owner     = owner;
-	action.triggerer = triggerer;
-	action.timestamp = EventMan.getTimestamp() + delay;
-
-	_delayedActions.insert(action);
+	ScriptSched.schedule(EventMan.getTimestamp(), delay, script, state, owner, triggerer);
 }
 
 Common::UString Module::getDescriptionExtra(Common::UString module) {
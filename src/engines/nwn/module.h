@@ -27,7 +27,6 @@
 
 #include <list>
 #include <map>
-#include <set>
 #include <memory>
 
 #include "src/common/ustring.h"
@@ -152,29 +151,9 @@ public:
 	void toggleWalkmesh();
 
 private:
-	enum ActionType {
-		kActionNone   = 0,
-		kActionScript = 1
-	};
-
-	struct Action {
-		ActionType type;
-
-		Common::UString script;
-
-		Aurora::NWScript::ScriptState state;
-		Aurora::NWScript::ObjectReference owner;
-		Aurora::NWScript::ObjectReference triggerer;
-
-		uint32_t timestamp;
-
-		bool operator<(const Action &s) const;
-	};
-
 	typedef std::map<Common::UString, std::unique_ptr<Area>> AreaMap;
 
 	typedef std::list<Events::Event> EventQueue;
-	typedef std::multiset<Action> ActionQueue;
 
 
 	::Engines::Console *_console { nullptr };
@@ -210,8 +189,7 @@ private:
 
 	Common::UString _newModule; ///< The module we should change to.
 
-	EventQueue  _eventQueue;
-	ActionQueue _delayedActions;
+	EventQueue _eventQueue;
 
 	// Surface types
 	/** A map between surface type and walkability. */
@@ -44,6 +44,7 @@
 
 #include "src/engines/nwn/types.h"
 #include "src/engines/nwn/object.h"
+#include "src/engines/nwn/area.h"
 
 namespace Engines {
 
@@ -138,7 +139,16 @@ Area *Object::getArea() const {
 }
 
 void Object::setArea(Area *area) {
+	if (_area == area)
+		return;
+
+	if (_area)
+		_area->removeFromSpatialIndex(*this);
+
 	_area = area;
+
+	if (_area)
+		_area->addToSpatialIndex(*this);
 }
 
 Location Object::getLocation() const {
@@ -171,6 +181,9 @@ void Object::setPosition(float x, float y, float z) {
 	_position[0] = x;
 	_position[1] = y;
 	_position[2] = z;
+
+	if (_area)
+		_area->notifyObjectMoved(*this);
 }
 
 void Object::setOrientation(float x, float y, float z, float angle) {
@@ -173,6 +173,8 @@ void Pathfinding::finalize() {
 		}
 	}
 
+	buildBVH();
+
 	_loaded = true;
 }
 
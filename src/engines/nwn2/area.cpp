@@ -92,6 +92,8 @@ Area::~Area() {
 
 void Area::clear() {
 	// Delete objects
+	_spatialIndex.clear();
+
 	for (auto &object : _objects)
 		_module->removeObject(*object);
 
@@ -516,6 +518,28 @@ void Area::unloadTileModels() {
 	}
 }
 
+void Area::addToSpatialIndex(NWN2::Object &object) {
+	float x, y, z;
+	object.getPosition(x, y, z);
+
+	_spatialIndex.add(object, object.getType(), x, y, z);
+}
+
+void Area::removeFromSpatialIndex(NWN2::Object &object) {
+	_spatialIndex.remove(object);
+}
+
+void Area::notifyObjectMoved(NWN2::Object &object) {
+	float x, y, z;
+	object.getPosition(x, y, z);
+
+	_spatialIndex.move(object, x, y, z);
+}
+
+const SpatialIndex &Area::getSpatialIndex() const {
+	return _spatialIndex;
+}
+
 void Area::loadObject(std::unique_ptr<NWN2::Object> &&object) {
 	object->setArea(this);
 
@@ -23,6 +23,7 @@
  */
 
 #include <cassert>
+#include <iterator>
 
 #include "src/common/util.h"
 #include "src/common/maths.h"
@@ -32,10 +33,13 @@
 #include "src/common/readfile.h"
 
 #include "src/aurora/resman.h"
+#include "src/aurora/2dareg.h"
 #include "src/aurora/talkman.h"
 #include "src/aurora/erffile.h"
 #include "src/aurora/gff3file.h"
 
+#include "src/aurora/nwscript/scheduler.h"
+
 #include "src/graphics/camera.h"
 
 #include "src/events/events.h"
@@ -51,15 +55,17 @@
 #include "src/engines/nwn2/roster.h"
 #include "src/engines/nwn2/journal.h"
 
+/** 2DAs needed by the areas and the objects in them, parsed in parallel before loading the areas. */
+static const char * const kWarmup2DAs[] = {
+	"appearance", "placeables", "genericdoors", "doortypes", "placeableobjsnds", "ambientmusic",
+	"ambientsound", "soundset", "baseitems", "armorvisualdata", "itempropdef", "iprp_onhit",
+	"repute", "traps", "tiles", "metatiles", "nwn2_icons"
+};
+
 namespace Engines {
 
 namespace NWN2 {
 
-bool Module::Action::operator<(const Action &s) const {
-	return timestamp < s.timestamp;
-}
-
-
 Module::Module() : Object(kObjectTypeModule) {
 }
 
@@ -206,6 +212,9 @@ void Module::enter(Creature &pc, bool isNewCampaign) {
 
 		loadTLK();
 		loadHAKs();
+
+		TwoDAReg.warmup(std::vector<Common::UString>(std::begin(kWarmup2DAs), std::end(kWarmup2DAs)));
+
 		loadAreas();
 		loadFactions();
 		loadRoster();
@@ -348,20 +357,11 @@ void Module::handleEvents() {
 }
 
 void Module::handleActions() {
-	uint32_t now = EventMan.getTimestamp();
-
-	while (!_delayedActions.empty()) {
-		ActionQueue::iterator action = _delayedActions.begin();
+	std::vector<Aurora::NWScript::DelayedScript> scripts;
+	ScriptSched.collect(EventMan.getTimestamp(), scripts);
 
-		if (now < action->timestamp)
-			break;
-
-		if (action->type == kActionScript)
-			ScriptContainer::runScript(action->script, action->state,
-			                           action->owner, action->triggerer);
-
-		_delayedActions.erase(action);
-	}
+	for (std::vector<Aurora::NWScript::DelayedScript>::iterator s = scripts.begin(); s != scripts.end(); ++s)
+		ScriptContainer::runScript(s->script, s->state, s->owner, s->triggerer);
 }
 
 void Module::unload() {
@@ -385,7 +385,7 @@ void Module::unloadModule() {
 	_newModule.clear();
 
 	_eventQueue.clear();
-	_delayedActions.clear();
+	ScriptSched.clear();
 
 	_hasModule = false;
 	_running   = false;
@@ -467,6 +467,10 @@ void Module::loadAreas() {
 }
 
 void Module::unloadAreas() {
+	// The PC outlives the areas, so take it out of its area first
+	if (_pc)
+		_pc->setArea(nullptr);
+
 	_areas.clear();
 	_newArea.clear();
 
@@ -477,6 +481,8 @@ void Module::unloadPC() {
 	if (!_pc)
 		return;
 
+	_pc->setArea(nullptr);
+
 	removeObject(*_pc);
 
 	_pc->hide();
@@ -567,16 +573,7 @@ void Module::delayScript(const Common::UString &script,
                          const Aurora::NWScript::ScriptState &state,
                          Aurora::NWScript::Object *owner,
                          Aurora::NWScript::Object *triggerer, uint32_t delay) {
-	Action action;
-
-	action.type      = kActionScript;
-	action.script    = script;
-	action.state     = state;
-	action.owner     = owner;
-	action.triggerer = triggerer;
-	action.timestamp = EventMan.getTimestamp() + delay;
-
-	_delayedActions.insert(action);
+	ScriptSched.schedule(EventMan.getTimestamp(), delay, script, state, owner, triggerer);
 }
 
 Common::UString Module::getName(const Common::UString &module) {
@@ -28,7 +28,6 @@
 #include <vector>
 #include <list>
 #include <map>
-#include <set>
 #include <memory>
 
 #include "src/common/ustring.h"
@@ -138,29 +137,9 @@ public:
 	// '---
 
 private:
-	enum ActionType {
-		kActionNone   = 0,
-		kActionScript = 1
-	};
-
-	struct Action {
-		ActionType type;
-
-		Common::UString script;
-
-		Aurora::NWScript::ScriptState state;
-		Aurora::NWScript::ObjectReference owner;
-		Aurora::NWScript::ObjectReference triggerer;
-
-		uint32_t timestamp;
-
-		bool operator<(const Action &s) const;
-	};
-
 	typedef std::map<Common::UString, std::unique_ptr<Area>> AreaMap;
 
 	typedef std::list<Events::Event> EventQueue;
-	typedef std::multiset<Action> ActionQueue;
 
 
 	::Engines::Console *_console { nullptr};
@@ -196,8 +175,7 @@ private:
 
 	Common::UString _newModule; ///< The module we should change to.
 
-	EventQueue  _eventQueue;
-	ActionQueue _delayedActions;
+	EventQueue _eventQueue;
 
 
 	// .--- Unloading
@@ -23,6 +23,7 @@
  */
 
 #include <memory>
+#include <limits>
 
 #include "src/common/util.h"
 
@@ -36,6 +37,7 @@
 #include "src/engines/nwn2/module.h"
 #include "src/engines/nwn2/objectcontainer.h"
 #include "src/engines/nwn2/object.h"
+#include "src/engines/nwn2/area.h"
 #include "src/engines/nwn2/creature.h"
 #include "src/engines/nwn2/door.h"
 #include "src/engines/nwn2/trigger.h"
@@ -237,41 +239,24 @@ void Functions::getNearestObject(Aurora::NWScript::FunctionContext &ctx) {
 	ctx.getReturn() = (Aurora::NWScript::Object *) 0;
 
 	NWN2::Object *target = NWN2::ObjectContainer::toObject(getParamObject(ctx, 1));
-	if (!target)
+	if (!target || !target->getArea())
 		return;
 
-	// Bitfield of type(s) to check for
-	uint32_t type = ctx.getParams()[0].getInt();
+	// Bitfield of type(s) to check for, ignoring invalid object types
+	uint32_t type = ctx.getParams()[0].getInt() & kObjectTypeAll;
 	// We want the nth nearest object
-	size_t nth  = MAX<int32_t>(ctx.getParams()[2].getInt() - 1, 0);
-
-	std::unique_ptr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjects());
-	Aurora::NWScript::Object *object = 0;
-
-	std::list<Object *> objects;
-	while ((object = search->next())) {
-		// Needs to be a valid object, not the target, but in the target's area
-		NWN2::Object *nwn2Object = NWN2::ObjectContainer::toObject(object);
-		if (!nwn2Object || (nwn2Object == target) || (nwn2Object->getArea() != target->getArea()))
-			continue;
-
-		// Ignore invalid object types
-		const uint32_t objectType = (uint32_t) nwn2Object->getType();
-		if (objectType >= kObjectTypeMAX)
-			continue;
+	size_t nth  = MAX<int32_t>(ctx.getParams()[2].getInt(), 1);
 
-		if (type & objectType)
-			objects.push_back(nwn2Object);
-	}
-
-	objects.sort(ObjectDistanceSort(*target));
+	float x, y, z;
+	target->getPosition(x, y, z);
 
-	std::list<Object *>::iterator it = objects.begin();
-	for (size_t n = 0; (n < nth) && (it != objects.end()); ++n)
-		++it;
+	// Only look at the target's area, and skip the target itself
+	std::vector<Aurora::NWScript::Object *> objects;
+	target->getArea()->getSpatialIndex().findNearest(x, y, z, type, nth, std::numeric_limits<float>::infinity(),
+			objects, [target](Aurora::NWScript::Object *object) { return object != target; });
 
-	if (it != objects.end())
-		ctx.getReturn() = *it;
+	if (objects.size() == nth)
+		ctx.getReturn() = objects.back();
 }
 
 void Functions::getNearestObjectByTag(Aurora::NWScript::FunctionContext &ctx) {
@@ -314,10 +299,10 @@ void Functions::getNearestCreature(Aurora::NWScript::FunctionContext &ctx) {
 	ctx.getReturn() = (Aurora::NWScript::Object *) 0;
 
 	NWN2::Object *target = NWN2::ObjectContainer::toObject(getParamObject(ctx, 2));
-	if (!target)
+	if (!target || !target->getArea())
 		return;
 
-	size_t nth = MAX<int32_t>(ctx.getParams()[3].getInt() - 1, 0);
+	size_t nth = MAX<int32_t>(ctx.getParams()[3].getInt(), 1);
 
 	/* TODO: Criteria:
 	 *
@@ -329,25 +314,15 @@ void Functions::getNearestCreature(Aurora::NWScript::FunctionContext &ctx) {
 	 * int crit3Value = ctx.getParams()[7].getInt();
 	 */
 
-	std::unique_ptr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjects());
-	Aurora::NWScript::Object *object = 0;
-
-	std::list<Object *> creatures;
-	while ((object = search->next())) {
-		Creature *creature = NWN2::ObjectContainer::toCreature(object);
-
-		if (creature && (creature != target) && (creature->getArea() == target->getArea()))
-			creatures.push_back(creature);
-	}
-
-	creatures.sort(ObjectDistanceSort(*target));
+	float x, y, z;
+	target->getPosition(x, y, z);
 
-	std::list<Object *>::iterator it = creatures.begin();
-	for (size_t n = 0; (n < nth) && (it != creatures.end()); ++n)
-		++it;
+	std::vector<Aurora::NWScript::Object *> creatures;
+	target->getArea()->getSpatialIndex().findNearest(x, y, z, kObjectTypeCreature, nth, std::numeric_limits<float>::infinity(),
+			creatures, [target](Aurora::NWScript::Object *object) { return object != target; });
 
-	if (it != creatures.end())
-		ctx.getReturn() = *it;
+	if (creatures.size() == nth)
+		ctx.getReturn() = creatures.back();
 }
 
 void Functions::getCurrentHitPoints(Aurora::NWScript::FunctionContext &ctx) {
@@ -36,6 +36,8 @@
 #include "src/aurora/erffile.h"
 #include "src/aurora/gff3file.h"
 
+#include "src/aurora/nwscript/scheduler.h"
+
 #include "src/graphics/camera.h"
 
 #include "src/events/events.h"
@@ -52,11 +54,6 @@ namespace Engines {
 
 namespace Witcher {
 
-bool Module::Action::operator<(const Action &s) const {
-	return timestamp < s.timestamp;
-}
-
-
 Module::Module(::Engines::Console &console) : Object(kObjectTypeModule), _console(&console) {
 }
 
@@ -333,20 +330,11 @@ void Module::handleEvents() {
 }
 
 void Module::handleActions() {
-	uint32_t now = EventMan.getTimestamp();
-
-	while (!_delayedActions.empty()) {
-		ActionQueue::iterator action = _delayedActions.begin();
+	std::vector<Aurora::NWScript::DelayedScript> scripts;
+	ScriptSched.collect(EventMan.getTimestamp(), scripts);
 
-		if (now < action->timestamp)
-			break;
-
-		if (action->type == kActionScript)
-			ScriptContainer::runScript(action->script, action->state,
-			                           action->owner, action->triggerer);
-
-		_delayedActions.erase(action);
-	}
+	for (std::vector<Aurora::NWScript::DelayedScript>::iterator s = scripts.begin(); s != scripts.end(); ++s)
+		ScriptContainer::runScript(s->script, s->state, s->owner, s->triggerer);
 }
 
 void Module::unload() {
@@ -368,7 +356,7 @@ void Module::unloadModule() {
 	_entryLocation.clear();
 
 	_eventQueue.clear();
-	_delayedActions.clear();
+	ScriptSched.clear();
 
 	_hasModule = false;
 	_running   = false;
@@ -501,16 +489,7 @@ void Module::delayScript(const Common::UString &script,
                          const Aurora::NWScript::ScriptState &state,
                          Aurora::NWScript::Object *owner,
                          Aurora::NWScript::Object *triggerer, uint32_t delay) {
-	Action action;
-
-	action.type      = kActionScript;
-	action.script    = script;
-	action.state     = state;
-	action.owner     = owner;
-	action.triggerer = triggerer;
-	action.timestamp = EventMan.getTimestamp() + delay;
-
-	_delayedActions.insert(action);
+	ScriptSched.schedule(EventMan.getTimestamp(), delay, script, state, owner, triggerer);
 }
 
 Common::UString Module::getName(const Common::UString &module) {
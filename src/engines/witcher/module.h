@@ -27,7 +27,6 @@
 
 #include <list>
 #include <map>
-#include <set>
 #include <memory>
 
 #include "src/common/ustring.h"
@@ -133,29 +132,9 @@ public:
 	// '---
 
 private:
-	enum ActionType {
-		kActionNone   = 0,
-		kActionScript = 1
-	};
-
-	struct Action {
-		ActionType type;
-
-		Common::UString script;
-
-		Aurora::NWScript::ScriptState state;
-		Aurora::NWScript::ObjectReference owner;
-		Aurora::NWScript::ObjectReference triggerer;
-
-		uint32_t timestamp;
-
-		bool operator<(const Action &s) const;
-	};
-
 	typedef std::map<Common::UString, std::unique_ptr<Area>> AreaMap;
 
 	typedef std::list<Events::Event> EventQueue;
-	typedef std::multiset<Action> ActionQueue;
 
 
 	::Engines::Console  *_console;
@@ -182,8 +161,7 @@ private:
 	/** The tag of the object in the start location for this module. */
 	Common::UString _entryLocation;
 
-	EventQueue  _eventQueue;
-	ActionQueue _delayedActions;
+	EventQueue _eventQueue;
 
 
 	// .--- Unloading
@@ -93,9 +93,6 @@ protected:
 	Common::UString _name; ///< The model's name.
 	float _length;
 	float _transtime;
-
-	glm::vec3 interpolatePosition(ModelNode *animNode, float time) const;
-	glm::quat interpolateOrientation(ModelNode *animNode, float time) const;
 };
 
 } // End of namespace Aurora
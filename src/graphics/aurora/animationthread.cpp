@@ -22,8 +22,12 @@
  *  Dedicated animation thread.
  */
 
+#include <chrono>
+
 #include "external/glm/gtc/type_ptr.hpp"
 
+#include "src/common/util.h"
+
 #include "src/events/events.h"
 
 #include "src/graphics/camera.h"
@@ -38,9 +42,18 @@ namespace Aurora {
 const int kPauseDuration = 10;
 const int kYieldDuration = 1;
 
+/** The maximum number of threads evaluating animations, including the animation thread. */
+static const size_t kMaxAnimationThreads = 8;
+
 AnimationThread::PoolModel::PoolModel(Model *m) : model(m) {
 }
 
+AnimationThread::Stats AnimationThread::getStats() {
+	std::lock_guard<std::mutex> lock(_statsMutex);
+
+	return _stats;
+}
+
 void AnimationThread::pause() {
 	PauseStatus expected = kPauseResumed;
 	if (!_pause.compare_exchange_strong(expected, kPauseRequested, std::memory_order_seq_cst))
@@ -90,6 +103,8 @@ void AnimationThread::flush() {
 }
 
 void AnimationThread::threadMethod() {
+	startWorkers();
+
 	while (!_killThread.load(std::memory_order_relaxed)) {
 		if (EventMan.quitRequested())
 			break;
@@ -108,29 +123,166 @@ void AnimationThread::threadMethod() {
 			continue;
 		}
 
-		for (auto &m : _models) {
-			if (EventMan.quitRequested() || (_pause.load(std::memory_order_seq_cst) == kPausePaused))
-				break;
+		updateModels();
+	}
+
+	stopWorkers();
+}
+
+void AnimationThread::startWorkers() {
+	const size_t count = CLIP<size_t>(std::thread::hardware_concurrency(), 1, kMaxAnimationThreads);
+
+	{
+		std::lock_guard<std::mutex> lock(_statsMutex);
+		_stats.workers = count;
+	}
+
+	// The animation thread itself evaluates jobs as well
+	_stopWorkers = false;
+	for (size_t i = 1; i < count; i++)
+		_workers.emplace_back(&AnimationThread::workerThread, this);
+}
+
+void AnimationThread::stopWorkers() {
+	{
+		std::lock_guard<std::mutex> lock(_jobsMutex);
+		_stopWorkers = true;
+	}
+
+	_jobsAvailable.notify_all();
+
+	for (std::vector<std::thread>::iterator w = _workers.begin(); w != _workers.end(); ++w)
+		w->join();
+
+	_workers.clear();
+}
+
+void AnimationThread::workerThread() {
+	Common::Thread::setCurrentThreadName("AnimationWorker");
+
+	size_t generation = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_jobsMutex);
+
+			_jobsAvailable.wait(lock, [&]() {
+				return _stopWorkers || (_jobsOpen && (_jobsGeneration != generation));
+			});
+
+			if (_stopWorkers)
+				return;
+
+			generation = _jobsGeneration;
+			_busyWorkers++;
+		}
+
+		runJobs(false);
+
+		_busyWorkers--;
+	}
+}
+
+void AnimationThread::updateModels() {
+	// Collect the models that are due an update, skipping far away ones more often
+	_jobs.clear();
+	for (auto &m : _models) {
+		if (m.second.skippedCount < getNumIterationsToSkip(m.second.model)) {
+			++m.second.skippedCount;
+			continue;
+		} else {
+			m.second.skippedCount = 0;
+		}
+
+		_jobs.push_back(&m.second);
+	}
+
+	if (_jobs.empty())
+		return;
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	_nextJob       = 0;
+	_modelsUpdated = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(_jobsMutex);
+
+		_jobsGeneration++;
+		_jobsOpen = true;
+	}
+
+	if (_jobs.size() > 1)
+		_jobsAvailable.notify_all();
+
+	runJobs(true);
+
+	// All jobs are claimed. Don't let any more workers join, and wait for the busy ones to finish
+	{
+		std::lock_guard<std::mutex> lock(_jobsMutex);
+		_jobsOpen = false;
+	}
+
+	while (_busyWorkers.load(std::memory_order_seq_cst) > 0) {
+		handleFlushBetweenJobs();
+		std::this_thread::yield();
+	}
+
+	const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::lock_guard<std::mutex> lock(_statsMutex);
+
+	_stats.passes++;
+	_stats.modelsUpdated    += _modelsUpdated;
+	_stats.lastModelsUpdated = _modelsUpdated;
+
+	_stats.lastPassTime   = time;
+	_stats.maxPassTime    = MAX(_stats.maxPassTime, time);
+	_stats.totalPassTime += time;
+}
 
-			if (m.second.skippedCount < getNumIterationsToSkip(m.second.model)) {
-				++m.second.skippedCount;
-				continue;
-			} else {
-				m.second.skippedCount = 0;
-			}
+void AnimationThread::runJobs(bool coordinator) {
+	while (true) {
+		// Only the animation thread grants flushes, and only while no job is being evaluated
+		if (coordinator)
+			handleFlushBetweenJobs();
 
-			handleFlush();
+		_activeJobs.fetch_add(1, std::memory_order_seq_cst);
 
-			uint32_t now = EventMan.getTimestamp();
-			float dt = 0;
-			if (m.second.lastChanged > 0) {
-				dt = (now - m.second.lastChanged) / 1000.0f;
-			}
-			m.second.lastChanged = now;
+		if (_flush.load(std::memory_order_seq_cst) != kFlushReady) {
+			_activeJobs.fetch_sub(1, std::memory_order_seq_cst);
 
-			m.second.model->manageAnimations(dt);
+			std::this_thread::yield();
+			continue;
 		}
+
+		const size_t job = _nextJob.fetch_add(1, std::memory_order_seq_cst);
+		if (job >= _jobs.size()) {
+			_activeJobs.fetch_sub(1, std::memory_order_seq_cst);
+			break;
+		}
+
+		// Stop the pass early when we're quitting
+		if (coordinator && EventMan.quitRequested())
+			_nextJob.store(_jobs.size(), std::memory_order_seq_cst);
+
+		updateModel(*_jobs[job]);
+
+		_activeJobs.fetch_sub(1, std::memory_order_seq_cst);
+	}
+}
+
+void AnimationThread::updateModel(PoolModel &model) {
+	uint32_t now = EventMan.getTimestamp();
+	float dt = 0;
+	if (model.lastChanged > 0) {
+		dt = (now - model.lastChanged) / 1000.0f;
 	}
+	model.lastChanged = now;
+
+	model.model->manageAnimations(dt);
+
+	_modelsUpdated++;
 }
 
 void AnimationThread::registerQueuedModels() {
@@ -189,6 +341,18 @@ void AnimationThread::handleFlush() {
 	}
 }
 
+void AnimationThread::handleFlushBetweenJobs() {
+	if (_flush.load(std::memory_order_seq_cst) != kFlushRequested)
+		return;
+
+	/* A worker first marks itself active and only then checks for a flush request,
+	 * so once we see no active jobs after the request, no job can start anymore. */
+	if (_activeJobs.load(std::memory_order_seq_cst) > 0)
+		return;
+
+	handleFlush();
+}
+
 } // End of namespace Aurora
 
 } // End of namespace Engines
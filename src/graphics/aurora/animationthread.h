@@ -27,6 +27,7 @@
 
 #include <map>
 #include <queue>
+#include <vector>
 #include <atomic>
 
 #include "external/glm/vec3.hpp"
@@ -41,8 +42,34 @@ namespace Aurora {
 
 class Model;
 
+/** The thread evaluating the animations of all visible models.
+ *
+ *  Each pass over the models, the animation thread collects the models
+ *  that are due an update. These are then evaluated as separate jobs by
+ *  the animation thread itself together with a pool of worker threads,
+ *  each claiming the next waiting model until all are done.
+ *
+ *  A flush of the models' buffered changes, requested by the main thread,
+ *  is only granted between jobs, while no job is being evaluated.
+ */
 class AnimationThread : public Common::Thread {
 public:
+	/** Statistics of the animation updates. */
+	struct Stats {
+		size_t workers       { 0 }; ///< Number of threads evaluating animations, including the animation thread.
+		size_t passes        { 0 }; ///< Number of passes that updated at least one model.
+		size_t modelsUpdated { 0 }; ///< Number of model updates over all passes.
+
+		size_t lastModelsUpdated { 0 }; ///< Number of models updated in the last pass.
+
+		double lastPassTime  { 0 }; ///< Time the last pass took, in seconds.
+		double maxPassTime   { 0 }; ///< Longest time a pass took, in seconds.
+		double totalPassTime { 0 }; ///< Time all passes took, in seconds.
+	};
+
+	/** Return statistics of the animation updates. */
+	Stats getStats();
+
 	void pause();
 	void resume();
 
@@ -79,6 +106,7 @@ private:
 
 	typedef std::map<uint32_t, PoolModel> ModelMap;
 	typedef std::queue<Model *> ModelQueue;
+	typedef std::vector<PoolModel *> JobList;
 
 	ModelMap _models;
 	ModelQueue _registerQueue;
@@ -89,6 +117,27 @@ private:
 	std::recursive_mutex _modelsMutex;   ///< Mutex protecting access to the model map.
 	std::recursive_mutex _registerMutex; ///< Mutex protecting access to the registration queue.
 
+	// Animation jobs
+
+	JobList _jobs; ///< The models to update in the current pass.
+
+	std::atomic<size_t> _nextJob { 0 };       ///< Index of the next job to claim.
+	std::atomic<size_t> _activeJobs { 0 };    ///< Number of jobs currently being evaluated.
+	std::atomic<size_t> _busyWorkers { 0 };   ///< Number of worker threads working on the current pass.
+	std::atomic<size_t> _modelsUpdated { 0 }; ///< Number of models updated in the current pass.
+
+	std::vector<std::thread> _workers;
+
+	std::mutex _jobsMutex;                  ///< Mutex protecting the start and end of a pass.
+	std::condition_variable _jobsAvailable; ///< Signals the start of a pass to the workers.
+
+	size_t _jobsGeneration { 0 };  ///< Number of the current pass.
+	bool   _jobsOpen { false };    ///< Can workers still join the current pass?
+	bool   _stopWorkers { false }; ///< Should the workers quit?
+
+	std::mutex _statsMutex; ///< Mutex protecting the statistics.
+	Stats _stats;
+
 	// Model registration
 
 	void registerQueuedModels();
@@ -96,10 +145,27 @@ private:
 	void unregisterModelInternal(Model *model);
 
 
+	// Job evaluation
+
+	void startWorkers();
+	void stopWorkers();
+
+	void workerThread();
+
+	/** Update all models that are due, spread over the worker threads. */
+	void updateModels();
+	/** Claim and evaluate jobs until there are none left. */
+	void runJobs(bool coordinator);
+	/** Update the animations of a model. */
+	void updateModel(PoolModel &model);
+
+
 	void threadMethod();
 	uint8_t getNumIterationsToSkip(Model *model) const;
 	bool handlePause();
 	void handleFlush();
+	/** Grant a requested flush, if no job is currently being evaluated. */
+	void handleFlushBetweenJobs();
 };
 
 } // End of namespace Aurora
@@ -0,0 +1,178 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Keyframes of an animated model node property.
+ */
+
+#ifndef GRAPHICS_AURORA_KEYFRAMES_H
+#define GRAPHICS_AURORA_KEYFRAMES_H
+
+#include <cmath>
+
+#include <vector>
+#include <algorithm>
+
+#include "external/glm/vec3.hpp"
+#include "external/glm/ext/quaternion_float.hpp"
+
+#include "src/common/types.h"
+#include "src/common/maths.h"
+
+namespace Graphics {
+
+namespace Aurora {
+
+/** Interpolate linearly between two positions. */
+static inline glm::vec3 interpolateKeyFrames(const glm::vec3 &last, const glm::vec3 &next, float f) {
+	return f * next + (1.0f - f) * last;
+}
+
+/** Interpolate linearly between two orientations, normalizing the result. */
+static inline glm::quat interpolateKeyFrames(const glm::quat &last, const glm::quat &next, float f) {
+	/* If the angle is > 90°, we need to flip the direction of one quaternion to
+	   get a smooth transition instead of wild jumps. */
+	const float angle = acos(last.x * next.x + last.y * next.y + last.z * next.z + last.w * next.w);
+	const float dir   = (angle >= (M_PI / 2)) ? -1.0f : 1.0f;
+
+	const float x = f * dir * next.x + (1.0f - f) * last.x;
+	const float y = f * dir * next.y + (1.0f - f) * last.y;
+	const float z = f * dir * next.z + (1.0f - f) * last.z;
+	const float q = f * dir * next.w + (1.0f - f) * last.w;
+
+	// Normalize the result for slightly better results
+	const float magnitude = sqrt(x * x + y * y + z * z + q * q);
+
+	return glm::quat(q / magnitude, x / magnitude, y / magnitude, z / magnitude);
+}
+
+/** The keyframes of one animated property of a model node.
+ *
+ *  The times and the values of the keyframes are kept in two separate
+ *  arrays, so that searching for a time only walks over the times.
+ *
+ *  The keyframes need to be added in order of ascending time.
+ */
+template<typename T>
+class KeyFrames {
+public:
+	bool empty() const {
+		return _times.empty();
+	}
+
+	size_t size() const {
+		return _times.size();
+	}
+
+	void clear() {
+		_times.clear();
+		_values.clear();
+	}
+
+	/** Add a keyframe after all existing ones. */
+	void add(float time, const T &value) {
+		_times.push_back(time);
+		_values.push_back(value);
+	}
+
+	float getTime(size_t i) const {
+		return _times[i];
+	}
+
+	const T &getValue(size_t i) const {
+		return _values[i];
+	}
+
+	T &getValue(size_t i) {
+		return _values[i];
+	}
+
+	/** Find the first keyframe at or after this time.
+	 *
+	 *  Animations mostly move forward in time in small steps, so the cursor
+	 *  remembers the result of the last search. Only if the keyframe isn't
+	 *  at or right after the cursor, for example when the animation looped
+	 *  or skipped ahead, do we fall back to a binary search.
+	 *
+	 *  @param  time   The time to look for.
+	 *  @param  cursor The result of the last search, updated to this result.
+	 *  @return The index of the keyframe, or size() if all keyframes are earlier.
+	 */
+	size_t find(float time, size_t &cursor) const {
+		const size_t count = _times.size();
+
+		if (cursor <= count) {
+			if (isAt(cursor, time))
+				return cursor;
+
+			if ((cursor < count) && isAt(cursor + 1, time))
+				return ++cursor;
+		}
+
+		cursor = std::lower_bound(_times.begin(), _times.end(), time) - _times.begin();
+		return cursor;
+	}
+
+	/** Return the value at this time, interpolating between the keyframes around it.
+	 *
+	 *  Before the first or after the last keyframe, return that keyframe's value.
+	 *
+	 *  @param  time   The time to evaluate.
+	 *  @param  cursor The search cursor, as used by find().
+	 */
+	T interpolate(float time, size_t &cursor) const {
+		// If only one keyframe, don't interpolate, just return the only value
+		if (_times.size() == 1)
+			return _values[0];
+
+		const size_t next = find(time, cursor);
+		if (next == 0)
+			return _values[0];
+		if (next >= _times.size())
+			return _values.back();
+
+		const size_t last = next - 1;
+
+		const float f = (time - _times[last]) / (_times[next] - _times[last]);
+
+		return interpolateKeyFrames(_values[last], _values[next], f);
+	}
+
+private:
+	std::vector<float> _times; ///< The times of all keyframes, in ascending order.
+	std::vector<T> _values;    ///< The values of all keyframes.
+
+	/** Is this the index of the first keyframe at or after this time? */
+	bool isAt(size_t index, float time) const {
+		if ((index > 0) && (_times[index - 1] >= time))
+			return false;
+
+		return (index == _times.size()) || (_times[index] >= time);
+	}
+};
+
+typedef KeyFrames<glm::vec3> PositionKeyFrames;
+typedef KeyFrames<glm::quat> OrientationKeyFrames;
+
+} // End of namespace Aurora
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_AURORA_KEYFRAMES_H
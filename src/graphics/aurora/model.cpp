@@ -36,6 +36,7 @@ STOP_IGNORE_IMPLICIT_FALLTHROUGH
 
 #include "src/common/readstream.h"
 #include "src/common/debug.h"
+#include "src/common/frustum.h"
 
 #include "src/graphics/camera.h"
 
@@ -159,6 +160,35 @@ bool Model::isIn(float x1, float y1, float z1, float x2, float y2, float z2) con
 	return _absoluteBoundBox.isIn(x1, y1, z1, x2, y2, z2);
 }
 
+bool Model::isInFrustum(const Common::Frustum &frustum) const {
+	if (_type == kModelTypeGUIFront)
+		return true;
+
+	// Without a bounding box, we can't tell
+	if (_absoluteBoundBox.empty())
+		return true;
+
+	float minX, minY, minZ, maxX, maxY, maxZ;
+	_absoluteBoundBox.getMin(minX, minY, minZ);
+	_absoluteBoundBox.getMax(maxX, maxY, maxZ);
+
+	/* Attached models (weapons, heads, ...) hang off our nodes, but they aren't part
+	 * of our bounding box. Grow the box by their size, so that they don't vanish
+	 * while they stick out into the view. */
+
+	float attachedSize = 0.0f;
+	for (std::map<Common::UString, Model *>::const_iterator m = _attachedModels.begin();
+	     m != _attachedModels.end(); ++m) {
+
+		const Common::BoundingBox &box = m->second->_absoluteBoundBox;
+
+		attachedSize = MAX(attachedSize, MAX(box.getWidth(), MAX(box.getHeight(), box.getDepth())));
+	}
+
+	return frustum.isIn(minX - attachedSize, minY - attachedSize, minZ - attachedSize,
+	                    maxX + attachedSize, maxY + attachedSize, maxZ + attachedSize);
+}
+
 float Model::getWidth() const {
 	return _boundBox.getWidth() * _scale[0];
 }
@@ -826,6 +856,8 @@ void Model::doDestroy() {
 }
 
 void Model::finalize() {
+	finishTextures();
+
 	_currentState = 0;
 
 	createStateNamesList();
@@ -844,6 +876,21 @@ void Model::finalize() {
 	createAbsolutePosition();
 }
 
+void Model::finishTextures() {
+	// Wait for the textures of all nodes at once, so that they're all decoded in parallel
+	std::vector<TextureHandle> textures;
+
+	for (StateList::iterator s = _stateList.begin(); s != _stateList.end(); ++s)
+		for (NodeList::iterator n = (*s)->nodeList.begin(); n != (*s)->nodeList.end(); ++n)
+			(*n)->getLoadingTextures(textures);
+
+	TextureMan.waitFor(textures);
+
+	for (StateList::iterator s = _stateList.begin(); s != _stateList.end(); ++s)
+		for (NodeList::iterator n = (*s)->nodeList.begin(); n != (*s)->nodeList.end(); ++n)
+			(*n)->finishTextures();
+}
+
 void Model::createStateNamesList(std::list<Common::UString> *stateNames) {
 	bool isRoot = false;
 
@@ -93,6 +93,9 @@ public:
 	/** Does the line from x1.y1.z1 to x2.y2.z2 intersect with model's bounding box? */
 	bool isIn(float x1, float y1, float z1, float x2, float y2, float z2) const;
 
+	/** Might the model's bounding box be visible within this view frustum? */
+	bool isInFrustum(const Common::Frustum &frustum) const;
+
 	// Positioning
 
 	/** Get the current scale of the model. */
@@ -296,6 +299,9 @@ private:
 
 	std::map<Common::UString, Model *> _attachedModels;
 
+	/** Wait for the textures of all nodes, and finish loading them. */
+	void finishTextures();
+
 	/** Create the list of all state names. */
 	void createStateNamesList(std::list<Common::UString> *stateNames = 0);
 	/** Create the model's bounding box. */
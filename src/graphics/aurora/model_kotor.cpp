@@ -684,13 +684,9 @@ void ModelNode_KotOR::readPositionController(uint8_t columnCount, uint16_t rowCo
 		case 3:
 		case 19:
 			for (int r = 0; r < rowCount; r++) {
-				PositionKeyFrame p;
-				p.time = data[timeIndex + r];
 				int index = dataIndex + (bezier ? 9 : 3) * r;
-				p.x = data[index + 0];
-				p.y = data[index + 1];
-				p.z = data[index + 2];
-				_positionFrames.push_back(p);
+				_positionFrames.add(data[timeIndex + r],
+				                    glm::vec3(data[index + 0], data[index + 1], data[index + 2]));
 			}
 			break;
 		default:
@@ -704,8 +700,7 @@ void ModelNode_KotOR::readOrientationController(uint8_t columnCount, uint16_t ro
 	switch (columnCount) {
 		case 2:
 			for (int r = 0; r < rowCount; r++) {
-				QuaternionKeyFrame q;
-				q.time = dataFloat[timeIndex + r];
+				glm::quat q;
 
 				uint32_t temp = dataInt[dataIndex + r];
 				q.x = 1.0f - static_cast<float>(temp & 0x7ff) / 1023.0f;
@@ -714,28 +709,24 @@ void ModelNode_KotOR::readOrientationController(uint8_t columnCount, uint16_t ro
 
 				float temp2 = q.x * q.x + q.y * q.y + q.z * q.z;
 				if (temp2 < 1.0f)
-					q.q = -sqrtf(1.0f - temp2);
+					q.w = -sqrtf(1.0f - temp2);
 				else {
 					temp2 = sqrtf(temp2);
 					q.x = q.x / temp2;
 					q.y = q.y / temp2;
 					q.z = q.z / temp2;
-					q.q = 0.0f;
+					q.w = 0.0f;
 				}
 
-				_orientationFrames.push_back(q);
+				_orientationFrames.add(dataFloat[timeIndex + r], q);
 			}
 			break;
 		case 4:
 			for (int r = 0; r < rowCount; r++) {
-				QuaternionKeyFrame q;
-				q.time = dataFloat[timeIndex + r];
 				int index = dataIndex + 4 * r;
-				q.x = dataFloat[index + 0];
-				q.y = dataFloat[index + 1];
-				q.z = dataFloat[index + 2];
-				q.q = dataFloat[index + 3];
-				_orientationFrames.push_back(q);
+				_orientationFrames.add(dataFloat[timeIndex + r],
+				                       glm::quat(dataFloat[index + 3], dataFloat[index + 0],
+				                                 dataFloat[index + 1], dataFloat[index + 2]));
 			}
 			break;
 		default:
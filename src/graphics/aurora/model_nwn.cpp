@@ -1011,15 +1011,14 @@ void ModelNode_NWN_Binary::readNodeControllers(Model_NWN::ParserContext &ctx,
 			if (columnCount != 3)
 				throw Common::Exception("Position controller with %d values", columnCount);
 			for (int r = 0; r < rowCount; r++) {
-				PositionKeyFrame p;
-				p.time = data[timeIndex + r];
-				p.x = data[dataIndex + (r * columnCount) + 0];
-				p.y = data[dataIndex + (r * columnCount) + 1];
-				p.z = data[dataIndex + (r * columnCount) + 2];
-				_positionFrames.push_back(p);
+				const float time = data[timeIndex + r];
+				const glm::vec3 p(data[dataIndex + (r * columnCount) + 0],
+				                  data[dataIndex + (r * columnCount) + 1],
+				                  data[dataIndex + (r * columnCount) + 2]);
+				_positionFrames.add(time, p);
 
 				// Starting position
-				if (p.time == 0.0f) {
+				if (time == 0.0f) {
 					_position[0] = p.x;
 					_position[1] = p.y;
 					_position[2] = p.z;
@@ -1035,13 +1034,11 @@ void ModelNode_NWN_Binary::readNodeControllers(Model_NWN::ParserContext &ctx,
 				throw Common::Exception("Orientation controller with %d values", columnCount);
 
 			for (int r = 0; r < rowCount; r++) {
-				QuaternionKeyFrame q;
-				q.time = data[timeIndex + r];
-				q.x = data[dataIndex + (r * columnCount) + 0];
-				q.y = data[dataIndex + (r * columnCount) + 1];
-				q.z = data[dataIndex + (r * columnCount) + 2];
-				q.q = data[dataIndex + (r * columnCount) + 3];
-				_orientationFrames.push_back(q);
+				_orientationFrames.add(data[timeIndex + r],
+				                       glm::quat(data[dataIndex + (r * columnCount) + 3],
+				                                 data[dataIndex + (r * columnCount) + 0],
+				                                 data[dataIndex + (r * columnCount) + 1],
+				                                 data[dataIndex + (r * columnCount) + 2]));
 				// Starting orientation
 				// TODO: Handle animation orientation correctly
 				if (data[timeIndex + 0] == 0.0f) {
@@ -985,6 +985,10 @@ void ModelNode_Witcher::buildMaterial() {
 
 	uint32_t textureCount = 0;
 
+	// Wait until the textures are fully loaded, the render queueing picks this up again then
+	if (_texturesLoading)
+		return;
+
 	_renderableArray.clear();
 
 	/**
@@ -89,8 +89,11 @@ ModelNode::ModelNode(Model &model) :
 		_attachedModel(0),
 		_level(0),
 		_alpha(1.0f),
+		_positionFrameCursor(0),
+		_orientationFrameCursor(0),
 		_render(false),
 		_dirtyRender(true),
+		_texturesLoading(false),
 		_mesh(0),
 		_rootStateNode(0),
 		_nodeNumber(0),
@@ -307,18 +310,14 @@ glm::vec3 ModelNode::getBasePosition() const {
 	if (_positionFrames.empty())
 		return glm::vec3();
 
-	const PositionKeyFrame &pos = _positionFrames[0];
-
-	return glm::vec3(pos.x, pos.y, pos.z);
+	return _positionFrames.getValue(0);
 }
 
 glm::quat ModelNode::getBaseOrientation() const {
 	if (_orientationFrames.empty())
 		return glm::quat();
 
-	const QuaternionKeyFrame &ori = _orientationFrames[0];
-
-	return glm::quat(ori.q, ori.x, ori.y, ori.z);
+	return _orientationFrames.getValue(0);
 }
 
 bool ModelNode::hasPositionFrames() const {
@@ -339,14 +338,11 @@ void ModelNode::setBasePosition(const glm::vec3 &pos) {
 	_positionBuffer[2] = pos.z;
 
 	if (_positionFrames.empty()) {
-		_positionFrames.push_back(PositionKeyFrame { 0.0f, pos.x, pos.y, pos.z });
+		_positionFrames.add(0.0f, pos);
 		return;
 	}
 
-	PositionKeyFrame &frame = _positionFrames[0];
-	frame.x = pos.x;
-	frame.y = pos.y;
-	frame.z = pos.z;
+	_positionFrames.getValue(0) = pos;
 }
 
 void ModelNode::setBaseOrientation(const glm::quat &ori) {
@@ -358,15 +354,11 @@ void ModelNode::setBaseOrientation(const glm::quat &ori) {
 	std::memcpy(_orientationBuffer, _orientation, 4 * sizeof(float));
 
 	if (_orientationFrames.empty()) {
-		_orientationFrames.push_back(QuaternionKeyFrame { 0.0f, ori.x, ori.y, ori.z, ori.w });
+		_orientationFrames.add(0.0f, ori);
 		return;
 	}
 
-	QuaternionKeyFrame &frame = _orientationFrames[0];
-	frame.x = ori.x;
-	frame.y = ori.y;
-	frame.z = ori.z;
-	frame.q = ori.w;
+	_orientationFrames.getValue(0) = ori;
 }
 
 void ModelNode::inheritPosition(ModelNode &node) const {
@@ -414,6 +406,7 @@ void ModelNode::setTextures(const std::vector<Common::UString> &textures) {
 	//       again when texture loading fails.
 	_render = true;
 	loadTextures(textures);
+	finishTextures();
 
 	unlockFrameIfVisible();
 }
@@ -450,42 +443,85 @@ void ModelNode::setAlpha(float alpha, bool isRecursive) {
 void ModelNode::loadTextures(const std::vector<Common::UString> &textures) {
 	bool hasTexture = false;
 
+	_mesh->data->textures.clear();
 	_mesh->data->textures.resize(textures.size());
 
-	bool hasAlpha = true;
-	bool isDecal  = true;
+	// Only start decoding the textures here. The whole model waits for them at once, in finishTextures()
+	for (size_t t = 0; t != textures.size(); t++) {
+		try {
+			if (!textures[t].empty() && (textures[t] != "NULL"))
+				_mesh->data->textures[t] = TextureMan.getAsync(textures[t]);
 
-	Common::UString envMap;
+			if (!_mesh->data->textures[t].empty())
+				hasTexture = true;
 
-	for (size_t t = 0; t != textures.size(); t++) {
+		} catch (...) {
+			Common::exceptionDispatcherWarning();
+		}
+	}
 
-		try {
+	_texturesLoading = true;
 
-			if (!textures[t].empty() && (textures[t] != "NULL")) {
-				_mesh->data->textures[t] = TextureMan.get(textures[t]);
-				if (_mesh->data->textures[t].empty())
-					continue;
+	_dirtyRender = true;
+	// If the node has no actual texture, we just assume
+	// that the geometry shouldn't be rendered.
+	if (!hasTexture)
+		_render = false;
+}
 
-				hasTexture = true;
+void ModelNode::getLoadingTextures(std::vector<TextureHandle> &textures) const {
+	if (!_texturesLoading)
+		return;
 
-				if (!_mesh->data->textures[t].getTexture().hasAlpha())
-					hasAlpha = false;
-				if (_mesh->data->textures[t].getTexture().getTXI().getFeatures().alphaMean == 1.0f)
-					hasAlpha = false;
+	textures.insert(textures.end(), _mesh->data->textures.begin(), _mesh->data->textures.end());
+}
 
-				if (!_mesh->data->textures[t].getTexture().getTXI().getFeatures().decal)
-					isDecal = false;
+void ModelNode::finishTextures() {
+	if (!_texturesLoading)
+		return;
 
-				if (!_mesh->data->textures[t].getTexture().getTXI().getFeatures().bumpyShinyTexture.empty())
-					envMap = _mesh->data->textures[t].getTexture().getTXI().getFeatures().bumpyShinyTexture;
-				if (!_mesh->data->textures[t].getTexture().getTXI().getFeatures().envMapTexture.empty())
-					envMap = _mesh->data->textures[t].getTexture().getTXI().getFeatures().envMapTexture;
-			}
+	_texturesLoading = false;
+
+	bool hasTexture = false;
+
+	bool hasAlpha = true;
+	bool isDecal  = true;
+
+	Common::UString envMap;
+
+	for (size_t t = 0; t != _mesh->data->textures.size(); t++) {
+		TextureHandle &texture = _mesh->data->textures[t];
+		if (texture.empty())
+			continue;
 
+		try {
+			TextureMan.waitFor(texture);
 		} catch (...) {
+			texture.clear();
+
 			Common::exceptionDispatcherWarning();
+			continue;
 		}
 
+		hasTexture = true;
+
+		// The image might not have been swapped in yet, so ask for the properties it will have
+		bool alpha;
+		TXI::Features features;
+		texture.getTexture().getProperties(alpha, features);
+
+		if (!alpha)
+			hasAlpha = false;
+		if (features.alphaMean == 1.0f)
+			hasAlpha = false;
+
+		if (!features.decal)
+			isDecal = false;
+
+		if (!features.bumpyShinyTexture.empty())
+			envMap = features.bumpyShinyTexture;
+		if (!features.envMapTexture.empty())
+			envMap = features.envMapTexture;
 	}
 
 	envMap.trim();
@@ -506,8 +542,6 @@ void ModelNode::loadTextures(const std::vector<Common::UString> &textures) {
 	}
 
 	_dirtyRender = true;
-	// If the node has no actual texture, we just assume
-	// that the geometry shouldn't be rendered.
 	if (!hasTexture)
 		_render = false;
 }
@@ -1063,16 +1097,16 @@ void ModelNode::computeLocalBaseTransform() {
 	_localBaseTransform = glm::mat4();
 
 	if (_positionFrames.size() > 0) {
-		const PositionKeyFrame &pos = _positionFrames[0];
-		_localBaseTransform = glm::translate(_localBaseTransform, glm::vec3(pos.x, pos.y, pos.z));
+		const glm::vec3 &pos = _positionFrames.getValue(0);
+		_localBaseTransform = glm::translate(_localBaseTransform, pos);
 	}
 
 	if (_orientationFrames.size() > 0) {
-		const QuaternionKeyFrame &ori = _orientationFrames[0];
+		const glm::quat &ori = _orientationFrames.getValue(0);
 		if ((ori.x != 0.0f) || (ori.y != 0.0f) || (ori.z != 0.0f)) {
 			_localBaseTransform = glm::rotate(
 					_localBaseTransform,
-					acosf(ori.q) * 2.0f,
+					acosf(ori.w) * 2.0f,
 					glm::vec3(ori.x, ori.y, ori.z));
 		}
 	}
@@ -1177,6 +1211,10 @@ TextureHandle *ModelNode::getEnvironmentMap(EnvironmentMapMode &mode) {
 }
 
 void ModelNode::buildMaterial() {
+	// Wait until the textures are fully loaded, the render queueing picks this up again then
+	if (_texturesLoading)
+		return;
+
 	_renderableArray.clear();
 
 	/**
@@ -39,6 +39,7 @@
 
 #include "src/graphics/aurora/types.h"
 #include "src/graphics/aurora/texturehandle.h"
+#include "src/graphics/aurora/keyframes.h"
 
 #include "src/graphics/mesh/meshman.h"
 #include "src/graphics/shader/shaderrenderable.h"
@@ -49,21 +50,6 @@ namespace Aurora {
 
 class Model;
 
-struct PositionKeyFrame {
-	float time;
-	float x;
-	float y;
-	float z;
-};
-
-struct QuaternionKeyFrame {
-	float time;
-	float x;
-	float y;
-	float z;
-	float q;
-};
-
 class ModelNode {
 public:
 	ModelNode(Model &model);
@@ -276,8 +262,13 @@ protected:
 
 	float _alpha;          ///< Alpha of the node, used if no _mesh is present in this node.
 
-	std::vector<PositionKeyFrame> _positionFrames;      ///< Keyframes for position animation.
-	std::vector<QuaternionKeyFrame> _orientationFrames; ///< Keyframes for orientation animation.
+	PositionKeyFrames    _positionFrames;    ///< Keyframes for position animation.
+	OrientationKeyFrames _orientationFrames; ///< Keyframes for orientation animation.
+
+	/** Where the last animation of this node found its position keyframe. */
+	size_t _positionFrameCursor;
+	/** Where the last animation of this node found its orientation keyframe. */
+	size_t _orientationFrameCursor;
 
 	/** Position of the node after translate/rotate. */
 	glm::mat4 _absolutePosition;
@@ -285,6 +276,7 @@ protected:
 
 	bool _render; ///< Render the node?
 	bool _dirtyRender; ///< Rendering information needs updating.
+	bool _texturesLoading; ///< Are the textures still waiting for finishTextures()?
 
 	Mesh *_mesh;
 	ModelNode *_rootStateNode;
@@ -321,7 +313,12 @@ protected:
 	Shader::ShaderRenderable *_shaderRenderable;
 
 	// Loading helpers
+	/** Start loading these textures, decoding them in the background. */
 	void loadTextures(const std::vector<Common::UString> &textures);
+	/** Add the textures still waiting for finishTextures() to the list. */
+	void getLoadingTextures(std::vector<TextureHandle> &textures) const;
+	/** Wait for the textures to be decoded, and evaluate their properties. */
+	void finishTextures();
 	void createBound();
 	void createCenter();
 
@@ -41,6 +41,7 @@ src_graphics_libgraphics_la_SOURCES += \
     src/graphics/aurora/guiquad.h \
     src/graphics/aurora/highlightableguiquad.h \
     src/graphics/aurora/geometryobject.h \
+    src/graphics/aurora/keyframes.h \
     src/graphics/aurora/modelnode.h \
     src/graphics/aurora/model.h \
     src/graphics/aurora/animnode.h \
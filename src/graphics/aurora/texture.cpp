@@ -23,6 +23,7 @@
  */
 
 #include <cassert>
+#include <cstring>
 
 #include "src/common/types.h"
 #include "src/common/util.h"
@@ -55,12 +56,35 @@ namespace Graphics {
 
 namespace Aurora {
 
-Texture::Texture() : _type(::Aurora::kFileTypeNone), _width(0), _height(0), _deswizzle(false) {
+/** A single white pixel, shown while a texture's real image is still being decoded. */
+class PlaceholderImage : public ImageDecoder {
+public:
+	PlaceholderImage() {
+		_format    = kPixelFormatRGBA;
+		_formatRaw = kPixelFormatRGBA8;
+		_dataType  = kPixelDataType8;
+
+		_mipMaps.emplace_back(std::make_unique<MipMap>(this));
+		MipMap &mipMap = *_mipMaps.back();
+
+		mipMap.width  = 1;
+		mipMap.height = 1;
+		mipMap.size   = 4;
+
+		mipMap.data = std::make_unique<byte[]>(mipMap.size);
+		std::memset(mipMap.data.get(), 0xFF, mipMap.size);
+	}
+};
+
+
+Texture::Texture() : _type(::Aurora::kFileTypeNone), _width(0), _height(0), _deswizzle(false),
+	_pendingType(::Aurora::kFileTypeNone) {
 }
 
 Texture::Texture(const Common::UString &name, ImageDecoder *image,
                  ::Aurora::FileType type, TXI *txi, bool deswizzle) :
-	_name(name), _type(type), _width(0), _height(0), _deswizzle(deswizzle) {
+	_name(name), _type(type), _width(0), _height(0), _deswizzle(deswizzle),
+	_pendingType(::Aurora::kFileTypeNone) {
 
 	set(name, image, type, txi, deswizzle);
 	addToQueues();
@@ -153,6 +177,8 @@ void Texture::doDestroy() {
 }
 
 void Texture::doRebuild() {
+	applyPendingImage();
+
 	if (!_image)
 		// No image
 		return;
@@ -323,49 +349,28 @@ Texture *Texture::createPLT(const Common::UString &name, Common::SeekableReadStr
 Texture *Texture::create(const Common::UString &name, bool deswizzle) {
 	::Aurora::FileType type = ::Aurora::kFileTypeNone;
 	ImageDecoder *image = 0;
-	ImageDecoder *layers[6] = { 0, 0, 0, 0, 0, 0 };
 	TXI *txi = 0;
 
 	try {
 		txi = loadTXI(name);
 
-		const bool isFileCubeMap = txi && txi->getFeatures().cube && (txi->getFeatures().fileRange == 6);
-		if (isFileCubeMap) {
-			// A cube map with each side a separate image file
-
-			for (size_t i = 0; i < 6; i++) {
-				const Common::UString side = name + Common::composeString(i);
-				Common::SeekableReadStream *imageStream = ResMan.getResource(::Aurora::kResourceImage, side, &type);
-				if (!imageStream)
-					throw Common::Exception("No such cube side image resource \"%s\"", side.c_str());
-
-				layers[i] = loadImage(imageStream, type, txi, deswizzle);
-			}
-
-			image = new CubeMapCombiner(layers);
-
-		} else {
-			Common::SeekableReadStream *imageStream = ResMan.getResource(::Aurora::kResourceImage, name, &type);
-			if (!imageStream)
-				throw Common::Exception("No such image resource \"%s\"", name.c_str());
-
-			// PLT needs extra handling, since they're their own Texture class
-			if (type == ::Aurora::kFileTypePLT) {
-				delete txi;
+		ImageStreams streams;
+		openImage(name, txi, type, streams);
 
-				return createPLT(name, imageStream);
-			}
+		// PLT needs extra handling, since they're their own Texture class
+		if ((streams.size() == 1) && (type == ::Aurora::kFileTypePLT)) {
+			delete txi;
+			txi = 0;
 
-			image = loadImage(imageStream, type, txi, deswizzle);
+			return createPLT(name, streams[0].release());
 		}
 
+		image = loadImage(streams, type, txi, deswizzle);
+
 	} catch (Common::Exception &e) {
 		delete txi;
 		delete image;
 
-		for (size_t i = 0; i < ARRAYSIZE(layers); i++)
-			delete layers[i];
-
 		e.add("Failed to create texture \"%s\" (%d)", name.c_str(), type);
 		throw;
 	}
@@ -373,6 +378,10 @@ Texture *Texture::create(const Common::UString &name, bool deswizzle) {
 	return new Texture(name, image, type, txi, deswizzle);
 }
 
+Texture *Texture::createPlaceholder(const Common::UString &name, TXI *txi, bool deswizzle) {
+	return new Texture(name, new PlaceholderImage, ::Aurora::kFileTypeNone, txi, deswizzle);
+}
+
 Texture *Texture::create(ImageDecoder *image, ::Aurora::FileType type, TXI *txi, bool deswizzle) {
 	if (!image)
 		throw Common::Exception("Can't create a texture from an empty image");
@@ -419,6 +428,47 @@ void Texture::refresh() {
 	addToQueues();
 }
 
+void Texture::setPendingImage(ImageDecoder *image, ::Aurora::FileType type, TXI *txi) {
+	{
+		std::lock_guard<std::mutex> lock(_pendingMutex);
+
+		_pendingImage.reset(image);
+		_pendingTXI.reset(txi);
+		_pendingType = type;
+	}
+
+	addToQueue(kQueueNewTexture);
+}
+
+bool Texture::applyPendingImage() {
+	// Swapped while locked, so that getProperties() never sees a half-set texture
+	std::lock_guard<std::mutex> lock(_pendingMutex);
+	if (!_pendingImage)
+		return false;
+
+	set(_name, _pendingImage.release(), _pendingType, _pendingTXI.release(), _deswizzle);
+	return true;
+}
+
+bool Texture::hasPendingImage() {
+	std::lock_guard<std::mutex> lock(_pendingMutex);
+
+	return _pendingImage.get() != 0;
+}
+
+void Texture::getProperties(bool &alpha, TXI::Features &features) {
+	std::lock_guard<std::mutex> lock(_pendingMutex);
+
+	if (!_pendingImage) {
+		alpha    = hasAlpha();
+		features = getTXI().getFeatures();
+		return;
+	}
+
+	alpha    = _pendingImage->hasAlpha();
+	features = _pendingTXI ? _pendingTXI->getFeatures() : _pendingImage->getTXI().getFeatures();
+}
+
 ImageDecoder *Texture::loadImage(const Common::UString &name, ::Aurora::FileType &type, bool deswizzle) {
 	return loadImage(name, type, 0, deswizzle);
 }
@@ -426,26 +476,45 @@ ImageDecoder *Texture::loadImage(const Common::UString &name, ::Aurora::FileType
 ImageDecoder *Texture::loadImage(const Common::UString &name, ::Aurora::FileType &type,
                                  TXI *txi, bool deswizzle) {
 
+	ImageStreams streams;
+	openImage(name, txi, type, streams);
+
+	return loadImage(streams, type, txi, deswizzle);
+}
+
+void Texture::openImage(const Common::UString &name, const TXI *txi, ::Aurora::FileType &type,
+                        ImageStreams &streams) {
+
 	const bool isFileCubeMap = txi && txi->getFeatures().cube && (txi->getFeatures().fileRange == 6);
 	if (!isFileCubeMap) {
-		Common::SeekableReadStream *imageStream = ResMan.getResource(::Aurora::kResourceImage, name, &type);
-		if (!imageStream)
+		streams.emplace_back(ResMan.getResource(::Aurora::kResourceImage, name, &type));
+		if (!streams.back())
 			throw Common::Exception("No such image resource \"%s\"", name.c_str());
 
-		return loadImage(imageStream, type, txi, deswizzle);
+		return;
 	}
 
+	for (size_t i = 0; i < 6; i++) {
+		const Common::UString side = name + Common::composeString(i);
+
+		streams.emplace_back(ResMan.getResource(::Aurora::kResourceImage, side, &type));
+		if (!streams.back())
+			throw Common::Exception("No such cube side image resource \"%s\"", side.c_str());
+	}
+}
+
+ImageDecoder *Texture::loadImage(ImageStreams &streams, ::Aurora::FileType type, TXI *txi, bool deswizzle) {
+	if (streams.size() == 1)
+		return loadImage(streams[0].release(), type, txi, deswizzle);
+
+	if (streams.size() != 6)
+		throw Common::Exception("Invalid number of image resources (%u)", (uint) streams.size());
+
 	ImageDecoder *layers[6] = { 0, 0, 0, 0, 0, 0 };
 
 	try {
-		for (size_t i = 0; i < 6; i++) {
-			const Common::UString side = name + Common::composeString(i);
-			Common::SeekableReadStream *imageStream = ResMan.getResource(::Aurora::kResourceImage, side, &type);
-			if (!imageStream)
-				throw Common::Exception("No such cube side image resource \"%s\"", side.c_str());
-
-			layers[i] = loadImage(imageStream, type, txi, deswizzle);
-		}
+		for (size_t i = 0; i < 6; i++)
+			layers[i] = loadImage(streams[i].release(), type, txi, deswizzle);
 
 		return new CubeMapCombiner(layers);
 
@@ -26,12 +26,16 @@
 #define GRAPHICS_AURORA_TEXTURE_H
 
 #include <memory>
+#include <vector>
+#include <mutex>
 
 #include "src/common/ustring.h"
 
 #include "src/graphics/types.h"
 #include "src/graphics/texture.h"
 
+#include "src/graphics/images/txi.h"
+
 #include "src/aurora/types.h"
 
 namespace Common {
@@ -41,7 +45,6 @@ namespace Common {
 namespace Graphics {
 
 class ImageDecoder;
-class TXI;
 
 namespace Aurora {
 
@@ -63,6 +66,14 @@ public:
 	/** Return the image. */
 	const ImageDecoder &getImage() const;
 
+	/** Return whether the texture has alpha, and its TXI features.
+	 *
+	 *  If a decoded image is still waiting to be swapped in, these are the
+	 *  properties it will have. Unlike hasAlpha() and getTXI(), this can be
+	 *  called from any thread.
+	 */
+	void getProperties(bool &alpha, TXI::Features &features);
+
 	/** Try to reload the texture. */
 	virtual bool reload();
 
@@ -95,6 +106,11 @@ protected:
 
 	bool _deswizzle;
 
+	std::mutex _pendingMutex;                    ///< Protects the pending image.
+	std::unique_ptr<ImageDecoder> _pendingImage; ///< A decoded image waiting to replace the current one.
+	std::unique_ptr<TXI> _pendingTXI;            ///< The TXI belonging to the pending image.
+	::Aurora::FileType _pendingType;             ///< The type of the pending image's file.
+
 
 	Texture();
 	Texture(const Common::UString &name, ImageDecoder *image, ::Aurora::FileType type, TXI *txi = 0,
@@ -107,6 +123,19 @@ protected:
 	void removeFromQueues();
 	void refresh();
 
+	/** Hand over a decoded image, to replace the current one with on the next rebuild.
+	 *
+	 *  Can be called from any thread.
+	 */
+	void setPendingImage(ImageDecoder *image, ::Aurora::FileType type, TXI *txi);
+	/** Replace the current image with the pending one, if there is one.
+	 *
+	 *  Must only be called from the main thread, or while the frame is locked.
+	 */
+	bool applyPendingImage();
+	/** Is there a decoded image waiting to replace the current one? */
+	bool hasPendingImage();
+
 
 	// GLContainer
 	void doRebuild();
@@ -122,7 +151,18 @@ protected:
 	void setMipMaps(GLenum target);
 	void setMipMapData(GLenum target, size_t layer, size_t mipMap);
 
+	/** The opened image resources of a texture. */
+	typedef std::vector<std::unique_ptr<Common::SeekableReadStream>> ImageStreams;
+
 	static TXI *loadTXI(const Common::UString &name);
+
+	/** Open the image resources of a texture: a single one, or one per side for file cube maps. */
+	static void openImage(const Common::UString &name, const TXI *txi, ::Aurora::FileType &type,
+	                      ImageStreams &streams);
+	/** Decode the image out of previously opened image resources, taking them over. */
+	static ImageDecoder *loadImage(ImageStreams &streams, ::Aurora::FileType type, TXI *txi,
+	                               bool deswizzle = false);
+
 	static ImageDecoder *loadImage(Common::SeekableReadStream *imageStream, ::Aurora::FileType type,
 	                               TXI *txi = 0, bool deswizzle = false);
 
@@ -130,6 +170,11 @@ protected:
 	                               bool deswizzle = false);
 
 	static Texture *createPLT(const Common::UString &name, Common::SeekableReadStream *imageStream);
+
+	/** Create a texture showing a placeholder image, until its real image has been decoded. */
+	static Texture *createPlaceholder(const Common::UString &name, TXI *txi, bool deswizzle = false);
+
+	friend class TextureManager;
 };
 
 } // End of namespace Aurora
@@ -23,15 +23,19 @@
  */
 
 #include <memory>
+#include <chrono>
 
 #include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/uuid.h"
+#include "src/common/readstream.h"
+#include "src/common/thread.h"
 
 #include "src/graphics/aurora/textureman.h"
 #include "src/graphics/aurora/texture.h"
 
 #include "src/graphics/images/decoder.h"
+#include "src/graphics/images/txi.h"
 
 #include "src/graphics/graphics.h"
 
@@ -80,17 +84,35 @@ static GLenum kTextureUnit[] = {
 
 static const size_t kTextureUnitCount = ARRAYSIZE(kTextureUnit);
 
+/** The maximum number of threads decoding images in the background. */
+static const size_t kMaxDecodeThreads = 4;
 
-TextureManager::TextureManager() : _deswizzleSBM(false), _recordNewTextures(false) {
+
+TextureManager::TextureManager() : _deswizzleSBM(false), _recordNewTextures(false), _decodeQuit(false) {
 }
 
 TextureManager::~TextureManager() {
 	clear();
+
+	stopDecodeThreads();
 }
 
 void TextureManager::clear() {
 	std::lock_guard<std::recursive_mutex> lock(_mutex);
 
+	// Throw away all waiting jobs. Jobs already being decoded are discarded once they're done
+	{
+		std::lock_guard<std::mutex> decodeLock(_decodeMutex);
+		_decodeQueue.clear();
+
+		for (DecodeJobs::iterator j = _decodeJobs.begin(); j != _decodeJobs.end(); ++j) {
+			j->second->texture   = 0;
+			j->second->cancelled = true;
+		}
+	}
+
+	_decodeJobs.clear();
+
 	_bogusTextures.clear();
 
 	for (TextureMap::iterator t = _textures.begin(); t != _textures.end(); ++t)
@@ -151,7 +173,7 @@ TextureHandle TextureManager::add(Texture *texture, Common::UString name) {
 }
 
 TextureHandle TextureManager::get(Common::UString name) {
-	std::lock_guard<std::recursive_mutex> lock(_mutex);
+	std::unique_lock<std::recursive_mutex> lock(_mutex);
 
 	if (_bogusTextures.find(name) != _bogusTextures.end())
 		return TextureHandle();
@@ -170,10 +192,26 @@ TextureHandle TextureManager::get(Common::UString name) {
 		texture = result.first;
 	}
 
+	TextureHandle handle(texture);
+
+	// The texture might still be decoding in the background
+	waitForDecode(handle.getTexture());
+
 	if (_recordNewTextures)
 		_newTextureNames.push_back(name);
 
-	return TextureHandle(texture);
+	/* Our caller wants the real image right away, so swap it in while no frame is
+	 * rendered. Our lock is released meanwhile, so that we don't block the main
+	 * thread waiting on us. The handle keeps the texture alive. */
+	if (handle.getTexture().hasPendingImage()) {
+		lock.unlock();
+
+		GfxMan.lockFrame();
+		handle.getTexture().applyPendingImage();
+		GfxMan.unlockFrame();
+	}
+
+	return handle;
 }
 
 TextureHandle TextureManager::getIfExist(const Common::UString &name) {
@@ -189,6 +227,257 @@ TextureHandle TextureManager::getIfExist(const Common::UString &name) {
 	return TextureHandle();
 }
 
+TextureHandle TextureManager::getAsync(const Common::UString &name) {
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+	if (_bogusTextures.find(name) != _bogusTextures.end())
+		return TextureHandle();
+
+	TextureMap::iterator texture = _textures.find(name);
+	if (texture != _textures.end()) {
+		// A texture that failed to decode fails for everybody
+		DecodeJobs::const_iterator j = _decodeJobs.find(texture->second->texture);
+		if (j != _decodeJobs.end()) {
+			std::lock_guard<std::mutex> decodeLock(_decodeMutex);
+
+			if (j->second->error)
+				std::rethrow_exception(j->second->error);
+		}
+
+		if (_recordNewTextures)
+			_newTextureNames.push_back(name);
+
+		return TextureHandle(texture);
+	}
+
+	std::shared_ptr<DecodeJob> job = std::make_shared<DecodeJob>();
+
+	job->deswizzle = _deswizzleSBM;
+
+	// The resources are opened here, since the resource manager isn't thread-safe
+	try {
+		job->txi.reset(Texture::loadTXI(name));
+
+		Texture::openImage(name, job->txi.get(), job->type, job->streams);
+	} catch (Common::Exception &e) {
+		e.add("Failed to create texture \"%s\" (%d)", name.c_str(), job->type);
+		throw;
+	}
+
+	// PLT are their own dynamic Texture class, so we can't decode them in the background
+	if (job->type == ::Aurora::kFileTypePLT) {
+		job.reset();
+
+		return get(name);
+	}
+
+	// The placeholder gets a copy of the TXI, to give the real image's properties early
+	std::unique_ptr<ManagedTexture> managedTexture =
+		std::make_unique<ManagedTexture>(Texture::createPlaceholder(name, job->txi ? new TXI(*job->txi) : 0,
+		                                                            job->deswizzle));
+
+	job->texture = managedTexture->texture;
+
+	texture = _textures.insert(std::make_pair(name, managedTexture.get())).first;
+	managedTexture.release();
+
+	_decodeJobs.insert(std::make_pair(job->texture, job));
+
+	startDecodeThreads();
+
+	{
+		std::lock_guard<std::mutex> decodeLock(_decodeMutex);
+
+		_decodeQueue.push_back(job);
+		_decodeStats.maxQueueDepth = MAX(_decodeStats.maxQueueDepth, _decodeQueue.size());
+	}
+
+	_decodeAvailable.notify_one();
+
+	if (_recordNewTextures)
+		_newTextureNames.push_back(name);
+
+	return TextureHandle(texture);
+}
+
+void TextureManager::waitFor(const TextureHandle &handle) {
+	if (handle.empty())
+		return;
+
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+	waitForDecode(handle.getTexture());
+}
+
+void TextureManager::waitFor(const std::vector<TextureHandle> &handles) {
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+	// Several handles can share a texture, so collect the jobs by texture
+	DecodeJobs jobs;
+	for (std::vector<TextureHandle>::const_iterator h = handles.begin(); h != handles.end(); ++h) {
+		if (h->empty())
+			continue;
+
+		DecodeJobs::const_iterator j = _decodeJobs.find(&h->getTexture());
+		if (j != _decodeJobs.end())
+			jobs.insert(*j);
+	}
+
+	if (jobs.empty())
+		return;
+
+	std::unique_lock<std::mutex> decodeLock(_decodeMutex);
+
+	for (DecodeJobs::const_iterator j = jobs.begin(); j != jobs.end(); ++j) {
+		const std::shared_ptr<DecodeJob> &job = j->second;
+
+		_decodeFinished.wait(decodeLock, [&job]() { return job->done; });
+	}
+
+	// Failed jobs stay, so that the error is reported to everybody asking for the texture
+	for (DecodeJobs::const_iterator j = jobs.begin(); j != jobs.end(); ++j)
+		if (!j->second->error)
+			_decodeJobs.erase(j->first);
+}
+
+void TextureManager::waitForDecode(const Texture &texture) {
+	DecodeJobs::iterator j = _decodeJobs.find(&texture);
+	if (j == _decodeJobs.end())
+		return;
+
+	std::exception_ptr error;
+
+	{
+		const std::shared_ptr<DecodeJob> &job = j->second;
+
+		std::unique_lock<std::mutex> decodeLock(_decodeMutex);
+		_decodeFinished.wait(decodeLock, [&job]() { return job->done; });
+
+		error = job->error;
+	}
+
+	// A failed job stays, so that the error is reported to everybody asking for the texture
+	if (error)
+		std::rethrow_exception(error);
+
+	_decodeJobs.erase(j);
+}
+
+void TextureManager::cancelDecode(const Texture &texture) {
+	DecodeJobs::iterator j = _decodeJobs.find(&texture);
+	if (j == _decodeJobs.end())
+		return;
+
+	{
+		std::lock_guard<std::mutex> decodeLock(_decodeMutex);
+
+		j->second->texture   = 0;
+		j->second->cancelled = true;
+	}
+
+	_decodeJobs.erase(j);
+}
+
+TextureManager::DecodeStats TextureManager::getDecodeStats() {
+	std::lock_guard<std::mutex> lock(_decodeMutex);
+
+	DecodeStats stats = _decodeStats;
+
+	stats.workers    = _decodeThreads.size();
+	stats.queueDepth = _decodeQueue.size();
+
+	return stats;
+}
+
+void TextureManager::startDecodeThreads() {
+	if (!_decodeThreads.empty())
+		return;
+
+	const size_t count = CLIP<size_t>(std::thread::hardware_concurrency(), 1, kMaxDecodeThreads);
+
+	_decodeQuit = false;
+	for (size_t i = 0; i < count; i++)
+		_decodeThreads.emplace_back(&TextureManager::decodeThread, this);
+}
+
+void TextureManager::stopDecodeThreads() {
+	{
+		std::lock_guard<std::mutex> lock(_decodeMutex);
+		_decodeQuit = true;
+	}
+
+	_decodeAvailable.notify_all();
+
+	for (std::vector<std::thread>::iterator t = _decodeThreads.begin(); t != _decodeThreads.end(); ++t)
+		t->join();
+
+	_decodeThreads.clear();
+}
+
+void TextureManager::decodeThread() {
+	Common::Thread::setCurrentThreadName("TextureDecoder");
+
+	while (true) {
+		std::shared_ptr<DecodeJob> job;
+
+		{
+			std::unique_lock<std::mutex> lock(_decodeMutex);
+
+			_decodeAvailable.wait(lock, [this]() { return _decodeQuit || !_decodeQueue.empty(); });
+			if (_decodeQuit)
+				return;
+
+			job = _decodeQueue.front();
+			_decodeQueue.pop_front();
+		}
+
+		decode(*job);
+	}
+}
+
+void TextureManager::decode(DecodeJob &job) {
+	std::unique_ptr<ImageDecoder> image;
+	std::exception_ptr error;
+
+	std::chrono::duration<double> time(0.0);
+
+	if (!job.cancelled) {
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		try {
+			image.reset(Texture::loadImage(job.streams, job.type, job.txi.get(), job.deswizzle));
+
+			// Generate the missing mip maps here instead of having the GL do it on the main thread
+			image->generateMipMaps();
+
+		} catch (...) {
+			image.reset();
+			error = std::current_exception();
+		}
+
+		time = std::chrono::steady_clock::now() - start;
+	}
+
+	std::lock_guard<std::mutex> lock(_decodeMutex);
+
+	if (image || error) {
+		DecodeFormatStats &stats = _decodeStats.formats[job.type];
+
+		stats.count  += image ? 1 : 0;
+		stats.failed += image ? 0 : 1;
+		stats.time   += time.count();
+	}
+
+	// The texture is only removed with _decodeMutex held, so it can't vanish while we hand over the image
+	if (job.texture && image)
+		job.texture->setPendingImage(image.release(), job.type, job.txi.release());
+
+	job.error = error;
+	job.done  = true;
+
+	_decodeFinished.notify_all();
+}
+
 void TextureManager::startRecordNewTextures() {
 	std::lock_guard<std::recursive_mutex> lock(_mutex);
 
@@ -220,6 +509,8 @@ void TextureManager::release(TextureHandle &texture) {
 
 	if (!texture._empty && (texture._it != _textures.end())) {
 		if (--texture._it->second->referenceCount == 0) {
+			cancelDecode(*texture._it->second->texture);
+
 			delete texture._it->second;
 			_textures.erase(texture._it);
 		}
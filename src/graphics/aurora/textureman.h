@@ -27,16 +27,32 @@
 
 #include <set>
 #include <list>
+#include <map>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <condition_variable>
 
 #include "src/common/types.h"
 #include "src/common/singleton.h"
 #include "src/common/ustring.h"
 #include "src/common/mutex.h"
 
+#include "src/aurora/types.h"
+
 #include "src/graphics/aurora/texturehandle.h"
 
+namespace Common {
+	class SeekableReadStream;
+}
+
 namespace Graphics {
 
+class TXI;
+
 namespace Aurora {
 
 /** The global Aurora texture manager. */
@@ -48,6 +64,22 @@ public:
 		kModeEnvironmentMapReflective ///< A reflective environment map.
 	};
 
+	/** Statistics of decoding images of a specific file type in the background. */
+	struct DecodeFormatStats {
+		size_t count  { 0 }; ///< Number of decoded images.
+		size_t failed { 0 }; ///< Number of images that failed to decode.
+		double time   { 0 }; ///< Total time spent decoding, in seconds.
+	};
+
+	/** Statistics of the background texture decoding. */
+	struct DecodeStats {
+		size_t workers       { 0 }; ///< Number of decoding worker threads.
+		size_t queueDepth    { 0 }; ///< Number of images currently waiting to be decoded.
+		size_t maxQueueDepth { 0 }; ///< Largest number of images ever waiting at once.
+
+		std::map<::Aurora::FileType, DecodeFormatStats> formats; ///< Statistics per image file type.
+	};
+
 	TextureManager();
 	~TextureManager();
 
@@ -81,6 +113,38 @@ public:
 	/** Retrieve this named texture, returning an empty handle if it's not managed. */
 	TextureHandle getIfExist(const Common::UString &name);
 
+	/** Retrieve this named texture, decoding its image in the background if it's not yet managed.
+	 *
+	 *  The image resources are opened right away, but the decoding, including a manual
+	 *  decompression and the generation of missing mip maps, is done by a pool of worker
+	 *  threads. Until then, the texture shows a placeholder image. Once decoded, the image
+	 *  is swapped in and uploaded by the main thread.
+	 *
+	 *  Since the image, and with it the texture's size, alpha and TXI, changes later on, only
+	 *  use this for textures whose properties aren't needed right away. Otherwise, call
+	 *  waitFor() and then read them with Texture::getProperties(). get() on the same
+	 *  texture waits and swaps in the image right away.
+	 *
+	 *  PLT textures can't be decoded in the background and are loaded like with get().
+	 */
+	TextureHandle getAsync(const Common::UString &name);
+	/** Wait for the background decoding of this texture to finish.
+	 *
+	 *  The decoded image is not swapped in here, that's left to the main thread.
+	 *
+	 *  If the decoding failed, the exception is rethrown here, and on every later get(),
+	 *  getAsync() and waitFor() of this texture, for as long as the texture exists.
+	 */
+	void waitFor(const TextureHandle &handle);
+	/** Wait for the background decoding of all these textures to finish.
+	 *
+	 *  Unlike waitFor() on a single texture, failed decodings aren't reported here.
+	 */
+	void waitFor(const std::vector<TextureHandle> &handles);
+
+	/** Return the statistics of the background texture decoding. */
+	DecodeStats getDecodeStats();
+
 	/** Start recording all names of newly created textures. */
 	void startRecordNewTextures();
 	/** Stop the recording of texture names, and return a list of previously recorded names. */
@@ -113,6 +177,53 @@ private:
 	bool _recordNewTextures;
 	std::list<Common::UString> _newTextureNames;
 
+	// .--- Background decoding
+	/** An image waiting to be decoded by a worker thread. */
+	struct DecodeJob {
+		/** The texture to hand the image to. Protected by _decodeMutex; 0 when cancelled. */
+		Texture *texture { nullptr };
+		std::atomic<bool> cancelled { false }; ///< Don't bother decoding anymore.
+		bool done { false };                   ///< Finished decoding. Protected by _decodeMutex.
+
+		std::vector<std::unique_ptr<Common::SeekableReadStream>> streams; ///< The image resources.
+
+		::Aurora::FileType type { ::Aurora::kFileTypeNone }; ///< The image's file type.
+		std::unique_ptr<TXI> txi;                            ///< The texture's TXI.
+		bool deswizzle { false };                            ///< Deswizzle SBM images?
+
+		std::exception_ptr error; ///< The reason the decoding failed. Protected by _decodeMutex.
+	};
+
+	typedef std::map<const Texture *, std::shared_ptr<DecodeJob>> DecodeJobs;
+
+	/** All jobs that haven't been waited for yet, and all failed ones. Protected by _mutex. */
+	DecodeJobs _decodeJobs;
+
+	std::vector<std::thread> _decodeThreads;
+	std::deque<std::shared_ptr<DecodeJob>> _decodeQueue;
+
+	/** Protects the queue, the statistics and the state of the jobs.
+	 *
+	 *  The worker threads never lock _mutex, so this can be locked with _mutex held.
+	 */
+	std::mutex _decodeMutex;
+	std::condition_variable _decodeAvailable;
+	std::condition_variable _decodeFinished; ///< Signals a finished job.
+	bool _decodeQuit;
+
+	DecodeStats _decodeStats;
+
+	void startDecodeThreads();
+	void stopDecodeThreads();
+
+	void decodeThread();
+	void decode(DecodeJob &job);
+
+	void cancelDecode(const Texture &texture);
+	/** Wait for the decoding of this texture, if any, rethrowing its error. */
+	void waitForDecode(const Texture &texture);
+	// '---
+
 	void assign(TextureHandle &texture, const TextureHandle &from);
 	void release(TextureHandle &texture);
 
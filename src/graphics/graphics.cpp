@@ -93,6 +93,11 @@ GraphicsManager::GraphicsManager() : Events::Notifyable() {
 	_cullFaceEnabled = true;
 	_cullFaceMode    = GL_BACK;
 
+	_frustumCulling.store(true);
+
+	_worldObjectsDrawn.store(0);
+	_worldObjectsCulled.store(0);
+
 	_projectType = kProjectTypePerspective;
 
 	_viewAngle = 60.0f;
@@ -480,6 +485,19 @@ void GraphicsManager::setCullFace(bool enabled, GLenum mode) {
 	_cullFaceMode    = mode;
 }
 
+void GraphicsManager::setFrustumCulling(bool enabled) {
+	_frustumCulling.store(enabled);
+}
+
+bool GraphicsManager::getFrustumCulling() const {
+	return _frustumCulling.load();
+}
+
+void GraphicsManager::getWorldObjectCount(uint32_t &drawn, uint32_t &culled) const {
+	drawn  = _worldObjectsDrawn.load();
+	culled = _worldObjectsCulled.load();
+}
+
 void GraphicsManager::setGUIScale(ScalingType scaling) {
 	_scalingType = scaling;
 
@@ -1046,6 +1064,32 @@ bool GraphicsManager::playVideo() {
 	return true;
 }
 
+void GraphicsManager::cullWorldObjects(const std::list<Queueable *> &objects) {
+	_frustum.set(_projection, _modelview);
+
+	const bool culling = _frustumCulling.load();
+
+	_visibleWorldObjects.clear();
+	_visibleWorldObjects.reserve(objects.size());
+
+	uint32_t culled = 0;
+	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
+	     o != objects.rend(); ++o) {
+
+		Renderable *object = static_cast<Renderable *>(*o);
+
+		if (culling && !object->isInFrustum(_frustum)) {
+			culled++;
+			continue;
+		}
+
+		_visibleWorldObjects.push_back(object);
+	}
+
+	_worldObjectsDrawn.store(_visibleWorldObjects.size());
+	_worldObjectsCulled.store(culled);
+}
+
 bool GraphicsManager::renderWorld() {
 	if (QueueMan.isQueueEmpty(kQueueVisibleWorldObject))
 		return false;
@@ -1087,21 +1131,23 @@ bool GraphicsManager::renderWorld() {
 
 	_animationThread.flush();
 
+	cullWorldObjects(objects);
+
 	// Draw opaque objects
-	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
-	     o != objects.rend(); ++o) {
+	for (std::vector<Renderable *>::const_iterator o = _visibleWorldObjects.begin();
+	     o != _visibleWorldObjects.end(); ++o) {
 
 		glPushMatrix();
-		static_cast<Renderable *>(*o)->render(kRenderPassOpaque);
+		(*o)->render(kRenderPassOpaque);
 		glPopMatrix();
 	}
 
 	// Draw transparent objects
-	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
-	     o != objects.rend(); ++o) {
+	for (std::vector<Renderable *>::const_iterator o = _visibleWorldObjects.begin();
+	     o != _visibleWorldObjects.end(); ++o) {
 
 		glPushMatrix();
-		static_cast<Renderable *>(*o)->render(kRenderPassTransparent);
+		(*o)->render(kRenderPassTransparent);
 		glPopMatrix();
 	}
 
@@ -1231,11 +1277,13 @@ bool GraphicsManager::renderWorldShader() {
 
 	_animationThread.flush();
 
+	cullWorldObjects(objects);
+
 	glm::mat4 ident;
 	RenderMan.clear();
-	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
-	     o != objects.rend(); ++o) {
-		static_cast<Renderable *>(*o)->queueRender(ident);
+	for (std::vector<Renderable *>::const_iterator o = _visibleWorldObjects.begin();
+	     o != _visibleWorldObjects.end(); ++o) {
+		(*o)->queueRender(ident);
 	}
 	RenderMan.sort();
 	RenderMan.render();
@@ -1405,6 +1453,10 @@ void GraphicsManager::unregisterAnimatedModel(Aurora::Model *model) {
 	_animationThread.unregisterModel(model);
 }
 
+Aurora::AnimationThread::Stats GraphicsManager::getAnimationStats() {
+	return _animationThread.getStats();
+}
+
 bool GraphicsManager::isGL3() const {
 	return _renderType == WindowManager::kOpenGL32Compat;
 }
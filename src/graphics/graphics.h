@@ -36,6 +36,7 @@
 #include "src/common/singleton.h"
 #include "src/common/ustring.h"
 #include "src/common/mutex.h"
+#include "src/common/frustum.h"
 
 #include "src/graphics/types.h"
 #include "src/graphics/windowman.h"
@@ -53,6 +54,7 @@ namespace Aurora {
 class FPSCounter;
 class Cursor;
 class Renderable;
+class Queueable;
 
 /** The graphics manager. */
 class GraphicsManager : public Common::Singleton<GraphicsManager>, public Events::Notifyable {
@@ -97,6 +99,14 @@ public:
 	/** Enable/Disable face culling. */
 	void setCullFace(bool enabled, GLenum mode = GL_BACK);
 
+	/** Enable/Disable skipping world objects outside the camera's view frustum. */
+	void setFrustumCulling(bool enabled);
+	/** Are world objects outside the camera's view frustum skipped? */
+	bool getFrustumCulling() const;
+
+	/** How many world objects were drawn and culled in the last frame? */
+	void getWorldObjectCount(uint32_t &drawn, uint32_t &culled) const;
+
 	/** Configure scaling type for the GUI. */
 	void setGUIScale(ScalingType scaling);
 	/** Configure the original size of the GUI. */
@@ -181,6 +191,8 @@ public:
 	void registerAnimatedModel(Aurora::Model *model);
 	/** Unregister a model from the animation thread. */
 	void unregisterAnimatedModel(Aurora::Model *model);
+	/** Return statistics of the animation thread. */
+	Aurora::AnimationThread::Stats getAnimationStats();
 
 private:
 	enum ProjectType {
@@ -206,6 +218,16 @@ private:
 	bool   _cullFaceEnabled;
 	GLenum _cullFaceMode;
 
+	std::atomic<bool> _frustumCulling; ///< Skip world objects outside the view frustum?
+
+	Common::Frustum _frustum; ///< The camera's view frustum in the current frame.
+
+	/** The world objects within the view frustum in the current frame, in render order. */
+	std::vector<Renderable *> _visibleWorldObjects;
+
+	std::atomic<uint32_t> _worldObjectsDrawn;  ///< World objects drawn in the last frame.
+	std::atomic<uint32_t> _worldObjectsCulled; ///< World objects culled in the last frame.
+
 	ProjectType _projectType;
 
 	float _viewAngle;
@@ -273,6 +295,9 @@ private:
 
 	void buildNewTextures();
 
+	/** Collect the world objects within the view frustum, in render order. */
+	void cullWorldObjects(const std::list<Queueable *> &objects);
+
 	void beginScene();
 	bool playVideo();
 	bool renderWorld();
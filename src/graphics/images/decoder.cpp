@@ -255,6 +255,66 @@ void ImageDecoder::decompress() {
 	_compressed = false;
 }
 
+void ImageDecoder::generateMipMaps() {
+	if (_compressed || (_dataType != kPixelDataType8) || (getMipMapCount() != 1))
+		return;
+
+	int bpp = 0;
+	if      (_formatRaw == kPixelFormatRGBA8)
+		bpp = 4;
+	else if (_formatRaw == kPixelFormatRGB8)
+		bpp = 3;
+	else
+		return;
+
+	// All layers need to produce mip map chains of the same length
+	for (MipMaps::const_iterator m = _mipMaps.begin(); m != _mipMaps.end(); ++m)
+		if (((*m)->width  != _mipMaps[0]->width ) || ((*m)->height != _mipMaps[0]->height) ||
+		    ((*m)->size   <  (uint32_t)((*m)->width * (*m)->height * bpp)))
+			return;
+
+	MipMaps mipMaps;
+
+	for (size_t layer = 0; layer < _layerCount; layer++) {
+		mipMaps.emplace_back(std::move(_mipMaps[layer]));
+
+		while ((mipMaps.back()->width > 1) || (mipMaps.back()->height > 1)) {
+			const MipMap &in = *mipMaps.back();
+
+			std::unique_ptr<MipMap> out = std::make_unique<MipMap>(this);
+
+			out->width  = MAX(in.width  / 2, 1);
+			out->height = MAX(in.height / 2, 1);
+			out->size   = out->width * out->height * bpp;
+
+			out->data = std::make_unique<byte[]>(out->size);
+
+			byte *dst = out->data.get();
+			for (int y = 0; y < out->height; y++) {
+				const int y0 = 2 * y;
+				const int y1 = MIN(y0 + 1, in.height - 1);
+
+				for (int x = 0; x < out->width; x++) {
+					const int x0 = 2 * x;
+					const int x1 = MIN(x0 + 1, in.width - 1);
+
+					const byte *p00 = in.data.get() + (y0 * in.width + x0) * bpp;
+					const byte *p01 = in.data.get() + (y0 * in.width + x1) * bpp;
+					const byte *p10 = in.data.get() + (y1 * in.width + x0) * bpp;
+					const byte *p11 = in.data.get() + (y1 * in.width + x1) * bpp;
+
+					for (int c = 0; c < bpp; c++)
+						*dst++ = (p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4;
+				}
+			}
+
+			mipMaps.emplace_back(std::move(out));
+		}
+	}
+
+	_mipMaps.swap(mipMaps);
+}
+
 bool ImageDecoder::dumpTGA(const Common::UString &fileName) const {
 	if (_mipMaps.size() < 1)
 		return false;
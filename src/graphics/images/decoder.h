@@ -107,6 +107,13 @@ public:
 	/** Manually decompress the texture image data. */
 	void decompress();
 
+	/** Generate a full chain of mip maps out of the first one, by averaging 2x2 pixel blocks.
+	 *
+	 *  This only does anything for uncompressed images with 8-bit RGB or RGBA data that don't
+	 *  already come with mip maps of their own.
+	 */
+	void generateMipMaps();
+
 	/** Return the texture information TXI, which may be embedded in the image. */
 	const TXI &getTXI() const;
 
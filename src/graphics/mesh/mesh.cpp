@@ -228,6 +228,18 @@ void Mesh::render() {
 	}
 }
 
+void Mesh::renderInstanced(uint32_t count) {
+	if (!GfxMan.isGL3()) {
+		return;
+	}
+
+	if (_indexBuffer.getCount()) {
+		glDrawElementsInstanced(_type, _indexBuffer.getCount(), _indexBuffer.getType(), 0, count);
+	} else {
+		glDrawArraysInstanced(_type, 0, _vertexBuffer.getCount(), count);
+	}
+}
+
 void Mesh::renderUnbind() {
 	if (GfxMan.isGL3()) {
 		// So long as each mesh rebinds what it needs, there's actually no need to bind 0 here.
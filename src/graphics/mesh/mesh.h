@@ -69,6 +69,9 @@ public:
 	void render();
 	void renderUnbind();
 
+	/** Render count instances of the mesh in one call. Needs a GL3.x context and a bound instancing shader. */
+	void renderInstanced(uint32_t count);
+
 	void useIncrement();
 	void useDecrement();
 	uint32_t useCount() const;
@@ -0,0 +1,297 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Sort keys for the render queue.
+ */
+
+#ifndef GRAPHICS_RENDER_RENDERKEY_H
+#define GRAPHICS_RENDER_RENDERKEY_H
+
+#include <cstring>
+
+#include <vector>
+#include <algorithm>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+
+namespace Graphics {
+
+namespace Render {
+
+/* Layout of a render key, from the most significant bit down:
+ *
+ *   63..52  program ID
+ *   51..38  material ID
+ *   37..24  mesh ID
+ *   23.. 0  quantised depth
+ *
+ * Sorting by the whole key groups items by program, then material, then mesh,
+ * and front to back within each group. Sorting by only the lowest bytes sorts
+ * by depth alone.
+ */
+
+static const unsigned kRenderKeyProgramBits  = 12;
+static const unsigned kRenderKeyMaterialBits = 14;
+static const unsigned kRenderKeyMeshBits     = 14;
+static const unsigned kRenderKeyDepthBits    = 24;
+
+static const unsigned kRenderKeyDepthShift    = 0;
+static const unsigned kRenderKeyMeshShift     = kRenderKeyDepthShift    + kRenderKeyDepthBits;
+static const unsigned kRenderKeyMaterialShift = kRenderKeyMeshShift     + kRenderKeyMeshBits;
+static const unsigned kRenderKeyProgramShift  = kRenderKeyMaterialShift + kRenderKeyMaterialBits;
+
+static const unsigned kRenderKeyBytes      = 8; ///< Number of bytes to sort by to sort by the whole key.
+static const unsigned kRenderKeyDepthBytes = 3; ///< Number of bytes to sort by to sort by depth only.
+
+/** Quantise a depth value into the lowest bits of a render key.
+ *
+ *  The depth is expected to be positive (it is a squared distance). The bits
+ *  of a positive IEEE float sort in the same order as the float itself, so we
+ *  just keep the topmost bits below the (always clear) sign bit. Negative and
+ *  NaN depths are clamped to 0.
+ */
+static inline uint64_t quantiseRenderKeyDepth(float depth) {
+	if (!(depth > 0.0f))
+		return 0;
+
+	uint32_t bits;
+	std::memcpy(&bits, &depth, sizeof(bits));
+
+	return bits >> (31 - kRenderKeyDepthBits);
+}
+
+/** Pack IDs and a depth into a render key. IDs that don't fit are clamped. */
+static inline uint64_t packRenderKey(uint32_t program, uint32_t material, uint32_t mesh, float depth) {
+	program  = MIN<uint32_t>(program , (1U << kRenderKeyProgramBits ) - 1);
+	material = MIN<uint32_t>(material, (1U << kRenderKeyMaterialBits) - 1);
+	mesh     = MIN<uint32_t>(mesh    , (1U << kRenderKeyMeshBits    ) - 1);
+
+	return (((uint64_t) program ) << kRenderKeyProgramShift ) |
+	       (((uint64_t) material) << kRenderKeyMaterialShift) |
+	       (((uint64_t) mesh    ) << kRenderKeyMeshShift    ) |
+	       (quantiseRenderKeyDepth(depth) << kRenderKeyDepthShift);
+}
+
+/** Hands out small, dense IDs for objects, in order of first appearance.
+ *
+ *  The IDs are only meaningful until the next clear(), which is fine for
+ *  sorting a queue that's refilled every frame.
+ *
+ *  This is a small open addressing hash table with linear probing. It's
+ *  queried several times for every queued item, so it avoids allocating
+ *  and chasing pointers. Clearing it only bumps a generation counter;
+ *  slots of an older generation count as empty. And since items are
+ *  usually queued in runs of the same object, the last lookup is cached.
+ */
+class RenderKeyIDs {
+public:
+	RenderKeyIDs() : _slots(kInitialSize), _generation(1), _count(0), _last(0), _lastID(0) { }
+
+	uint32_t get(const void *object) {
+		if ((object == _last) && (_count > 0))
+			return _lastID;
+
+		// Keep the table at most half full
+		if ((_count + 1) * 2 > _slots.size())
+			grow();
+
+		const size_t mask = _slots.size() - 1;
+		for (size_t i = hash(object) & mask; ; i = (i + 1) & mask) {
+			Slot &slot = _slots[i];
+
+			if (slot.generation != _generation) {
+				slot.object     = object;
+				slot.id         = _count++;
+				slot.generation = _generation;
+			} else if (slot.object != object)
+				continue;
+
+			_last   = object;
+			_lastID = slot.id;
+
+			return _lastID;
+		}
+	}
+
+	void clear() {
+		_count = 0;
+
+		_last   = 0;
+		_lastID = 0;
+
+		// When the generation counter wraps around, old slots could look valid again
+		if (++_generation == 0) {
+			for (Slot &slot : _slots)
+				slot.generation = 0;
+
+			_generation = 1;
+		}
+	}
+
+private:
+	static const size_t kInitialSize = 64;
+
+	struct Slot {
+		const void *object;
+		uint32_t id;
+		uint32_t generation;
+
+		Slot() : object(0), id(0), generation(0) { }
+	};
+
+	std::vector<Slot> _slots;
+
+	uint32_t _generation;
+	uint32_t _count;
+
+	const void *_last;
+	uint32_t _lastID;
+
+	static size_t hash(const void *object) {
+		// Fibonacci hashing; the lowest bits of a pointer are mostly alignment
+		const uint64_t value = (uint64_t) (uintptr_t) object;
+
+		return (size_t) (((value >> 4) * UINT64_C(0x9E3779B97F4A7C15)) >> 32);
+	}
+
+	void grow() {
+		std::vector<Slot> slots(_slots.size() * 2);
+		slots.swap(_slots);
+
+		const size_t mask = _slots.size() - 1;
+		for (const Slot &slot : slots) {
+			if (slot.generation != _generation)
+				continue;
+
+			size_t i = hash(slot.object) & mask;
+			while (_slots[i].generation == _generation)
+				i = (i + 1) & mask;
+
+			_slots[i] = slot;
+		}
+	}
+};
+
+/** Builds the render keys of one queue. */
+class RenderKeyBuilder {
+public:
+	uint64_t build(const void *program, const void *material, const void *mesh, float depth) {
+		return packRenderKey(_programs.get(program), _materials.get(material), _meshes.get(mesh), depth);
+	}
+
+	void clear() {
+		_programs.clear();
+		_materials.clear();
+		_meshes.clear();
+	}
+
+private:
+	RenderKeyIDs _programs;
+	RenderKeyIDs _materials;
+	RenderKeyIDs _meshes;
+};
+
+/** An item in the render queue: its sort key and the index of its payload. */
+struct RenderQueueNode {
+	uint64_t key;
+	uint32_t index;
+
+	RenderQueueNode() : key(0), index(0) { }
+	RenderQueueNode(uint64_t k, uint32_t i) : key(k), index(i) { }
+};
+
+/** Queues shorter than this are sorted with a simple stable sort instead. */
+static const size_t kRenderQueueRadixThreshold = 64;
+
+/** Stably sort render queue nodes by the lowest keyBytes bytes of their keys.
+ *
+ *  This is a least significant digit radix sort with 8-bit digits. All the
+ *  histograms are built in one pass over the keys, and digits that are the
+ *  same for all keys (typically the high bytes of the IDs) are skipped.
+ *
+ *  The scratch vector is kept by the caller, so that its memory can be reused
+ *  from frame to frame.
+ */
+static inline void sortRenderQueueNodes(std::vector<RenderQueueNode> &nodes,
+                                        std::vector<RenderQueueNode> &scratch, unsigned keyBytes) {
+
+	const size_t count = nodes.size();
+	if (count < 2)
+		return;
+
+	keyBytes = MIN(keyBytes, kRenderKeyBytes);
+
+	if (count < kRenderQueueRadixThreshold) {
+		const uint64_t mask = (keyBytes == 8) ? ~((uint64_t) 0) : ((((uint64_t) 1) << (keyBytes * 8)) - 1);
+
+		std::stable_sort(nodes.begin(), nodes.end(), [mask](const RenderQueueNode &a, const RenderQueueNode &b) {
+			return (a.key & mask) < (b.key & mask);
+		});
+		return;
+	}
+
+	uint32_t histograms[kRenderKeyBytes][256];
+	std::memset(histograms, 0, sizeof(histograms));
+
+	for (size_t i = 0; i < count; i++) {
+		const uint64_t key = nodes[i].key;
+
+		for (unsigned b = 0; b < keyBytes; b++)
+			histograms[b][(key >> (b * 8)) & 0xFF]++;
+	}
+
+	scratch.resize(count);
+
+	RenderQueueNode *src = nodes.data();
+	RenderQueueNode *dst = scratch.data();
+
+	for (unsigned b = 0; b < keyBytes; b++) {
+		const unsigned shift = b * 8;
+		uint32_t *histogram = histograms[b];
+
+		// All keys have the same digit here, nothing to do
+		if (histogram[(src[0].key >> shift) & 0xFF] == count)
+			continue;
+
+		uint32_t offset = 0;
+		for (size_t d = 0; d < 256; d++) {
+			const uint32_t digitCount = histogram[d];
+
+			histogram[d] = offset;
+			offset += digitCount;
+		}
+
+		for (size_t i = 0; i < count; i++)
+			dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+		std::swap(src, dst);
+	}
+
+	if (src != nodes.data())
+		nodes.swap(scratch);
+}
+
+} // namespace Render
+
+} // namespace Graphics
+
+#endif // GRAPHICS_RENDER_RENDERKEY_H
@@ -97,6 +97,17 @@ void RenderManager::render() {
 	_queueColorSolidDecal.render();
 	_queueColorTransparentPrimary.render();
 	_queueColorTransparentSecondary.render();
+
+	_stats = RenderQueue::Stats();
+	_stats.add(_queueColorSolidPrimary.getStats());
+	_stats.add(_queueColorSolidSecondary.getStats());
+	_stats.add(_queueColorSolidDecal.getStats());
+	_stats.add(_queueColorTransparentPrimary.getStats());
+	_stats.add(_queueColorTransparentSecondary.getStats());
+}
+
+const RenderQueue::Stats &RenderManager::getStats() const {
+	return _stats;
 }
 
 void RenderManager::clear() {
@@ -59,6 +59,9 @@ public:
 
 	void clear();
 
+	/** Return the counters of all queues of the last rendered frame. */
+	const RenderQueue::Stats &getStats() const;
+
 	void init() {}
 	void deinit() {}
 	void cleanup() {}
@@ -73,6 +76,8 @@ private:
 
 	SortingHints _sortingHints;
 
+	RenderQueue::Stats _stats;
+
 	//std::vector<GLContainer *> _queueColorImmediate; // For anything special outside the normal render path.
 };
 
@@ -29,39 +29,28 @@
 #include "src/graphics/render/renderqueue.h"
 #include "src/common/util.h"
 
-#include <algorithm>
-
 namespace Graphics {
 
 namespace Render {
 
-bool compareShader(const RenderQueue::RenderQueueNode &a, const RenderQueue::RenderQueueNode &b)
-{
-	if (a.program < b.program)
-		return false;
-	else if (a.program > b.program)
-		return true;
-	if (a.material < b.material)  // node_program values are equal.
-		return false;
-	else if (a.material > b.material)
-		return true;
-	else  // node material values are equal, compare mesh values next.
-		return (a.mesh <= b.mesh ? false : true);
-	// No, surfaces are not compared here.
+RenderQueue::RenderQueue(uint32_t precache) : _cameraReference(0.0f, 0.0f, 0.0f) {
+	_nodeArray.reserve(precache);
+	_sortScratch.reserve(precache);
+	_instanceTransforms.reserve(Shader::kShaderMaxInstances);
+
+	_programs.reserve(precache);
+	_surfaces.reserve(precache);
+	_materials.reserve(precache);
+	_meshes.reserve(precache);
+	_transforms.reserve(precache);
+	_alphas.reserve(precache);
 }
 
-bool compareDepth(const RenderQueue::RenderQueueNode &a, const RenderQueue::RenderQueueNode &b) {
-	return (a.reference <= b.reference);
-	//return (a.reference.lengthSquared() <= b.reference.lengthSquared());
+RenderQueue::~RenderQueue() {
 }
 
-RenderQueue::RenderQueue(uint32_t precache) : _nodeArray(precache), _cameraReference(0.0f, 0.0f, 0.0f) {
-//	_nodeArray.reserve(1000);
-}
-
-RenderQueue::~RenderQueue()
-{
-	_nodeArray.clear();
+const RenderQueue::Stats &RenderQueue::getStats() const {
+	return _stats;
 }
 
 void RenderQueue::setCameraReference(const glm::vec3 &reference) {
@@ -76,7 +65,7 @@ void RenderQueue::queueItem(Shader::ShaderProgram *program, Shader::ShaderSurfac
 	ref += mesh->getCentre();
 	ref -= _cameraReference;
 	// Length squared of ref serves as a suitable depth sorting value.
-	_nodeArray.push_back(RenderQueueNode(program, surface, material, mesh, transform, alpha, glm::dot(ref, ref)));
+	pushItem(program, surface, material, mesh, transform, alpha, glm::dot(ref, ref));
 }
 
 void RenderQueue::queueItem(Shader::ShaderRenderable *renderable, const glm::mat4 *transform, float alpha) {
@@ -86,26 +75,37 @@ void RenderQueue::queueItem(Shader::ShaderRenderable *renderable, const glm::mat
 	glm::vec3 ref((*transform)[3]);
 	ref -= _cameraReference;
 	// Length squared of ref serves as a suitable depth sorting value.
-	_nodeArray.push_back(RenderQueueNode(renderable->getProgram(), renderable->getSurface(), renderable->getMaterial(), renderable->getMesh(), transform, alpha, glm::dot(ref, ref)));
+	pushItem(renderable->getProgram(), renderable->getSurface(), renderable->getMaterial(), renderable->getMesh(), transform, alpha, glm::dot(ref, ref));
+}
+
+void RenderQueue::pushItem(Shader::ShaderProgram *program, Shader::ShaderSurface *surface, Shader::ShaderMaterial *material, Mesh::Mesh *mesh, const glm::mat4 *transform, float alpha, float reference) {
+	_nodeArray.push_back(RenderQueueNode(_keys.build(program, material, mesh, reference), _programs.size()));
+
+	_programs.push_back(program);
+	_surfaces.push_back(surface);
+	_materials.push_back(material);
+	_meshes.push_back(mesh);
+	_transforms.push_back(transform);
+	_alphas.push_back(alpha);
 }
 
 void RenderQueue::sortShader() {
-	if (_nodeArray.size() > 1) {
-		std::sort(_nodeArray.begin(), _nodeArray.end(), compareShader);
-	}
+	sortRenderQueueNodes(_nodeArray, _sortScratch, kRenderKeyBytes);
 }
 
 void RenderQueue::sortDepth() {
-	if (_nodeArray.size() > 1) {
-		std::sort(_nodeArray.begin(), _nodeArray.end(), compareDepth);
-	}
+	sortRenderQueueNodes(_nodeArray, _sortScratch, kRenderKeyDepthBytes);
 }
 
 void RenderQueue::render() {
+	_stats = Stats();
+
 	if (_nodeArray.size() == 0) {
 		return;
 	}
 
+	const bool canInstance = GfxMan.isGL3();
+
 	Shader::ShaderProgram *currentProgram = 0;
 	Shader::ShaderMaterial *currentMaterial = 0;
 	Shader::ShaderSurface *currentSurface = 0;
@@ -114,9 +114,11 @@ void RenderQueue::render() {
 	uint32_t i = 0;
 	uint32_t limit = _nodeArray.size();
 	while (i < limit) {
-		assert(_nodeArray[i].program);
-		if (currentProgram != _nodeArray[i].program) {
-			currentProgram = _nodeArray[i].program;
+		uint32_t item = _nodeArray[i].index;
+
+		assert(_programs[item]);
+		if (currentProgram != _programs[item]) {
+			currentProgram = _programs[item];
 			glUseProgram(currentProgram->glid);
 
 			if (currentSurface != 0) {
@@ -129,52 +131,49 @@ void RenderQueue::render() {
 			currentSurface = 0;
 		}
 
-		assert(_nodeArray[i].material);
-		if (currentMaterial != _nodeArray[i].material) {
+		assert(_materials[item]);
+		if (currentMaterial != _materials[item]) {
 			if (currentMaterial != 0) {
 				currentMaterial->unbindGLState();
 			}
-			currentMaterial = _nodeArray[i].material;
+			currentMaterial = _materials[item];
 			currentMaterial->bindProgramNoFade(currentProgram);
 			currentMaterial->bindGLState();
 		}
 
-		assert(_nodeArray[i].surface);
-		assert(_nodeArray[i].mesh);
+		assert(_surfaces[item]);
+		assert(_meshes[item]);
 
-		if (currentSurface != _nodeArray[i].surface) {
+		if (currentSurface != _surfaces[item]) {
 			if (currentSurface != 0) {
 				currentSurface->unbindGLState();
 			}
-			currentSurface = _nodeArray[i].surface;
+			currentSurface = _surfaces[item];
 			currentSurface->bindGLState();
 		}
 
-		currentSurface = _nodeArray[i].surface;
-		currentMesh = _nodeArray[i].mesh;
+		currentSurface = _surfaces[item];
+		currentMesh = _meshes[item];
 		currentMesh->renderBind();  // Binds VAO ready for rendering.
 
 		// There's at least one mesh to be rendering here.
-		assert(_nodeArray[i].transform);
 		assert(currentSurface);
 		assert(currentMaterial);
 
-		currentSurface->bindProgram(currentProgram, _nodeArray[i].transform);
-		//currentSurface->bindObjectModelview(currentProgram, _nodeArray[i].transform);
-		bindBoneUniforms(currentProgram, currentSurface, currentMesh);
-		currentMaterial->bindFade(currentProgram, _nodeArray[i].alpha);
-		currentMesh->render();
-
-		++i;  // Move to next object.
-		while ((i < limit) && (_nodeArray[i].mesh == currentMesh) && (_nodeArray[i].material == currentMaterial) && (_nodeArray[i].surface == currentSurface)) {
-			// Next object is basically the same, but will have a different object modelview transform. So rebind that, and render again.
-			assert(_nodeArray[i].transform);
-			currentSurface->bindObjectModelview(currentProgram, _nodeArray[i].transform);
-			bindBoneUniforms(currentProgram, currentSurface, currentMesh);
-			currentMaterial->bindFade(currentProgram, _nodeArray[i].alpha);
-			currentMesh->render();
-			++i;
+		// Find the run of objects that only differ in their transform and alpha.
+		uint32_t runEnd = i + 1;
+		while ((runEnd < limit) && (_meshes[_nodeArray[runEnd].index] == currentMesh) && (_materials[_nodeArray[runEnd].index] == currentMaterial) && (_surfaces[_nodeArray[runEnd].index] == currentSurface)) {
+			++runEnd;
 		}
+
+		// Skinned meshes have their own bone transforms per object, so they can't be instanced.
+		if (canInstance && ((runEnd - i) > 1) && (currentSurface->getMaxInstances() > 1) && currentMesh->getBoneTransforms().empty()) {
+			renderInstanced(currentProgram, currentSurface, currentMaterial, currentMesh, i, runEnd);
+		} else {
+			renderSingle(currentProgram, currentSurface, currentMaterial, currentMesh, i, runEnd);
+		}
+		i = runEnd;
+
 		// Done rendering, unbind the mesh, and onwards into the queue.
 		currentMesh->renderUnbind();
 	}
@@ -189,8 +188,81 @@ void RenderQueue::render() {
 	glActiveTexture(GL_TEXTURE0);
 }
 
+void RenderQueue::renderSingle(Shader::ShaderProgram *program, Shader::ShaderSurface *surface, Shader::ShaderMaterial *material, Mesh::Mesh *mesh, uint32_t start, uint32_t end) {
+	uint32_t item = _nodeArray[start].index;
+
+	assert(_transforms[item]);
+	surface->bindProgram(program, _transforms[item]);
+	//surface->bindObjectModelview(program, _transforms[item]);
+	bindBoneUniforms(program, surface, mesh);
+	material->bindFade(program, _alphas[item]);
+	mesh->render();
+
+	for (uint32_t i = start + 1; i < end; i++) {
+		item = _nodeArray[i].index;
+
+		// Next object is basically the same, but will have a different object modelview transform. So rebind that, and render again.
+		assert(_transforms[item]);
+		surface->bindObjectModelview(program, _transforms[item]);
+		bindBoneUniforms(program, surface, mesh);
+		material->bindFade(program, _alphas[item]);
+		mesh->render();
+	}
+
+	_stats.objects   += end - start;
+	_stats.drawCalls += end - start;
+
+	_stats.maxBatchSize = MAX<uint32_t>(_stats.maxBatchSize, 1);
+}
+
+void RenderQueue::renderInstanced(Shader::ShaderProgram *program, Shader::ShaderSurface *surface, Shader::ShaderMaterial *material, Mesh::Mesh *mesh, uint32_t start, uint32_t end) {
+	const uint32_t maxInstances = surface->getMaxInstances();
+
+	// Binds all the other variables of the surface. The object transform is ignored while instancing.
+	assert(_transforms[_nodeArray[start].index]);
+	surface->bindProgram(program, _transforms[_nodeArray[start].index]);
+	bindBoneUniforms(program, surface, mesh);
+
+	uint32_t i = start;
+	while (i < end) {
+		// The alpha is a fragment shader uniform, so all instances of one draw call need to share it.
+		const float alpha = _alphas[_nodeArray[i].index];
+
+		_instanceTransforms.clear();
+		while ((i < end) && (_instanceTransforms.size() < maxInstances) && (_alphas[_nodeArray[i].index] == alpha)) {
+			assert(_transforms[_nodeArray[i].index]);
+			_instanceTransforms.push_back(*_transforms[_nodeArray[i].index]);
+			++i;
+		}
+
+		const uint32_t count = _instanceTransforms.size();
+
+		surface->bindInstances(program, _instanceTransforms.data(), count);
+		material->bindFade(program, alpha);
+		mesh->renderInstanced(count);
+
+		_stats.objects            += count;
+		_stats.drawCalls          += 1;
+		_stats.instancedDrawCalls += 1;
+		_stats.instancedObjects   += count;
+
+		_stats.maxBatchSize = MAX(_stats.maxBatchSize, count);
+	}
+
+	surface->unbindInstances(program);
+}
+
 void RenderQueue::clear() {
 	_nodeArray.clear();
+
+	_programs.clear();
+	_surfaces.clear();
+	_materials.clear();
+	_meshes.clear();
+	_transforms.clear();
+	_alphas.clear();
+
+	_keys.clear();
 }
 
 void RenderQueue::bindBoneUniforms(Shader::ShaderProgram *program, Shader::ShaderSurface *surface, Mesh::Mesh *mesh) {
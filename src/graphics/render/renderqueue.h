@@ -28,8 +28,11 @@
 #include "external/glm/vec3.hpp"
 #include "external/glm/mat4x4.hpp"
 
+#include "src/common/util.h"
+
 #include "src/graphics/graphics.h"
 #include "src/graphics/shader/shaderrenderable.h"
+#include "src/graphics/render/renderkey.h"
 
 #include <vector>
 
@@ -37,22 +40,36 @@ namespace Graphics {
 
 namespace Render {
 
+/** A queue of items to render.
+ *
+ *  Every queued item gets a 64-bit sort key (see renderkey.h). The nodes that
+ *  are sorted only hold that key and the index of the item's payload, which
+ *  lives in separate arrays. Sorting therefore only moves 16-byte nodes around
+ *  and never has to look at the objects themselves.
+ *
+ *  When rendering, runs of objects that share mesh, material and surface
+ *  are drawn with instanced draw calls where the shaders support it.
+ */
 class RenderQueue {
 public:
-	struct RenderQueueNode {
-		Shader::ShaderProgram *program;
-		Shader::ShaderSurface *surface;
-		Shader::ShaderMaterial *material;
-		Mesh::Mesh *mesh;
-		const glm::mat4 *transform;
-		float reference;  ///< Reference point to the camera location, primarily used for depth sorting.
-		float alpha;      ///< Custom alpha value applied per-object.
-
-		RenderQueueNode() : program(0), surface(0), material(0), mesh(0), transform(0), reference(0.0f), alpha(1.0f) {}
-		RenderQueueNode(const RenderQueueNode &src) : program(src.program), surface(src.surface), material(src.material), mesh(src.mesh), transform(src.transform), reference(src.reference), alpha(src.alpha) {}
-		RenderQueueNode(Shader::ShaderProgram *prog, Shader::ShaderSurface *sur, Shader::ShaderMaterial *mat, Mesh::Mesh *mes, const glm::mat4 *t, float a = 1.0f, float ref = 0.0f) : program(prog), surface(sur), material(mat), mesh(mes), transform(t), reference(ref), alpha(a) {}
-
-		inline const RenderQueueNode &operator=(const RenderQueueNode &src) { program = src.program; material = src.material; surface = src.surface; mesh = src.mesh; transform = src.transform; reference = src.reference; alpha = src.alpha; return *this; }
+	/** Counters of the last render() call, for profiling. */
+	struct Stats {
+		uint32_t objects;            ///< Number of objects rendered.
+		uint32_t drawCalls;          ///< Number of draw calls, instanced or not.
+		uint32_t instancedDrawCalls; ///< Number of instanced draw calls.
+		uint32_t instancedObjects;   ///< Number of objects rendered by instanced draw calls.
+		uint32_t maxBatchSize;       ///< Largest number of objects rendered by one draw call.
+
+		Stats() : objects(0), drawCalls(0), instancedDrawCalls(0), instancedObjects(0), maxBatchSize(0) {}
+
+		void add(const Stats &stats) {
+			objects            += stats.objects;
+			drawCalls          += stats.drawCalls;
+			instancedDrawCalls += stats.instancedDrawCalls;
+			instancedObjects   += stats.instancedObjects;
+
+			maxBatchSize = MAX(maxBatchSize, stats.maxBatchSize);
+		}
 	};
 
 	RenderQueue(uint32_t precache = 1000);
@@ -63,18 +80,42 @@ public:
 	void queueItem(Shader::ShaderProgram *program, Shader::ShaderSurface *surface, Shader::ShaderMaterial *material, Mesh::Mesh *mesh, const glm::mat4 *transform, float alpha);
 	void queueItem(Shader::ShaderRenderable *renderable, const glm::mat4 *transform, float alpha);
 
-	void sortShader(); ///< Sort queue elements by shader program.
-	void sortDepth();  ///< Sort queue elements by depth.
+	void sortShader(); ///< Sort queue elements by shader program, then front to back.
+	void sortDepth();  ///< Sort queue elements by depth, front to back.
 
 	void render();  ///< Render all queued items.
 
 	void clear();  ///< Clear the queue of all items.
 
+	const Stats &getStats() const;
+
 private:
+	std::vector<RenderQueueNode> _nodeArray;   ///< The sortable keys of all queued items.
+	std::vector<RenderQueueNode> _sortScratch; ///< Scratch space for sorting the keys.
+
+	// The payload of all queued items, indexed by RenderQueueNode::index
+	std::vector<Shader::ShaderProgram *>  _programs;
+	std::vector<Shader::ShaderSurface *>  _surfaces;
+	std::vector<Shader::ShaderMaterial *> _materials;
+	std::vector<Mesh::Mesh *>             _meshes;
+	std::vector<const glm::mat4 *>        _transforms;
+	std::vector<float>                    _alphas; ///< Custom alpha value applied per-object.
+
+	RenderKeyBuilder _keys;
+
+	std::vector<glm::mat4> _instanceTransforms; ///< Object transforms of the current instanced draw call.
+
+	Stats _stats;
 
-	std::vector<RenderQueueNode>_nodeArray;
 	glm::vec3 _cameraReference;
 
+	void pushItem(Shader::ShaderProgram *program, Shader::ShaderSurface *surface, Shader::ShaderMaterial *material, Mesh::Mesh *mesh, const glm::mat4 *transform, float alpha, float reference);
+
+	/** Render the run of objects from start to end one by one. */
+	void renderSingle(Shader::ShaderProgram *program, Shader::ShaderSurface *surface, Shader::ShaderMaterial *material, Mesh::Mesh *mesh, uint32_t start, uint32_t end);
+	/** Render the run of objects from start to end with as few instanced draw calls as possible. */
+	void renderInstanced(Shader::ShaderProgram *program, Shader::ShaderSurface *surface, Shader::ShaderMaterial *material, Mesh::Mesh *mesh, uint32_t start, uint32_t end);
+
 	void bindBoneUniforms(Shader::ShaderProgram *program, Shader::ShaderSurface *surface, Mesh::Mesh *mesh);
 };
 
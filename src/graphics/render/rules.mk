@@ -23,6 +23,7 @@ noinst_LTLIBRARIES += src/graphics/render/librender.la
 src_graphics_render_librender_la_SOURCES =
 
 src_graphics_render_librender_la_SOURCES += \
+    src/graphics/render/renderkey.h \
     src/graphics/render/renderman.h \
     src/graphics/render/renderqueue.h \
     $(EMPTY)
@@ -138,6 +138,10 @@ bool Renderable::isIn(float UNUSED(x1), float UNUSED(y1), float UNUSED(z1),
 	return false;
 }
 
+bool Renderable::isInFrustum(const Common::Frustum &UNUSED(frustum)) const {
+	return true;
+}
+
 void Renderable::lockFrame() {
 	GfxMan.lockFrame();
 }
@@ -36,6 +36,10 @@
 #include "src/graphics/types.h"
 #include "src/graphics/queueable.h"
 
+namespace Common {
+	class Frustum;
+}
+
 namespace Graphics {
 
 /** An object that can be displayed by the graphics manager. */
@@ -89,6 +93,12 @@ public:
 	/** Does the line from x1.y1.z1 to x2.y2.z2 intersect with the object? */
 	virtual bool isIn(float x1, float y1, float z1, float x2, float y2, float z2) const;
 
+	/** Might the object be visible within this view frustum?
+	 *
+	 *  Objects that can't tell always claim to be.
+	 */
+	virtual bool isInFrustum(const Common::Frustum &frustum) const;
+
 protected:
 	QueueType _queueExists;
 	QueueType _queueVisible;
@@ -91,9 +91,7 @@ void ShaderDescriptor::build(bool isGL3, Common::UString &v_string, Common::UStr
 		           "uniform mat4 _projectionMatrix;\n"
 		           "uniform mat4 _modelviewMatrix;\n";
 
-		v_body =   "void main(void) {\n"
-		           "	mat4 mo = (_modelviewMatrix * _objectModelviewMatrix);\n";
-
+		v_body =   "void main(void) {\n";
 
 		f_header = "#version 150\n\n"
 		           "precision highp float;\n\n"
@@ -109,8 +107,7 @@ void ShaderDescriptor::build(bool isGL3, Common::UString &v_string, Common::UStr
 		           "uniform mat4 _projectionMatrix;\n"
 		           "uniform mat4 _modelviewMatrix;\n";
 
-		v_body =   "void main(void) {\n"
-		           "	mat4 mo = (_modelviewMatrix * _objectModelviewMatrix);\n";
+		v_body =   "void main(void) {\n";
 
 		f_header = "#version 120\n\n"
 		           "uniform float _alpha;\n";
@@ -146,6 +143,21 @@ void ShaderDescriptor::build(bool isGL3, Common::UString &v_string, Common::UStr
 		}
 	}
 
+	/**
+	 * Object transform. GL3 shaders without skinning can also draw several
+	 * instances of a mesh in one call, each with its own transform taken from
+	 * an array. Skinned meshes carry per-object bone transforms, and so are
+	 * always drawn one at a time.
+	 */
+	if (isGL3 && (boneCount == 0)) {
+		v_header += "uniform mat4 _instanceModelviewMatrix[" + Common::composeString(kShaderMaxInstances) + "];\n"
+		            "uniform int _instanced;\n";
+
+		v_body += "	mat4 mo = _modelviewMatrix * ((_instanced != 0) ? _instanceModelviewMatrix[gl_InstanceID] : _objectModelviewMatrix);\n";
+	} else {
+		v_body += "	mat4 mo = (_modelviewMatrix * _objectModelviewMatrix);\n";
+	}
+
 	/**
 	 * Vertex shader input declarations.
 	 *
@@ -42,6 +42,14 @@ namespace Graphics {
 
 namespace Shader {
 
+/** Maximum number of instances drawn by one instanced draw call.
+ *
+ *  The object transforms of the instances are passed in a uniform array,
+ *  so this is kept well below the minimum uniform storage guaranteed by
+ *  OpenGL 3.2 for vertex shaders.
+ */
+static const uint32_t kShaderMaxInstances = 32;
+
 class ShaderDescriptor
 {
 public:
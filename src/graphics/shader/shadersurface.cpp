@@ -25,6 +25,8 @@
 
 #include "external/glm/gtc/type_ptr.hpp"
 
+#include "src/common/util.h"
+
 #include "src/graphics/graphics.h"
 
 #include "src/graphics/shader/shadersurface.h"
@@ -44,7 +46,9 @@ ShaderSurface::ShaderSurface(Shader::ShaderObject *vertShader, const Common::USt
 		_objectModelviewIndex(std::numeric_limits<uint32_t>::max()),
 		_textureViewIndex(std::numeric_limits<uint32_t>::max()),
 		_bindPoseIndex(std::numeric_limits<uint32_t>::max()),
-		_boneTransformsIndex(std::numeric_limits<uint32_t>::max()) {
+		_boneTransformsIndex(std::numeric_limits<uint32_t>::max()),
+		_instanceModelviewIndex(std::numeric_limits<uint32_t>::max()),
+		_instancedIndex(std::numeric_limits<uint32_t>::max()) {
 
 	vertShader->usageCount++;
 
@@ -66,6 +70,10 @@ ShaderSurface::ShaderSurface(Shader::ShaderObject *vertShader, const Common::USt
 			_bindPoseIndex = i;
 		} else if (vertShader->variablesCombined[i].name == "_boneTransforms") {
 			_boneTransformsIndex = i;
+		} else if (vertShader->variablesCombined[i].name == "_instanceModelviewMatrix") {
+			_instanceModelviewIndex = i;
+		} else if (vertShader->variablesCombined[i].name == "_instanced") {
+			_instancedIndex = i;
 		}
 	}
 }
@@ -177,13 +185,18 @@ void ShaderSurface::addUBO(uint32_t index, GLuint glid) {
 
 void ShaderSurface::bindProgram(Shader::ShaderProgram *program) {
 	for (uint32_t i = 0; i < _variableData.size(); i++) {
+		if (isInstanceVariable(i)) {
+			continue;
+		}
 		ShaderMan.bindShaderVariable(program->vertexObject->variablesCombined[i], program->vertexVariableLocations[i], _variableData[i].data);
 	}
 }
 
 void ShaderSurface::bindProgram(Shader::ShaderProgram *program, const glm::mat4 *t) {
 	for (uint32_t i = 0; i < _variableData.size(); i++) {
-		if (_objectModelviewIndex == i) {
+		if (isInstanceVariable(i)) {
+			continue;
+		} else if (_objectModelviewIndex == i) {
 			ShaderMan.bindShaderVariable(program->vertexObject->variablesCombined[i], program->vertexVariableLocations[i], t);
 		} else {
 			ShaderMan.bindShaderVariable(program->vertexObject->variablesCombined[i], program->vertexVariableLocations[i], _variableData[i].data);
@@ -215,6 +228,38 @@ void ShaderSurface::bindBoneTransforms(Shader::ShaderProgram *program, const flo
 	}
 }
 
+uint32_t ShaderSurface::getMaxInstances() const {
+	if ((_instanceModelviewIndex == std::numeric_limits<uint32_t>::max()) ||
+	    (_instancedIndex == std::numeric_limits<uint32_t>::max())) {
+		return 0;
+	}
+
+	return _vertShader->variablesCombined[_instanceModelviewIndex].count;
+}
+
+void ShaderSurface::bindInstances(Shader::ShaderProgram *program, const glm::mat4 *t, uint32_t count) {
+	if (getMaxInstances() == 0) {
+		return;
+	}
+
+	// Only upload as many transforms as there are instances, not the whole array
+	glUniformMatrix4fv(program->vertexVariableLocations[_instanceModelviewIndex], MIN(count, getMaxInstances()), GL_FALSE, glm::value_ptr(*t));
+	glUniform1i(program->vertexVariableLocations[_instancedIndex], 1);
+}
+
+void ShaderSurface::unbindInstances(Shader::ShaderProgram *program) {
+	if (_instancedIndex != std::numeric_limits<uint32_t>::max()) {
+		glUniform1i(program->vertexVariableLocations[_instancedIndex], 0);
+	}
+}
+
+bool ShaderSurface::isInstanceVariable(uint32_t index) const {
+	/* The instance transforms are only ever uploaded by bindInstances(), and
+	 * only as many as needed. The instancing flag stays at its default of 0
+	 * outside of bindInstances() and unbindInstances(). */
+	return (index == _instanceModelviewIndex) || (index == _instancedIndex);
+}
+
 void ShaderSurface::bindGLState() {
 	if (_flags & SHADER_SURFACE_NOCULL) {
 		glDisable(GL_CULL_FACE);
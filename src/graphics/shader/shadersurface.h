@@ -81,6 +81,13 @@ public:
 	void bindBindPose(Shader::ShaderProgram *program, const glm::mat4 *t);
 	void bindBoneTransforms(Shader::ShaderProgram *program, const float *t);
 
+	/** Return the number of instances this surface can draw in one call, or 0 if it can't instance. */
+	uint32_t getMaxInstances() const;
+	/** Switch the surface's program to instanced rendering, with count object transforms. */
+	void bindInstances(Shader::ShaderProgram *program, const glm::mat4 *t, uint32_t count);
+	/** Switch the surface's program back to rendering single objects. */
+	void unbindInstances(Shader::ShaderProgram *program);
+
 	void bindGLState();
 	void unbindGLState();
 	void restoreGLState();
@@ -107,6 +114,10 @@ private:
 	uint32_t _textureViewIndex;
 	uint32_t _bindPoseIndex;
 	uint32_t _boneTransformsIndex;
+	uint32_t _instanceModelviewIndex;
+	uint32_t _instancedIndex;
+
+	bool isInstanceVariable(uint32_t index) const;
 
 	void *genSurfaceVar(uint32_t index);
 	void delSurfaceVar(uint32_t index);
@@ -19,13 +19,14 @@
  */
 
 /** @file
- *  Decoding RIFF WAVE (Resource Interchange File Format Waveform).
+ *  Decoding and writing RIFF WAVE (Resource Interchange File Format Waveform).
  */
 
 #include "src/common/error.h"
 #include "src/common/util.h"
 #include "src/common/strutil.h"
 #include "src/common/readstream.h"
+#include "src/common/writestream.h"
 
 #include "src/sound/audiostream.h"
 #include "src/sound/decoders/wave.h"
@@ -105,4 +106,33 @@ RewindableAudioStream *makeWAVStream(Common::SeekableReadStream *stream, bool di
 	return 0;
 }
 
+void writeWAVHeader(Common::WriteStream &stream, uint32_t dataSize, uint16_t channels, uint32_t rate) {
+	const uint16_t blockAlign = channels * 2;
+
+	stream.writeUint32BE(MKTAG('R', 'I', 'F', 'F'));
+	stream.writeUint32LE(36 + dataSize);
+	stream.writeUint32BE(MKTAG('W', 'A', 'V', 'E'));
+
+	stream.writeUint32BE(MKTAG('f', 'm', 't', ' '));
+	stream.writeUint32LE(16);
+	stream.writeUint16LE(kWavePCM);
+	stream.writeUint16LE(channels);
+	stream.writeUint32LE(rate);
+	stream.writeUint32LE(rate * blockAlign);
+	stream.writeUint16LE(blockAlign);
+	stream.writeUint16LE(16);
+
+	stream.writeUint32BE(MKTAG('d', 'a', 't', 'a'));
+	stream.writeUint32LE(dataSize);
+}
+
+void writeWAVData(Common::WriteStream &stream, const int16_t *samples, size_t count) {
+#ifdef XOREOS_LITTLE_ENDIAN
+	stream.write(samples, count * sizeof(int16_t));
+#else
+	for (size_t i = 0; i < count; i++)
+		stream.writeUint16LE(static_cast<uint16_t>(samples[i]));
+#endif
+}
+
 } // End of namespace Sound
@@ -19,7 +19,7 @@
  */
 
 /** @file
- *  Decoding RIFF WAVE (Resource Interchange File Format Waveform).
+ *  Decoding and writing RIFF WAVE (Resource Interchange File Format Waveform).
  */
 
 #ifndef SOUND_DECODERS_WAVE_H
@@ -27,7 +27,10 @@
 
 #include "src/common/types.h"
 
-namespace Common { class SeekableReadStream; }
+namespace Common {
+	class SeekableReadStream;
+	class WriteStream;
+}
 
 namespace Sound {
 
@@ -47,6 +50,18 @@ RewindableAudioStream *makeWAVStream(
 	Common::SeekableReadStream *stream,
 	bool disposeAfterUse);
 
+/** Write the header of a RIFF WAVE file holding 16-bit PCM samples.
+ *
+ *  @param stream   The stream to write the header to.
+ *  @param dataSize The size of the sample data following the header, in bytes.
+ *  @param channels The number of interleaved channels.
+ *  @param rate     The sampling rate.
+ */
+void writeWAVHeader(Common::WriteStream &stream, uint32_t dataSize, uint16_t channels, uint32_t rate);
+
+/** Write 16-bit PCM samples in the byte order of a RIFF WAVE file. */
+void writeWAVData(Common::WriteStream &stream, const int16_t *samples, size_t count);
+
 } // End of namespace Sound
 
 #endif // SOUND_DECODERS_WAVE_H
@@ -766,7 +766,7 @@ Common::SeekableReadStream *WMACodec::decodeSuperFrame(Common::SeekableReadStrea
 	if (_blockAlign)
 		size = _blockAlign;
 
-	Common::BitStream8MSB bits(data);
+	Common::BufferedBitStream8MSB bits(data);
 
 	int outputDataSize = 0;
 	std::unique_ptr<int16_t[]> outputData;
@@ -826,7 +826,7 @@ Common::SeekableReadStream *WMACodec::decodeSuperFrame(Common::SeekableReadStrea
 			}
 
 			Common::MemoryReadStream lastSuperframe(_lastSuperframe, _lastSuperframeLen);
-			Common::BitStream8MSB lastBits(lastSuperframe);
+			Common::BufferedBitStream8MSB lastBits(lastSuperframe);
 
 			lastBits.skip(_lastBitoffset);
 
@@ -0,0 +1,339 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A software mixer, mixing many audio streams into one.
+ */
+
+#include <cstring>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+
+#include "src/sound/mixer.h"
+#include "src/sound/audiostream.h"
+
+/** The fixed-point representation of a step of exactly one frame. */
+static const uint64_t kStepOne = UINT64_C(1) << 32;
+
+/** The highest pitch we resample to. A block needs to fit into a voice's ring buffer. */
+static const float kMaxStep = 8.0f;
+/** The lowest pitch we resample to. */
+static const float kMinStep = 1.0f / 256.0f;
+
+/** Gain of the center and rear channels when mixing 5.1 sound down to stereo. */
+static const float kDownmixGain = 0.7071f;
+
+namespace Sound {
+
+/** Read one frame of samples, mixed down to stereo. */
+static inline void readFrame(const int16_t *frame, size_t channels, float &left, float &right) {
+	switch (channels) {
+		case 1:
+			left = right = frame[0];
+			break;
+
+		case 6:
+			// Front left, front right, front center, low frequency, rear left, rear right
+			left  = frame[0] + kDownmixGain * (frame[2] + frame[4]);
+			right = frame[1] + kDownmixGain * (frame[2] + frame[5]);
+			break;
+
+		default:
+			left  = frame[0];
+			right = frame[1];
+			break;
+	}
+}
+
+Mixer::Voice::Voice() : stream(0), channels(0), ringSize(0), decoded(0), ended(false),
+	position(0), positionFrac(0), step(kStepOne), streamRate(0), gainLeft(1.0f), gainRight(1.0f),
+	paused(true) {
+
+}
+
+
+Mixer::Mixer(uint32_t rate) : _rate(rate), _gain(1.0f) {
+	if (_rate == 0)
+		throw Common::Exception("Invalid mixer rate");
+}
+
+Mixer::~Mixer() {
+}
+
+uint32_t Mixer::getRate() const {
+	return _rate;
+}
+
+void Mixer::setGain(float gain) {
+	_gain = gain;
+}
+
+size_t Mixer::addVoice(AudioStream *stream) {
+	if (!stream)
+		throw Common::Exception("No audio stream");
+
+	const int channels = stream->getChannels();
+	const int rate     = stream->getRate();
+
+	if ((channels != 1) && (channels != 2) && (channels != 6))
+		throw Common::Exception("Unsupported channel count for mixing: %d", channels);
+	if (rate <= 0)
+		throw Common::Exception("Invalid sampling rate for mixing: %d", rate);
+
+	// Reuse an unused voice if we can
+	size_t index = 0;
+	while ((index < _voices.size()) && _voices[index] && _voices[index]->stream)
+		index++;
+
+	if (index == _voices.size())
+		_voices.emplace_back();
+	if (!_voices[index])
+		_voices[index] = std::make_unique<Voice>();
+
+	Voice &voice = *_voices[index];
+
+	const size_t ringSize = kRingFrames * channels;
+	if (voice.ringSize < ringSize) {
+		voice.ring     = std::make_unique<int16_t[]>(ringSize);
+		voice.ringSize = ringSize;
+	}
+
+	voice.stream     = stream;
+	voice.channels   = channels;
+	voice.streamRate = rate;
+
+	voice.decoded      = 0;
+	voice.ended        = false;
+	voice.position     = 0;
+	voice.positionFrac = 0;
+
+	voice.gainLeft  = 1.0f;
+	voice.gainRight = 1.0f;
+
+	voice.paused = true;
+
+	setStep(voice, 1.0f);
+
+	return index;
+}
+
+void Mixer::removeVoice(size_t voice) {
+	Voice *v = getVoice(voice);
+	if (v)
+		v->stream = 0;
+}
+
+void Mixer::setVoicePaused(size_t voice, bool paused) {
+	Voice *v = getVoice(voice);
+	if (v)
+		v->paused = paused;
+}
+
+void Mixer::setVoiceGain(size_t voice, float left, float right) {
+	Voice *v = getVoice(voice);
+	if (!v)
+		return;
+
+	v->gainLeft  = left;
+	v->gainRight = right;
+}
+
+void Mixer::setVoicePitch(size_t voice, float pitch) {
+	Voice *v = getVoice(voice);
+	if (v)
+		setStep(*v, pitch);
+}
+
+bool Mixer::isVoiceFinished(size_t voice) const {
+	const Voice *v = getVoice(voice);
+	if (!v)
+		return true;
+
+	return v->ended && (v->position >= v->decoded);
+}
+
+uint64_t Mixer::getVoiceFramesPlayed(size_t voice) const {
+	const Voice *v = getVoice(voice);
+	if (!v)
+		return 0;
+
+	return MIN(v->position, v->decoded);
+}
+
+size_t Mixer::getPlayingVoiceCount() const {
+	size_t count = 0;
+	for (size_t i = 0; i < _voices.size(); i++)
+		if (_voices[i] && _voices[i]->stream && !_voices[i]->paused && !isVoiceFinished(i))
+			count++;
+
+	return count;
+}
+
+Mixer::Voice *Mixer::getVoice(size_t voice) {
+	if ((voice >= _voices.size()) || !_voices[voice] || !_voices[voice]->stream)
+		return 0;
+
+	return _voices[voice].get();
+}
+
+const Mixer::Voice *Mixer::getVoice(size_t voice) const {
+	if ((voice >= _voices.size()) || !_voices[voice] || !_voices[voice]->stream)
+		return 0;
+
+	return _voices[voice].get();
+}
+
+void Mixer::setStep(Voice &voice, float pitch) {
+	const float step = CLIP((voice.streamRate * pitch) / _rate, kMinStep, kMaxStep);
+
+	voice.step = (uint64_t) (step * (double) kStepOne);
+}
+
+void Mixer::decode(Voice &voice) {
+	if (voice.ended)
+		return;
+
+	while (true) {
+		/* The frames from the current position on are still needed. The position
+		 * can be past the decoded frames, if the last block skipped ahead. */
+		const uint64_t buffered = (voice.decoded > voice.position) ? (voice.decoded - voice.position) : 0;
+		if (buffered >= kRingFrames)
+			break;
+
+		// Fill up to the end of the free space, or the end of the ring, whichever is first
+		const size_t offset = voice.decoded % kRingFrames;
+		const size_t frames = MIN<size_t>(kRingFrames - buffered, kRingFrames - offset);
+
+		const size_t samples = voice.stream->readBuffer(voice.ring.get() + offset * voice.channels,
+		                                                frames * voice.channels);
+
+		if (samples == AudioStream::kSizeInvalid) {
+			voice.ended = true;
+			break;
+		}
+
+		voice.decoded += samples / voice.channels;
+
+		if (samples < (frames * voice.channels)) {
+			// Either the stream has ended, or there's just no more data right now
+			if (voice.stream->endOfStream())
+				voice.ended = true;
+
+			break;
+		}
+	}
+}
+
+size_t Mixer::resample(Voice &voice, size_t frames) {
+	const int16_t *ring = voice.ring.get();
+	const size_t channels = voice.channels;
+
+	if ((voice.step == kStepOne) && (voice.positionFrac == 0)) {
+		// Playing at the output rate: no need to interpolate
+
+		const size_t count = MIN<uint64_t>(frames, (voice.decoded > voice.position) ? (voice.decoded - voice.position) : 0);
+
+		for (size_t i = 0; i < count; i++)
+			readFrame(ring + ((voice.position + i) % kRingFrames) * channels, channels, _voiceLeft[i], _voiceRight[i]);
+
+		voice.position += count;
+		return count;
+	}
+
+	const uint32_t stepInt  = voice.step >> 32;
+	const uint32_t stepFrac = voice.step & 0xFFFFFFFF;
+
+	size_t count = 0;
+	while (count < frames) {
+		const uint64_t next = voice.position + 1;
+
+		if (voice.position >= voice.decoded)
+			break;
+
+		// We need the next frame to interpolate, unless there won't be one
+		if ((next >= voice.decoded) && !voice.ended)
+			break;
+
+		float left0, right0, left1, right1;
+		readFrame(ring + (voice.position % kRingFrames) * channels, channels, left0, right0);
+
+		if (next < voice.decoded)
+			readFrame(ring + (next % kRingFrames) * channels, channels, left1, right1);
+		else
+			left1 = left0, right1 = right0;
+
+		const float f = voice.positionFrac * (1.0f / (float) kStepOne);
+
+		_voiceLeft [count] = left0  + (left1  - left0 ) * f;
+		_voiceRight[count] = right0 + (right1 - right0) * f;
+		count++;
+
+		const uint64_t frac = (uint64_t) voice.positionFrac + stepFrac;
+
+		voice.position    += stepInt + (frac >> 32);
+		voice.positionFrac = (uint32_t) frac;
+	}
+
+	return count;
+}
+
+void Mixer::mix(int16_t *buffer, size_t frames) {
+	while (frames > 0) {
+		const size_t block = MIN(frames, kBlockSize);
+
+		mixBlock(buffer, block);
+
+		buffer += block * 2;
+		frames -= block;
+	}
+}
+
+void Mixer::mixBlock(int16_t *buffer, size_t frames) {
+	std::memset(_mixLeft , 0, frames * sizeof(float));
+	std::memset(_mixRight, 0, frames * sizeof(float));
+
+	for (size_t v = 0; v < _voices.size(); v++) {
+		Voice *voice = getVoice(v);
+		if (!voice || voice->paused)
+			continue;
+
+		decode(*voice);
+
+		const size_t count = resample(*voice, frames);
+
+		/* Simple loops over plain float arrays, so that the compiler
+		 * can vectorize applying the gains and summing up. */
+		const float gainLeft  = voice->gainLeft;
+		const float gainRight = voice->gainRight;
+
+		for (size_t i = 0; i < count; i++)
+			_mixLeft[i] += _voiceLeft[i] * gainLeft;
+		for (size_t i = 0; i < count; i++)
+			_mixRight[i] += _voiceRight[i] * gainRight;
+	}
+
+	for (size_t i = 0; i < frames; i++) {
+		buffer[i * 2 + 0] = (int16_t) CLIP(_mixLeft [i] * _gain, -32768.0f, 32767.0f);
+		buffer[i * 2 + 1] = (int16_t) CLIP(_mixRight[i] * _gain, -32768.0f, 32767.0f);
+	}
+}
+
+} // End of namespace Sound
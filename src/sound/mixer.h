@@ -0,0 +1,162 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A software mixer, mixing many audio streams into one.
+ */
+
+#ifndef SOUND_MIXER_H
+#define SOUND_MIXER_H
+
+#include <vector>
+#include <memory>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+
+namespace Sound {
+
+class AudioStream;
+
+/** A software mixer.
+ *
+ *  The mixer mixes any number of audio streams (voices) into one stream of
+ *  interleaved, 16-bit stereo samples at a fixed output rate.
+ *
+ *  Every voice decodes ahead into its own ring buffer, which is allocated
+ *  when the voice is added (and kept around for the next voice using the
+ *  slot). Mixing then only resamples out of the ring buffers, applies the
+ *  voices' gains and sums them up, all in blocks of a fixed size. Nothing
+ *  is allocated while mixing.
+ *
+ *  Voices with more than two channels are mixed down to stereo. Voices with
+ *  a different sampling rate, or a pitch other than 1.0, are resampled with
+ *  linear interpolation.
+ *
+ *  The mixer does not lock; the owner needs to serialize access to it.
+ */
+class Mixer : boost::noncopyable {
+public:
+	static const size_t kVoiceInvalid = SIZE_MAX;
+
+	static const uint32_t kDefaultRate = 44100; ///< Default output sampling rate.
+	static const size_t   kBlockSize   = 256;   ///< Number of output frames mixed at once.
+	static const size_t   kRingFrames  = 4096;  ///< Number of source frames a voice decodes ahead.
+
+	Mixer(uint32_t rate = kDefaultRate);
+	~Mixer();
+
+	/** Return the output sampling rate. */
+	uint32_t getRate() const;
+
+	/** Set the master gain, applied to the final mix. */
+	void setGain(float gain);
+
+	// .--- Voices
+	/** Add a voice playing this audio stream. The stream is not taken over.
+	 *
+	 *  New voices start paused.
+	 */
+	size_t addVoice(AudioStream *stream);
+	/** Remove a voice. Its audio stream will not be accessed anymore. */
+	void removeVoice(size_t voice);
+
+	/** Pause or unpause a voice. */
+	void setVoicePaused(size_t voice, bool paused);
+	/** Set the gains of a voice's left and right output channels. */
+	void setVoiceGain(size_t voice, float left, float right);
+	/** Set the pitch of a voice. 1.0 plays the stream at its own rate. */
+	void setVoicePitch(size_t voice, float pitch);
+
+	/** Has this voice played all of its stream? */
+	bool isVoiceFinished(size_t voice) const;
+	/** Return the number of sample frames of its stream this voice has played. */
+	uint64_t getVoiceFramesPlayed(size_t voice) const;
+
+	/** Return the number of voices that are currently playing. */
+	size_t getPlayingVoiceCount() const;
+	// '---
+
+	/** Mix the next frames of output, as interleaved 16-bit stereo samples. */
+	void mix(int16_t *buffer, size_t frames);
+
+private:
+	/** A voice, playing one audio stream. */
+	struct Voice {
+		AudioStream *stream; ///< The stream we're playing, or 0 if the voice is unused.
+
+		size_t channels; ///< Number of channels in the stream.
+
+		std::unique_ptr<int16_t[]> ring; ///< The decoded frames, kRingFrames * channels samples.
+		size_t ringSize;                 ///< Number of samples allocated in the ring.
+
+		uint64_t decoded; ///< Number of frames decoded into the ring so far.
+		bool ended;       ///< Has the stream ended?
+
+		/** The current play position within the stream, in whole frames. */
+		uint64_t position;
+		/** The fractional part of the play position, as a 0.32 fixed-point number. */
+		uint32_t positionFrac;
+
+		/** The distance between two output frames within the stream, as a 32.32 fixed-point number. */
+		uint64_t step;
+		uint32_t streamRate; ///< The sampling rate of the stream.
+
+		float gainLeft;
+		float gainRight;
+
+		bool paused;
+
+		Voice();
+	};
+
+	uint32_t _rate;
+	float _gain;
+
+	std::vector<std::unique_ptr<Voice>> _voices;
+
+	// Scratch space for mixing one block
+	float _voiceLeft[kBlockSize];
+	float _voiceRight[kBlockSize];
+	float _mixLeft[kBlockSize];
+	float _mixRight[kBlockSize];
+
+	Voice *getVoice(size_t voice);
+	const Voice *getVoice(size_t voice) const;
+
+	void setStep(Voice &voice, float pitch);
+
+	/** Decode as much of the stream as fits into the voice's ring buffer. */
+	void decode(Voice &voice);
+
+	/** Resample up to frames frames of the voice into _voiceLeft/_voiceRight.
+	 *
+	 *  @return The number of frames produced, less than requested if the voice ran out of data.
+	 */
+	size_t resample(Voice &voice, size_t frames);
+
+	/** Mix one block of output. */
+	void mixBlock(int16_t *buffer, size_t frames);
+};
+
+} // End of namespace Sound
+
+#endif // SOUND_MIXER_H
@@ -27,6 +27,7 @@ src_sound_libsound_la_SOURCES += \
     src/sound/sound.h \
     src/sound/audiostream.h \
     src/sound/interleaver.h \
+    src/sound/mixer.h \
     src/sound/xactwavebank.h \
     src/sound/xactwavebank_ascii.h \
     src/sound/xactwavebank_binary.h \
@@ -40,8 +41,10 @@ src_sound_libsound_la_SOURCES += \
 
 src_sound_libsound_la_SOURCES += \
     src/sound/sound.cpp \
+    src/sound/soundfile.cpp \
     src/sound/audiostream.cpp \
     src/sound/interleaver.cpp \
+    src/sound/mixer.cpp \
     src/sound/xactwavebank.cpp \
     src/sound/xactwavebank_ascii.cpp \
     src/sound/xactwavebank_binary.cpp \
@@ -36,11 +36,15 @@
 
 #include <cassert>
 #include <cstring>
+#include <cmath>
+
+#include <limits>
 
 #include <boost/scope_exit.hpp>
 
 #include "src/common/util.h"
 #include "src/common/readstream.h"
+#include "src/common/writestream.h"
 #include "src/common/strutil.h"
 #include "src/common/error.h"
 #include "src/common/configman.h"
@@ -48,13 +52,7 @@
 
 #include "src/sound/sound.h"
 #include "src/sound/audiostream.h"
-#include "src/sound/decoders/asf.h"
-#ifdef ENABLE_MAD
-#include "src/sound/decoders/mp3.h"
-#endif
-#ifdef ENABLE_VORBIS
-#include "src/sound/decoders/vorbis.h"
-#endif
+#include "src/sound/mixer.h"
 #include "src/sound/decoders/wave.h"
 
 #include "src/events/events.h"
@@ -74,23 +72,38 @@ static const size_t kOpenALBufferCount = 5;
  */
 static const size_t kOpenALBufferSize = 32768;
 
+/** Number of sample frames per OpenAL buffer of the software mix.
+ *
+ *  Together with the number of buffers, this bounds the latency of the
+ *  software mix: at 44.1kHz, each buffer holds about 23ms of sound.
+ */
+static const size_t kMixerBufferFrames = 1024;
+
+/** How long the sound thread sleeps at most between updates. */
+static const std::chrono::milliseconds kUpdateInterval(100);
+
 namespace Sound {
 
 SoundManager::Channel::Channel(uint32_t i, size_t idx, SoundType t,
                                const TypeList::iterator &ti, AudioStream *s, bool d) :
 	id(i), index(idx), state(AL_PAUSED), stream(s, d), source(0),
-	type(t), typeIt(ti), finishedBuffers(0), gain(1.0f) {
+	type(t), typeIt(ti), finishedBuffers(0), gain(1.0f), voice(Mixer::kVoiceInvalid),
+	relative(true), minDistance(1.0f), maxDistance(std::numeric_limits<float>::max()) {
 
+	position[0] = position[1] = position[2] = 0.0f;
 }
 
 
-SoundManager::SoundManager() : _ready(false), _hasSound(false), _hasMultiChannel(false), _format51(0) {
+SoundManager::SoundManager() : _ready(false), _hasSound(false), _hasMultiChannel(false), _format51(0),
+	_useMixer(false), _headless(false), _headlessTime(0), _headlessOutputSize(0), _mixerSource(0) {
+
+	std::memset(_mixerBuffers, 0, sizeof(_mixerBuffers));
 }
 
 SoundManager::~SoundManager() {
 }
 
-void SoundManager::init() {
+void SoundManager::init(bool headless) {
 	for (size_t i = 0; i < kSoundTypeMAX; i++)
 		_types[i].gain = 1.0f;
 
@@ -103,25 +116,45 @@ void SoundManager::init() {
 	_hasMultiChannel = false;
 	_format51        = 0;
 
+	_useMixer = false;
+	_headless = headless;
+
+	_headlessTime = 0;
+
+	_listenerPosition[0] = _listenerPosition[1] = _listenerPosition[2] = 0.0f;
+
+	// The OpenAL default: looking down the negative z axis, with y up
+	const float orientation[] = { 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f };
+	std::memcpy(_listenerOrientation, orientation, sizeof(_listenerOrientation));
+
 	try {
-		_dev = alcOpenDevice(0);
-		if (!_dev)
-			throw Common::Exception("Could not open OpenAL device");
+		if (!_headless) {
+			_dev = alcOpenDevice(0);
+			if (!_dev)
+				throw Common::Exception("Could not open OpenAL device");
+
+			_ctx = alcCreateContext(_dev, 0);
+			if (!_ctx)
+				throw Common::Exception("Could not create OpenAL context: 0x%X", (uint) alGetError());
+
+			alcMakeContextCurrent(_ctx);
 
-		_ctx = alcCreateContext(_dev, 0);
-		if (!_ctx)
-			throw Common::Exception("Could not create OpenAL context: 0x%X", (uint) alGetError());
+			ALenum error = alGetError();
+			if (error != AL_NO_ERROR)
+				throw Common::Exception("Could not use OpenAL context: 0x%X", (uint) alGetError());
 
-		alcMakeContextCurrent(_ctx);
+			_hasMultiChannel = alIsExtensionPresent("AL_EXT_MCFORMATS") != 0;
+			_format51        = alGetEnumValue("AL_FORMAT_51CHN16");
 
-		ALenum error = alGetError();
-		if (error != AL_NO_ERROR)
-			throw Common::Exception("Could not use OpenAL context: 0x%X", (uint) alGetError());
+			_fillBuffer = std::make_unique<byte[]>(kOpenALBufferSize);
+		}
 
-		_hasMultiChannel = alIsExtensionPresent("AL_EXT_MCFORMATS") != 0;
-		_format51        = alGetEnumValue("AL_FORMAT_51CHN16");
+		// Headless mode can only mix in software
+		if (_headless || ConfigMan.getBool("soundmixer", false))
+			initMixer();
 
-		if (!createThread("SoundManager"))
+		// In headless mode, renderHeadless() drives the updates instead of a thread
+		if (!_headless && !createThread("SoundManager"))
 			throw Common::Exception("Failed to create sound thread: %s", SDL_GetError());
 
 		_hasSound = true;
@@ -142,7 +175,8 @@ void SoundManager::init() {
 	setTypeGain(kSoundTypeVoice, ConfigMan.getDouble("volume_voice", 1.0));
 	setTypeGain(kSoundTypeVideo, ConfigMan.getDouble("volume_video", 1.0));
 
-	alDistanceModel(AL_LINEAR_DISTANCE_CLAMPED);
+	if (!_headless)
+		alDistanceModel(AL_LINEAR_DISTANCE_CLAMPED);
 }
 
 void SoundManager::deinit() {
@@ -154,10 +188,16 @@ void SoundManager::deinit() {
 	for (size_t i = 0; i < kChannelCount; i++)
 		freeChannel(i);
 
+	finishHeadlessOutput();
+
 	if (_hasSound) {
-		alcMakeContextCurrent(0);
-		alcDestroyContext(_ctx);
-		alcCloseDevice(_dev);
+		deinitMixer();
+
+		if (!_headless) {
+			alcMakeContextCurrent(0);
+			alcDestroyContext(_ctx);
+			alcCloseDevice(_dev);
+		}
 	}
 
 	_ready = false;
@@ -206,6 +246,9 @@ bool SoundManager::isPlaying(size_t channel) const {
 	if (!_hasSound)
 		return true;
 
+	if (_useMixer)
+		return _channels[channel]->stream && !_mixer->isVoiceFinished(_channels[channel]->voice);
+
 	ALenum error = AL_NO_ERROR;
 
 	ALint val;
@@ -253,92 +296,6 @@ bool SoundManager::isPaused(const ChannelHandle &handle) {
 	return _channels[handle.channel]->state == AL_PAUSED;
 }
 
-AudioStream *SoundManager::makeAudioStream(Common::SeekableReadStream *stream) {
-	bool isMP3 = false;
-	uint32_t tag = stream->readUint32BE();
-
-	if (tag == 0xfff360c4) {
-		// Modified WAVE file (used in streamsounds folder, at least in KotOR 1/2)
-		stream = new Common::SeekableSubReadStream(stream, 0x1D6, stream->size(), true);
-
-	} else if (tag == MKTAG('R', 'I', 'F', 'F')) {
-		stream->seek(12);
-		tag = stream->readUint32BE();
-
-		if (tag != MKTAG('f', 'm', 't', ' '))
-			throw Common::Exception("Broken WAVE file (%s)", Common::debugTag(tag).c_str());
-
-		// Skip fmt chunk
-		stream->skip(stream->readUint32LE());
-		tag = stream->readUint32BE();
-
-		while ((tag == MKTAG('f', 'a', 'c', 't')) || (tag == MKTAG('P', 'A', 'D', ' ')) ||
-		       (tag == MKTAG('c', 'u', 'e', ' ')) || (tag == MKTAG('L', 'I', 'S', 'T')) ||
-		       (tag == MKTAG('s', 'm', 'p', 'l'))) {
-			// Skip useless chunks
-			stream->skip(stream->readUint32LE());
-			tag = stream->readUint32BE();
-		}
-
-		if (tag != MKTAG('d', 'a', 't', 'a'))
-			throw Common::Exception("Found invalid tag in WAVE file: %s", Common::debugTag(tag).c_str());
-
-		uint32_t dataSize = stream->readUint32LE();
-		if (dataSize == 0) {
-			isMP3 = true;
-			stream = new Common::SeekableSubReadStream(stream, stream->pos(), stream->size(), true);
-		} else
-			// Just a regular WAVE
-			stream->seek(0);
-
-	} else if ((tag                    == MKTAG('B', 'M', 'U', ' ')) &&
-	           (stream->readUint32BE() == MKTAG('V', '1', '.', '0'))) {
-
-		// BMU files: MP3 with extra header
-		isMP3 = true;
-		stream = new Common::SeekableSubReadStream(stream, stream->pos(), stream->size(), true);
-
-	} else if (tag == MKTAG('O', 'g', 'g', 'S')) {
-
-#ifdef ENABLE_VORBIS
-		stream->seek(0);
-		return makeVorbisStream(stream, true);
-#else
-		throw Common::Exception("Vorbis decoding disabled when building without libvorbis");
-#endif
-
-	} else if (tag == 0x3026B275) {
-
-		// ASF (most probably with WMAv2)
-		stream->seek(0);
-		return makeASFStream(stream, true);
-
-	} else if (((tag & 0xFFFFFF00) | 0x20) == MKTAG('I', 'D', '3', ' ')) {
-
-		// ID3v2 tag found => Should be MP3.
-		stream->seek(0);
-		isMP3 = true;
-
-	} else if ((tag & 0xFFFA0000) == 0xFFFA0000) {
-
-		// MPEG sync + MPEG1 layer 3 bits found => Should be MP3.
-		// NOTE: To decrease the chances of false positives, we could look at more than just the first frame.
-		stream->seek(0);
-		isMP3 = true;
-
-	} else
-		throw Common::Exception("Unknown sound format %s", Common::debugTag(tag).c_str());
-
-	if (isMP3)
-#ifdef ENABLE_MAD
-		return makeMP3Stream(stream, true);
-#else
-		throw Common::Exception("MP3 decoding disabled when building without libmad");
-#endif
-
-	return makeWAVStream(stream, true);
-}
-
 ChannelHandle SoundManager::playAudioStream(AudioStream *audStream, SoundType type, bool disposeAfterUse) {
 	assert((type >= 0) && (type < kSoundTypeMAX));
 
@@ -367,7 +324,10 @@ ChannelHandle SoundManager::playAudioStream(AudioStream *audStream, SoundType ty
 
 	ALenum error = AL_NO_ERROR;
 
-	if (_hasSound) {
+	if (_hasSound && _useMixer) {
+		channel.voice = _mixer->addVoice(channel.stream.get());
+
+	} else if (_hasSound) {
 		// Create the source
 		alGenSources(1, &channel.source);
 		if ((error = alGetError()) != AL_NO_ERROR)
@@ -405,6 +365,9 @@ ChannelHandle SoundManager::playAudioStream(AudioStream *audStream, SoundType ty
 	_types[channel.type].list.push_back(&channel);
 	channel.typeIt = --_types[channel.type].list.end();
 
+	if (_hasSound && _useMixer)
+		updateVoice(channel);
+
 	debugC(Common::kDebugSound, 2, "Created sound channel %s", formatChannel(handle).c_str());
 
 	success = true;
@@ -524,7 +487,10 @@ void SoundManager::setListenerGain(float gain) {
 
 	std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-	if (_hasSound)
+	// The software mix is already scaled before it reaches OpenAL
+	if (_useMixer)
+		_mixer->setGain(gain);
+	else if (_hasSound)
 		alListenerf(AL_GAIN, gain);
 }
 
@@ -533,7 +499,16 @@ void SoundManager::setListenerPosition(float x, float y, float z) {
 
 	std::lock_guard<std::recursive_mutex> lock(_mutex);
 
+	_listenerPosition[0] = x;
+	_listenerPosition[1] = y;
+	_listenerPosition[2] = z;
+
 	alListener3f(AL_POSITION, x, y, z);
+
+	if (_useMixer)
+		for (size_t i = 0; i < kSoundTypeMAX; i++)
+			for (TypeList::iterator t = _types[i].list.begin(); t != _types[i].list.end(); ++t)
+				updateVoice(**t);
 }
 
 void SoundManager::setListenerOrientation(float dirX, float dirY, float dirZ, float upX, float upY, float upZ) {
@@ -542,7 +517,14 @@ void SoundManager::setListenerOrientation(float dirX, float dirY, float dirZ, fl
 	std::lock_guard<std::recursive_mutex> lock(_mutex);
 
 	float orientation[] = {dirX, dirY, dirZ, upX, upY, upZ};
+	std::memcpy(_listenerOrientation, orientation, sizeof(_listenerOrientation));
+
 	alListenerfv(AL_ORIENTATION, orientation);
+
+	if (_useMixer)
+		for (size_t i = 0; i < kSoundTypeMAX; i++)
+			for (TypeList::iterator t = _types[i].list.begin(); t != _types[i].list.end(); ++t)
+				updateVoice(**t);
 }
 
 void SoundManager::setChannelPosition(const ChannelHandle &handle, float x, float y, float z) {
@@ -556,7 +538,13 @@ void SoundManager::setChannelPosition(const ChannelHandle &handle, float x, floa
 		throw Common::Exception("Cannot set position of a non-mono sound in %s",
 		                        formatChannel(handle).c_str());
 
-	if (_hasSound)
+	channel->position[0] = x;
+	channel->position[1] = y;
+	channel->position[2] = z;
+
+	if (_hasSound && _useMixer)
+		updateVoice(*channel);
+	else if (_hasSound)
 		alSource3f(channel->source, AL_POSITION, x, y, z);
 }
 
@@ -571,8 +559,14 @@ void SoundManager::getChannelPosition(const ChannelHandle &handle, float &x, flo
 		throw Common::Exception("Cannot get position of a non-mono sound in %s",
 		                        formatChannel(handle).c_str());
 
-	if (_hasSound)
+	if (_hasSound && !_useMixer) {
 		alGetSource3f(channel->source, AL_POSITION, &x, &y, &z);
+		return;
+	}
+
+	x = channel->position[0];
+	y = channel->position[1];
+	z = channel->position[2];
 }
 
 void SoundManager::setChannelGain(const ChannelHandle &handle, float gain) {
@@ -584,7 +578,9 @@ void SoundManager::setChannelGain(const ChannelHandle &handle, float gain) {
 
 	channel->gain = gain;
 
-	if (_hasSound)
+	if (_hasSound && _useMixer)
+		updateVoice(*channel);
+	else if (_hasSound)
 		alSourcef(channel->source, AL_GAIN, _types[channel->type].gain * gain);
 }
 
@@ -595,7 +591,9 @@ void SoundManager::setChannelPitch(const ChannelHandle &handle, float pitch) {
 	if (!channel || !channel->stream)
 		throw Common::Exception("Invalid channel");
 
-	if (_hasSound)
+	if (_hasSound && _useMixer)
+		_mixer->setVoicePitch(channel->voice, pitch);
+	else if (_hasSound)
 		alSourcef(channel->source, AL_PITCH, pitch);
 }
 
@@ -606,7 +604,11 @@ void SoundManager::setChannelRelative(const ChannelHandle &handle, bool relative
 	if (!channel || !channel->stream)
 		throw Common::Exception("Invalid channel");
 
-	if (_hasSound)
+	channel->relative = relative;
+
+	if (_hasSound && _useMixer)
+		updateVoice(*channel);
+	else if (_hasSound)
 		alSourcei(channel->source, AL_SOURCE_RELATIVE, relative ? AL_TRUE : AL_FALSE);
 }
 
@@ -617,7 +619,12 @@ void SoundManager::setChannelDistance(const ChannelHandle &handle, float minDist
 	if (!channel || !channel->stream)
 		throw Common::Exception("Invalid channel");
 
-	if (_hasSound) {
+	channel->minDistance = minDistance;
+	channel->maxDistance = maxDistance;
+
+	if (_hasSound && _useMixer) {
+		updateVoice(*channel);
+	} else if (_hasSound) {
 		alSourcef(channel->source, AL_REFERENCE_DISTANCE, minDistance);
 		alSourcef(channel->source, AL_MAX_DISTANCE, maxDistance);
 	}
@@ -630,6 +637,9 @@ uint64_t SoundManager::getChannelSamplesPlayed(const ChannelHandle &handle) {
 	if (!channel || !channel->stream)
 		return 0;
 
+	if (_useMixer)
+		return _mixer->getVoiceFramesPlayed(channel->voice);
+
 	// Update the queued/unqueued buffers to make sure the channel is up-to-date
 	bufferData(*channel);
 
@@ -666,13 +676,15 @@ void SoundManager::setTypeGain(SoundType type, float gain) {
 	for (TypeList::iterator t = _types[type].list.begin(); t != _types[type].list.end(); ++t) {
 		assert(*t);
 
-		if (_hasSound)
+		if (_hasSound && _useMixer)
+			updateVoice(**t);
+		else if (_hasSound)
 			alSourcef((*t)->source, AL_GAIN, (*t)->gain * gain);
 	}
 }
 
 bool SoundManager::fillBuffer(const Channel &channel, ALuint alBuffer,
-                              AudioStream *stream, ALsizei &bufferedSize) const {
+                              AudioStream *stream, ALsizei &bufferedSize) {
 
 	bufferedSize = 0;
 
@@ -710,17 +722,14 @@ bool SoundManager::fillBuffer(const Channel &channel, ALuint alBuffer,
 	// Read in the required amount of samples
 	size_t numSamples = kOpenALBufferSize / 2;
 
-	std::unique_ptr<byte[]> buffer = std::make_unique<byte[]>(kOpenALBufferSize);
-	std::memset(buffer.get(), 0, kOpenALBufferSize);
-
-	numSamples = stream->readBuffer(reinterpret_cast<int16_t *>(buffer.get()), numSamples);
+	numSamples = stream->readBuffer(reinterpret_cast<int16_t *>(_fillBuffer.get()), numSamples);
 	if (numSamples == AudioStream::kSizeInvalid) {
 		warning("Failed reading from stream while filling buffer in %s", formatChannel(&channel).c_str());
 		return false;
 	}
 
 	bufferedSize = numSamples * 2;
-	alBufferData(alBuffer, format, buffer.get(), bufferedSize, stream->getRate());
+	alBufferData(alBuffer, format, _fillBuffer.get(), bufferedSize, stream->getRate());
 
 	ALenum error = alGetError();
 	if (error != AL_NO_ERROR) {
@@ -742,7 +751,7 @@ void SoundManager::bufferData(Channel &channel) {
 	if (!channel.stream)
 		return;
 
-	if (!_hasSound)
+	if (!_hasSound || _useMixer)
 		return;
 
 	ALenum error = AL_NO_ERROR;
@@ -810,10 +819,16 @@ void SoundManager::update() {
 			continue;
 		}
 
+		if (_useMixer)
+			_mixer->setVoicePaused(_channels[i]->voice, _channels[i]->state != AL_PLAYING);
+
 		// Try to buffer some more data
 		bufferData(i);
 	}
 
+	if (_useMixer && !_headless)
+		bufferMixer();
+
 	debugC(Common::kDebugSound, 9, "Active sound channel: %s", Common::composeString(channelCount).c_str());
 }
 
@@ -845,7 +860,9 @@ void SoundManager::pauseChannel(Channel *channel, bool pause) {
 
 	ALenum error = AL_NO_ERROR;
 	if (pause) {
-		if (_hasSound) {
+		if (_hasSound && _useMixer) {
+			_mixer->setVoicePaused(channel->voice, true);
+		} else if (_hasSound) {
 			alSourcePause(channel->source);
 			if ((error = alGetError()) != AL_NO_ERROR)
 				warning("OpenAL error while attempting to pause channel %s: 0x%X",
@@ -889,10 +906,14 @@ void SoundManager::freeChannel(size_t channel) {
 		// Nothing to do
 		return;
 
+	// The mixer must not touch the stream anymore
+	if (_useMixer)
+		_mixer->removeVoice(c->voice);
+
 	// Discard the stream
 	c->stream.reset();
 
-	if (_hasSound) {
+	if (_hasSound && !_useMixer) {
 		// Delete the channel's OpenAL source
 		if (c->source)
 			alDeleteSources(1, &c->source);
@@ -910,11 +931,259 @@ void SoundManager::freeChannel(size_t channel) {
 	_channels[channel].reset();
 }
 
+void SoundManager::initMixer() {
+	_mixer     = std::make_unique<Mixer>();
+	_mixBuffer = std::make_unique<int16_t[]>(kMixerBufferFrames * 2);
+
+	if (_headless) {
+		_useMixer = true;
+
+		status("Mixing sound headlessly, at %uHz", (uint) _mixer->getRate());
+		return;
+	}
+
+	ALenum error = AL_NO_ERROR;
+
+	alGenSources(1, &_mixerSource);
+	if ((error = alGetError()) != AL_NO_ERROR)
+		throw Common::Exception("OpenAL error while generating the mixer source: 0x%X", error);
+
+	// The mix is already positioned, so keep the mixer source on the listener
+	alSourcei(_mixerSource, AL_SOURCE_RELATIVE, AL_TRUE);
+
+	alGenBuffers(kMixerBufferCount, _mixerBuffers);
+	if ((error = alGetError()) != AL_NO_ERROR)
+		throw Common::Exception("OpenAL error while generating the mixer buffers: 0x%X", error);
+
+	// Start with all buffers queued. There's nothing to mix yet, so they're silent
+	for (size_t i = 0; i < kMixerBufferCount; i++) {
+		_mixer->mix(_mixBuffer.get(), kMixerBufferFrames);
+
+		alBufferData(_mixerBuffers[i], AL_FORMAT_STEREO16, _mixBuffer.get(),
+		             kMixerBufferFrames * 2 * sizeof(int16_t), _mixer->getRate());
+	}
+
+	alSourceQueueBuffers(_mixerSource, kMixerBufferCount, _mixerBuffers);
+	alSourcePlay(_mixerSource);
+
+	if ((error = alGetError()) != AL_NO_ERROR)
+		throw Common::Exception("OpenAL error while starting the mixer source: 0x%X", error);
+
+	_useMixer = true;
+
+	status("Mixing sound in software, at %uHz", (uint) _mixer->getRate());
+}
+
+void SoundManager::deinitMixer() {
+	if (!_useMixer)
+		return;
+
+	if (!_headless) {
+		alSourceStop(_mixerSource);
+		alDeleteSources(1, &_mixerSource);
+		alDeleteBuffers(kMixerBufferCount, _mixerBuffers);
+	}
+
+	_mixerSource = 0;
+	std::memset(_mixerBuffers, 0, sizeof(_mixerBuffers));
+
+	_mixer.reset();
+	_mixBuffer.reset();
+
+	_useMixer = false;
+}
+
+bool SoundManager::isHeadless() const {
+	return _headless;
+}
+
+uint32_t SoundManager::getHeadlessRate() const {
+	return _mixer ? _mixer->getRate() : Mixer::kDefaultRate;
+}
+
+uint64_t SoundManager::getHeadlessTime() const {
+	return _headlessTime;
+}
+
+void SoundManager::renderHeadless(int16_t *data, size_t frames) {
+	checkReady();
+
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+	if (!_headless || !_useMixer)
+		throw Common::Exception("SoundManager::renderHeadless(): Not in headless mode");
+
+	/* Mix in chunks of the same size the sound thread would refill OpenAL with,
+	 * updating the channels in between. That way, channels get freed and their
+	 * pause state picked up at the same points of the virtual clock every time. */
+
+	while (frames > 0) {
+		const size_t chunk = MIN(frames, kMixerBufferFrames);
+
+		update();
+
+		int16_t *buffer = data ? data : _mixBuffer.get();
+		_mixer->mix(buffer, chunk);
+
+		if (_headlessOutput) {
+			writeWAVData(*_headlessOutput, buffer, chunk * 2);
+			_headlessOutputSize += chunk * 2 * sizeof(int16_t);
+		}
+
+		_headlessTime += chunk;
+
+		frames -= chunk;
+		if (data)
+			data += chunk * 2;
+	}
+}
+
+void SoundManager::setHeadlessOutput(Common::SeekableWriteStream *wav) {
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+	finishHeadlessOutput();
+
+	_headlessOutput.reset(wav);
+	if (!_headlessOutput)
+		return;
+
+	// Write a placeholder header for now, we don't know the size yet
+	writeWAVHeader(*_headlessOutput, 0, 2, getHeadlessRate());
+}
+
+void SoundManager::finishHeadlessOutput() {
+	if (!_headlessOutput)
+		return;
+
+	const size_t end = _headlessOutput->pos();
+
+	_headlessOutput->seek(0);
+	writeWAVHeader(*_headlessOutput, _headlessOutputSize, 2, getHeadlessRate());
+	_headlessOutput->seek(end);
+
+	_headlessOutput->flush();
+
+	_headlessOutput.reset();
+	_headlessOutputSize = 0;
+}
+
+void SoundManager::bufferMixer() {
+	ALenum error = AL_NO_ERROR;
+
+	ALint buffersProcessed = 0;
+	alGetSourcei(_mixerSource, AL_BUFFERS_PROCESSED, &buffersProcessed);
+	if ((error = alGetError()) != AL_NO_ERROR)
+		throw Common::Exception("OpenAL error while getting processed mixer buffers: 0x%X", error);
+
+	buffersProcessed = CLIP<ALint>(buffersProcessed, 0, kMixerBufferCount);
+
+	// Unqueue the buffers that finished playing, mix into them and queue them again
+	ALuint freeBuffers[kMixerBufferCount];
+	alSourceUnqueueBuffers(_mixerSource, buffersProcessed, freeBuffers);
+
+	for (ALint i = 0; i < buffersProcessed; i++) {
+		_mixer->mix(_mixBuffer.get(), kMixerBufferFrames);
+
+		alBufferData(freeBuffers[i], AL_FORMAT_STEREO16, _mixBuffer.get(),
+		             kMixerBufferFrames * 2 * sizeof(int16_t), _mixer->getRate());
+		alSourceQueueBuffers(_mixerSource, 1, &freeBuffers[i]);
+	}
+
+	if ((error = alGetError()) != AL_NO_ERROR)
+		throw Common::Exception("OpenAL error while queueing mixer buffers: 0x%X", error);
+
+	// If we were too late and the source ran dry, restart it
+	ALint state;
+	alGetSourcei(_mixerSource, AL_SOURCE_STATE, &state);
+	if (state != AL_PLAYING)
+		alSourcePlay(_mixerSource);
+}
+
+void SoundManager::updateVoice(Channel &channel) {
+	if (!_useMixer || !channel.stream)
+		return;
+
+	float gain  = _types[channel.type].gain * channel.gain;
+	float left  = gain;
+	float right = gain;
+
+	// Only mono sounds can be positioned
+	if (channel.stream->getChannels() == 1) {
+		float x = channel.position[0];
+		float y = channel.position[1];
+		float z = channel.position[2];
+
+		if (!channel.relative) {
+			x -= _listenerPosition[0];
+			y -= _listenerPosition[1];
+			z -= _listenerPosition[2];
+		}
+
+		const float distance = std::sqrt(x * x + y * y + z * z);
+
+		// Linear, clamped distance attenuation, like the AL_LINEAR_DISTANCE_CLAMPED model we use with OpenAL
+		if (channel.maxDistance > channel.minDistance) {
+			const float clamped = CLIP(distance, channel.minDistance, channel.maxDistance);
+
+			gain *= 1.0f - (clamped - channel.minDistance) / (channel.maxDistance - channel.minDistance);
+		}
+
+		left = right = gain;
+
+		// Pan by how far to the right of the listener the sound is
+		const float *dir = _listenerOrientation;
+		const float *up  = _listenerOrientation + 3;
+
+		const float rightX = dir[1] * up[2] - dir[2] * up[1];
+		const float rightY = dir[2] * up[0] - dir[0] * up[2];
+		const float rightZ = dir[0] * up[1] - dir[1] * up[0];
+
+		const float rightLength = std::sqrt(rightX * rightX + rightY * rightY + rightZ * rightZ);
+
+		if ((distance > 0.0f) && (rightLength > 0.0f)) {
+			const float pan = CLIP((x * rightX + y * rightY + z * rightZ) / (distance * rightLength), -1.0f, 1.0f);
+
+			left  = gain * MIN(1.0f, 1.0f - pan);
+			right = gain * MIN(1.0f, 1.0f + pan);
+		}
+	}
+
+	_mixer->setVoiceGain(channel.voice, left, right);
+}
+
+std::chrono::milliseconds SoundManager::getUpdateInterval() {
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+	if (!_useMixer)
+		return kUpdateInterval;
+
+	/* Wake up again when the currently playing buffer of the mix has
+	 * finished, so that it can be refilled right away. */
+
+	ALint buffersProcessed = 0, byteOffset = 0;
+	alGetSourcei(_mixerSource, AL_BUFFERS_PROCESSED, &buffersProcessed);
+	alGetSourcei(_mixerSource, AL_BYTE_OFFSET, &byteOffset);
+
+	if (buffersProcessed > 0)
+		return std::chrono::milliseconds(0);
+
+	// The mix is 16-bit stereo, so each frame takes 4 bytes
+	const size_t framesPlayed = MAX<ALint>(byteOffset, 0) / (2 * sizeof(int16_t));
+	const size_t framesLeft   = kMixerBufferFrames - MIN(framesPlayed, kMixerBufferFrames);
+
+	const std::chrono::milliseconds interval((framesLeft * 1000) / _mixer->getRate());
+
+	return CLIP(interval, std::chrono::milliseconds(1), kUpdateInterval);
+}
+
 void SoundManager::threadMethod() {
 	while (!_killThread.load(std::memory_order_relaxed)) {
 		update();
+
+		const std::chrono::milliseconds interval = getUpdateInterval();
+
 		std::unique_lock<std::recursive_mutex> lock(_needUpdateMutex);
-		_needUpdate.wait_for(lock, std::chrono::duration<int, std::milli>(100));
+		_needUpdate.wait_for(lock, interval);
 	}
 }
 
@@ -38,6 +38,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <chrono>
 
 #include "src/common/types.h"
 #include "src/common/disposableptr.h"
@@ -50,20 +51,35 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class SeekableWriteStream;
 }
 
 namespace Sound {
 
 class AudioStream;
+class Mixer;
 
-/** The sound manager. */
+/** The sound manager.
+ *
+ *  Normally, every channel is played through its own OpenAL source. If the
+ *  "soundmixer" option is set, all channels are instead mixed in software,
+ *  and the mix is played through a single OpenAL source.
+ *
+ *  In headless mode, no sound device is opened at all. All channels are
+ *  mixed in software, but only when renderHeadless() is called, which
+ *  advances a virtual clock. The output of the same sequence of calls is
+ *  therefore always the same, regardless of the speed of the machine.
+ */
 class SoundManager : public Common::Singleton<SoundManager>, public Common::Thread {
 public:
 	SoundManager();
 	~SoundManager();
 
-	/** Initialize the sound subsystem. */
-	void init();
+	/** Initialize the sound subsystem.
+	 *
+	 *  @param headless Don't open a sound device, and only mix on calls to renderHeadless().
+	 */
+	void init(bool headless = false);
 	/** Deinitialize the sound subsystem. */
 	void deinit();
 
@@ -174,6 +190,32 @@ public:
 	void setTypeGain(SoundType type, float gain);
 	// '---
 
+	// .--- Headless mode
+	/** Are we running in headless mode? */
+	bool isHeadless() const;
+
+	/** Return the sampling rate of the headless mix. */
+	uint32_t getHeadlessRate() const;
+	/** Return the virtual clock of the headless mix, in sample frames rendered so far. */
+	uint64_t getHeadlessTime() const;
+
+	/** Mix the next frames of all channels, advancing the virtual clock.
+	 *
+	 *  @param data   Receives the mix as interleaved 16-bit stereo samples, frames * 2 of them.
+	 *                May be 0, if the mix is only wanted in the headless output file.
+	 *  @param frames The number of sample frames to mix.
+	 */
+	void renderHeadless(int16_t *data, size_t frames);
+
+	/** Additionally write everything rendered from now on into a WAVE file.
+	 *
+	 *  The stream is taken over, and finalized once another stream is set, or
+	 *  the sound subsystem is deinitialized. Setting 0 just finalizes the
+	 *  current stream.
+	 */
+	void setHeadlessOutput(Common::SeekableWriteStream *wav);
+	// '---
+
 	// .--- Utility methods
 	/** Create an audio stream from this data stream.
 	 *
@@ -189,6 +231,8 @@ public:
 private:
 	static const size_t kChannelCount = 65535; ///< Maximal number of channels.
 
+	static const size_t kMixerBufferCount = 4; ///< Number of OpenAL buffers queued for the software mix.
+
 	struct Channel;
 	typedef std::list<Channel *> TypeList;
 
@@ -222,6 +266,13 @@ private:
 
 		float gain; ///< The channel's gain.
 
+		size_t voice; ///< The channel's voice in the software mixer.
+
+		float position[3]; ///< The position of the sound.
+		bool  relative;    ///< Is the position relative to the listener?
+		float minDistance; ///< Up to this distance, the sound plays at full gain.
+		float maxDistance; ///< From this distance on, the sound is inaudible.
+
 		Channel(uint32_t i, size_t idx, SoundType t, const TypeList::iterator &ti, AudioStream *s, bool d);
 	};
 
@@ -246,9 +297,37 @@ private:
 	ALCdevice *_dev;
 	ALCcontext *_ctx;
 
+	/** Buffer to decode sound into, before handing it to OpenAL. */
+	std::unique_ptr<byte[]> _fillBuffer;
+
+	float _listenerPosition[3];    ///< The position of the listener.
+	float _listenerOrientation[6]; ///< The direction and up vectors of the listener.
+
+	bool _useMixer; ///< Are we mixing in software?
+	bool _headless; ///< Are we only mixing on demand, without a sound device?
+
+	uint64_t _headlessTime; ///< Sample frames rendered in headless mode so far.
+
+	std::unique_ptr<Common::SeekableWriteStream> _headlessOutput; ///< WAVE file receiving the headless mix.
+	uint32_t _headlessOutputSize; ///< Bytes of samples written to the headless output so far.
+
+	std::unique_ptr<Mixer> _mixer;         ///< The software mixer.
+	std::unique_ptr<int16_t[]> _mixBuffer; ///< Buffer the software mixer mixes into.
+
+	ALuint _mixerSource;     ///< OpenAL source playing the software mix.
+	ALuint _mixerBuffers[kMixerBufferCount]; ///< OpenAL buffers of the software mix.
+
 	/** Check that the SoundManager was properly initialized. */
 	void checkReady();
 
+	/** Create the software mixer and the OpenAL source it plays through. */
+	void initMixer();
+	/** Destroy the software mixer. */
+	void deinitMixer();
+
+	/** Fix up the header of the headless output file and close it. */
+	void finishHeadlessOutput();
+
 	/** Update the sound information. Called regularly from within the thread method. */
 	void update();
 
@@ -260,6 +339,14 @@ private:
 	/** Buffer more sound from the channel to the OpenAL buffers. */
 	void bufferData(size_t channel);
 
+	/** Mix more sound into the OpenAL buffers of the software mix. */
+	void bufferMixer();
+	/** Update the gains of the channel's mixer voice from its type, gain and position. */
+	void updateVoice(Channel &channel);
+
+	/** Return how long the sound thread can sleep before the next update. */
+	std::chrono::milliseconds getUpdateInterval();
+
 	/** Is that channel currently playing a sound? */
 	bool isPlaying(size_t channel) const;
 
@@ -282,7 +369,7 @@ private:
 
 	/** Fill the buffer with data from the audio stream. */
 	bool fillBuffer(const Channel &channel, ALuint alBuffer,
-	                AudioStream *stream, ALsizei &bufferedSize) const;
+	                AudioStream *stream, ALsizei &bufferedSize);
 
 	/** Return a string representing this channel. */
 	Common::UString formatChannel(const Channel *channel) const;
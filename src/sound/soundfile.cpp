@@ -0,0 +1,132 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Detecting the format of sound files.
+ *
+ *  This lives apart from the rest of the sound manager, so that it can be
+ *  used without pulling in OpenAL.
+ */
+
+#include "src/common/util.h"
+#include "src/common/readstream.h"
+#include "src/common/strutil.h"
+#include "src/common/error.h"
+
+#include "src/sound/sound.h"
+#include "src/sound/audiostream.h"
+#include "src/sound/decoders/asf.h"
+#ifdef ENABLE_MAD
+#include "src/sound/decoders/mp3.h"
+#endif
+#ifdef ENABLE_VORBIS
+#include "src/sound/decoders/vorbis.h"
+#endif
+#include "src/sound/decoders/wave.h"
+
+namespace Sound {
+
+AudioStream *SoundManager::makeAudioStream(Common::SeekableReadStream *stream) {
+	bool isMP3 = false;
+	uint32_t tag = stream->readUint32BE();
+
+	if (tag == 0xfff360c4) {
+		// Modified WAVE file (used in streamsounds folder, at least in KotOR 1/2)
+		stream = new Common::SeekableSubReadStream(stream, 0x1D6, stream->size(), true);
+
+	} else if (tag == MKTAG('R', 'I', 'F', 'F')) {
+		stream->seek(12);
+		tag = stream->readUint32BE();
+
+		if (tag != MKTAG('f', 'm', 't', ' '))
+			throw Common::Exception("Broken WAVE file (%s)", Common::debugTag(tag).c_str());
+
+		// Skip fmt chunk
+		stream->skip(stream->readUint32LE());
+		tag = stream->readUint32BE();
+
+		while ((tag == MKTAG('f', 'a', 'c', 't')) || (tag == MKTAG('P', 'A', 'D', ' ')) ||
+		       (tag == MKTAG('c', 'u', 'e', ' ')) || (tag == MKTAG('L', 'I', 'S', 'T')) ||
+		       (tag == MKTAG('s', 'm', 'p', 'l'))) {
+			// Skip useless chunks
+			stream->skip(stream->readUint32LE());
+			tag = stream->readUint32BE();
+		}
+
+		if (tag != MKTAG('d', 'a', 't', 'a'))
+			throw Common::Exception("Found invalid tag in WAVE file: %s", Common::debugTag(tag).c_str());
+
+		uint32_t dataSize = stream->readUint32LE();
+		if (dataSize == 0) {
+			isMP3 = true;
+			stream = new Common::SeekableSubReadStream(stream, stream->pos(), stream->size(), true);
+		} else
+			// Just a regular WAVE
+			stream->seek(0);
+
+	} else if ((tag                    == MKTAG('B', 'M', 'U', ' ')) &&
+	           (stream->readUint32BE() == MKTAG('V', '1', '.', '0'))) {
+
+		// BMU files: MP3 with extra header
+		isMP3 = true;
+		stream = new Common::SeekableSubReadStream(stream, stream->pos(), stream->size(), true);
+
+	} else if (tag == MKTAG('O', 'g', 'g', 'S')) {
+
+#ifdef ENABLE_VORBIS
+		stream->seek(0);
+		return makeVorbisStream(stream, true);
+#else
+		throw Common::Exception("Vorbis decoding disabled when building without libvorbis");
+#endif
+
+	} else if (tag == 0x3026B275) {
+
+		// ASF (most probably with WMAv2)
+		stream->seek(0);
+		return makeASFStream(stream, true);
+
+	} else if (((tag & 0xFFFFFF00) | 0x20) == MKTAG('I', 'D', '3', ' ')) {
+
+		// ID3v2 tag found => Should be MP3.
+		stream->seek(0);
+		isMP3 = true;
+
+	} else if ((tag & 0xFFFA0000) == 0xFFFA0000) {
+
+		// MPEG sync + MPEG1 layer 3 bits found => Should be MP3.
+		// NOTE: To decrease the chances of false positives, we could look at more than just the first frame.
+		stream->seek(0);
+		isMP3 = true;
+
+	} else
+		throw Common::Exception("Unknown sound format %s", Common::debugTag(tag).c_str());
+
+	if (isMP3)
+#ifdef ENABLE_MAD
+		return makeMP3Stream(stream, true);
+#else
+		throw Common::Exception("MP3 decoding disabled when building without libmad");
+#endif
+
+	return makeWAVStream(stream, true);
+}
+
+} // End of namespace Sound
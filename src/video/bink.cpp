@@ -184,7 +184,7 @@ void Bink::decodeNextTrackFrame(VideoTrack &track) {
 	size_t videoPacketEnd   = _bink->pos() + frameSize;
 
 	frame.bits =
-		new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink.get(),
+		new Common::BufferedBitStream32LELSB(new Common::SeekableSubReadStream(_bink.get(),
 		    videoPacketStart, videoPacketEnd), true);
 
 	assert(_surface);
@@ -1363,7 +1363,7 @@ void Bink::BinkAudioTrack::decodeAudio(Common::SeekableReadStream& bink, const s
 		uint32_t sampleCount = bink.readUint32LE() / (2 * _info.channels);
 
 		// Create a substream for these bits
-		Common::BitStream32LELSB bits(new Common::SeekableSubReadStream(&bink, bink.pos(), bink.pos() + audioPacketLength - 4), true);
+		Common::BufferedBitStream32LELSB bits(new Common::SeekableSubReadStream(&bink, bink.pos(), bink.pos() + audioPacketLength - 4), true);
 
 		int outSize = _info.frameLen * _info.channels;
 
@@ -309,8 +309,8 @@ void XMVWMV2Codec::init() {
 void XMVWMV2Codec::decodeFrame(Graphics::Surface &surface,
                                Common::SeekableReadStream &dataStream) {
 
-	Common::BitStream32LEMSB bits(dataStream);
-	DecodeContext            ctx(bits);
+	Common::BufferedBitStream32LEMSB bits(dataStream);
+	DecodeContext                    ctx(bits);
 
 	initDecodeContext(ctx);
 
@@ -54,6 +54,8 @@
 
 #include "src/aurora/nwscript/objectman.h"
 #include "src/aurora/nwscript/functionman.h"
+#include "src/aurora/nwscript/programcache.h"
+#include "src/aurora/nwscript/scheduler.h"
 
 #include "src/graphics/queueman.h"
 #include "src/graphics/graphics.h"
@@ -272,6 +274,8 @@ static void initConfig() {
 	ConfigMan.setDouble(Common::kConfigRealmDefault, "volume_voice", 1.0);
 	ConfigMan.setDouble(Common::kConfigRealmDefault, "volume_video", 1.0);
 
+	ConfigMan.setBool(Common::kConfigRealmDefault, "soundmixer", false);
+
 	ConfigMan.setBool(Common::kConfigRealmDefault, "showfps", false);
 
 	ConfigMan.setBool(Common::kConfigRealmDefault, "skipvideos", false);
@@ -343,6 +347,8 @@ static void deinit() {
 
 	Aurora::NWScript::ObjectManager::destroy();
 	Aurora::NWScript::FunctionManager::destroy();
+	Aurora::NWScript::ProgramCache::destroy();
+	Aurora::NWScript::ScriptScheduler::destroy();
 
 	Engines::EngineManager::destroy();
 	Engines::TokenManager::destroy();
@@ -27,6 +27,7 @@
 #include "gtest/gtest.h"
 
 #include "src/common/ustring.h"
+#include "src/common/string.h"
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
 #include "src/common/memwritestream.h"
@@ -151,6 +152,8 @@ GTEST_TEST(TwoDAFileASCII, getRow) {
 		}
 	}
 
+	EXPECT_EQ(&twoda.getRow("StringValue", "fooBAR"), &twoda.getRow(0));
+
 	EXPECT_EQ(&twoda.getRow("Nope", "0"   ), &twoda.getRow(Aurora::kFieldIDInvalid));
 	EXPECT_EQ(&twoda.getRow("ID"  , "Nope"), &twoda.getRow(Aurora::kFieldIDInvalid));
 }
@@ -649,6 +652,47 @@ GTEST_TEST(TwoDAFileVariants, binaryWrongRowIndices) {
 	EXPECT_STREQ(twoda.getRow(0).getString("Nope").c_str(), "");
 }
 
+GTEST_TEST(TwoDAFileVariants, asciiDefault) {
+	static const char *k2DAASCIIDefault =
+		"2DA V2.0\n"
+		"DEFAULT: 7\n"
+		"   ID   FloatValue\n"
+		" 0 23   23.5\n"
+		" 1 **** ****\n";
+
+	Common::MemoryReadStream stream(k2DAASCIIDefault);
+	const Aurora::TwoDAFile twoda(stream);
+
+	EXPECT_EQ(twoda.getRow(0).getInt("ID"), 23);
+	EXPECT_EQ(twoda.getRow(1).getInt("ID"), 7);
+	EXPECT_EQ(twoda.getRow(1).getInt("Nope"), 7);
+	EXPECT_EQ(twoda.getRow(Aurora::kFieldIDInvalid).getInt("ID"), 7);
+
+	EXPECT_FLOAT_EQ(twoda.getRow(0).getFloat("FloatValue"), 23.5f);
+	EXPECT_FLOAT_EQ(twoda.getRow(1).getFloat("FloatValue"), 7.0f);
+
+	EXPECT_STREQ(twoda.getRow(1).getString("ID").c_str(), "7");
+	EXPECT_TRUE(twoda.getRow(1).empty("ID"));
+}
+
+GTEST_TEST(TwoDAFileVariants, asciiManyRows) {
+	Common::UString data = "2DA V2.0\n\n   ID   Value\n";
+	for (size_t i = 0; i < 200; i++)
+		data += Common::String::format("%u %u %s\n", (uint) i, (uint) i, (i % 3) ? "****" : "3");
+
+	Common::MemoryReadStream stream(data.c_str());
+	const Aurora::TwoDAFile twoda(stream);
+
+	ASSERT_EQ(twoda.getRowCount(), 200);
+
+	for (size_t i = 0; i < 200; i++) {
+		EXPECT_EQ(twoda.getRow(i).getInt("ID"), i) << "At index " << i;
+
+		EXPECT_EQ(twoda.getRow(i).empty("Value"), (i % 3) != 0) << "At index " << i;
+		EXPECT_EQ(twoda.getRow(i).getInt("Value"), (i % 3) ? 0 : 3) << "At index " << i;
+	}
+}
+
 GTEST_TEST(TwoDAFileVariants, asciiEmpty) {
 	static const char *k2DAASCIIEmpty = "2DA V2.0";
 
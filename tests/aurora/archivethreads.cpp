@@ -0,0 +1,222 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/** @file
+ *  Unit tests for reading archive resources from several threads at once.
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/platform.h"
+#include "src/common/strutil.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/readfile.h"
+#include "src/common/mappedfile.h"
+
+#include "src/aurora/erfwriter.h"
+#include "src/aurora/erffile.h"
+
+static const size_t kResourceCount = 64;
+static const size_t kThreadCount   =  8;
+static const size_t kRoundCount    =  4;
+
+static size_t getResourceSize(size_t index) {
+	return 1 + (index * 997) % 8192;
+}
+
+static byte getResourceByte(size_t index, size_t pos) {
+	return (byte) (index * 31 + pos * 7 + (pos >> 8));
+}
+
+/** A simple FNV-1a checksum over a whole stream, read in small, odd-sized chunks. */
+static uint32_t checksum(Common::SeekableReadStream &stream) {
+	uint32_t hash = 2166136261U;
+
+	byte buffer[7];
+	size_t n;
+	while ((n = stream.read(buffer, sizeof(buffer))) > 0)
+		for (size_t i = 0; i < n; i++)
+			hash = (hash ^ buffer[i]) * 16777619U;
+
+	return hash;
+}
+
+static std::vector<uint32_t> getExpectedChecksums() {
+	std::vector<uint32_t> checksums;
+
+	for (size_t i = 0; i < kResourceCount; i++) {
+		std::vector<byte> data(getResourceSize(i));
+		for (size_t j = 0; j < data.size(); j++)
+			data[j] = getResourceByte(i, j);
+
+		Common::MemoryReadStream stream(data.data(), data.size());
+		checksums.push_back(checksum(stream));
+	}
+
+	return checksums;
+}
+
+static Common::MemoryWriteStreamDynamic *createERF(Aurora::ERFWriter::Version version,
+                                                   Aurora::ERFWriter::Compression compression) {
+
+	std::unique_ptr<Common::MemoryWriteStreamDynamic> erf = std::make_unique<Common::MemoryWriteStreamDynamic>(true);
+
+	Aurora::ERFWriter writer(MKTAG('E', 'R', 'F', ' '), kResourceCount, *erf, version, compression);
+
+	for (size_t i = 0; i < kResourceCount; i++) {
+		std::vector<byte> data(getResourceSize(i));
+		for (size_t j = 0; j < data.size(); j++)
+			data[j] = getResourceByte(i, j);
+
+		Common::MemoryReadStream stream(data.data(), data.size());
+		writer.add("res" + Common::composeString(i), Aurora::kFileTypeTXT, stream);
+	}
+
+	return erf.release();
+}
+
+/** Read every resource of the archive, from several threads at the same time. */
+static void readConcurrently(const Aurora::Archive &archive, bool tryNoCopy) {
+	ASSERT_EQ(archive.getResources().size(), kResourceCount);
+
+	const std::vector<uint32_t> expected = getExpectedChecksums();
+
+	std::atomic<size_t> mismatches(0), failures(0), reads(0);
+
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < kThreadCount; t++) {
+		threads.emplace_back([&, t]() {
+			for (size_t round = 0; round < kRoundCount; round++) {
+				for (size_t r = 0; r < kResourceCount; r++) {
+					// Every thread starts at a different resource
+					const size_t index = (r + t * 7 + round) % kResourceCount;
+
+					try {
+						std::unique_ptr<Common::SeekableReadStream> stream(archive.getResource(index, tryNoCopy));
+
+						if (checksum(*stream) != expected[index])
+							mismatches++;
+
+						reads++;
+					} catch (...) {
+						failures++;
+					}
+				}
+			}
+		});
+	}
+
+	for (std::vector<std::thread>::iterator t = threads.begin(); t != threads.end(); ++t)
+		t->join();
+
+	EXPECT_EQ(failures.load(), 0);
+	EXPECT_EQ(mismatches.load(), 0);
+	EXPECT_EQ(reads.load(), kThreadCount * kRoundCount * kResourceCount);
+}
+
+class ArchiveThreads : public ::testing::Test {
+protected:
+	boost::filesystem::path _filePath;
+
+	void SetUp() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		_filePath = tmpPath / uniquePath;
+	}
+
+	void TearDown() {
+		if (!_filePath.empty())
+			boost::filesystem::remove(_filePath);
+	}
+
+	void writeFile(Common::MemoryWriteStreamDynamic &erf) {
+		boost::filesystem::ofstream file(_filePath, std::ofstream::binary);
+
+		file.write(reinterpret_cast<const char *>(erf.getData()), erf.size());
+		file.close();
+
+		ASSERT_FALSE(file.fail());
+	}
+};
+
+GTEST_TEST_F(ArchiveThreads, memory) {
+	std::unique_ptr<Common::MemoryWriteStreamDynamic> erf(createERF(Aurora::ERFWriter::kERFVersion10,
+	                                                                 Aurora::ERFWriter::kCompressionNone));
+
+	Aurora::ERFFile archive(new Common::MemoryReadStream(erf->getData(), erf->size()));
+
+	readConcurrently(archive, false);
+	readConcurrently(archive, true);
+}
+
+GTEST_TEST_F(ArchiveThreads, memoryCompressed) {
+	std::unique_ptr<Common::MemoryWriteStreamDynamic> erf(createERF(Aurora::ERFWriter::kERFVersion22,
+	                                                                 Aurora::ERFWriter::kCompressionBiowareZlib));
+
+	Aurora::ERFFile archive(new Common::MemoryReadStream(erf->getData(), erf->size()));
+
+	readConcurrently(archive, false);
+	readConcurrently(archive, true);
+}
+
+GTEST_TEST_F(ArchiveThreads, file) {
+	std::unique_ptr<Common::MemoryWriteStreamDynamic> erf(createERF(Aurora::ERFWriter::kERFVersion10,
+	                                                                 Aurora::ERFWriter::kCompressionNone));
+	writeFile(*erf);
+
+	Aurora::ERFFile archive(new Common::ReadFile(_filePath.generic_string()));
+
+	readConcurrently(archive, false);
+	readConcurrently(archive, true);
+}
+
+GTEST_TEST_F(ArchiveThreads, mapped) {
+	std::unique_ptr<Common::MemoryWriteStreamDynamic> erf(createERF(Aurora::ERFWriter::kERFVersion10,
+	                                                                 Aurora::ERFWriter::kCompressionNone));
+	writeFile(*erf);
+
+	Aurora::ERFFile archive(new Common::MappedReadStream(_filePath.generic_string()));
+
+	readConcurrently(archive, false);
+	readConcurrently(archive, true);
+}
+
+GTEST_TEST_F(ArchiveThreads, mappedCompressed) {
+	std::unique_ptr<Common::MemoryWriteStreamDynamic> erf(createERF(Aurora::ERFWriter::kERFVersion22,
+	                                                                 Aurora::ERFWriter::kCompressionBiowareZlib));
+	writeFile(*erf);
+
+	Aurora::ERFFile archive(new Common::MappedReadStream(_filePath.generic_string()));
+
+	readConcurrently(archive, false);
+	readConcurrently(archive, true);
+}
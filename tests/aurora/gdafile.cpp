@@ -356,6 +356,9 @@ GTEST_TEST(GDAFile, add) {
 
 	Aurora::GDAFile gda(new Common::MemoryReadStream(kMGDA1));
 
+	// Rows that are added later need to be found as well
+	EXPECT_EQ(gda.findRow(10), Aurora::GDAFile::kInvalidRow);
+
 	gda.add(new Common::MemoryReadStream(kMGDA3));
 	gda.add(new Common::MemoryReadStream(kMGDA2));
 
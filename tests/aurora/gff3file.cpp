@@ -22,12 +22,16 @@
  *  Unit tests for our GFF3 file reader class.
  */
 
+#include <atomic>
+#include <thread>
 #include <vector>
+#include <memory>
 
 #include "gtest/gtest.h"
 
 #include "src/common/util.h"
 #include "src/common/error.h"
+#include "src/common/readstream.h"
 #include "src/common/memreadstream.h"
 
 #include "src/aurora/locstring.h"
@@ -165,6 +169,38 @@ GTEST_TEST(GFF3Struct, getFieldType) {
 		EXPECT_EQ(strct.getFieldType(kFieldNamesSingle[i]), kFieldTypesSingle[i]) << "At index " << i;
 }
 
+GTEST_TEST(GFF3Struct, getFieldByLabel) {
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3SingleStruct));
+	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
+
+	for (size_t i = 0; i < ARRAYSIZE(kFieldNamesSingle); i++) {
+		const Aurora::GFF3Label label(kFieldNamesSingle[i]);
+
+		EXPECT_EQ(label.getHash(), Aurora::GFF3Label::hash(kFieldNamesSingle[i])) << "At index " << i;
+
+		EXPECT_TRUE(strct.hasField(label)) << "At index " << i;
+		EXPECT_EQ(strct.getFieldType(label), kFieldTypesSingle[i]) << "At index " << i;
+	}
+
+	EXPECT_FALSE(strct.hasField(Aurora::GFF3Label("Nope")));
+	EXPECT_EQ(strct.getFieldType(Aurora::GFF3Label("Nope")), Aurora::GFF3Struct::kFieldTypeNone);
+
+	EXPECT_EQ(strct.getUint(Aurora::GFF3Label("FieldUint32")), 25);
+	EXPECT_EQ(strct.getSint(Aurora::GFF3Label("FieldSint64")), -42);
+	EXPECT_EQ(strct.getUint(Aurora::GFF3Label("Nope"), 99), 99);
+
+	EXPECT_STREQ(strct.getString(Aurora::GFF3Label("FieldExoString")).c_str(), "Foobar");
+	EXPECT_STREQ(strct.getString(Aurora::GFF3Label("FieldResRef")).c_str(), "Barfoo");
+
+	float x = 0.0f, y = 0.0f, z = 0.0f;
+	strct.getVector(Aurora::GFF3Label("FieldVector"), x, y, z);
+	EXPECT_FLOAT_EQ(x, 43.1f);
+	EXPECT_FLOAT_EQ(y, 43.2f);
+	EXPECT_FLOAT_EQ(z, 43.3f);
+
+	EXPECT_THROW(strct.getUint(Aurora::GFF3Label("FieldLocString")), Common::Exception);
+}
+
 GTEST_TEST(GFF3Struct, getChar) {
 	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3SingleStruct));
 	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
@@ -654,3 +690,61 @@ GTEST_TEST(GFF3File, GFF3V33) {
 	EXPECT_EQ(strct.getID(), 23);
 	EXPECT_EQ(strct.getUint("FieldUint32"), 32);
 }
+
+// --- GFF3, reading out of memory ---
+
+/** Check that a struct read from kGFF3SingleStruct has the right values, without gtest assertions. */
+static bool checkSingleStruct(const Aurora::GFF3Struct &strct) {
+	float x = 0.0f, y = 0.0f, z = 0.0f;
+	strct.getVector("FieldVector", x, y, z);
+
+	std::unique_ptr<Common::SeekableReadStream> data(strct.getData("FieldVoid"));
+
+	return (strct.getUint("FieldUint64") == 42) &&
+	       (strct.getSint("FieldSint64") == -42) &&
+	       (strct.getDouble("FieldDouble") == 25.6) &&
+	       (strct.getString("FieldExoString") == "Foobar") &&
+	       (strct.getString("FieldResRef") == "Barfoo") &&
+	       (strct.getUint("FieldStrRef") == 101) &&
+	       (x == 43.1f) && (y == 43.2f) && (z == 43.3f) &&
+	       data && (data->size() == 6);
+}
+
+GTEST_TEST(GFF3File, nonMemoryStream) {
+	/* A GFF3 from a stream that isn't in memory gets read into memory first.
+	 * The SeekableSubReadStream here stands in for any such stream. */
+
+	Common::SeekableSubReadStream *stream =
+		new Common::SeekableSubReadStream(new Common::MemoryReadStream(kGFF3SingleStruct),
+		                                  0, sizeof(kGFF3SingleStruct), true);
+
+	Aurora::GFF3File gff3(stream);
+	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
+
+	EXPECT_EQ(strct.getFieldCount(), ARRAYSIZE(kFieldNamesSingle));
+	EXPECT_TRUE(checkSingleStruct(strct));
+}
+
+GTEST_TEST(GFF3File, readFromThreads) {
+	static const size_t kThreadCount = 8;
+	static const size_t kRoundCount  = 500;
+
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3SingleStruct));
+	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
+
+	std::atomic<size_t> failures(0);
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < kThreadCount; i++) {
+		threads.emplace_back([&strct, &failures]() {
+			for (size_t j = 0; j < kRoundCount; j++)
+				if (!checkSingleStruct(strct))
+					failures++;
+		});
+	}
+
+	for (std::vector<std::thread>::iterator t = threads.begin(); t != threads.end(); ++t)
+		t->join();
+
+	EXPECT_EQ(failures, 0);
+}
@@ -0,0 +1,233 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the NWScript script scheduler.
+ */
+
+#include <cstdlib>
+
+#include <vector>
+#include <map>
+
+#include "gtest/gtest.h"
+
+#include "src/common/ustring.h"
+#include "src/common/strutil.h"
+
+#include "src/aurora/nwscript/scheduler.h"
+
+static void schedule(Aurora::NWScript::ScriptScheduler &scheduler, uint32_t now, uint32_t delay,
+                     const Common::UString &script) {
+
+	scheduler.schedule(now, delay, script, Aurora::NWScript::ScriptState(),
+	                   Aurora::NWScript::ObjectReference(), Aurora::NWScript::ObjectReference());
+}
+
+static Common::UString collect(Aurora::NWScript::ScriptScheduler &scheduler, uint32_t now) {
+	std::vector<Aurora::NWScript::DelayedScript> batch;
+	scheduler.collect(now, batch);
+
+	Common::UString scripts;
+	for (std::vector<Aurora::NWScript::DelayedScript>::const_iterator s = batch.begin(); s != batch.end(); ++s)
+		scripts += s->script;
+
+	return scripts;
+}
+
+GTEST_TEST(NWScriptScheduler, empty) {
+	Aurora::NWScript::ScriptScheduler scheduler;
+
+	EXPECT_EQ(scheduler.getQueueDepth(), 0);
+	EXPECT_STREQ(collect(scheduler, 0).c_str(), "");
+	EXPECT_STREQ(collect(scheduler, 100000).c_str(), "");
+}
+
+GTEST_TEST(NWScriptScheduler, order) {
+	Aurora::NWScript::ScriptScheduler scheduler;
+
+	schedule(scheduler, 1000, 30, "c");
+	schedule(scheduler, 1000, 10, "a");
+	schedule(scheduler, 1000, 20, "b");
+	schedule(scheduler, 1000, 10, "A");
+
+	EXPECT_EQ(scheduler.getQueueDepth(), 4);
+
+	EXPECT_STREQ(collect(scheduler, 1009).c_str(), "");
+	EXPECT_STREQ(collect(scheduler, 1010).c_str(), "aA");
+	EXPECT_STREQ(collect(scheduler, 1030).c_str(), "bc");
+
+	EXPECT_EQ(scheduler.getQueueDepth(), 0);
+}
+
+GTEST_TEST(NWScriptScheduler, immediate) {
+	Aurora::NWScript::ScriptScheduler scheduler;
+
+	schedule(scheduler, 500, 0, "a");
+	EXPECT_STREQ(collect(scheduler, 500).c_str(), "a");
+
+	// Scheduled while the wheels are already past this time
+	schedule(scheduler, 500, 10, "b");
+	schedule(scheduler, 500,  0, "c");
+	EXPECT_STREQ(collect(scheduler, 501).c_str(), "c");
+	EXPECT_STREQ(collect(scheduler, 510).c_str(), "b");
+}
+
+GTEST_TEST(NWScriptScheduler, longDelays) {
+	Aurora::NWScript::ScriptScheduler scheduler;
+
+	schedule(scheduler, 0, 0x1000000 + 5, "d");
+	schedule(scheduler, 0,   0x10000 + 5, "c");
+	schedule(scheduler, 0,     0x100 + 5, "b");
+	schedule(scheduler, 0,             5, "a");
+
+	EXPECT_STREQ(collect(scheduler,             4).c_str(), "");
+	EXPECT_STREQ(collect(scheduler,             5).c_str(), "a");
+	EXPECT_STREQ(collect(scheduler,     0x100 + 4).c_str(), "");
+	EXPECT_STREQ(collect(scheduler,     0x100 + 5).c_str(), "b");
+	EXPECT_STREQ(collect(scheduler,   0x10000 + 4).c_str(), "");
+	EXPECT_STREQ(collect(scheduler,   0x10000 + 5).c_str(), "c");
+	EXPECT_STREQ(collect(scheduler, 0x1000000 + 4).c_str(), "");
+	EXPECT_STREQ(collect(scheduler, 0x1000000 + 5).c_str(), "d");
+}
+
+GTEST_TEST(NWScriptScheduler, cascadeOrder) {
+	Aurora::NWScript::ScriptScheduler scheduler;
+
+	// 300ms ahead of the wheels, "a" lands on the second level
+	schedule(scheduler, 0, 300, "a");
+
+	// Once the wheels moved on to 100, "b" and "c" are less than 256ms ahead, on the lowest level
+	EXPECT_STREQ(collect(scheduler, 100).c_str(), "");
+
+	schedule(scheduler, 100, 200, "b");
+	schedule(scheduler, 100, 200, "c");
+
+	// "a" only cascades down into the slot of "b" and "c" at 256, but was scheduled first
+
+	EXPECT_STREQ(collect(scheduler, 299).c_str(), "");
+	EXPECT_STREQ(collect(scheduler, 300).c_str(), "abc");
+}
+
+GTEST_TEST(NWScriptScheduler, state) {
+	Aurora::NWScript::ScriptScheduler scheduler;
+
+	Aurora::NWScript::ScriptState state;
+	state.offset = 23;
+	state.globals.push_back(Aurora::NWScript::Variable(42));
+	state.locals.push_back(Aurora::NWScript::Variable(Common::UString("foobar")));
+
+	scheduler.schedule(0, 10, "script", state, Aurora::NWScript::ObjectReference(),
+	                   Aurora::NWScript::ObjectReference());
+
+	std::vector<Aurora::NWScript::DelayedScript> batch;
+	ASSERT_EQ(scheduler.collect(10, batch), 1);
+
+	EXPECT_STREQ(batch[0].script.c_str(), "script");
+	EXPECT_EQ(batch[0].timestamp, 10);
+
+	EXPECT_EQ(batch[0].state.offset, 23);
+	ASSERT_EQ(batch[0].state.globals.size(), 1);
+	ASSERT_EQ(batch[0].state.locals.size(), 1);
+	EXPECT_EQ(batch[0].state.globals[0].getInt(), 42);
+	EXPECT_STREQ(batch[0].state.locals[0].getString().c_str(), "foobar");
+}
+
+GTEST_TEST(NWScriptScheduler, clear) {
+	Aurora::NWScript::ScriptScheduler scheduler;
+
+	schedule(scheduler, 0,     10, "a");
+	schedule(scheduler, 0,   1000, "b");
+	schedule(scheduler, 0, 100000, "c");
+
+	scheduler.clear();
+
+	EXPECT_EQ(scheduler.getQueueDepth(), 0);
+	EXPECT_STREQ(collect(scheduler, 200000).c_str(), "");
+
+	schedule(scheduler, 200000, 10, "d");
+	EXPECT_STREQ(collect(scheduler, 200010).c_str(), "d");
+}
+
+GTEST_TEST(NWScriptScheduler, stats) {
+	Aurora::NWScript::ScriptScheduler scheduler;
+
+	schedule(scheduler, 0, 10, "a");
+	schedule(scheduler, 0, 10, "b");
+	schedule(scheduler, 0, 20, "c");
+
+	EXPECT_STREQ(collect(scheduler, 15).c_str(), "ab");
+	EXPECT_STREQ(collect(scheduler, 30).c_str(), "c");
+
+	const Aurora::NWScript::ScriptScheduler::Stats stats = scheduler.getStats();
+
+	EXPECT_EQ(stats.queueDepth   , 0);
+	EXPECT_EQ(stats.maxQueueDepth, 3);
+	EXPECT_EQ(stats.scheduled    , 3);
+	EXPECT_EQ(stats.fired        , 3);
+	EXPECT_EQ(stats.batches      , 2);
+	EXPECT_EQ(stats.maxBatchSize , 2);
+	EXPECT_EQ(stats.totalLatency , 20);
+	EXPECT_EQ(stats.maxLatency   , 10);
+
+	scheduler.resetStats();
+
+	EXPECT_EQ(scheduler.getStats().scheduled, 0);
+	EXPECT_EQ(scheduler.getStats().fired    , 0);
+}
+
+GTEST_TEST(NWScriptScheduler, random) {
+	Aurora::NWScript::ScriptScheduler scheduler;
+
+	std::srand(0);
+
+	std::map<Common::UString, uint32_t> due;
+
+	uint32_t now = 0x10000 - 5000;
+	for (size_t i = 0; i < 2000; i++) {
+		// Mostly short delays, some long ones. Always at least 1ms, so none is already due
+		const uint32_t delay = 1 + (((i % 10) == 0) ? (std::rand() % 300000) : (std::rand() % 1000));
+
+		const Common::UString script = Common::composeString(i);
+		schedule(scheduler, now, delay, script);
+		due[script] = now + delay;
+
+		now += std::rand() % 20;
+
+		std::vector<Aurora::NWScript::DelayedScript> batch;
+		scheduler.collect(now, batch);
+
+		uint32_t last = 0;
+		for (std::vector<Aurora::NWScript::DelayedScript>::const_iterator s = batch.begin(); s != batch.end(); ++s) {
+			ASSERT_EQ(due.count(s->script), 1);
+			EXPECT_LE(due[s->script], now);
+			EXPECT_LE(last, s->timestamp);
+
+			last = s->timestamp;
+			due.erase(s->script);
+		}
+
+		// Nothing still waiting may have been due
+		for (std::map<Common::UString, uint32_t>::const_iterator d = due.begin(); d != due.end(); ++d)
+			ASSERT_GT(d->second, now);
+	}
+
+	EXPECT_EQ(scheduler.getQueueDepth(), due.size());
+}
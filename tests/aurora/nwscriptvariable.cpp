@@ -0,0 +1,150 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the NWScript variable.
+ */
+
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "src/common/error.h"
+#include "src/common/ustring.h"
+
+#include "src/aurora/nwscript/variable.h"
+#include "src/aurora/nwscript/enginetype.h"
+
+class Counter : public Aurora::NWScript::EngineType {
+public:
+	Counter(int value = 0) : _value(value) { }
+
+	Counter *clone() const {
+		return new Counter(*this);
+	}
+
+	int _value;
+};
+
+GTEST_TEST(NWScriptVariable, numbers) {
+	const Aurora::NWScript::Variable i(23);
+	const Aurora::NWScript::Variable f(23.5f);
+	const Aurora::NWScript::Variable v(1.0f, 2.0f, 3.0f);
+
+	EXPECT_EQ(i.getType(), Aurora::NWScript::kTypeInt);
+	EXPECT_EQ(i.getInt(), 23);
+	EXPECT_FLOAT_EQ(f.getFloat(), 23.5f);
+
+	float x, y, z;
+	v.getVector(x, y, z);
+	EXPECT_FLOAT_EQ(x, 1.0f);
+	EXPECT_FLOAT_EQ(y, 2.0f);
+	EXPECT_FLOAT_EQ(z, 3.0f);
+
+	EXPECT_THROW(i.getFloat(), Common::Exception);
+	EXPECT_THROW(f.getInt(), Common::Exception);
+}
+
+GTEST_TEST(NWScriptVariable, object) {
+	const Aurora::NWScript::Variable o(Aurora::NWScript::kTypeObject);
+
+	EXPECT_EQ(o.getObject(), static_cast<Aurora::NWScript::Object *>(0));
+	EXPECT_EQ(o, Aurora::NWScript::Variable(static_cast<Aurora::NWScript::Object *>(0)));
+}
+
+GTEST_TEST(NWScriptVariable, string) {
+	const Aurora::NWScript::Variable empty(Aurora::NWScript::kTypeString);
+	EXPECT_STREQ(empty.getString().c_str(), "");
+
+	Aurora::NWScript::Variable a(Common::UString("Foobar"));
+	Aurora::NWScript::Variable b(a);
+
+	EXPECT_STREQ(b.getString().c_str(), "Foobar");
+	EXPECT_EQ(a, b);
+
+	// Modifying a copy must leave the original alone
+	b.getString() += "Barfoo";
+
+	EXPECT_STREQ(a.getString().c_str(), "Foobar");
+	EXPECT_STREQ(b.getString().c_str(), "FoobarBarfoo");
+	EXPECT_NE(a, b);
+
+	b = a;
+	a = Common::UString("Quux");
+
+	EXPECT_STREQ(a.getString().c_str(), "Quux");
+	EXPECT_STREQ(b.getString().c_str(), "Foobar");
+
+	a.getString() = "Foo";
+	EXPECT_STREQ(a.getString().c_str(), "Foo");
+
+	Aurora::NWScript::Variable c(Aurora::NWScript::kTypeString);
+	c.getString() = "Bar";
+
+	EXPECT_STREQ(c.getString().c_str(), "Bar");
+	EXPECT_STREQ(empty.getString().c_str(), "");
+
+	// Empty strings, however they came to be, all compare equal
+	Aurora::NWScript::Variable d(Common::UString(""));
+	Aurora::NWScript::Variable e(c);
+	e = Common::UString("");
+
+	EXPECT_EQ(d, empty);
+	EXPECT_EQ(e, empty);
+	EXPECT_STREQ(e.getString().c_str(), "");
+	EXPECT_STREQ(c.getString().c_str(), "Bar");
+	EXPECT_NE(c, empty);
+
+	Aurora::NWScript::Variable f(empty);
+	f.getString() += "Baz";
+
+	EXPECT_STREQ(f.getString().c_str(), "Baz");
+	EXPECT_STREQ(empty.getString().c_str(), "");
+}
+
+GTEST_TEST(NWScriptVariable, engineType) {
+	const Aurora::NWScript::Variable empty(Aurora::NWScript::kTypeEngineType);
+	EXPECT_EQ(empty.getEngineType(), static_cast<const Aurora::NWScript::EngineType *>(0));
+
+	Aurora::NWScript::Variable a(Counter(5));
+	const Aurora::NWScript::Variable b(a);
+
+	// Copies share the engine type for reading...
+	EXPECT_EQ(static_cast<const Aurora::NWScript::Variable &>(a).getEngineType(), b.getEngineType());
+
+	// ...but modifying a copy must leave the original alone
+	static_cast<Counter *>(a.getEngineType())->_value = 6;
+
+	EXPECT_EQ(static_cast<const Counter *>(a.getEngineType())->_value, 6);
+	EXPECT_EQ(static_cast<const Counter *>(b.getEngineType())->_value, 5);
+}
+
+GTEST_TEST(NWScriptVariable, move) {
+	Aurora::NWScript::Variable a(Common::UString("Foobar"));
+	Aurora::NWScript::Variable b(std::move(a));
+
+	EXPECT_EQ(a.getType(), Aurora::NWScript::kTypeVoid);
+	EXPECT_STREQ(b.getString().c_str(), "Foobar");
+
+	a = std::move(b);
+
+	EXPECT_EQ(b.getType(), Aurora::NWScript::kTypeVoid);
+	EXPECT_STREQ(a.getString().c_str(), "Foobar");
+}
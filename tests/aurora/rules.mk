@@ -170,6 +170,11 @@ tests_aurora_test_erfwriter_SOURCES  = tests/aurora/erfwriter.cpp
 tests_aurora_test_erfwriter_LDADD    = $(aurora_LIBS)
 tests_aurora_test_erfwriter_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                          += tests/aurora/test_archivethreads
+tests_aurora_test_archivethreads_SOURCES  = tests/aurora/archivethreads.cpp
+tests_aurora_test_archivethreads_LDADD    = $(aurora_LIBS)
+tests_aurora_test_archivethreads_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                       += tests/aurora/test_gff3writer
 tests_aurora_test_gff3writer_SOURCES  = tests/aurora/gff3writer.cpp
 tests_aurora_test_gff3writer_LDADD    = $(aurora_LIBS)
@@ -189,3 +194,13 @@ check_PROGRAMS                     += tests/aurora/test_xmlfixer
 tests_aurora_test_xmlfixer_SOURCES  = tests/aurora/xmlfixer.cpp
 tests_aurora_test_xmlfixer_LDADD    = $(aurora_LIBS)
 tests_aurora_test_xmlfixer_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                             += tests/aurora/test_nwscriptvariable
+tests_aurora_test_nwscriptvariable_SOURCES  = tests/aurora/nwscriptvariable.cpp
+tests_aurora_test_nwscriptvariable_LDADD    = $(aurora_LIBS)
+tests_aurora_test_nwscriptvariable_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                              += tests/aurora/test_nwscriptscheduler
+tests_aurora_test_nwscriptscheduler_SOURCES  = tests/aurora/nwscriptscheduler.cpp
+tests_aurora_test_nwscriptscheduler_LDADD    = $(aurora_LIBS)
+tests_aurora_test_nwscriptscheduler_CXXFLAGS = $(test_CXXFLAGS)
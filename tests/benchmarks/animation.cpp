@@ -0,0 +1,221 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for evaluating model animations.
+ */
+
+#include <cmath>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+
+#include "src/graphics/aurora/keyframes.h"
+
+#include "tests/benchmarks/benchmark.h"
+
+static const size_t kModelCount     = 500;
+static const size_t kBoneCount      = 60;
+static const float  kLength         = 5.0f;  ///< Length of the animation, in seconds.
+static const size_t kKeysPerSecond  = 30;
+static const size_t kSimulatedTime  = 10;    ///< How long the models are animated, in seconds.
+static const size_t kTicksPerSecond = 60;
+
+/** The same scene is also evaluated the old way, but only for every nth model. */
+static const size_t kLinearScanStride = 10;
+
+/** A position keyframe, as the animations used to keep them. */
+struct PositionKeyFrame {
+	float time;
+	float x;
+	float y;
+	float z;
+};
+
+/** The animation of one bone. */
+struct Bone {
+	Graphics::Aurora::PositionKeyFrames    positions;
+	Graphics::Aurora::OrientationKeyFrames orientations;
+
+	std::vector<PositionKeyFrame> positionFrames;
+};
+
+/** A model playing the animation, with its own time and keyframe cursors. */
+struct Model {
+	float time;
+
+	std::vector<size_t> positionCursors;
+	std::vector<size_t> orientationCursors;
+};
+
+/** Find the position at this time by scanning all keyframes from the start, like the animations used to. */
+static glm::vec3 interpolateLinearScan(const std::vector<PositionKeyFrame> &frames, float time) {
+	size_t lastFrame = 0;
+	for (size_t i = 0; i < frames.size(); i++) {
+		if (frames[i].time >= time)
+			break;
+
+		lastFrame = i;
+	}
+
+	const PositionKeyFrame &last = frames[lastFrame];
+	if (lastFrame + 1 >= frames.size() || last.time >= time)
+		return glm::vec3(last.x, last.y, last.z);
+
+	const PositionKeyFrame &next = frames[lastFrame + 1];
+
+	const float f = (time - last.time) / (next.time - last.time);
+
+	return glm::vec3(f * next.x + (1.0f - f) * last.x,
+	                 f * next.y + (1.0f - f) * last.y,
+	                 f * next.z + (1.0f - f) * last.z);
+}
+
+static std::vector<Bone> createBones() {
+	const size_t keyCount = kLength * kKeysPerSecond + 1;
+
+	std::vector<Bone> bones(kBoneCount);
+	for (size_t b = 0; b < kBoneCount; b++) {
+		for (size_t k = 0; k < keyCount; k++) {
+			const float time  = (k * kLength) / (keyCount - 1);
+			const float angle = time + b;
+
+			const glm::vec3 position(std::sin(angle), std::cos(angle), b * 0.1f);
+
+			bones[b].positions.add(time, position);
+			bones[b].orientations.add(time, glm::quat(std::cos(angle / 2), std::sin(angle / 2), 0.0f, 0.0f));
+
+			bones[b].positionFrames.push_back(PositionKeyFrame { time, position.x, position.y, position.z });
+		}
+	}
+
+	return bones;
+}
+
+static std::vector<Model> createModels() {
+	std::vector<Model> models(kModelCount);
+	for (size_t m = 0; m < kModelCount; m++) {
+		// Stagger the models, so they loop at different times
+		models[m].time = std::fmod(m * 0.37f, kLength);
+
+		models[m].positionCursors.resize(kBoneCount, 0);
+		models[m].orientationCursors.resize(kBoneCount, 0);
+	}
+
+	return models;
+}
+
+GTEST_TEST(AnimationBenchmark, keyFrames) {
+	const std::vector<Bone> bones = createBones();
+	std::vector<Model> models = createModels();
+
+	const size_t ticks = Benchmark::scale(kSimulatedTime * kTicksPerSecond);
+
+	// Scanning through all keyframes from the start, for every bone of every nth model
+
+	size_t scanned = 0;
+	float  scanSum = 0.0f;
+
+	Benchmark::Timer timer;
+	for (size_t t = 0; t < ticks; t++) {
+		for (size_t m = 0; m < kModelCount; m += kLinearScanStride) {
+			const float time = std::fmod(models[m].time + t / (float) kTicksPerSecond, kLength);
+
+			for (size_t b = 0; b < kBoneCount; b++) {
+				scanSum += interpolateLinearScan(bones[b].positionFrames, time).x;
+				scanned++;
+			}
+		}
+	}
+	Benchmark::report("Position keyframes, linear scan", timer.elapsed(), scanned);
+
+	// The cursor into the keyframe arrays, for the same models
+
+	float cursorSum = 0.0f;
+
+	timer.reset();
+	for (size_t t = 0; t < ticks; t++) {
+		for (size_t m = 0; m < kModelCount; m += kLinearScanStride) {
+			const float time = std::fmod(models[m].time + t / (float) kTicksPerSecond, kLength);
+
+			for (size_t b = 0; b < kBoneCount; b++)
+				cursorSum += bones[b].positions.interpolate(time, models[m].positionCursors[b]).x;
+		}
+	}
+	Benchmark::report("Position keyframes, cursor", timer.elapsed(), scanned);
+
+	EXPECT_FLOAT_EQ(cursorSum, scanSum);
+
+	// The full scene, positions and orientations of all bones of all models
+
+	models = createModels();
+
+	size_t evaluated = 0;
+	float  sum       = 0.0f;
+
+	timer.reset();
+	for (size_t t = 0; t < ticks; t++) {
+		for (size_t m = 0; m < kModelCount; m++) {
+			Model &model = models[m];
+
+			const float time = std::fmod(model.time + t / (float) kTicksPerSecond, kLength);
+
+			for (size_t b = 0; b < kBoneCount; b++) {
+				const glm::vec3 position    = bones[b].positions.interpolate(time, model.positionCursors[b]);
+				const glm::quat orientation = bones[b].orientations.interpolate(time, model.orientationCursors[b]);
+
+				sum += position.x + orientation.w;
+				evaluated++;
+			}
+		}
+	}
+	Benchmark::reportRate("Animated bones, 500 models", timer.elapsed(), evaluated, "bones");
+
+	EXPECT_EQ(evaluated, ticks * kModelCount * kBoneCount);
+	EXPECT_TRUE(std::isfinite(sum));
+}
+
+GTEST_TEST(AnimationBenchmark, keyFramesSeek) {
+	const std::vector<Bone> bones = createBones();
+	const Graphics::Aurora::PositionKeyFrames &positions = bones[0].positions;
+
+	// Jumping around in time finds the same keyframes as scanning does
+	size_t cursor = 0;
+	for (size_t i = 0; i < 1000; i++) {
+		const float time = std::fmod(i * 1.618f, kLength + 1.0f) - 0.5f;
+
+		const glm::vec3 found   = positions.interpolate(time, cursor);
+		const glm::vec3 scanned = interpolateLinearScan(bones[0].positionFrames, time);
+
+		EXPECT_FLOAT_EQ(found.x, scanned.x);
+		EXPECT_FLOAT_EQ(found.y, scanned.y);
+		EXPECT_FLOAT_EQ(found.z, scanned.z);
+	}
+
+	// Exactly on a keyframe, and before and after all of them
+	cursor = 0;
+	EXPECT_EQ(positions.find(positions.getTime(10), cursor), 10);
+	EXPECT_EQ(positions.find(-1.0f, cursor), 0);
+	EXPECT_EQ(positions.find(kLength + 1.0f, cursor), positions.size());
+	EXPECT_EQ(positions.find(kLength + 2.0f, cursor), positions.size());
+}
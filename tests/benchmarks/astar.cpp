@@ -0,0 +1,327 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for finding paths with the A* algorithm.
+ */
+
+#include <cmath>
+
+#include <vector>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+
+#include "src/engines/aurora/astar.h"
+#include "src/engines/aurora/pathfinding.h"
+
+#include "tests/benchmarks/benchmark.h"
+
+static const uint32_t kGridWidth   = 64;
+static const uint32_t kGridHeight  = 64;
+static const size_t   kQueryCount  = 500;
+
+/** A synthetic walkmesh: a grid of square faces, with a quarter of them blocked. */
+class GridPathfinding : public Engines::Pathfinding {
+public:
+	GridPathfinding() : Engines::Pathfinding(std::vector<bool>({ false, true }), 4) {
+		_facesCount    = kGridWidth * kGridHeight;
+		_verticesCount = (kGridWidth + 1) * (kGridHeight + 1);
+
+		_vertices.resize(_verticesCount * 3);
+		for (uint32_t y = 0; y <= kGridHeight; y++) {
+			for (uint32_t x = 0; x <= kGridWidth; x++) {
+				const uint32_t vertex = x + y * (kGridWidth + 1);
+
+				_vertices[vertex * 3 + 0] = x;
+				_vertices[vertex * 3 + 1] = y;
+				_vertices[vertex * 3 + 2] = 0.0f;
+			}
+		}
+
+		_faces.resize(_facesCount * 4);
+		_adjFaces.resize(_facesCount * 4);
+		for (uint32_t y = 0; y < kGridHeight; y++) {
+			for (uint32_t x = 0; x < kGridWidth; x++) {
+				const uint32_t face = x + y * kGridWidth;
+
+				_faces[face * 4 + 0] = x     + (y     * (kGridWidth + 1));
+				_faces[face * 4 + 1] = x + 1 + (y     * (kGridWidth + 1));
+				_faces[face * 4 + 2] = x + 1 + ((y + 1) * (kGridWidth + 1));
+				_faces[face * 4 + 3] = x     + ((y + 1) * (kGridWidth + 1));
+
+				_adjFaces[face * 4 + 0] = (y != 0)                 ? face - kGridWidth : UINT32_MAX;
+				_adjFaces[face * 4 + 1] = (x != (kGridWidth  - 1)) ? face + 1          : UINT32_MAX;
+				_adjFaces[face * 4 + 2] = (y != (kGridHeight - 1)) ? face + kGridWidth : UINT32_MAX;
+				_adjFaces[face * 4 + 3] = (x != 0)                 ? face - 1          : UINT32_MAX;
+			}
+		}
+
+		// Deterministic pseudo-random obstacles
+		uint32_t seed = 0x12345678;
+
+		_faceProperty.resize(_facesCount);
+		for (uint32_t face = 0; face < _facesCount; face++) {
+			seed = seed * 1664525 + 1013904223;
+
+			_faceProperty[face] = ((seed >> 24) < 64) ? 0 : 1;
+			if (_faceProperty[face] == 1)
+				_walkableFaces.push_back(face);
+		}
+
+		setAStarAlgorithm(new Engines::AStar(this));
+	}
+
+	uint32_t findFace(float x, float y, bool onlyWalkable = true) {
+		if ((x < 0.0f) || (y < 0.0f) || (x >= kGridWidth) || (y >= kGridHeight))
+			return UINT32_MAX;
+
+		const uint32_t face = static_cast<uint32_t>(x) + static_cast<uint32_t>(y) * kGridWidth;
+		if (onlyWalkable && !faceWalkable(face))
+			return UINT32_MAX;
+
+		return face;
+	}
+
+	void getAdjacentFaces(uint32_t face, uint32_t parent, std::vector<uint32_t> &adjFaces,
+	                      bool onlyWalkable = true) const {
+
+		Engines::Pathfinding::getAdjacentFaces(face, parent, adjFaces, onlyWalkable);
+	}
+
+	void getAdjacencyCenter(uint32_t faceA, uint32_t faceB, float &x, float &y) const {
+		for (uint32_t f = 0; f < 4; f++) {
+			if (_adjFaces[faceA * 4 + f] != faceB)
+				continue;
+
+			const uint32_t vert1 = _faces[faceA * 4 + f];
+			const uint32_t vert2 = _faces[faceA * 4 + (f + 1) % 4];
+
+			x = (_vertices[vert1 * 3 + 0] + _vertices[vert2 * 3 + 0]) / 2;
+			y = (_vertices[vert1 * 3 + 1] + _vertices[vert2 * 3 + 1]) / 2;
+			return;
+		}
+	}
+
+	const std::vector<uint32_t> &getWalkableFaces() const {
+		return _walkableFaces;
+	}
+
+private:
+	std::vector<uint32_t> _walkableFaces;
+};
+
+/** The previous A* implementation: linear lists, sorted after every expansion. */
+class ListAStar {
+public:
+	ListAStar(GridPathfinding &pathfinding) : _pathfinding(&pathfinding) {
+	}
+
+	bool findPath(float startX, float startY, float endX, float endY,
+	              std::vector<uint32_t> &facePath, uint32_t maxIteration = 10000) {
+
+		facePath.clear();
+
+		uint32_t startFace = _pathfinding->findFace(startX, startY, false);
+		uint32_t endFace   = _pathfinding->findFace(endX, endY, false);
+
+		if (startFace == UINT32_MAX || endFace == UINT32_MAX)
+			return false;
+
+		if (startFace == endFace) {
+			facePath.push_back(startFace);
+			return true;
+		}
+
+		Node startNode = Node(startFace, startX, startY);
+		Node endNode   = Node(endFace, endX, endY);
+
+		startNode.H = distance(startNode.x, startNode.y, endNode.x, endNode.y);
+		Node closestToEnd = startNode;
+
+		std::vector<Node> openList;
+		std::vector<Node> closedList;
+		openList.push_back(startNode);
+
+		for (uint32_t it = 0; it < maxIteration; ++it) {
+			if (openList.empty())
+				break;
+
+			Node current = openList.front();
+
+			if (current.face == endNode.face) {
+				reconstructPath(current, closedList, facePath);
+				return true;
+			}
+
+			openList.erase(openList.begin());
+			closedList.push_back(current);
+
+			std::vector<uint32_t> adjFaces;
+			_pathfinding->getAdjacentFaces(current.face, current.parent, adjFaces);
+			for (std::vector<uint32_t>::iterator a = adjFaces.begin(); a != adjFaces.end(); ++a) {
+				if (getNode(*a, closedList))
+					continue;
+
+				float x, y;
+				_pathfinding->getAdjacencyCenter(current.face, *a, x, y);
+				float gScore = current.G + distance(current.x, current.y, x, y);
+
+				Node *adjNode = getNode(*a, openList);
+				bool isThere = adjNode != 0;
+
+				Node newNode(*a, x, y);
+				if (!isThere)
+					adjNode = &newNode;
+				else if (gScore >= adjNode->G)
+					continue;
+
+				adjNode->parent = current.face;
+				adjNode->G = gScore;
+				adjNode->H = distance(adjNode->x, adjNode->y, endNode.x, endNode.y);
+				if (adjNode->H < closestToEnd.H)
+					closestToEnd = *adjNode;
+				if (!isThere)
+					openList.push_back(*adjNode);
+
+				std::sort(openList.begin(), openList.end());
+			}
+		}
+
+		reconstructPath(closestToEnd, closedList, facePath);
+		return false;
+	}
+
+private:
+	struct Node {
+		uint32_t face;
+		float x;
+		float y;
+		uint32_t parent;
+
+		float G;
+		float H;
+
+		Node(uint32_t faceID, float pX, float pY) :
+			face(faceID), x(pX), y(pY), parent(UINT32_MAX), G(0.0f), H(0.0f) {
+		}
+
+		bool operator<(const Node &node) const {
+			return G + H < node.G + node.H;
+		}
+	};
+
+	GridPathfinding *_pathfinding;
+
+	static float distance(float xA, float yA, float xB, float yB) {
+		return sqrt(pow(xA - xB, 2.f) + pow(yA - yB, 2.f));
+	}
+
+	static Node *getNode(uint32_t face, std::vector<Node> &nodes) {
+		for (std::vector<Node>::iterator n = nodes.begin(); n != nodes.end(); ++n)
+			if (n->face == face)
+				return &*n;
+
+		return 0;
+	}
+
+	static void reconstructPath(Node endNode, std::vector<Node> &closedList, std::vector<uint32_t> &path) {
+		path.push_back(endNode.face);
+
+		while (endNode.parent != UINT32_MAX) {
+			path.push_back(endNode.parent);
+
+			endNode = *getNode(endNode.parent, closedList);
+		}
+
+		std::reverse(path.begin(), path.end());
+	}
+};
+
+struct Query {
+	float startX, startY;
+	float endX, endY;
+};
+
+static void createQueries(const GridPathfinding &pathfinding, std::vector<Query> &queries) {
+	const std::vector<uint32_t> &faces = pathfinding.getWalkableFaces();
+
+	uint32_t seed = 0x87654321;
+	for (std::vector<Query>::iterator q = queries.begin(); q != queries.end(); ++q) {
+		seed = seed * 1664525 + 1013904223;
+		const uint32_t start = faces[(seed >> 8) % faces.size()];
+
+		seed = seed * 1664525 + 1013904223;
+		const uint32_t end   = faces[(seed >> 8) % faces.size()];
+
+		q->startX = (start % kGridWidth) + 0.5f;
+		q->startY = (start / kGridWidth) + 0.5f;
+		q->endX   = (end   % kGridWidth) + 0.5f;
+		q->endY   = (end   / kGridWidth) + 0.5f;
+	}
+}
+
+GTEST_TEST(AStarBenchmark, grid) {
+	GridPathfinding pathfinding;
+	ListAStar listAStar(pathfinding);
+
+	std::vector<Query> queries(Benchmark::scale(kQueryCount));
+	createQueries(pathfinding, queries);
+
+	std::vector<uint32_t> path;
+
+	size_t listFound = 0, listFaces = 0;
+	double listTime = 0.0;
+	{
+		Benchmark::Timer timer;
+		for (std::vector<Query>::const_iterator q = queries.begin(); q != queries.end(); ++q) {
+			if (listAStar.findPath(q->startX, q->startY, q->endX, q->endY, path))
+				listFound++;
+
+			listFaces += path.size();
+		}
+
+		listTime = timer.elapsed();
+		Benchmark::report("A*, sorted lists", listTime, queries.size());
+	}
+
+	size_t heapFound = 0, heapFaces = 0;
+	double heapTime = 0.0;
+	{
+		Benchmark::Timer timer;
+		for (std::vector<Query>::const_iterator q = queries.begin(); q != queries.end(); ++q) {
+			if (pathfinding.findPath(q->startX, q->startY, q->endX, q->endY, path))
+				heapFound++;
+
+			heapFaces += path.size();
+		}
+
+		heapTime = timer.elapsed();
+		Benchmark::report("A*, binary heap", heapTime, queries.size());
+	}
+
+	std::printf("[   BENCH  ] A* speedup: %.2fx, paths found: %zu/%zu, average path length: %.1f/%.1f faces\n",
+	            (heapTime > 0.0) ? (listTime / heapTime) : 0.0, listFound, heapFound,
+	            (double) listFaces / queries.size(), (double) heapFaces / queries.size());
+
+	EXPECT_EQ(heapFound, listFound);
+}
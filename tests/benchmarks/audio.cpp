@@ -0,0 +1,331 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for decoding and mixing sound.
+ *
+ *  By default, this decodes generated PCM WAVE files. Set
+ *  XOREOS_BENCHMARK_AUDIO to a directory to instead decode every file
+ *  in it that Sound::SoundManager::makeAudioStream() can detect.
+ */
+
+#include <cstdlib>
+#include <cmath>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/ustring.h"
+#include "src/common/string.h"
+#include "src/common/filelist.h"
+#include "src/common/readfile.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/sound/sound.h"
+#include "src/sound/audiostream.h"
+#include "src/sound/mixer.h"
+#include "src/sound/decoders/wave.h"
+
+#include "tests/benchmarks/benchmark.h"
+
+static const size_t kGeneratedFiles   = 16;
+static const size_t kGeneratedSeconds = 2;
+static const size_t kMixVoices        = 32;
+static const size_t kMixSeconds       = 10;
+
+/** A sound file, in memory. */
+struct SoundFile {
+	Common::UString name;
+	std::vector<byte> data;
+};
+
+/** Create a WAVE file holding a sine tone. */
+static void createWAV(SoundFile &file, size_t index) {
+	const uint16_t channels = (index % 2) ? 2 : 1;
+	const uint32_t rate     = (index % 3) ? 44100 : 22050;
+	const size_t   frames   = rate * kGeneratedSeconds;
+
+	std::vector<int16_t> samples(frames * channels);
+	for (size_t i = 0; i < frames; i++)
+		for (size_t j = 0; j < channels; j++)
+			samples[i * channels + j] = (int16_t) (8000.0 * std::sin((i * (j + 1) * (index + 1) * 220.0 * 6.2831853) / rate));
+
+	Common::MemoryWriteStreamDynamic wav(true);
+	Sound::writeWAVHeader(wav, samples.size() * 2, channels, rate);
+	Sound::writeWAVData(wav, samples.data(), samples.size());
+
+	file.name = Common::String::format("generated%u.wav", (uint) index);
+	file.data.assign(wav.getData(), wav.getData() + wav.size());
+}
+
+static void loadFiles(std::vector<SoundFile> &files) {
+	const char *directory = std::getenv("XOREOS_BENCHMARK_AUDIO");
+	if (!directory) {
+		files.resize(kGeneratedFiles);
+		for (size_t i = 0; i < files.size(); i++)
+			createWAV(files[i], i);
+
+		return;
+	}
+
+	const Common::FileList list(directory, -1);
+	for (Common::FileList::const_iterator f = list.begin(); f != list.end(); ++f) {
+		Common::ReadFile file;
+		if (!file.open(*f))
+			continue;
+
+		files.push_back(SoundFile());
+		files.back().name = *f;
+		files.back().data.resize(file.size());
+
+		if (file.read(files.back().data.data(), file.size()) != file.size())
+			files.pop_back();
+	}
+}
+
+/** Return the name of the decoder makeAudioStream() will use on this file. */
+static const char *getDecoderName(const byte *data, size_t size) {
+	if (size < 36)
+		return "Unknown";
+
+	const uint32_t tag = READ_BE_UINT32(data);
+
+	if (tag == 0xfff360c4)
+		return (size > 0x1D6) ? getDecoderName(data + 0x1D6, size - 0x1D6) : "Unknown";
+
+	if (tag == MKTAG('R', 'I', 'F', 'F')) {
+		switch (READ_LE_UINT16(data + 20)) {
+		case 0x0001:
+			return "PCM";
+		case 0x0002:
+		case 0x0011:
+		case 0x0069:
+			return "ADPCM";
+		default:
+			return "MP3";
+		}
+	}
+
+	if (tag == MKTAG('O', 'g', 'g', 'S'))
+		return "Vorbis";
+	if (tag == 0x3026B275)
+		return "WMA";
+
+	return "MP3";
+}
+
+/** Decode a whole stream, returning the number of samples. */
+static size_t decode(Sound::AudioStream &stream) {
+	static const size_t kBufferSize = 4096;
+	int16_t buffer[kBufferSize];
+
+	size_t total = 0;
+	while (!stream.endOfStream()) {
+		const size_t count = stream.readBuffer(buffer, kBufferSize);
+		if ((count == Sound::AudioStream::kSizeInvalid) || (count == 0))
+			break;
+
+		total += count;
+	}
+
+	return total;
+}
+
+GTEST_TEST(AudioBenchmark, decode) {
+	std::vector<SoundFile> files;
+	loadFiles(files);
+
+	struct Throughput {
+		size_t files;
+		size_t samples;
+		double seconds;
+
+		Throughput() : files(0), samples(0), seconds(0.0) { }
+	};
+
+	std::map<Common::UString, Throughput> decoders;
+
+	size_t skipped = 0;
+	for (std::vector<SoundFile>::const_iterator f = files.begin(); f != files.end(); ++f) {
+		Benchmark::Timer timer;
+
+		try {
+			std::unique_ptr<Sound::AudioStream> stream(Sound::SoundManager::makeAudioStream(
+				new Common::MemoryReadStream(f->data.data(), f->data.size())));
+
+			const size_t samples = decode(*stream);
+
+			Throughput &throughput = decoders[getDecoderName(f->data.data(), f->data.size())];
+
+			throughput.seconds += timer.elapsed();
+			throughput.samples += samples;
+			throughput.files++;
+
+		} catch (...) {
+			skipped++;
+		}
+	}
+
+	for (std::map<Common::UString, Throughput>::const_iterator d = decoders.begin(); d != decoders.end(); ++d) {
+		const Common::UString name = Common::String::format("decode%s (%u files)", d->first.c_str(), (uint) d->second.files);
+
+		Benchmark::reportRate(name.c_str(), d->second.seconds, d->second.samples, "samples");
+	}
+
+	if (skipped > 0)
+		std::printf("[   BENCH  ] Skipped %u undetectable or broken files\n", (uint) skipped);
+
+	if (!std::getenv("XOREOS_BENCHMARK_AUDIO")) {
+		EXPECT_EQ(skipped, 0U);
+	}
+}
+
+/** Mix the generated files on many voices, at a virtual clock. */
+static void mix(const std::vector<SoundFile> &files, std::vector<int16_t> &output, size_t frames) {
+	std::vector<std::unique_ptr<Sound::AudioStream>> streams;
+
+	Sound::Mixer mixer;
+	for (size_t i = 0; i < files.size(); i++) {
+		streams.emplace_back(Sound::SoundManager::makeAudioStream(
+			new Common::MemoryReadStream(files[i].data.data(), files[i].data.size())));
+
+		const size_t voice = mixer.addVoice(streams.back().get());
+
+		mixer.setVoiceGain(voice, 0.1f * (i % 4), 0.1f * (3 - (i % 4)));
+		mixer.setVoicePitch(voice, 0.5f + 0.1f * (i % 10));
+		mixer.setVoicePaused(voice, false);
+	}
+
+	output.resize(frames * 2);
+	mixer.mix(output.data(), frames);
+}
+
+GTEST_TEST(AudioBenchmark, mixOffline) {
+	const size_t frames = Benchmark::scale(kMixSeconds) * Sound::Mixer::kDefaultRate;
+
+	std::vector<SoundFile> files(kMixVoices);
+	for (size_t i = 0; i < files.size(); i++)
+		createWAV(files[i], i);
+
+	std::vector<int16_t> output1, output2;
+
+	Benchmark::Timer timer;
+	mix(files, output1, frames);
+	Benchmark::reportRate("mixOffline (32 voices)", timer.elapsed(), frames, "frames");
+
+	// Rendering at a virtual clock is deterministic
+	mix(files, output2, frames);
+	EXPECT_TRUE(output1 == output2);
+}
+
+/** Mix the generated files through the sound manager in headless mode.
+ *
+ *  The mix is returned twice: rendered into memory, and as the WAVE file
+ *  the sound manager wrote alongside.
+ */
+static void mixHeadless(const std::vector<SoundFile> &files, std::vector<int16_t> &output,
+                        std::vector<byte> &wav, size_t frames) {
+
+	SoundMan.init(true);
+	ASSERT_TRUE(SoundMan.isHeadless());
+
+	for (size_t i = 0; i < files.size(); i++) {
+		Sound::ChannelHandle channel = SoundMan.playAudioStream(Sound::SoundManager::makeAudioStream(
+			new Common::MemoryReadStream(files[i].data.data(), files[i].data.size())), Sound::kSoundTypeSFX);
+
+		SoundMan.setChannelGain(channel, 0.1f * (i % 4));
+		SoundMan.setChannelPitch(channel, 0.5f + 0.1f * (i % 10));
+		SoundMan.startChannel(channel);
+	}
+
+	/* The sound manager takes over the output stream and destroys it on deinit(),
+	 * but leaves the memory alone. With all of it reserved up front, it can't move. */
+	const size_t wavSize = 44 + frames * 2 * sizeof(int16_t);
+
+	Common::MemoryWriteStreamDynamic *wavStream = new Common::MemoryWriteStreamDynamic(false, wavSize);
+	std::unique_ptr<byte[]> wavData(wavStream->getData());
+
+	SoundMan.setHeadlessOutput(wavStream);
+
+	output.resize(frames * 2);
+	SoundMan.renderHeadless(output.data(), frames);
+
+	EXPECT_EQ(SoundMan.getHeadlessTime(), frames);
+
+	SoundMan.deinit();
+
+	wav.assign(wavData.get(), wavData.get() + wavSize);
+}
+
+GTEST_TEST(AudioBenchmark, mixHeadless) {
+	const size_t frames = Benchmark::scale(kMixSeconds) * Sound::Mixer::kDefaultRate;
+
+	std::vector<SoundFile> files(kMixVoices);
+	for (size_t i = 0; i < files.size(); i++)
+		createWAV(files[i], i);
+
+	std::vector<int16_t> output1, output2;
+	std::vector<byte> wav1, wav2;
+
+	Benchmark::Timer timer;
+	mixHeadless(files, output1, wav1, frames);
+	Benchmark::reportRate("mixHeadless (32 voices)", timer.elapsed(), frames, "frames");
+
+	mixHeadless(files, output2, wav2, frames);
+
+	// Two headless runs of the same calls are bit-identical, in memory and on disk
+	EXPECT_TRUE(output1 == output2);
+	EXPECT_TRUE(wav1 == wav2);
+
+	// The finalized header describes exactly the samples rendered
+	const uint32_t rate = Sound::Mixer::kDefaultRate;
+
+	ASSERT_EQ(wav1.size(), 44 + frames * 2 * sizeof(int16_t));
+
+	EXPECT_EQ(READ_BE_UINT32(wav1.data() +  0), MKTAG('R', 'I', 'F', 'F'));
+	EXPECT_EQ(READ_LE_UINT32(wav1.data() +  4), wav1.size() - 8);
+	EXPECT_EQ(READ_BE_UINT32(wav1.data() +  8), MKTAG('W', 'A', 'V', 'E'));
+	EXPECT_EQ(READ_LE_UINT16(wav1.data() + 20), 1);
+	EXPECT_EQ(READ_LE_UINT16(wav1.data() + 22), 2);
+	EXPECT_EQ(READ_LE_UINT32(wav1.data() + 24), rate);
+	EXPECT_EQ(READ_BE_UINT32(wav1.data() + 36), MKTAG('d', 'a', 't', 'a'));
+	EXPECT_EQ(READ_LE_UINT32(wav1.data() + 40), frames * 2 * sizeof(int16_t));
+
+	// And decoding the file again gives back the mix rendered into memory
+	std::unique_ptr<Sound::AudioStream> stream(Sound::SoundManager::makeAudioStream(
+		new Common::MemoryReadStream(wav1.data(), wav1.size())));
+
+	ASSERT_EQ(stream->getChannels(), 2);
+	EXPECT_EQ((uint32_t) stream->getRate(), rate);
+
+	std::vector<int16_t> decoded(output1.size());
+	EXPECT_EQ(stream->readBuffer(decoded.data(), decoded.size()), decoded.size());
+	EXPECT_TRUE(decoded == output1);
+
+	// The mix actually contains the generated tones
+	EXPECT_TRUE(std::any_of(output1.begin(), output1.end(), [](int16_t s) { return s != 0; }));
+}
@@ -0,0 +1,98 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Helpers for our micro-benchmarks.
+ */
+
+#ifndef TESTS_BENCHMARKS_BENCHMARK_H
+#define TESTS_BENCHMARKS_BENCHMARK_H
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <chrono>
+
+namespace Benchmark {
+
+/** Scale a benchmark's default workload.
+ *
+ *  The benchmarks run as part of the unit tests, so their default workloads
+ *  are kept small. Set XOREOS_BENCHMARK_SCALE to a positive integer to run
+ *  them with a proportionally larger workload.
+ */
+static inline size_t scale(size_t count) {
+	const char *env = std::getenv("XOREOS_BENCHMARK_SCALE");
+	if (!env)
+		return count;
+
+	const long factor = std::strtol(env, 0, 10);
+	if (factor <= 0)
+		return count;
+
+	return count * factor;
+}
+
+/** A simple wall-clock stopwatch. */
+class Timer {
+public:
+	Timer() : _start(std::chrono::steady_clock::now()) { }
+
+	/** Restart the timer. */
+	void reset() {
+		_start = std::chrono::steady_clock::now();
+	}
+
+	/** Return the time since the timer was started, in seconds. */
+	double elapsed() const {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+	}
+
+private:
+	std::chrono::steady_clock::time_point _start;
+};
+
+/** Print the result of a benchmark as time per operation. */
+static inline void report(const char *name, double seconds, size_t count) {
+	const double nsPerOp = (count > 0) ? ((seconds * 1000000000.0) / count) : 0.0;
+
+	std::printf("[   BENCH  ] %s: %zu ops in %.3f ms, %.2f ns/op\n", name, count, seconds * 1000.0, nsPerOp);
+	std::fflush(stdout);
+}
+
+/** Print the result of a benchmark as throughput. */
+static inline void reportThroughput(const char *name, double seconds, size_t bytes) {
+	const double mbPerSec = (seconds > 0.0) ? ((bytes / (1024.0 * 1024.0)) / seconds) : 0.0;
+
+	std::printf("[   BENCH  ] %s: %zu bytes in %.3f ms, %.2f MB/s\n", name, bytes, seconds * 1000.0, mbPerSec);
+	std::fflush(stdout);
+}
+
+/** Print the result of a benchmark as a rate of things per second. */
+static inline void reportRate(const char *name, double seconds, size_t count, const char *unit) {
+	const double mPerSec = (seconds > 0.0) ? ((count / 1000000.0) / seconds) : 0.0;
+
+	std::printf("[   BENCH  ] %s: %zu %s in %.3f ms, %.2f M%s/s\n", name, count, unit, seconds * 1000.0, mPerSec, unit);
+	std::fflush(stdout);
+}
+
+} // End of namespace Benchmark
+
+#endif // TESTS_BENCHMARKS_BENCHMARK_H
@@ -0,0 +1,107 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for reading bit streams.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/memreadstream.h"
+#include "src/common/bitstream.h"
+
+#include "tests/benchmarks/benchmark.h"
+
+static const size_t kDataSize = 4 * 1024 * 1024;
+
+/** The widths of the values we read, in a loop. A mix typical for audio and video codecs. */
+static const size_t kWidths[] = { 1, 4, 7, 1, 12, 3, 16, 2, 9, 1, 5, 24, 1, 6, 32, 8 };
+
+static void createData(std::vector<byte> &data) {
+	uint32_t x = 0x12345678;
+	for (size_t i = 0; i < data.size(); i++) {
+		x = x * 1664525 + 1013904223;
+
+		data[i] = x >> 24;
+	}
+}
+
+/** Read the whole bit stream, returning a checksum over all values. */
+template<class BitStream>
+static uint32_t readBitStream(BitStream &bits) {
+	uint32_t checksum = 0;
+
+	size_t width = 0;
+	size_t left  = bits.size() - bits.pos();
+	while (left >= 32) {
+		const size_t n = kWidths[width];
+		width = (width + 1) % ARRAYSIZE(kWidths);
+
+		checksum = (checksum * 31) + bits.getBits(n);
+		left -= n;
+	}
+
+	return checksum;
+}
+
+template<class BitStream>
+static uint32_t benchmarkBitStream(const char *name, const std::vector<byte> &data) {
+	Common::MemoryReadStream stream(data.data(), data.size());
+
+	Benchmark::Timer timer;
+
+	BitStream bits(stream);
+	const uint32_t checksum = readBitStream(bits);
+
+	Benchmark::reportThroughput(name, timer.elapsed(), data.size());
+
+	return checksum;
+}
+
+#define BENCHMARK_BITSTREAM(LAYOUT) \
+	GTEST_TEST(BitStreamBenchmark, LAYOUT) { \
+		std::vector<byte> data(Benchmark::scale(kDataSize)); \
+		createData(data); \
+		\
+		const uint32_t plain    = benchmarkBitStream<Common::BitStream##LAYOUT>("BitStream" #LAYOUT, data); \
+		const uint32_t buffered = benchmarkBitStream<Common::BufferedBitStream##LAYOUT>("BufferedBitStream" #LAYOUT, data); \
+		\
+		EXPECT_EQ(buffered, plain); \
+	}
+
+BENCHMARK_BITSTREAM(8MSB)
+BENCHMARK_BITSTREAM(8LSB)
+BENCHMARK_BITSTREAM(16LEMSB)
+BENCHMARK_BITSTREAM(16LELSB)
+BENCHMARK_BITSTREAM(16BEMSB)
+BENCHMARK_BITSTREAM(16BELSB)
+BENCHMARK_BITSTREAM(32LEMSB)
+BENCHMARK_BITSTREAM(32LELSB)
+BENCHMARK_BITSTREAM(32BEMSB)
+BENCHMARK_BITSTREAM(32BELSB)
+BENCHMARK_BITSTREAM(64LEMSB)
+BENCHMARK_BITSTREAM(64LELSB)
+BENCHMARK_BITSTREAM(64BEMSB)
+BENCHMARK_BITSTREAM(64BELSB)
+
+#undef BENCHMARK_BITSTREAM
@@ -0,0 +1,198 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for loading a GFF3 and looking up its fields.
+ */
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/gff3file.h"
+#include "src/aurora/gff3writer.h"
+
+#include "tests/benchmarks/benchmark.h"
+
+static const size_t kCreatureCount  = 2000;
+static const size_t kPlaceableCount = 2000;
+static const size_t kQueryRounds    =   10;
+
+static const char * const kCreatureLabels[] = {
+	"Tag", "TemplateResRef", "XPosition", "YPosition", "ZPosition", "XOrientation", "YOrientation",
+	"Appearance_Type", "FactionID", "Gender", "Race", "Subrace", "Deity", "CurrentHitPoints",
+	"MaxHitPoints", "Str", "Dex", "Con", "Int", "Wis", "Cha", "NaturalAC", "ChallengeRating",
+	"WalkRate", "Conversation", "ScriptSpawn", "ScriptDeath", "ScriptHeartbeat"
+};
+
+static const char * const kPlaceableLabels[] = {
+	"Tag", "TemplateResRef", "X", "Y", "Z", "Bearing", "Appearance", "Static", "Useable", "Locked",
+	"OpenLockDC", "KeyRequired", "KeyName", "HP", "CurrentHP", "Hardness", "Fort", "Will",
+	"OnUsed", "OnOpen", "OnClosed", "OnDeath", "OnHeartbeat"
+};
+
+/** Fill a GFF3 writer struct with the given labels, using a mix of GIT-like field types. */
+static void fillStruct(Aurora::GFF3WriterStruct &strct, const char * const *labels, size_t count, size_t index) {
+	for (size_t i = 0; i < count; i++) {
+		switch (i % 5) {
+			case 0:
+				strct.addExoString(labels[i], Common::String::format("value%u", (uint) index));
+				break;
+
+			case 1:
+				strct.addResRef(labels[i], Common::String::format("res%u", (uint) index));
+				break;
+
+			case 2:
+				strct.addFloat(labels[i], index * 0.5f);
+				break;
+
+			case 3:
+				strct.addUint32(labels[i], (uint32_t) index);
+				break;
+
+			default:
+				strct.addByte(labels[i], (uint8_t) index);
+				break;
+		}
+	}
+}
+
+/** Write a large GIT, with creature and placeable lists. */
+static std::vector<byte> createGIT() {
+	Aurora::GFF3Writer writer(MKTAG('G', 'I', 'T', ' '));
+
+	Aurora::GFF3WriterStructPtr top = writer.getTopLevel();
+
+	Aurora::GFF3WriterListPtr creatures  = top->addList("Creature List");
+	Aurora::GFF3WriterListPtr placeables = top->addList("Placeable List");
+
+	for (size_t i = 0; i < kCreatureCount; i++)
+		fillStruct(*creatures->addStruct(4), kCreatureLabels, ARRAYSIZE(kCreatureLabels), i);
+	for (size_t i = 0; i < kPlaceableCount; i++)
+		fillStruct(*placeables->addStruct(9), kPlaceableLabels, ARRAYSIZE(kPlaceableLabels), i);
+
+	Common::MemoryWriteStreamDynamic stream(true);
+	writer.write(stream);
+
+	return std::vector<byte>(stream.getData(), stream.getData() + stream.size());
+}
+
+GTEST_TEST(GFF3Benchmark, queryAllFields) {
+	const std::vector<byte> git = createGIT();
+
+	const size_t loads = Benchmark::scale(10);
+
+	Benchmark::Timer timer;
+	for (size_t i = 0; i < loads; i++)
+		Aurora::GFF3File gff3(new Common::MemoryReadStream(git.data(), git.size()));
+	Benchmark::report("GFF3File(), large GIT", timer.elapsed(), loads);
+
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(git.data(), git.size()), MKTAG('G', 'I', 'T', ' '));
+
+	const Aurora::GFF3List &creatures  = gff3.getTopLevel().getList("Creature List");
+	const Aurora::GFF3List &placeables = gff3.getTopLevel().getList("Placeable List");
+
+	ASSERT_EQ(creatures.size(), kCreatureCount);
+	ASSERT_EQ(placeables.size(), kPlaceableCount);
+
+	std::vector<const Aurora::GFF3Struct *> structs;
+	std::vector<Common::UString> names;
+
+	structs.insert(structs.end(), creatures.begin(), creatures.end());
+	structs.insert(structs.end(), placeables.begin(), placeables.end());
+
+	for (size_t i = 0; i < ARRAYSIZE(kCreatureLabels); i++)
+		names.push_back(kCreatureLabels[i]);
+	for (size_t i = 0; i < ARRAYSIZE(kPlaceableLabels); i++)
+		names.push_back(kPlaceableLabels[i]);
+
+	std::vector<Aurora::GFF3Label> labels;
+	for (std::vector<Common::UString>::const_iterator n = names.begin(); n != names.end(); ++n)
+		labels.push_back(Aurora::GFF3Label(*n));
+
+	/* The previous implementation, for comparison: a map from the label
+	 * string to the field, in every struct. */
+	std::vector<std::map<Common::UString, Aurora::GFF3Struct::FieldType>> maps(structs.size());
+	for (size_t i = 0; i < structs.size(); i++) {
+		const std::vector<Common::UString> fieldNames = structs[i]->getFieldNames();
+		for (std::vector<Common::UString>::const_iterator n = fieldNames.begin(); n != fieldNames.end(); ++n)
+			maps[i][*n] = structs[i]->getFieldType(*n);
+	}
+
+	const size_t rounds  = Benchmark::scale(kQueryRounds);
+	const size_t queries = rounds * structs.size() * names.size();
+
+	size_t found = 0;
+
+	timer.reset();
+	for (size_t r = 0; r < rounds; r++)
+		for (size_t i = 0; i < structs.size(); i++)
+			for (size_t n = 0; n < names.size(); n++)
+				found += (maps[i].find(names[n]) != maps[i].end()) ? 1 : 0;
+	Benchmark::report("std::map<UString, Field>::find()", timer.elapsed(), queries);
+
+	const size_t expected = found;
+	EXPECT_EQ(expected, rounds * (kCreatureCount  * ARRAYSIZE(kCreatureLabels) +
+	                              kPlaceableCount * ARRAYSIZE(kPlaceableLabels) +
+	                              // Tag and TemplateResRef appear in both
+	                              (kCreatureCount + kPlaceableCount) * 2));
+
+	found = 0;
+
+	timer.reset();
+	for (size_t r = 0; r < rounds; r++)
+		for (size_t i = 0; i < structs.size(); i++)
+			for (size_t n = 0; n < names.size(); n++)
+				found += (structs[i]->getFieldType(names[n]) != Aurora::GFF3Struct::kFieldTypeNone) ? 1 : 0;
+	Benchmark::report("GFF3Struct::getFieldType(UString)", timer.elapsed(), queries);
+
+	EXPECT_EQ(found, expected);
+
+	found = 0;
+
+	timer.reset();
+	for (size_t r = 0; r < rounds; r++)
+		for (size_t i = 0; i < structs.size(); i++)
+			for (size_t n = 0; n < labels.size(); n++)
+				found += (structs[i]->getFieldType(labels[n]) != Aurora::GFF3Struct::kFieldTypeNone) ? 1 : 0;
+	Benchmark::report("GFF3Struct::getFieldType(GFF3Label)", timer.elapsed(), queries);
+
+	EXPECT_EQ(found, expected);
+
+	uint64_t sum = 0;
+
+	timer.reset();
+	for (size_t r = 0; r < rounds; r++)
+		for (size_t i = 0; i < structs.size(); i++)
+			for (size_t n = 0; n < labels.size(); n++)
+				if (structs[i]->getFieldType(labels[n]) == Aurora::GFF3Struct::kFieldTypeUint32)
+					sum += structs[i]->getUint(labels[n]);
+	Benchmark::report("GFF3Struct::getUint(GFF3Label)", timer.elapsed(), queries);
+
+	EXPECT_GT(sum, 0U);
+}
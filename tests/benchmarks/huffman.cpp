@@ -0,0 +1,231 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/** @file
+ *  Benchmarks for decoding Huffman codes.
+ */
+
+#include <list>
+#include <queue>
+#include <vector>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/bitstream.h"
+#include "src/common/bitstreamwriter.h"
+#include "src/common/huffman.h"
+
+#include "tests/benchmarks/benchmark.h"
+
+static const size_t kSymbolCount = 256;
+static const size_t kDecodeCount = 1000000;
+
+/** The previous decoder: read bit by bit, searching the codes of each length in turn. */
+class ListHuffman {
+public:
+	ListHuffman(size_t codeCount, const uint32_t *codes, const uint8_t *lengths) {
+		for (size_t i = 0; i < codeCount; i++) {
+			if (_codes.size() < lengths[i])
+				_codes.resize(lengths[i]);
+
+			_codes[lengths[i] - 1].push_back(Symbol(codes[i], i));
+		}
+	}
+
+	uint32_t getSymbol(Common::BitStream &bits) const {
+		uint32_t code = 0;
+
+		for (size_t i = 0; i < _codes.size(); i++) {
+			bits.addBit(code, i);
+
+			for (CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode)
+				if (code == cCode->code)
+					return cCode->symbol;
+		}
+
+		throw Common::Exception("Unknown Huffman code");
+	}
+
+private:
+	struct Symbol {
+		uint32_t code;
+		uint32_t symbol;
+
+		Symbol(uint32_t c, uint32_t s) : code(c), symbol(s) { }
+	};
+
+	typedef std::list<Symbol> CodeList;
+
+	std::vector<CodeList> _codes;
+};
+
+/** A Huffman code over kSymbolCount symbols with a Zipf-like distribution. */
+struct HuffmanCode {
+	std::vector<uint32_t> codes;   ///< The codes, first bit read at the MSB.
+	std::vector<uint8_t>  lengths; ///< The code lengths.
+	std::vector<uint32_t> weights; ///< The symbol frequencies.
+
+	HuffmanCode() : codes(kSymbolCount), lengths(kSymbolCount), weights(kSymbolCount) {
+		for (size_t i = 0; i < kSymbolCount; i++)
+			weights[i] = 65536 / (i + 1);
+
+		// Build the Huffman tree, just to get the code lengths
+		typedef std::pair<uint64_t, size_t> Node;
+		std::priority_queue<Node, std::vector<Node>, std::greater<Node> > queue;
+
+		std::vector<size_t> parents(2 * kSymbolCount, 0);
+
+		for (size_t i = 0; i < kSymbolCount; i++)
+			queue.push(Node(weights[i], i));
+
+		size_t next = kSymbolCount;
+		while (queue.size() > 1) {
+			const Node a = queue.top(); queue.pop();
+			const Node b = queue.top(); queue.pop();
+
+			parents[a.second] = parents[b.second] = next;
+			queue.push(Node(a.first + b.first, next++));
+		}
+
+		const size_t root = next - 1;
+		for (size_t i = 0; i < kSymbolCount; i++) {
+			lengths[i] = 0;
+			for (size_t n = i; n != root; n = parents[n])
+				lengths[i]++;
+		}
+
+		// Assign canonical codes
+		uint32_t code = 0;
+		for (uint8_t length = 1; length <= 32; length++) {
+			for (size_t i = 0; i < kSymbolCount; i++)
+				if (lengths[i] == length)
+					codes[i] = code++;
+
+			code <<= 1;
+		}
+	}
+
+	/** Return the codes as a bit stream reading LSB first needs them. */
+	std::vector<uint32_t> getCodesLSB() const {
+		std::vector<uint32_t> reversed(kSymbolCount, 0);
+
+		for (size_t i = 0; i < kSymbolCount; i++)
+			for (size_t j = 0; j < lengths[i]; j++)
+				reversed[i] |= ((codes[i] >> j) & 1) << (lengths[i] - 1 - j);
+
+		return reversed;
+	}
+};
+
+/** Create a random sequence of symbols following the code's distribution. */
+static void createSymbols(const HuffmanCode &code, std::vector<uint32_t> &symbols) {
+	uint64_t totalWeight = 0;
+	for (size_t i = 0; i < kSymbolCount; i++)
+		totalWeight += code.weights[i];
+
+	uint32_t seed = 0x12345678;
+	for (size_t i = 0; i < symbols.size(); i++) {
+		seed = seed * 1664525 + 1013904223;
+
+		uint64_t pick = ((uint64_t) seed * totalWeight) >> 32;
+
+		size_t s = 0;
+		while (pick >= code.weights[s])
+			pick -= code.weights[s++];
+
+		symbols[i] = s;
+	}
+}
+
+template<class BitStreamWriter>
+static Common::MemoryWriteStreamDynamic *encode(const std::vector<uint32_t> &codes, const std::vector<uint8_t> &lengths,
+                                                const std::vector<uint32_t> &symbols) {
+
+	std::unique_ptr<Common::MemoryWriteStreamDynamic> stream = std::make_unique<Common::MemoryWriteStreamDynamic>(true);
+
+	BitStreamWriter bits(*stream);
+	for (std::vector<uint32_t>::const_iterator s = symbols.begin(); s != symbols.end(); ++s)
+		bits.putBits(codes[*s], lengths[*s]);
+
+	bits.flush();
+
+	// Padding, so that the bit stream never runs dry while decoding the last symbols
+	stream->writeUint64LE(0);
+
+	return stream.release();
+}
+
+template<class BitStreamWriter, class BitStream>
+static void benchmarkHuffman(const char *nameList, const char *nameTable, bool msbFirst) {
+	const HuffmanCode code;
+
+	std::vector<uint32_t> symbols(Benchmark::scale(kDecodeCount));
+	createSymbols(code, symbols);
+
+	const std::vector<uint32_t> codes = msbFirst ? code.codes : code.getCodesLSB();
+
+	std::unique_ptr<Common::MemoryWriteStreamDynamic> data(encode<BitStreamWriter>(codes, code.lengths, symbols));
+
+	const ListHuffman     listHuffman (kSymbolCount, codes.data(), code.lengths.data());
+	const Common::Huffman tableHuffman(0, kSymbolCount, codes.data(), code.lengths.data());
+
+	size_t listErrors = 0, tableErrors = 0;
+
+	{
+		Common::MemoryReadStream stream(data->getData(), data->size());
+		BitStream bits(stream);
+
+		Benchmark::Timer timer;
+		for (size_t i = 0; i < symbols.size(); i++)
+			if (listHuffman.getSymbol(bits) != symbols[i])
+				listErrors++;
+
+		Benchmark::report(nameList, timer.elapsed(), symbols.size());
+	}
+
+	{
+		Common::MemoryReadStream stream(data->getData(), data->size());
+		BitStream bits(stream);
+
+		Benchmark::Timer timer;
+		for (size_t i = 0; i < symbols.size(); i++)
+			if (tableHuffman.getSymbol(bits) != symbols[i])
+				tableErrors++;
+
+		Benchmark::report(nameTable, timer.elapsed(), symbols.size());
+	}
+
+	EXPECT_EQ(listErrors, 0);
+	EXPECT_EQ(tableErrors, 0);
+}
+
+GTEST_TEST(HuffmanBenchmark, BitStream8MSB) {
+	benchmarkHuffman<Common::BitStreamWriter8MSB, Common::BitStream8MSB>(
+		"Huffman, BitStream8MSB, linear search", "Huffman, BitStream8MSB, lookup tables", true);
+}
+
+GTEST_TEST(HuffmanBenchmark, BitStream32LELSB) {
+	benchmarkHuffman<Common::BitStreamWriter32LELSB, Common::BitStream32LELSB>(
+		"Huffman, BitStream32LELSB, linear search", "Huffman, BitStream32LELSB, lookup tables", false);
+}
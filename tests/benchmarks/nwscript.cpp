@@ -0,0 +1,619 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for loading and running NWScript bytecode.
+ */
+
+#include <cstring>
+#include <cstdlib>
+
+#include <vector>
+#include <set>
+#include <memory>
+#include <new>
+#include <atomic>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/platform.h"
+#include "src/common/changeid.h"
+#include "src/common/writefile.h"
+#include "src/common/memreadstream.h"
+
+#include "src/aurora/resman.h"
+
+#include "src/aurora/nwscript/ncsfile.h"
+#include "src/aurora/nwscript/ncsprogram.h"
+#include "src/aurora/nwscript/programcache.h"
+#include "src/aurora/nwscript/functionman.h"
+#include "src/aurora/nwscript/functioncontext.h"
+#include "src/aurora/nwscript/scheduler.h"
+
+#include "tests/benchmarks/benchmark.h"
+
+static boost::filesystem::path kDirectoryPath;
+
+/** Number of heap allocations done by this whole process so far. */
+static std::atomic<size_t> kAllocations(0);
+
+void *operator new(size_t size) {
+	kAllocations++;
+
+	void *ptr = std::malloc(size ? size : 1);
+	if (!ptr)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+/* Once inlined, GCC sees the free() below pairing up with an operator new it
+ * didn't inline, and mistakes that for a mismatched deallocation. */
+#if !defined(__clang__) && defined(__GNUC__) && (__GNUC__ >= 11)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t UNUSED(size)) noexcept {
+	std::free(ptr);
+}
+
+#if !defined(__clang__) && defined(__GNUC__) && (__GNUC__ >= 11)
+	#pragma GCC diagnostic pop
+#endif
+
+/** Write a script that returns the sum of two integer constants. */
+static void writeAddScript(const Common::UString &fileName, int32_t a, int32_t b) {
+	std::vector<byte> code = {
+		0x04, 0x03, 0x00, 0x00, 0x00, 0x00, // CONST int a
+		0x04, 0x03, 0x00, 0x00, 0x00, 0x00, // CONST int b
+		0x14, 0x20,                         // ADD int int
+		0x20, 0x00                          // RETN
+	};
+
+	WRITE_BE_UINT32(&code[2], a);
+	WRITE_BE_UINT32(&code[8], b);
+
+	Common::WriteFile file((kDirectoryPath / fileName.c_str()).generic_string());
+
+	file.writeUint32BE(MKTAG('N', 'C', 'S', ' '));
+	file.writeUint32BE(MKTAG('V', '1', '.', '0'));
+	file.writeByte(0x42);
+	file.writeUint32BE(13 + code.size());
+	file.write(&code[0], code.size());
+}
+
+namespace NWScript = Aurora::NWScript;
+
+/** A tiny assembler for hand-written NCS bytecode. */
+class Bytecode {
+public:
+	/** Return the offset of the next instruction within the NCS. */
+	int32_t pos() const {
+		return 13 + _code.size();
+	}
+
+	void op(NWScript::Opcode opcode, NWScript::InstructionType type = NWScript::kInstTypeNone) {
+		_code.push_back(opcode);
+		_code.push_back(type);
+	}
+
+	void int16(int16_t value) {
+		_code.push_back((value >> 8) & 0xFF);
+		_code.push_back( value       & 0xFF);
+	}
+
+	void int32(int32_t value) {
+		int16(value >> 16);
+		int16(value & 0xFFFF);
+	}
+
+	void constInt(int32_t value) {
+		op(NWScript::kOpcodeCONST, NWScript::kInstTypeInt);
+		int32(value);
+	}
+
+	void constFloat(float value) {
+		op(NWScript::kOpcodeCONST, NWScript::kInstTypeFloat);
+		int32(convertIEEEFloat(value));
+	}
+
+	void constString(const Common::UString &value) {
+		op(NWScript::kOpcodeCONST, NWScript::kInstTypeString);
+		int16(value.size());
+		_code.insert(_code.end(), value.c_str(), value.c_str() + value.size());
+	}
+
+	/** Copy the stack element at this offset to the top of the stack. */
+	void cptopsp(int32_t offset, int16_t size = 4) {
+		op(NWScript::kOpcodeCPTOPSP, NWScript::kInstTypeDirect);
+		int32(offset);
+		int16(size);
+	}
+
+	/** Copy the top of the stack into the stack element at this offset. */
+	void cpdownsp(int32_t offset, int16_t size = 4) {
+		op(NWScript::kOpcodeCPDOWNSP, NWScript::kInstTypeDirect);
+		int32(offset);
+		int16(size);
+	}
+
+	void movsp(int32_t offset) {
+		op(NWScript::kOpcodeMOVSP);
+		int32(offset);
+	}
+
+	void incsp(int32_t offset) {
+		op(NWScript::kOpcodeINCSP, NWScript::kInstTypeInt);
+		int32(offset);
+	}
+
+	void action(uint16_t function, uint8_t argCount) {
+		op(NWScript::kOpcodeACTION);
+		int16(function);
+		_code.push_back(argCount);
+	}
+
+	/** Jump backwards to a known offset. */
+	void jump(NWScript::Opcode opcode, int32_t target) {
+		const int32_t address = pos();
+
+		op(opcode);
+		int32(target - address);
+	}
+
+	/** Jump forwards, returning the jump to be fixed up later with land(). */
+	int32_t jumpForward(NWScript::Opcode opcode) {
+		const int32_t address = pos();
+
+		op(opcode);
+		int32(0);
+
+		return address;
+	}
+
+	/** Let the forward jump at this offset land on the next instruction. */
+	void land(int32_t jump) {
+		WRITE_BE_UINT32(&_code[jump - 13 + 2], pos() - jump);
+	}
+
+	/** Create a script out of the assembled bytecode. */
+	NWScript::NCSFile *create() const {
+		const size_t size = 13 + _code.size();
+
+		byte *data = new byte[size];
+
+		WRITE_BE_UINT32(data + 0, MKTAG('N', 'C', 'S', ' '));
+		WRITE_BE_UINT32(data + 4, MKTAG('V', '1', '.', '0'));
+		data[8] = 0x42;
+		WRITE_BE_UINT32(data + 9, size);
+		std::memcpy(data + 13, &_code[0], _code.size());
+
+		return new NWScript::NCSFile(new Common::MemoryReadStream(data, size, true));
+	}
+
+private:
+	std::vector<byte> _code;
+};
+
+/** Assemble a loop running its body this many times.
+ *
+ *  The loop counter lives on the top of the stack, below whatever the
+ *  body keeps there; keep is the size of this state, in stack bytes.
+ *  The body needs to leave the stack like it found it.
+ */
+template<typename Body>
+static void assembleLoop(Bytecode &code, int32_t iterations, int32_t keep, Body body) {
+	const int32_t counter = -4 - keep;
+
+	const int32_t loop = code.pos();
+
+	code.cptopsp(counter);
+	code.constInt(iterations);
+	code.op(NWScript::kOpcodeLT, NWScript::kInstTypeIntInt);
+	const int32_t exit = code.jumpForward(NWScript::kOpcodeJZ);
+
+	body(code);
+
+	code.incsp(counter);
+	code.jump(NWScript::kOpcodeJMP, loop);
+
+	code.land(exit);
+}
+
+/** Run the script and report how many instructions it executes per second.
+ *
+ *  The script is then run a second time, counting the heap allocations.
+ *  Since the script's stack has already grown to size by then, these are
+ *  the allocations the instructions themselves do.
+ */
+static const NWScript::Variable &runVM(const char *name, NWScript::NCSFile &ncs, size_t &allocations) {
+	Benchmark::Timer timer;
+	ncs.run(static_cast<NWScript::Object *>(0));
+	Benchmark::reportRate(name, timer.elapsed(), ncs.getInstructionCount(), "instructions");
+
+	const size_t allocationsStart = kAllocations;
+	const NWScript::Variable &result = ncs.run(static_cast<NWScript::Object *>(0));
+	allocations = kAllocations - allocationsStart;
+
+	std::printf("[   BENCH  ] %s: %zu heap allocations, %.3f per instruction\n", name, allocations,
+	            (double) allocations / ncs.getInstructionCount());
+
+	return result;
+}
+
+static int32_t runScript(const Common::UString &name) {
+	Aurora::NWScript::NCSFile ncs(name);
+
+	return ncs.run(static_cast<Aurora::NWScript::Object *>(0)).getInt();
+}
+
+class NWScriptBenchmark : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kDirectoryPath = tmpPath / uniquePath;
+		boost::filesystem::create_directory(kDirectoryPath);
+		boost::filesystem::create_directory(kDirectoryPath / "override");
+
+		writeAddScript("bench.ncs", 1, 2);
+		writeAddScript("override/bench.ncs", 2, 3);
+	}
+
+	static void TearDownTestCase() {
+		NCSCache.clear();
+		NCSCache.setCapacity(Aurora::NWScript::ProgramCache::kDefaultCapacity);
+
+		ResMan.clear();
+
+		if (!kDirectoryPath.empty())
+			boost::filesystem::remove_all(kDirectoryPath);
+	}
+};
+
+GTEST_TEST_F(NWScriptBenchmark, programCache) {
+	ASSERT_FALSE(kDirectoryPath.empty());
+
+	ResMan.clear();
+	ResMan.registerDataBase(kDirectoryPath.generic_string());
+	ResMan.indexResourceFile("bench.ncs", 100);
+
+	const size_t runs = Benchmark::scale(100000);
+
+	// Without caching, every run loads and checks the script anew
+
+	NCSCache.clear();
+	NCSCache.setCapacity(0);
+
+	int64_t sum = 0;
+
+	Benchmark::Timer timer;
+	for (size_t i = 0; i < runs; i++)
+		sum += runScript("bench");
+	Benchmark::report("NCSFile::run(), uncached", timer.elapsed(), runs);
+
+	EXPECT_EQ(sum, 3 * (int64_t) runs);
+	EXPECT_EQ(NCSCache.getHits(), 0);
+	EXPECT_EQ(NCSCache.getMisses(), runs);
+
+	// With caching, only the first run loads the script
+
+	NCSCache.clear();
+	NCSCache.setCapacity(Aurora::NWScript::ProgramCache::kDefaultCapacity);
+
+	sum = 0;
+
+	timer.reset();
+	for (size_t i = 0; i < runs; i++)
+		sum += runScript("bench");
+	Benchmark::report("NCSFile::run(), cached", timer.elapsed(), runs);
+
+	EXPECT_EQ(sum, 3 * (int64_t) runs);
+	EXPECT_EQ(NCSCache.getHits(), runs - 1);
+	EXPECT_EQ(NCSCache.getMisses(), 1);
+	EXPECT_EQ(NCSCache.getSize(), 1);
+
+	// Changing the resources reloads the script
+
+	Common::ChangeID overrideChange;
+	ResMan.indexResourceFile("override/bench.ncs", 200, &overrideChange);
+
+	EXPECT_EQ(runScript("bench"), 5);
+	EXPECT_EQ(NCSCache.getMisses(), 2);
+
+	ResMan.undo(overrideChange);
+
+	EXPECT_EQ(runScript("bench"), 3);
+	EXPECT_EQ(NCSCache.getMisses(), 3);
+	EXPECT_EQ(runScript("BENCH"), 3);
+	EXPECT_EQ(NCSCache.getMisses(), 3);
+}
+
+GTEST_TEST_F(NWScriptBenchmark, programCacheCapacity) {
+	ASSERT_FALSE(kDirectoryPath.empty());
+
+	ResMan.clear();
+	ResMan.registerDataBase(kDirectoryPath.generic_string());
+	ResMan.indexResourceFile("bench.ncs", 100);
+
+	NCSCache.clear();
+	NCSCache.setCapacity(1);
+
+	EXPECT_EQ(runScript("bench"), 3);
+	EXPECT_EQ(NCSCache.getSize(), 1);
+
+	EXPECT_THROW(runScript("nonexistent"), Common::Exception);
+	EXPECT_EQ(NCSCache.getSize(), 1);
+
+	EXPECT_EQ(runScript("bench"), 3);
+	EXPECT_EQ(NCSCache.getHits(), 1);
+
+	NCSCache.setCapacity(0);
+	EXPECT_EQ(NCSCache.getSize(), 0);
+}
+
+GTEST_TEST_F(NWScriptBenchmark, vmArithmetic) {
+	const int32_t iterations = Benchmark::scale(200000);
+
+	// sum = (sum + i * 3) & 0xFFFF, for all i in [0, iterations)
+
+	Bytecode code;
+	code.constInt(0); // i
+	code.constInt(0); // sum
+
+	assembleLoop(code, iterations, 4, [](Bytecode &c) {
+		c.cptopsp(-4);
+		c.cptopsp(-12);
+		c.constInt(3);
+		c.op(NWScript::kOpcodeMUL, NWScript::kInstTypeIntInt);
+		c.op(NWScript::kOpcodeADD, NWScript::kInstTypeIntInt);
+		c.constInt(0xFFFF);
+		c.op(NWScript::kOpcodeBOOLAND, NWScript::kInstTypeIntInt);
+		c.cpdownsp(-8);
+		c.movsp(-4);
+	});
+
+	code.op(NWScript::kOpcodeRETN);
+
+	int32_t sum = 0;
+	for (int32_t i = 0; i < iterations; i++)
+		sum = (sum + i * 3) & 0xFFFF;
+
+	size_t allocations = 0;
+
+	std::unique_ptr<NWScript::NCSFile> ncs(code.create());
+	EXPECT_EQ(runVM("NCSFile, integer arithmetic", *ncs, allocations).getInt(), sum);
+	EXPECT_EQ(allocations, 0);
+}
+
+GTEST_TEST_F(NWScriptBenchmark, vmStrings) {
+	const int32_t iterations = Benchmark::scale(100000);
+
+	// s = "Hello" + ", " + "world" + "!", over and over again
+
+	Bytecode code;
+	code.constInt(0);    // i
+	code.constString(""); // s
+
+	assembleLoop(code, iterations, 4, [](Bytecode &c) {
+		c.constString("Hello");
+		c.constString(", ");
+		c.op(NWScript::kOpcodeADD, NWScript::kInstTypeStringString);
+		c.constString("world");
+		c.op(NWScript::kOpcodeADD, NWScript::kInstTypeStringString);
+		c.constString("!");
+		c.op(NWScript::kOpcodeADD, NWScript::kInstTypeStringString);
+		c.cpdownsp(-8);
+		c.movsp(-4);
+	});
+
+	code.op(NWScript::kOpcodeRETN);
+
+	size_t allocations = 0;
+
+	std::unique_ptr<NWScript::NCSFile> ncs(code.create());
+	EXPECT_STREQ(runVM("NCSFile, string concatenation", *ncs, allocations).getString().c_str(), "Hello, world!");
+
+	// String constants are shared, only the concatenated strings need memory of their own
+	EXPECT_LE(allocations, 3 * (size_t) iterations);
+}
+
+GTEST_TEST_F(NWScriptBenchmark, vmVectors) {
+	const int32_t iterations = Benchmark::scale(100000);
+
+	// v = (v + [1, 1, 1]) * 0.5, which converges towards [1, 1, 1]
+
+	Bytecode code;
+	code.constInt(0);      // i
+	code.constFloat(0.0f); // v.x
+	code.constFloat(0.0f); // v.y
+	code.constFloat(0.0f); // v.z
+
+	assembleLoop(code, iterations, 12, [](Bytecode &c) {
+		c.cptopsp(-12, 12);
+		c.constFloat(1.0f);
+		c.constFloat(1.0f);
+		c.constFloat(1.0f);
+		c.op(NWScript::kOpcodeADD, NWScript::kInstTypeVectorVector);
+		c.constFloat(0.5f);
+		c.op(NWScript::kOpcodeMUL, NWScript::kInstTypeVectorFloat);
+		c.cpdownsp(-24, 12);
+		c.movsp(-12);
+	});
+
+	code.op(NWScript::kOpcodeRETN);
+
+	size_t allocations = 0;
+
+	std::unique_ptr<NWScript::NCSFile> ncs(code.create());
+	EXPECT_FLOAT_EQ(runVM("NCSFile, vector math", *ncs, allocations).getFloat(), 1.0f);
+	EXPECT_EQ(allocations, 0);
+}
+
+GTEST_TEST_F(NWScriptBenchmark, vmEngineCalls) {
+	const int32_t iterations = Benchmark::scale(100000);
+
+	FunctionMan.clear();
+	FunctionMan.registerFunction("BenchAdd", 0, [](NWScript::FunctionContext &ctx) {
+		ctx.getReturn() = ctx.getParams()[0].getInt() + ctx.getParams()[1].getInt();
+	}, { NWScript::kTypeInt, NWScript::kTypeInt, NWScript::kTypeInt });
+
+	// sum = BenchAdd(sum, 2), via the engine
+
+	Bytecode code;
+	code.constInt(0); // i
+	code.constInt(0); // sum
+
+	assembleLoop(code, iterations, 4, [](Bytecode &c) {
+		c.cptopsp(-4);
+		c.constInt(2);
+		c.action(0, 2);
+		c.cpdownsp(-8);
+		c.movsp(-4);
+	});
+
+	code.op(NWScript::kOpcodeRETN);
+
+	size_t allocations = 0;
+
+	std::unique_ptr<NWScript::NCSFile> ncs(code.create());
+	EXPECT_EQ(runVM("NCSFile, engine function calls", *ncs, allocations).getInt(), 2 * iterations);
+	EXPECT_EQ(allocations, 0);
+
+	FunctionMan.clear();
+}
+
+/** Heartbeat period of the simulated objects, in milliseconds. */
+static const uint32_t kHeartbeat = 6000;
+/** Length of a simulated frame, in milliseconds. */
+static const uint32_t kFrame     = 16;
+
+/** A delayed script, as the modules used to keep them in a sorted set. */
+struct SortedDelayedScript {
+	Common::UString script;
+
+	NWScript::ScriptState state;
+	NWScript::ObjectReference owner;
+	NWScript::ObjectReference triggerer;
+
+	uint32_t timestamp;
+
+	bool operator<(const SortedDelayedScript &s) const {
+		return timestamp < s.timestamp;
+	}
+};
+
+GTEST_TEST_F(NWScriptBenchmark, delayedScripts) {
+	/* Simulate a busy module: lots of objects with a script that delays
+	 * itself by one heartbeat each time it runs, with the module collecting
+	 * the scripts that are due once every frame. */
+
+	const size_t   objects = Benchmark::scale(20000);
+	const uint32_t frames  = 60000 / kFrame;
+
+	const Common::UString script("nw_c2_default1");
+	const NWScript::ScriptState state = NWScript::ScriptState();
+
+	// The old way, a multiset ordered by due time
+
+	std::multiset<SortedDelayedScript> sorted;
+	for (size_t i = 0; i < objects; i++) {
+		SortedDelayedScript delayed;
+
+		delayed.script    = script;
+		delayed.state     = state;
+		delayed.timestamp = (i * kHeartbeat) / objects;
+
+		sorted.insert(delayed);
+	}
+
+	size_t sortedFired = 0;
+
+	size_t allocationsStart = kAllocations;
+
+	Benchmark::Timer timer;
+	for (uint32_t frame = 0; frame < frames; frame++) {
+		const uint32_t now = frame * kFrame;
+
+		while (!sorted.empty() && (sorted.begin()->timestamp <= now)) {
+			SortedDelayedScript delayed = *sorted.begin();
+			sorted.erase(sorted.begin());
+
+			delayed.timestamp = now + kHeartbeat;
+			sorted.insert(delayed);
+
+			sortedFired++;
+		}
+	}
+	Benchmark::reportRate("Delayed scripts, sorted set", timer.elapsed(), sortedFired, "scripts");
+
+	size_t allocations = kAllocations - allocationsStart;
+	std::printf("[   BENCH  ] Delayed scripts, sorted set: %zu heap allocations, %.3f per script\n",
+	            allocations, (double) allocations / sortedFired);
+
+	// The timing wheel
+
+	NWScript::ScriptScheduler scheduler;
+	for (size_t i = 0; i < objects; i++)
+		scheduler.schedule(0, (i * kHeartbeat) / objects, script, state,
+		                   NWScript::ObjectReference(), NWScript::ObjectReference());
+
+	std::vector<NWScript::DelayedScript> batch;
+	size_t wheelFired = 0;
+
+	allocationsStart = kAllocations;
+
+	timer.reset();
+	for (uint32_t frame = 0; frame < frames; frame++) {
+		const uint32_t now = frame * kFrame;
+
+		scheduler.collect(now, batch);
+		for (std::vector<NWScript::DelayedScript>::const_iterator d = batch.begin(); d != batch.end(); ++d)
+			scheduler.schedule(now, kHeartbeat, d->script, d->state, d->owner, d->triggerer);
+
+		wheelFired += batch.size();
+		batch.clear();
+	}
+	Benchmark::reportRate("Delayed scripts, timing wheel", timer.elapsed(), wheelFired, "scripts");
+
+	allocations = kAllocations - allocationsStart;
+	std::printf("[   BENCH  ] Delayed scripts, timing wheel: %zu heap allocations, %.3f per script\n",
+	            allocations, (double) allocations / wheelFired);
+
+	const NWScript::ScriptScheduler::Stats stats = scheduler.getStats();
+	std::printf("[   BENCH  ] Delayed scripts, timing wheel: %zu batches, largest %zu scripts\n",
+	            stats.batches, stats.maxBatchSize);
+
+	EXPECT_EQ(wheelFired, sortedFired);
+	EXPECT_EQ(scheduler.getQueueDepth(), objects);
+	EXPECT_LT(stats.maxLatency, kFrame);
+}
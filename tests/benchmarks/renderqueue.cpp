@@ -0,0 +1,267 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for sorting the render queue.
+ */
+
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include "src/common/types.h"
+
+#include "src/graphics/render/renderkey.h"
+
+#include "tests/benchmarks/benchmark.h"
+
+static const size_t kNodeCount     = 50000;
+static const size_t kProgramCount  = 40;
+static const size_t kMaterialCount = 600;
+static const size_t kMeshCount     = 3000;
+static const size_t kFrameCount    = 20;
+
+/** Stand-in for the shader programs, materials, surfaces and meshes. */
+struct FakeObject {
+	uint32_t dummy;
+};
+
+/** An item to queue, as the render manager would hand it over. */
+struct Item {
+	const FakeObject *program;
+	const FakeObject *surface;
+	const FakeObject *material;
+	const FakeObject *mesh;
+	float depth;
+	float alpha;
+};
+
+/** A node of the render queue, as it used to be: the whole payload, sorted by pointers. */
+struct PointerNode {
+	const FakeObject *program;
+	const FakeObject *surface;
+	const FakeObject *material;
+	const FakeObject *mesh;
+	float reference;
+	float alpha;
+};
+
+static bool comparePointers(const PointerNode &a, const PointerNode &b) {
+	if (a.program != b.program)
+		return a.program > b.program;
+	if (a.material != b.material)
+		return a.material > b.material;
+
+	return a.mesh > b.mesh;
+}
+
+/** The render queue, with its payload in separate arrays. */
+struct KeyQueue {
+	std::vector<Graphics::Render::RenderQueueNode> nodes;
+	std::vector<Graphics::Render::RenderQueueNode> scratch;
+
+	std::vector<const FakeObject *> programs;
+	std::vector<const FakeObject *> surfaces;
+	std::vector<const FakeObject *> materials;
+	std::vector<const FakeObject *> meshes;
+	std::vector<float> alphas;
+
+	Graphics::Render::RenderKeyBuilder keys;
+
+	void clear() {
+		nodes.clear();
+
+		programs.clear();
+		surfaces.clear();
+		materials.clear();
+		meshes.clear();
+		alphas.clear();
+
+		keys.clear();
+	}
+
+	void queue(const Item &item) {
+		nodes.push_back(Graphics::Render::RenderQueueNode(keys.build(item.program, item.material, item.mesh, item.depth), programs.size()));
+
+		programs.push_back(item.program);
+		surfaces.push_back(item.surface);
+		materials.push_back(item.material);
+		meshes.push_back(item.mesh);
+		alphas.push_back(item.alpha);
+	}
+};
+
+static std::vector<Item> createItems(const std::vector<FakeObject> &objects) {
+	std::mt19937 rng(23);
+
+	const FakeObject *programs  = &objects[0];
+	const FakeObject *materials = programs  + kProgramCount;
+	const FakeObject *meshes    = materials + kMaterialCount;
+
+	std::uniform_real_distribution<float> depth(0.0f, 10000.0f);
+
+	std::vector<Item> items(kNodeCount);
+	for (size_t i = 0; i < kNodeCount; i++) {
+		// Like a real scene, models are queued as runs of meshes sharing a material
+		const size_t mesh     = rng() % kMeshCount;
+		const size_t material = mesh % kMaterialCount;
+		const size_t program  = material % kProgramCount;
+
+		items[i].program  = &programs[program];
+		items[i].material = &materials[material];
+		items[i].mesh     = &meshes[mesh];
+		items[i].surface  = &programs[program];
+		items[i].depth    = depth(rng);
+		items[i].alpha    = 1.0f;
+	}
+
+	return items;
+}
+
+/** Count how often the program, material or mesh changes when walking the queue. */
+static size_t countStateChanges(const KeyQueue &queue) {
+	size_t changes = 0;
+
+	for (size_t i = 1; i < queue.nodes.size(); i++) {
+		const uint32_t a = queue.nodes[i - 1].index;
+		const uint32_t b = queue.nodes[i    ].index;
+
+		if ((queue.programs[a] != queue.programs[b]) || (queue.materials[a] != queue.materials[b]) ||
+		    (queue.meshes[a]   != queue.meshes[b]))
+			changes++;
+	}
+
+	return changes;
+}
+
+GTEST_TEST(RenderQueueBenchmark, sortShader) {
+	const std::vector<FakeObject> objects(kProgramCount + kMaterialCount + kMeshCount);
+	const std::vector<Item> items = createItems(objects);
+
+	const size_t frames = Benchmark::scale(kFrameCount);
+
+	// The old way: copy the whole payload into the queue and sort by chasing pointers
+
+	std::vector<PointerNode> pointerQueue;
+	pointerQueue.reserve(kNodeCount);
+
+	Benchmark::Timer timer;
+	for (size_t f = 0; f < frames; f++) {
+		pointerQueue.clear();
+
+		for (const Item &item : items)
+			pointerQueue.push_back(PointerNode { item.program, item.surface, item.material, item.mesh, item.depth, item.alpha });
+
+		std::sort(pointerQueue.begin(), pointerQueue.end(), comparePointers);
+	}
+	Benchmark::report("Queue and sort by shader, std::sort on pointers", timer.elapsed(), frames * kNodeCount);
+
+	// Packed keys and a radix sort
+
+	KeyQueue queue;
+
+	timer.reset();
+	for (size_t f = 0; f < frames; f++) {
+		queue.clear();
+
+		for (const Item &item : items)
+			queue.queue(item);
+
+		Graphics::Render::sortRenderQueueNodes(queue.nodes, queue.scratch, Graphics::Render::kRenderKeyBytes);
+	}
+	Benchmark::report("Queue and sort by shader, radix sort on keys", timer.elapsed(), frames * kNodeCount);
+
+	ASSERT_EQ(queue.nodes.size(), kNodeCount);
+
+	// Sorted by key, and stable: equal keys keep the order they were queued in
+	for (size_t i = 1; i < queue.nodes.size(); i++) {
+		const Graphics::Render::RenderQueueNode &a = queue.nodes[i - 1];
+		const Graphics::Render::RenderQueueNode &b = queue.nodes[i    ];
+
+		ASSERT_LE(a.key, b.key);
+		if (a.key == b.key) {
+			ASSERT_LT(a.index, b.index);
+		}
+	}
+
+	// Every mesh ends up in one contiguous run, so there are as many state changes as with the old sort
+	size_t pointerChanges = 0;
+	for (size_t i = 1; i < pointerQueue.size(); i++)
+		if ((pointerQueue[i - 1].program != pointerQueue[i].program) || (pointerQueue[i - 1].material != pointerQueue[i].material) ||
+		    (pointerQueue[i - 1].mesh    != pointerQueue[i].mesh))
+			pointerChanges++;
+
+	EXPECT_EQ(countStateChanges(queue), pointerChanges);
+}
+
+GTEST_TEST(RenderQueueBenchmark, sortDepth) {
+	const std::vector<FakeObject> objects(kProgramCount + kMaterialCount + kMeshCount);
+	const std::vector<Item> items = createItems(objects);
+
+	const size_t frames = Benchmark::scale(kFrameCount);
+
+	KeyQueue queue;
+
+	Benchmark::Timer timer;
+	for (size_t f = 0; f < frames; f++) {
+		queue.clear();
+
+		for (const Item &item : items)
+			queue.queue(item);
+
+		Graphics::Render::sortRenderQueueNodes(queue.nodes, queue.scratch, Graphics::Render::kRenderKeyDepthBytes);
+	}
+	Benchmark::report("Queue and sort by depth, radix sort on keys", timer.elapsed(), frames * kNodeCount);
+
+	ASSERT_EQ(queue.nodes.size(), kNodeCount);
+
+	// Front to back, up to the precision of the quantised depth
+	for (size_t i = 1; i < queue.nodes.size(); i++) {
+		const float a = items[queue.nodes[i - 1].index].depth;
+		const float b = items[queue.nodes[i    ].index].depth;
+
+		if (Graphics::Render::quantiseRenderKeyDepth(a) != Graphics::Render::quantiseRenderKeyDepth(b)) {
+			ASSERT_LT(a, b);
+		} else {
+			ASSERT_LT(queue.nodes[i - 1].index, queue.nodes[i].index);
+		}
+	}
+}
+
+GTEST_TEST(RenderQueueBenchmark, sortSmall) {
+	// Short queues take the simple path, but sort the same way
+	std::vector<Graphics::Render::RenderQueueNode> nodes, scratch;
+	for (uint32_t i = 0; i < 20; i++)
+		nodes.push_back(Graphics::Render::RenderQueueNode(Graphics::Render::packRenderKey(i % 3, 0, 0, 20.0f - i), i));
+
+	Graphics::Render::sortRenderQueueNodes(nodes, scratch, Graphics::Render::kRenderKeyDepthBytes);
+	for (uint32_t i = 0; i < 20; i++)
+		EXPECT_EQ(nodes[i].index, 19 - i);
+
+	Graphics::Render::sortRenderQueueNodes(nodes, scratch, Graphics::Render::kRenderKeyBytes);
+	for (uint32_t i = 0; i < 20; i++)
+		EXPECT_EQ(nodes[i].key >> Graphics::Render::kRenderKeyProgramShift, i / 7);
+
+	// Depths that can't be sorted end up in front
+	EXPECT_EQ(Graphics::Render::quantiseRenderKeyDepth(-1.0f), 0);
+	EXPECT_LT(Graphics::Render::quantiseRenderKeyDepth(0.5f), Graphics::Render::quantiseRenderKeyDepth(0.5001f));
+}
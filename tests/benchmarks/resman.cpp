@@ -0,0 +1,210 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for indexing and looking up resources in the resource manager.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/platform.h"
+#include "src/common/hash.h"
+#include "src/common/changeid.h"
+#include "src/common/memreadstream.h"
+#include "src/common/writefile.h"
+
+#include "src/aurora/util.h"
+#include "src/aurora/erfwriter.h"
+#include "src/aurora/resman.h"
+
+#include "tests/benchmarks/benchmark.h"
+
+static const size_t kResourceCount = 100000;
+static const size_t kOverrideCount =  10000;
+
+static boost::filesystem::path kDirectoryPath;
+
+static Common::UString getResourceName(size_t i) {
+	return Common::String::format("res%06u", (uint) i);
+}
+
+/** Write an ERF archive with count 4-byte resources, starting at the given name index. */
+static void writeArchive(const Common::UString &fileName, size_t first, size_t count, uint32_t content) {
+	Common::WriteFile file((kDirectoryPath / fileName.c_str()).generic_string());
+
+	Aurora::ERFWriter erf(MKTAG('E', 'R', 'F', ' '), count, file);
+
+	const byte data[4] = { (byte) (content >> 24), (byte) (content >> 16), (byte) (content >> 8), (byte) content };
+	for (size_t i = first; i < (first + count); i++) {
+		Common::MemoryReadStream stream(data);
+
+		erf.add(getResourceName(i), Aurora::kFileTypeUTC, stream);
+	}
+}
+
+static uint32_t readResource(const Common::UString &name) {
+	std::unique_ptr<Common::SeekableReadStream> stream(ResMan.getResource(name, Aurora::kFileTypeUTC));
+	if (!stream)
+		return 0;
+
+	return stream->readUint32BE();
+}
+
+class ResourceManagerBenchmark : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kDirectoryPath = tmpPath / uniquePath;
+		boost::filesystem::create_directory(kDirectoryPath);
+
+		writeArchive("base.erf"    , 0, kResourceCount, 0x11111111);
+		writeArchive("override.erf", 0, kOverrideCount, 0x22222222);
+	}
+
+	static void TearDownTestCase() {
+		ResMan.clear();
+
+		if (!kDirectoryPath.empty())
+			boost::filesystem::remove_all(kDirectoryPath);
+	}
+};
+
+GTEST_TEST_F(ResourceManagerBenchmark, indexAndLookup) {
+	ASSERT_FALSE(kDirectoryPath.empty());
+
+	ResMan.clear();
+	ResMan.registerDataBase(kDirectoryPath.generic_string());
+
+	Common::ChangeID baseChange, overrideChange;
+
+	Benchmark::Timer timer;
+	ResMan.indexArchive("base.erf", 100, &baseChange);
+	Benchmark::report("ResourceManager::indexArchive()", timer.elapsed(), kResourceCount);
+
+	timer.reset();
+	ResMan.indexArchive("override.erf", 200, &overrideChange);
+	Benchmark::report("ResourceManager::indexArchive(), overriding", timer.elapsed(), kOverrideCount);
+
+	std::vector<Common::UString> names;
+	std::vector<uint64_t> hashes;
+
+	names.reserve(kResourceCount);
+	hashes.reserve(kResourceCount);
+
+	for (size_t i = 0; i < kResourceCount; i++) {
+		names.push_back(getResourceName(i));
+		hashes.push_back(Common::hashString(TypeMan.setFileType(names.back(), Aurora::kFileTypeUTC), Common::kHashFNV64));
+	}
+
+	const size_t lookups = Benchmark::scale(10 * kResourceCount);
+
+	size_t found = 0;
+
+	timer.reset();
+	for (size_t i = 0; i < lookups; i++)
+		found += ResMan.hasResource(hashes[(i * 7919) % kResourceCount]) ? 1 : 0;
+	Benchmark::report("ResourceManager::hasResource(hash)", timer.elapsed(), lookups);
+
+	EXPECT_EQ(found, lookups);
+
+	found = 0;
+
+	timer.reset();
+	for (size_t i = 0; i < lookups; i++)
+		found += ResMan.hasResource(hashes[(i * 7919) % kResourceCount] ^ 1) ? 1 : 0;
+	Benchmark::report("ResourceManager::hasResource(hash), missing", timer.elapsed(), lookups);
+
+	EXPECT_EQ(found, 0);
+
+	found = 0;
+
+	timer.reset();
+	for (size_t i = 0; i < kResourceCount; i++)
+		found += ResMan.hasResource(names[i], Aurora::kFileTypeUTC) ? 1 : 0;
+	Benchmark::report("ResourceManager::hasResource(name, type)", timer.elapsed(), kResourceCount);
+
+	EXPECT_EQ(found, kResourceCount);
+
+	// The higher-priority archive overrides the lower-priority one
+
+	EXPECT_EQ(readResource(names[0]), 0x22222222);
+	EXPECT_EQ(readResource(names[kOverrideCount - 1]), 0x22222222);
+	EXPECT_EQ(readResource(names[kOverrideCount]), 0x11111111);
+	EXPECT_EQ(readResource(names[kResourceCount - 1]), 0x11111111);
+
+	// Removing the overriding archive brings the shadowed resources back
+
+	ResMan.undo(overrideChange);
+
+	EXPECT_EQ(readResource(names[0]), 0x11111111);
+	EXPECT_EQ(readResource(names[kOverrideCount - 1]), 0x11111111);
+
+	// Removing the base archive as well leaves nothing behind
+
+	ResMan.undo(baseChange);
+
+	EXPECT_FALSE(ResMan.hasResource(names[0], Aurora::kFileTypeUTC));
+	EXPECT_FALSE(ResMan.hasResource(names[kResourceCount - 1], Aurora::kFileTypeUTC));
+}
+
+GTEST_TEST_F(ResourceManagerBenchmark, priorities) {
+	ASSERT_FALSE(kDirectoryPath.empty());
+
+	ResMan.clear();
+	ResMan.registerDataBase(kDirectoryPath.generic_string());
+
+	// Index the overriding archive first, with a higher priority
+
+	Common::ChangeID overrideChange, baseChange;
+	ResMan.indexArchive("override.erf", 200, &overrideChange);
+	ResMan.indexArchive("base.erf", 100, &baseChange);
+
+	EXPECT_EQ(readResource(getResourceName(0)), 0x22222222);
+	EXPECT_EQ(readResource(getResourceName(kOverrideCount)), 0x11111111);
+
+	// Removing the lower-priority archive doesn't change the winner
+
+	ResMan.undo(baseChange);
+
+	EXPECT_EQ(readResource(getResourceName(0)), 0x22222222);
+	EXPECT_FALSE(ResMan.hasResource(getResourceName(kOverrideCount), Aurora::kFileTypeUTC));
+
+	// Blacklisting hides a resource
+
+	ResMan.blacklist(getResourceName(1), Aurora::kFileTypeUTC);
+
+	EXPECT_FALSE(ResMan.hasResource(getResourceName(1), Aurora::kFileTypeUTC));
+	EXPECT_TRUE(ResMan.hasResource(getResourceName(2), Aurora::kFileTypeUTC));
+
+	ResMan.undo(overrideChange);
+
+	EXPECT_FALSE(ResMan.hasResource(getResourceName(0), Aurora::kFileTypeUTC));
+}
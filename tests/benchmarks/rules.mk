@@ -0,0 +1,92 @@
+# xoreos - A reimplementation of BioWare's Aurora engine
+#
+# xoreos is the legal property of its developers, whose names
+# can be found in the AUTHORS file distributed with this source
+# distribution.
+#
+# xoreos is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 3
+# of the License, or (at your option) any later version.
+#
+# xoreos is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+
+# Micro-benchmarks. They run as unit tests with a small default workload;
+# set XOREOS_BENCHMARK_SCALE to scale them up.
+
+benchmarks_LIBS = \
+    $(test_LIBS) \
+    src/aurora/libaurora.la \
+    src/common/libcommon.la \
+    tests/version/libversion.la \
+    $(LDADD)
+
+noinst_HEADERS += \
+    tests/benchmarks/benchmark.h \
+    $(EMPTY)
+
+check_PROGRAMS                        += tests/benchmarks/bench_resman
+tests_benchmarks_bench_resman_SOURCES  = tests/benchmarks/resman.cpp
+tests_benchmarks_bench_resman_LDADD    = $(benchmarks_LIBS)
+tests_benchmarks_bench_resman_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                         += tests/benchmarks/bench_huffman
+tests_benchmarks_bench_huffman_SOURCES  = tests/benchmarks/huffman.cpp
+tests_benchmarks_bench_huffman_LDADD    = $(benchmarks_LIBS)
+tests_benchmarks_bench_huffman_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                           += tests/benchmarks/bench_bitstream
+tests_benchmarks_bench_bitstream_SOURCES  = tests/benchmarks/bitstream.cpp
+tests_benchmarks_bench_bitstream_LDADD    = $(benchmarks_LIBS)
+tests_benchmarks_bench_bitstream_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                       += tests/benchmarks/bench_astar
+tests_benchmarks_bench_astar_SOURCES  = tests/benchmarks/astar.cpp
+tests_benchmarks_bench_astar_LDADD    = $(engines_LIBS)
+tests_benchmarks_bench_astar_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                      += tests/benchmarks/bench_gff3
+tests_benchmarks_bench_gff3_SOURCES  = tests/benchmarks/gff3.cpp
+tests_benchmarks_bench_gff3_LDADD    = $(benchmarks_LIBS)
+tests_benchmarks_bench_gff3_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                          += tests/benchmarks/bench_nwscript
+tests_benchmarks_bench_nwscript_SOURCES  = tests/benchmarks/nwscript.cpp
+tests_benchmarks_bench_nwscript_LDADD    = $(benchmarks_LIBS)
+tests_benchmarks_bench_nwscript_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                           += tests/benchmarks/bench_animation
+tests_benchmarks_bench_animation_SOURCES  = tests/benchmarks/animation.cpp
+tests_benchmarks_bench_animation_LDADD    = $(benchmarks_LIBS)
+tests_benchmarks_bench_animation_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                             += tests/benchmarks/bench_renderqueue
+tests_benchmarks_bench_renderqueue_SOURCES  = tests/benchmarks/renderqueue.cpp
+tests_benchmarks_bench_renderqueue_LDADD    = $(benchmarks_LIBS)
+tests_benchmarks_bench_renderqueue_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                       += tests/benchmarks/bench_audio
+tests_benchmarks_bench_audio_SOURCES  = tests/benchmarks/audio.cpp
+tests_benchmarks_bench_audio_LDADD    = src/sound/libsound.la $(benchmarks_LIBS)
+tests_benchmarks_bench_audio_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                       += tests/benchmarks/bench_twoda
+tests_benchmarks_bench_twoda_SOURCES  = tests/benchmarks/twoda.cpp
+tests_benchmarks_bench_twoda_LDADD    = $(benchmarks_LIBS)
+tests_benchmarks_bench_twoda_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                          += tests/benchmarks/bench_walkmesh
+tests_benchmarks_bench_walkmesh_SOURCES  = tests/benchmarks/walkmesh.cpp
+tests_benchmarks_bench_walkmesh_LDADD    = $(engines_LIBS)
+tests_benchmarks_bench_walkmesh_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                              += tests/benchmarks/bench_spatialindex
+tests_benchmarks_bench_spatialindex_SOURCES  = tests/benchmarks/spatialindex.cpp
+tests_benchmarks_bench_spatialindex_LDADD    = $(engines_LIBS)
+tests_benchmarks_bench_spatialindex_CXXFLAGS = $(test_CXXFLAGS)
@@ -0,0 +1,245 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for proximity queries on the objects in an area.
+ */
+
+#include <list>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/aurora/nwscript/object.h"
+
+#include "src/engines/aurora/spatialindex.h"
+
+#include "tests/benchmarks/benchmark.h"
+
+static const size_t kObjectCount   = 5000;
+static const size_t kRegionCount   = 500;
+static const float  kAreaSize      = 500.0f;
+static const size_t kNearestCount  = 1000;
+static const size_t kRegionQueries = 100000;
+
+static const uint32_t kTypeCount    = 5;
+static const uint32_t kTypeCreature = 1U << 0;
+
+/** A simple object with a position, like the objects in an area. */
+struct AreaObject : public Aurora::NWScript::Object {
+	uint32_t type;
+	float x, y, z;
+
+	float minX, minY, maxX, maxY; ///< The rectangle a region covers.
+};
+
+/** The distance sort the script functions used to run over a list of all objects. */
+struct DistanceSort {
+	float x, y, z;
+
+	DistanceSort(float px, float py, float pz) : x(px), y(py), z(pz) { }
+
+	float getDistance(const AreaObject &o) const {
+		return (o.x - x) * (o.x - x) + (o.y - y) * (o.y - y) + (o.z - z) * (o.z - z);
+	}
+
+	bool operator()(const AreaObject *a, const AreaObject *b) const {
+		return getDistance(*a) < getDistance(*b);
+	}
+};
+
+static void createObjects(std::vector<AreaObject> &objects, uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> coordinate(0.0f, kAreaSize);
+	std::uniform_real_distribution<float> height(-2.0f, 2.0f);
+	std::uniform_real_distribution<float> extent(2.0f, 20.0f);
+	std::uniform_int_distribution<uint32_t> type(0, kTypeCount - 1);
+
+	for (AreaObject &o : objects) {
+		o.type = 1U << type(rng);
+
+		o.x = coordinate(rng);
+		o.y = coordinate(rng);
+		o.z = height(rng);
+
+		o.minX = o.x - extent(rng);
+		o.minY = o.y - extent(rng);
+		o.maxX = o.x + extent(rng);
+		o.maxY = o.y + extent(rng);
+	}
+}
+
+static void createPoints(std::vector<float> &points, size_t count, uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> coordinate(0.0f, kAreaSize);
+
+	points.resize(count * 2);
+	for (float &p : points)
+		p = coordinate(rng);
+}
+
+GTEST_TEST(SpatialIndexBenchmark, findNearest) {
+	std::vector<AreaObject> objects(kObjectCount);
+	createObjects(objects, 42);
+
+	Engines::SpatialIndex index;
+
+	Benchmark::Timer timer;
+	for (AreaObject &o : objects)
+		index.add(o, o.type, o.x, o.y, o.z);
+	Benchmark::report("add(), 5000 objects", timer.elapsed(), objects.size());
+
+	const size_t queries = Benchmark::scale(kNearestCount);
+
+	std::vector<float> points;
+	createPoints(points, queries, 23);
+
+	// The nth nearest creature, like GetNearestCreature()
+	std::vector<const Aurora::NWScript::Object *> listResults(queries);
+	std::vector<const Aurora::NWScript::Object *> gridResults(queries);
+
+	const size_t nth = 3;
+
+	timer.reset();
+	for (size_t i = 0; i < queries; i++) {
+		std::list<AreaObject *> found;
+		for (AreaObject &o : objects)
+			if (o.type & kTypeCreature)
+				found.push_back(&o);
+
+		found.sort(DistanceSort(points[i * 2 + 0], points[i * 2 + 1], 0.0f));
+
+		std::list<AreaObject *>::const_iterator it = found.begin();
+		for (size_t n = 1; (n < nth) && (it != found.end()); ++n)
+			++it;
+
+		listResults[i] = (it != found.end()) ? *it : 0;
+	}
+	Benchmark::report("nth nearest creature, sorting a list of all objects", timer.elapsed(), queries);
+
+	std::vector<Aurora::NWScript::Object *> nearest;
+
+	timer.reset();
+	for (size_t i = 0; i < queries; i++) {
+		index.findNearest(points[i * 2 + 0], points[i * 2 + 1], 0.0f, kTypeCreature, nth, nearest);
+
+		gridResults[i] = (nearest.size() == nth) ? nearest.back() : 0;
+	}
+	Benchmark::report("nth nearest creature, spatial index", timer.elapsed(), queries);
+
+	size_t mismatches = 0;
+	for (size_t i = 0; i < queries; i++)
+		mismatches += (listResults[i] != gridResults[i]) ? 1 : 0;
+
+	EXPECT_EQ(mismatches, 0);
+
+	// Nearest objects of any type within a radius, like a perception check
+	timer.reset();
+	size_t nearby = 0;
+	for (size_t i = 0; i < queries; i++) {
+		index.findNearest(points[i * 2 + 0], points[i * 2 + 1], 0.0f, Engines::SpatialIndex::kTypeAll, 16, nearest, 20.0f);
+
+		nearby += nearest.size();
+	}
+	Benchmark::report("16 nearest objects within 20 units, spatial index", timer.elapsed(), queries);
+
+	EXPECT_GT(nearby, 0);
+}
+
+GTEST_TEST(SpatialIndexBenchmark, findRegions) {
+	std::vector<AreaObject> regions(kRegionCount);
+	createObjects(regions, 7);
+
+	Engines::SpatialIndex index;
+	for (AreaObject &r : regions)
+		index.addRegion(r, r.type, r.x, r.y, r.z, r.minX, r.minY, r.maxX, r.maxY);
+
+	const size_t queries = Benchmark::scale(kRegionQueries);
+
+	std::vector<float> points;
+	createPoints(points, queries, 11);
+
+	// The first region containing a point, like evaluating triggers
+	std::vector<const Aurora::NWScript::Object *> listResults(queries);
+	std::vector<const Aurora::NWScript::Object *> gridResults(queries);
+
+	Benchmark::Timer timer;
+	for (size_t i = 0; i < queries; i++) {
+		const float x = points[i * 2 + 0];
+		const float y = points[i * 2 + 1];
+
+		listResults[i] = 0;
+		for (const AreaObject &r : regions) {
+			if ((x >= r.minX) && (x <= r.maxX) && (y >= r.minY) && (y <= r.maxY)) {
+				listResults[i] = &r;
+				break;
+			}
+		}
+	}
+	Benchmark::report("first region containing a point, testing all regions", timer.elapsed(), queries);
+
+	std::vector<Aurora::NWScript::Object *> found;
+
+	timer.reset();
+	for (size_t i = 0; i < queries; i++) {
+		index.findRegions(points[i * 2 + 0], points[i * 2 + 1], Engines::SpatialIndex::kTypeAll, found);
+
+		gridResults[i] = found.empty() ? 0 : found.front();
+	}
+	Benchmark::report("first region containing a point, spatial index", timer.elapsed(), queries);
+
+	size_t mismatches = 0, hits = 0;
+	for (size_t i = 0; i < queries; i++) {
+		mismatches += (listResults[i] != gridResults[i]) ? 1 : 0;
+		hits       += gridResults[i] ? 1 : 0;
+	}
+
+	EXPECT_EQ(mismatches, 0);
+	EXPECT_GT(hits, 0);
+}
+
+GTEST_TEST(SpatialIndexBenchmark, move) {
+	std::vector<AreaObject> objects(kObjectCount);
+	createObjects(objects, 42);
+
+	Engines::SpatialIndex index;
+	for (AreaObject &o : objects)
+		index.add(o, o.type, o.x, o.y, o.z);
+
+	// Every object takes a few steps, as if walking around for some frames
+	const size_t frames = Benchmark::scale(20);
+
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> step(-1.0f, 1.0f);
+
+	Benchmark::Timer timer;
+	for (size_t f = 0; f < frames; f++) {
+		for (AreaObject &o : objects) {
+			o.x += step(rng);
+			o.y += step(rng);
+
+			index.move(o, o.x, o.y, o.z);
+		}
+	}
+	Benchmark::report("move(), 5000 objects", timer.elapsed(), frames * objects.size());
+
+	EXPECT_EQ(index.size(), objects.size());
+}
@@ -0,0 +1,291 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for reading cells out of 2DA files.
+ */
+
+#include <vector>
+#include <memory>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/string.h"
+#include "src/common/strutil.h"
+#include "src/common/platform.h"
+#include "src/common/memreadstream.h"
+#include "src/common/writefile.h"
+
+#include "src/aurora/types.h"
+#include "src/aurora/2dafile.h"
+#include "src/aurora/2dareg.h"
+#include "src/aurora/resman.h"
+
+#include "tests/benchmarks/benchmark.h"
+
+static const size_t kRowCount    = 5000;
+static const size_t kColumnCount = 80;
+static const size_t kReadPasses  = 2;
+
+static const size_t kWarmupTableCount = 8;
+static const size_t kWarmupRowCount   = 500;
+
+/** The previous row layout: every cell a string, parsed again on each read. */
+class StringRow {
+public:
+	std::vector<Common::UString> data;
+
+	int32_t getInt(size_t column) const {
+		const Common::UString &cell = data[column];
+		if (cell.empty() || (cell == "****"))
+			return 0;
+
+		int32_t v = 0;
+
+		try {
+			Common::parseString(cell, v);
+		} catch (...) {
+		}
+
+		return v;
+	}
+};
+
+/** Create the cell of a synthetic 2DA: mostly ints, some floats, strings and empty cells. */
+static Common::UString createCell(size_t row, size_t column) {
+	const uint32_t value = (row * 2654435761U) ^ (column * 40503U);
+
+	switch (column % 8) {
+		case 0:
+		case 1:
+		case 2:
+		case 3:
+			return Common::String::format("%u", value % 1000);
+
+		case 4:
+			return Common::String::format("%u.%02u", value % 100, value % 97);
+
+		case 5:
+			return Common::String::format("Str%u", value % 50);
+
+		default:
+			return (value % 3) ? "****" : Common::String::format("%u", value % 10);
+	}
+}
+
+static Common::UString create2DA(std::vector<StringRow> &rows, size_t rowCount) {
+	rows.resize(rowCount);
+
+	Common::UString data = "2DA V2.0\n\n";
+	for (size_t j = 0; j < kColumnCount; j++)
+		data += Common::String::format(" Column%u", (uint) j);
+	data += "\n";
+
+	for (size_t i = 0; i < rowCount; i++) {
+		data += Common::composeString(i);
+
+		rows[i].data.resize(kColumnCount);
+		for (size_t j = 0; j < kColumnCount; j++) {
+			rows[i].data[j] = createCell(i, j);
+
+			data += " ";
+			data += rows[i].data[j];
+		}
+
+		data += "\n";
+	}
+
+	return data;
+}
+
+GTEST_TEST(TwoDABenchmark, getInt) {
+	std::vector<StringRow> stringRows;
+	const Common::UString data = create2DA(stringRows, kRowCount);
+
+	Benchmark::Timer timer;
+
+	Common::MemoryReadStream stream(data.c_str());
+	const Aurora::TwoDAFile twoda(stream);
+
+	Benchmark::report("load (5000x80 cells)", timer.elapsed(), kRowCount * kColumnCount);
+
+	ASSERT_EQ(twoda.getRowCount(), kRowCount);
+	ASSERT_EQ(twoda.getColumnCount(), kColumnCount);
+
+	const size_t passes = Benchmark::scale(kReadPasses);
+	const size_t reads  = passes * kRowCount * kColumnCount;
+
+	int64_t sumStrings = 0, sumColumns = 0, sumHeaders = 0;
+
+	timer.reset();
+	for (size_t p = 0; p < passes; p++)
+		for (size_t i = 0; i < kRowCount; i++)
+			for (size_t j = 0; j < kColumnCount; j++)
+				sumStrings += stringRows[i].getInt(j);
+	Benchmark::report("getInt, parsing strings", timer.elapsed(), reads);
+
+	// The first read of each column parses the whole column
+	timer.reset();
+	for (size_t i = 0; i < kRowCount; i++)
+		for (size_t j = 0; j < kColumnCount; j++)
+			sumColumns += twoda.getRow(i).getInt(j);
+	Benchmark::report("getInt, by column index, first pass", timer.elapsed(), kRowCount * kColumnCount);
+
+	timer.reset();
+	for (size_t p = 1; p < passes; p++)
+		for (size_t i = 0; i < kRowCount; i++)
+			for (size_t j = 0; j < kColumnCount; j++)
+				sumColumns += twoda.getRow(i).getInt(j);
+	Benchmark::report("getInt, by column index", timer.elapsed(), reads - kRowCount * kColumnCount);
+
+	const std::vector<Common::UString> &headers = twoda.getHeaders();
+
+	timer.reset();
+	for (size_t i = 0; i < kRowCount; i++)
+		for (size_t j = 0; j < kColumnCount; j++)
+			sumHeaders += twoda.getRow(i).getInt(headers[j]);
+	Benchmark::report("getInt, by column header", timer.elapsed(), kRowCount * kColumnCount);
+
+	EXPECT_EQ(sumColumns, sumStrings);
+	EXPECT_EQ(sumHeaders * (int64_t) passes, sumStrings);
+}
+
+/** The previous row lookup: scan all rows, comparing the cell strings. */
+static const Aurora::TwoDARow &scanRow(const Aurora::TwoDAFile &twoda, size_t column, const Common::UString &value) {
+	for (size_t i = 0; i < twoda.getRowCount(); i++)
+		if (twoda.getRow(i).getString(column).equalsIgnoreCase(value))
+			return twoda.getRow(i);
+
+	return twoda.getRow(Aurora::kFieldIDInvalid);
+}
+
+GTEST_TEST(TwoDABenchmark, getRowByLabel) {
+	const size_t rowCount = Benchmark::scale(kRowCount);
+
+	Common::UString data = "2DA V2.0\n\n Label Value\n";
+	std::vector<Common::UString> labels(rowCount);
+
+	for (size_t i = 0; i < rowCount; i++) {
+		labels[i] = Common::String::format("Label_%u", (uint) ((i * 2654435761U) % 1000003));
+
+		data += Common::String::format("%u %s %u\n", (uint) i, labels[i].c_str(), (uint) i);
+		labels[i].makeUpper();
+	}
+
+	Common::MemoryReadStream stream(data.c_str());
+	const Aurora::TwoDAFile twoda(stream);
+
+	ASSERT_EQ(twoda.getRowCount(), rowCount);
+
+	// The linear scan is slow, so only look up every 10th label with it
+	size_t scanErrors = 0;
+
+	Benchmark::Timer timer;
+	for (size_t i = 0; i < rowCount; i += 10)
+		if (scanRow(twoda, 0, labels[i]).getInt(1) != (int32_t) i)
+			scanErrors++;
+	Benchmark::report("getRow by label, scanning", timer.elapsed(), (rowCount + 9) / 10);
+
+	size_t indexErrors = 0;
+
+	timer.reset();
+	for (size_t i = 0; i < rowCount; i++)
+		if (twoda.getRow("Label", labels[i]).getInt("Value") != (int32_t) i)
+			indexErrors++;
+	Benchmark::report("getRow by label, indexed", timer.elapsed(), rowCount);
+
+	EXPECT_EQ(scanErrors, 0);
+	EXPECT_EQ(indexErrors, 0);
+}
+
+GTEST_TEST(TwoDABenchmark, registryWarmup) {
+	Common::Platform::init();
+
+	const boost::filesystem::path directory = boost::filesystem::temp_directory_path() /
+		boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+	boost::filesystem::create_directory(directory);
+
+	const size_t tableCount = Benchmark::scale(kWarmupTableCount);
+
+	std::vector<Common::UString> names(tableCount);
+	for (size_t i = 0; i < tableCount; i++) {
+		names[i] = Common::String::format("table%u", (uint) i);
+
+		std::vector<StringRow> rows;
+		const Common::UString data = create2DA(rows, kWarmupRowCount);
+
+		Common::WriteFile file((directory / (names[i] + ".2da").c_str()).generic_string());
+		file.write(data.c_str(), data.size());
+		file.close();
+	}
+
+	ResMan.clear();
+	ResMan.registerDataBase(directory.generic_string());
+	ResMan.indexResourceDir("", 0, 0, 100);
+
+	TwoDAReg.clear();
+
+	Benchmark::Timer timer;
+	for (size_t i = 0; i < tableCount; i++)
+		TwoDAReg.get2DA(names[i]);
+	Benchmark::report("TwoDARegistry::get2DA(), loading on first use", timer.elapsed(), tableCount);
+
+	TwoDAReg.clear();
+
+	timer.reset();
+	TwoDAReg.warmup(names);
+	Benchmark::report("TwoDARegistry::warmup()", timer.elapsed(), tableCount);
+
+	const Aurora::TwoDARegistry::Stats stats = TwoDAReg.getStats();
+
+	EXPECT_EQ(stats.twodas.size(), tableCount);
+	EXPECT_EQ(stats.failed, 0);
+
+	const size_t lookups = Benchmark::scale(1000000);
+
+	size_t errors = 0;
+
+	timer.reset();
+	for (size_t i = 0; i < lookups; i++)
+		if (TwoDAReg.get2DA(names[i % tableCount]).getRowCount() != kWarmupRowCount)
+			errors++;
+	Benchmark::report("TwoDARegistry::get2DA(), already loaded", timer.elapsed(), lookups);
+
+	EXPECT_EQ(errors, 0);
+
+	// Removed and reloaded tables are freed once nobody holds onto them anymore
+	std::weak_ptr<const Aurora::TwoDAFile> removed  = TwoDAReg.get2DAShared(names[0]);
+	std::weak_ptr<const Aurora::TwoDAFile> reloaded = TwoDAReg.get2DAShared(names[tableCount - 1]);
+
+	TwoDAReg.remove2DA(names[0]);
+	TwoDAReg.add2DA(names[tableCount - 1]);
+
+	EXPECT_TRUE(removed.expired());
+	EXPECT_TRUE(reloaded.expired());
+
+	TwoDAReg.clear();
+	ResMan.clear();
+
+	boost::filesystem::remove_all(directory);
+}
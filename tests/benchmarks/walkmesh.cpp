@@ -0,0 +1,220 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** @file
+ *  Benchmarks for finding faces in a walkmesh.
+ */
+
+#include <cfloat>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/aabbnode.h"
+
+#include "src/engines/aurora/pathfinding.h"
+
+#include "tests/benchmarks/benchmark.h"
+
+static const uint32_t kTileCount  = 16; ///< Tiles along each axis.
+static const uint32_t kTileCells  =  8; ///< Cells along each axis of a tile.
+static const float    kTileSize   = 10.0f;
+static const size_t   kQueryCount = 1000000;
+
+/** A synthetic walkmesh: a grid of tiles, each a grid of cells split into two triangles.
+ *
+ *  Like the NWN walkmeshes, each tile comes with its own AABB tree.
+ */
+class TilePathfinding : public Engines::Pathfinding {
+public:
+	TilePathfinding() : Engines::Pathfinding(std::vector<bool>({ false, true }), 3) {
+		_epsilon = 0.06f;
+
+		const uint32_t size = kTileCount * kTileCells;
+
+		_verticesCount = (size + 1) * (size + 1);
+		_vertices.resize(_verticesCount * 3);
+
+		for (uint32_t y = 0; y <= size; y++) {
+			for (uint32_t x = 0; x <= size; x++) {
+				const uint32_t vertex = x + y * (size + 1);
+
+				_vertices[vertex * 3 + 0] = x * (kTileSize / kTileCells);
+				_vertices[vertex * 3 + 1] = y * (kTileSize / kTileCells);
+				_vertices[vertex * 3 + 2] = ((x + y) % 3) * 0.1f;
+			}
+		}
+
+		for (uint32_t tileY = 0; tileY < kTileCount; tileY++) {
+			for (uint32_t tileX = 0; tileX < kTileCount; tileX++) {
+				const uint32_t firstFace = _faces.size() / 3;
+
+				for (uint32_t cellY = 0; cellY < kTileCells; cellY++) {
+					for (uint32_t cellX = 0; cellX < kTileCells; cellX++) {
+						const uint32_t x = tileX * kTileCells + cellX;
+						const uint32_t y = tileY * kTileCells + cellY;
+
+						const uint32_t v0 = x     + y       * (size + 1);
+						const uint32_t v1 = x + 1 + y       * (size + 1);
+						const uint32_t v2 = x + 1 + (y + 1) * (size + 1);
+						const uint32_t v3 = x     + (y + 1) * (size + 1);
+
+						addFace(v0, v1, v2);
+						addFace(v0, v2, v3);
+					}
+				}
+
+				_aabbTrees.push_back(createTree(firstFace, _faces.size() / 3));
+			}
+		}
+
+		_facesCount = _faces.size() / 3;
+		_adjFaces.resize(_faces.size(), UINT32_MAX);
+	}
+
+	uint32_t find(float x, float y) {
+		return findFace(x, y, true);
+	}
+
+	void flatten() {
+		buildBVH();
+	}
+
+private:
+	void addFace(uint32_t v0, uint32_t v1, uint32_t v2) {
+		_faces.push_back(v0);
+		_faces.push_back(v1);
+		_faces.push_back(v2);
+
+		// Every 16th face isn't walkable
+		_faceProperty.push_back(((_faceProperty.size() % 16) == 5) ? 0 : 1);
+	}
+
+	/** Create an AABB tree over these faces, halving the range of faces at each level. */
+	Common::AABBNode *createTree(uint32_t first, uint32_t last) {
+		float min[3], max[3];
+		for (int i = 0; i < 3; i++) {
+			min[i] =  FLT_MAX;
+			max[i] = -FLT_MAX;
+		}
+
+		for (uint32_t f = first; f < last; f++) {
+			for (uint32_t v = 0; v < 3; v++) {
+				const float *vertex = &_vertices[_faces[f * 3 + v] * 3];
+
+				for (int i = 0; i < 3; i++) {
+					min[i] = MIN(min[i], vertex[i]);
+					max[i] = MAX(max[i], vertex[i]);
+				}
+			}
+		}
+
+		if ((last - first) == 1)
+			return new Common::AABBNode(min, max, first);
+
+		const uint32_t middle = first + (last - first) / 2;
+
+		Common::AABBNode *node = new Common::AABBNode(min, max);
+		node->setChildren(createTree(first, middle), createTree(middle, last));
+
+		return node;
+	}
+};
+
+GTEST_TEST(WalkmeshBenchmark, findFace) {
+	TilePathfinding pathfinding;
+
+	const size_t queries = Benchmark::scale(kQueryCount);
+	const float  extent  = kTileCount * kTileSize;
+
+	// Random points, some of them a bit outside of the walkmesh
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> coordinate(-0.05f * extent, 1.05f * extent);
+
+	std::vector<float> points(queries * 2);
+	for (size_t i = 0; i < points.size(); i++)
+		points[i] = coordinate(rng);
+
+	std::vector<uint32_t> treeFaces(queries);
+
+	Benchmark::Timer timer;
+	for (size_t i = 0; i < queries; i++)
+		treeFaces[i] = pathfinding.find(points[i * 2 + 0], points[i * 2 + 1]);
+	Benchmark::report("findFace(), walking the AABB trees of each tile", timer.elapsed(), queries);
+
+	timer.reset();
+	pathfinding.flatten();
+	Benchmark::report("buildBVH()", timer.elapsed(), 1);
+
+	std::vector<uint32_t> bvhFaces(queries);
+
+	timer.reset();
+	for (size_t i = 0; i < queries; i++)
+		bvhFaces[i] = pathfinding.find(points[i * 2 + 0], points[i * 2 + 1]);
+	Benchmark::report("findFace(), flattened hierarchy", timer.elapsed(), queries);
+
+	size_t mismatches = 0, found = 0;
+	for (size_t i = 0; i < queries; i++) {
+		mismatches += (treeFaces[i] != bvhFaces[i]) ? 1 : 0;
+		found      += (bvhFaces[i] != UINT32_MAX) ? 1 : 0;
+	}
+
+	EXPECT_EQ(mismatches, 0);
+	EXPECT_GT(found, queries / 2);
+}
+
+GTEST_TEST(WalkmeshBenchmark, getHeight) {
+	TilePathfinding pathfinding;
+
+	const size_t queries = Benchmark::scale(kQueryCount / 10);
+	const float  extent  = kTileCount * kTileSize;
+
+	std::mt19937 rng(23);
+	std::uniform_real_distribution<float> coordinate(0.0f, extent);
+
+	std::vector<float> points(queries * 2);
+	for (size_t i = 0; i < points.size(); i++)
+		points[i] = coordinate(rng);
+
+	std::vector<float> treeHeights(queries);
+
+	Benchmark::Timer timer;
+	for (size_t i = 0; i < queries; i++)
+		treeHeights[i] = pathfinding.getHeight(points[i * 2 + 0], points[i * 2 + 1], true);
+	Benchmark::report("getHeight(), walking the AABB trees of each tile", timer.elapsed(), queries);
+
+	pathfinding.flatten();
+
+	std::vector<float> bvhHeights(queries);
+
+	timer.reset();
+	for (size_t i = 0; i < queries; i++)
+		bvhHeights[i] = pathfinding.getHeight(points[i * 2 + 0], points[i * 2 + 1], true);
+	Benchmark::report("getHeight(), flattened hierarchy", timer.elapsed(), queries);
+
+	size_t mismatches = 0;
+	for (size_t i = 0; i < queries; i++)
+		mismatches += (treeHeights[i] != bvhHeights[i]) ? 1 : 0;
+
+	EXPECT_EQ(mismatches, 0);
+}
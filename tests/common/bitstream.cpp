@@ -46,6 +46,85 @@ GTEST_TEST(BitStream, skip) {
 	EXPECT_EQ(bitStream.pos(), 0);
 }
 
+GTEST_TEST(BitStream, skipValues) {
+	static const byte data[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xAB, 0xCD, 0xEF };
+	Common::MemoryReadStream stream(data);
+	Common::BitStream8MSB bitStream(stream);
+
+	bitStream.skip(20);
+	EXPECT_EQ(bitStream.pos(), 20);
+	EXPECT_EQ(bitStream.getBits(8), 0x67);
+
+	bitStream.skip(16);
+	EXPECT_EQ(bitStream.pos(), 44);
+	EXPECT_EQ(bitStream.getBits(8), 0xBC);
+
+	EXPECT_THROW(bitStream.skip(13), Common::Exception);
+}
+
+GTEST_TEST(BitStream, peekBits8MSB) {
+	static const byte data[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xAB, 0xCD, 0xEF };
+	Common::MemoryReadStream stream(data);
+	Common::BitStream8MSB bitStream(stream);
+
+	EXPECT_EQ(bitStream.peekBits(12), 0x123);
+	EXPECT_EQ(bitStream.pos(), 0);
+
+	EXPECT_EQ(bitStream.getBits(4), 0x1);
+	EXPECT_EQ(bitStream.peekBits(12), 0x234);
+	EXPECT_EQ(bitStream.peekBits(32), 0x23456789);
+	EXPECT_EQ(bitStream.pos(), 4);
+	EXPECT_EQ(bitStream.getBits(12), 0x234);
+
+	bitStream.skip(40);
+	EXPECT_EQ(bitStream.peekBits(8), 0xEF);
+	EXPECT_EQ(bitStream.peekBits(12), 0xEF0);
+	EXPECT_EQ(bitStream.getBits(8), 0xEF);
+}
+
+GTEST_TEST(BitStream, peekBits8LSB) {
+	static const byte data[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xAB, 0xCD, 0xEF };
+	Common::MemoryReadStream stream(data);
+	Common::BitStream8LSB bitStream(stream);
+
+	EXPECT_EQ(bitStream.peekBits(12), 0x412);
+	EXPECT_EQ(bitStream.pos(), 0);
+
+	EXPECT_EQ(bitStream.getBits(4), 0x2);
+	EXPECT_EQ(bitStream.peekBits(12), 0x341);
+	EXPECT_EQ(bitStream.getBits(12), 0x341);
+
+	bitStream.skip(40);
+	EXPECT_EQ(bitStream.peekBits(12), 0x0EF);
+	EXPECT_EQ(bitStream.getBits(8), 0xEF);
+}
+
+GTEST_TEST(BitStream, peekBits32LELSB) {
+	static const byte data[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xAB, 0xCD, 0xEF };
+	Common::MemoryReadStream stream(data);
+	Common::BitStream32LELSB bitStream(stream);
+
+	EXPECT_EQ(bitStream.peekBits(12), 0x412);
+
+	bitStream.skip(28);
+	EXPECT_EQ(bitStream.peekBits(12), 0x907);
+	EXPECT_EQ(bitStream.pos(), 28);
+	EXPECT_EQ(bitStream.getBits(12), 0x907);
+}
+
+GTEST_TEST(BitStream, peekBits32BEMSB) {
+	static const byte data[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xAB, 0xCD, 0xEF };
+	Common::MemoryReadStream stream(data);
+	Common::BitStream32BEMSB bitStream(stream);
+
+	EXPECT_EQ(bitStream.peekBits(12), 0x123);
+
+	bitStream.skip(28);
+	EXPECT_EQ(bitStream.peekBits(12), 0x890);
+	EXPECT_EQ(bitStream.pos(), 28);
+	EXPECT_EQ(bitStream.getBits(12), 0x890);
+}
+
 static void readBitStream(Common::BitStream &bitStream, byte (&data)[11]) {
 	for (size_t i = 0; i < 8; i++)
 		data[i] = bitStream.getBit();
@@ -192,3 +271,122 @@ GTEST_TEST(BitStream, BitStream64BELSB) {
 
 	testBitStream(bitStream, compValues);
 }
+
+/** Read the same data through a BitStreamImpl and a BufferedBitStreamImpl and compare the results. */
+template<class Plain, class Buffered>
+static void compareBufferedBitStream(Common::SeekableReadStream &plainStream,
+                                     Common::SeekableReadStream &bufferedStream) {
+
+	Plain    plain(plainStream);
+	Buffered buffered(bufferedStream);
+
+	ASSERT_EQ(buffered.size(), plain.size());
+	ASSERT_EQ(buffered.pos() , plain.pos());
+
+	size_t n = 0;
+	while ((plain.size() - plain.pos()) >= 64) {
+		n = (n * 7 + 5) % 33;
+
+		EXPECT_EQ(buffered.peekBits(32), plain.peekBits(32)) << "At bit " << plain.pos();
+
+		if ((n % 5) == 0) {
+			plain.skip(n);
+			buffered.skip(n);
+		} else
+			EXPECT_EQ(buffered.getBits(n), plain.getBits(n)) << "At bit " << plain.pos();
+
+		EXPECT_EQ(buffered.pos(), plain.pos());
+	}
+
+	buffered.skip(buffered.size() - buffered.pos() - 3);
+	EXPECT_EQ(buffered.peekBits(8) & (buffered.isMSBFirst() ? 0x1F : 0xF8), 0);
+	EXPECT_THROW(buffered.getBits(4), Common::Exception);
+
+	buffered.getBits(3);
+	EXPECT_TRUE(buffered.eos());
+
+	buffered.rewind();
+	EXPECT_EQ(buffered.pos(), 0);
+}
+
+template<class Plain, class Buffered>
+static void compareBufferedBitStream() {
+	static byte data[1027];
+	for (size_t i = 0; i < ARRAYSIZE(data); i++)
+		data[i] = (byte) ((i * 0x9E3779B1) >> 13);
+
+	// Directly out of the memory
+	{
+		Common::MemoryReadStream plainStream(data), bufferedStream(data);
+
+		compareBufferedBitStream<Plain, Buffered>(plainStream, bufferedStream);
+	}
+
+	// Buffered copy of a stream that isn't in memory, starting in the middle
+	{
+		Common::MemoryReadStream plainData(data), bufferedData(data);
+		Common::SeekableSubReadStream plainStream(&plainData, 0, ARRAYSIZE(data));
+		Common::SeekableSubReadStream bufferedStream(&bufferedData, 0, ARRAYSIZE(data));
+
+		plainStream.seek(16);
+		bufferedStream.seek(16);
+
+		compareBufferedBitStream<Plain, Buffered>(plainStream, bufferedStream);
+	}
+}
+
+GTEST_TEST(BitStream, BufferedBitStream8MSB) {
+	compareBufferedBitStream<Common::BitStream8MSB, Common::BufferedBitStream8MSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream8LSB) {
+	compareBufferedBitStream<Common::BitStream8LSB, Common::BufferedBitStream8LSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream16LEMSB) {
+	compareBufferedBitStream<Common::BitStream16LEMSB, Common::BufferedBitStream16LEMSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream16LELSB) {
+	compareBufferedBitStream<Common::BitStream16LELSB, Common::BufferedBitStream16LELSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream16BEMSB) {
+	compareBufferedBitStream<Common::BitStream16BEMSB, Common::BufferedBitStream16BEMSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream16BELSB) {
+	compareBufferedBitStream<Common::BitStream16BELSB, Common::BufferedBitStream16BELSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream32LEMSB) {
+	compareBufferedBitStream<Common::BitStream32LEMSB, Common::BufferedBitStream32LEMSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream32LELSB) {
+	compareBufferedBitStream<Common::BitStream32LELSB, Common::BufferedBitStream32LELSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream32BEMSB) {
+	compareBufferedBitStream<Common::BitStream32BEMSB, Common::BufferedBitStream32BEMSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream32BELSB) {
+	compareBufferedBitStream<Common::BitStream32BELSB, Common::BufferedBitStream32BELSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream64LEMSB) {
+	compareBufferedBitStream<Common::BitStream64LEMSB, Common::BufferedBitStream64LEMSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream64LELSB) {
+	compareBufferedBitStream<Common::BitStream64LELSB, Common::BufferedBitStream64LELSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream64BEMSB) {
+	compareBufferedBitStream<Common::BitStream64BEMSB, Common::BufferedBitStream64BEMSB>();
+}
+
+GTEST_TEST(BitStream, BufferedBitStream64BELSB) {
+	compareBufferedBitStream<Common::BitStream64BELSB, Common::BufferedBitStream64BELSB>();
+}
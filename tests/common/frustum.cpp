@@ -0,0 +1,163 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the Frustum class.
+ */
+
+#include "external/glm/gtc/matrix_transform.hpp"
+
+#include "gtest/gtest.h"
+
+#include "src/common/frustum.h"
+#include "src/common/boundingbox.h"
+#include "src/common/maths.h"
+
+/** A camera at (0, 0, 0), looking down the negative z axis, with a 90° field of view. */
+static Common::Frustum createFrustum() {
+	const glm::mat4 projection = glm::perspective(Common::deg2rad(90.0f), 1.0f, 1.0f, 100.0f);
+
+	return Common::Frustum(projection, glm::mat4());
+}
+
+GTEST_TEST(Frustum, identity) {
+	const Common::Frustum f;
+
+	EXPECT_TRUE(f.isIn(0.0f, 0.0f, 0.0f));
+	EXPECT_TRUE(f.isIn(0.9f, -0.9f, 0.9f));
+
+	EXPECT_FALSE(f.isIn( 1.1f,  0.0f,  0.0f));
+	EXPECT_FALSE(f.isIn( 0.0f, -1.1f,  0.0f));
+	EXPECT_FALSE(f.isIn( 0.0f,  0.0f,  1.1f));
+}
+
+GTEST_TEST(Frustum, planes) {
+	const Common::Frustum f = createFrustum();
+
+	const glm::vec4 &nearPlane = f.getPlane(Common::Frustum::kPlaneNear);
+	EXPECT_NEAR(nearPlane.x,  0.0f, 0.0001f);
+	EXPECT_NEAR(nearPlane.y,  0.0f, 0.0001f);
+	EXPECT_NEAR(nearPlane.z, -1.0f, 0.0001f);
+	EXPECT_NEAR(nearPlane.w, -1.0f, 0.0001f);
+
+	const glm::vec4 &farPlane = f.getPlane(Common::Frustum::kPlaneFar);
+	EXPECT_NEAR(farPlane.x,    0.0f, 0.0001f);
+	EXPECT_NEAR(farPlane.y,    0.0f, 0.0001f);
+	EXPECT_NEAR(farPlane.z,    1.0f, 0.0001f);
+	EXPECT_NEAR(farPlane.w,  100.0f, 0.01f);
+
+	const glm::vec4 &leftPlane = f.getPlane(Common::Frustum::kPlaneLeft);
+	EXPECT_NEAR(leftPlane.x,  0.70710678f, 0.0001f);
+	EXPECT_NEAR(leftPlane.y,  0.0f       , 0.0001f);
+	EXPECT_NEAR(leftPlane.z, -0.70710678f, 0.0001f);
+	EXPECT_NEAR(leftPlane.w,  0.0f       , 0.0001f);
+}
+
+GTEST_TEST(Frustum, isInPoint) {
+	const Common::Frustum f = createFrustum();
+
+	EXPECT_TRUE(f.isIn(0.0f, 0.0f, -10.0f));
+	EXPECT_TRUE(f.isIn(9.0f, -9.0f, -10.0f));
+
+	// Behind the camera, in front of the near plane and beyond the far plane
+	EXPECT_FALSE(f.isIn(0.0f, 0.0f,  10.0f));
+	EXPECT_FALSE(f.isIn(0.0f, 0.0f,  -0.5f));
+	EXPECT_FALSE(f.isIn(0.0f, 0.0f, -101.0f));
+
+	// Outside of the sides
+	EXPECT_FALSE(f.isIn(-11.0f,   0.0f, -10.0f));
+	EXPECT_FALSE(f.isIn( 11.0f,   0.0f, -10.0f));
+	EXPECT_FALSE(f.isIn(  0.0f, -11.0f, -10.0f));
+	EXPECT_FALSE(f.isIn(  0.0f,  11.0f, -10.0f));
+}
+
+GTEST_TEST(Frustum, isInSphere) {
+	const Common::Frustum f = createFrustum();
+
+	EXPECT_TRUE(f.isIn(0.0f, 0.0f, -10.0f, 1.0f));
+
+	// Center outside, but reaching inside
+	EXPECT_TRUE (f.isIn(12.0f, 0.0f, -10.0f, 2.0f));
+	EXPECT_FALSE(f.isIn(12.0f, 0.0f, -10.0f, 1.0f));
+
+	EXPECT_TRUE (f.isIn(0.0f, 0.0f, 2.0f, 3.5f));
+	EXPECT_FALSE(f.isIn(0.0f, 0.0f, 2.0f, 2.5f));
+}
+
+GTEST_TEST(Frustum, isInBox) {
+	const Common::Frustum f = createFrustum();
+
+	EXPECT_TRUE(f.isIn(-1.0f, -1.0f, -11.0f, 1.0f, 1.0f, -9.0f));
+
+	// Straddling a plane
+	EXPECT_TRUE(f.isIn( 9.0f, -1.0f, -11.0f, 20.0f, 1.0f, -9.0f));
+	EXPECT_TRUE(f.isIn(-1.0f, -1.0f, -10.0f,  1.0f, 1.0f, 10.0f));
+	EXPECT_TRUE(f.isIn(-1.0f, -1.0f, -200.0f, 1.0f, 1.0f, -99.0f));
+
+	// Containing the whole frustum
+	EXPECT_TRUE(f.isIn(-1000.0f, -1000.0f, -1000.0f, 1000.0f, 1000.0f, 1000.0f));
+
+	// Completely outside
+	EXPECT_FALSE(f.isIn(11.0f, -1.0f, -10.0f, 20.0f, 1.0f, -9.0f));
+	EXPECT_FALSE(f.isIn(-1.0f, -1.0f,   1.0f,  1.0f, 1.0f,  2.0f));
+	EXPECT_FALSE(f.isIn(-1.0f, -1.0f, -200.0f, 1.0f, 1.0f, -101.0f));
+}
+
+GTEST_TEST(Frustum, isInBoundingBox) {
+	const Common::Frustum f = createFrustum();
+
+	Common::BoundingBox empty;
+	EXPECT_FALSE(f.isIn(empty));
+
+	Common::BoundingBox box;
+	box.add(-1.0f, -1.0f, -1.0f);
+	box.add( 1.0f,  1.0f,  1.0f);
+
+	Common::BoundingBox visible = box;
+	visible.translate(0.0f, 0.0f, -10.0f);
+	visible.absolutize();
+
+	EXPECT_TRUE(f.isIn(visible));
+
+	Common::BoundingBox behind = box;
+	behind.translate(0.0f, 0.0f, 10.0f);
+	behind.absolutize();
+
+	EXPECT_FALSE(f.isIn(behind));
+}
+
+GTEST_TEST(Frustum, camera) {
+	/* A camera the way the GraphicsManager sets it up: positioned at (10, 20, 5),
+	 * pitched up by 90° so that it looks along the positive y axis. */
+
+	glm::mat4 modelview;
+	modelview = glm::rotate(modelview, Common::deg2rad(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+	modelview = glm::translate(modelview, glm::vec3(-10.0f, -20.0f, -5.0f));
+
+	const glm::mat4 projection = glm::perspective(Common::deg2rad(90.0f), 1.0f, 1.0f, 100.0f);
+
+	const Common::Frustum f(projection, modelview);
+
+	EXPECT_TRUE (f.isIn(10.0f,  30.0f,  5.0f));
+	EXPECT_TRUE (f.isIn(15.0f,  30.0f,  9.0f));
+	EXPECT_FALSE(f.isIn(10.0f,  10.0f,  5.0f));
+	EXPECT_FALSE(f.isIn(10.0f, 130.0f,  5.0f));
+	EXPECT_FALSE(f.isIn(10.0f,  30.0f, 20.0f));
+}
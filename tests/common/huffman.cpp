@@ -28,7 +28,9 @@
 #include "src/common/error.h"
 #include "src/common/util.h"
 #include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
 #include "src/common/bitstream.h"
+#include "src/common/bitstreamwriter.h"
 
 static const uint32_t kCodes  [] = {  0,   4,   5,   6,   7  };
 static const uint8_t  kLengths[] = {  1,   3,   3,   3,   3  };
@@ -120,3 +122,72 @@ GTEST_TEST(Huffman, invalidSymbol) {
 
 	EXPECT_THROW(huffman.getSymbol(bitStream), Common::Exception);
 }
+
+GTEST_TEST(Huffman, getSymbolLSB) {
+	// The same data as kHuffmanData, with the bits in each byte reversed
+	static const byte kHuffmanDataLSB[] = { 0xA2, 0xE6 };
+
+	Common::MemoryReadStream byteStream(kHuffmanDataLSB);
+	Common::BitStream8LSB    bitStream (byteStream);
+
+	// When reading LSB first, the first bit read ends up in the LSB of the code
+	static const uint32_t kCodesLSB[] = { 0, 1, 5, 3, 7 };
+
+	Common::Huffman huffman(kMaxLength, ARRAYSIZE(kCodesLSB), kCodesLSB, kLengths, kSymbols);
+
+	for (size_t i = 0; i < ARRAYSIZE(kDeHuffmanDataSymbols); i++)
+		EXPECT_EQ(huffman.getSymbol(bitStream), kDeHuffmanDataSymbols[i]) << "At index " << i;
+}
+
+template<class BitStreamWriter, class BitStream>
+static void testLongCodes(bool msbFirst) {
+	/* Codes of the lengths 1 to 20, "0", "10", "110", ..., making sure
+	 * that we need several levels of lookup tables. */
+
+	static const size_t kLongCodeCount = 21;
+
+	uint32_t codes  [kLongCodeCount];
+	uint8_t  lengths[kLongCodeCount];
+
+	for (size_t i = 0; i < kLongCodeCount; i++) {
+		lengths[i] = MIN<size_t>(i + 1, kLongCodeCount - 1);
+		codes  [i] = ((1U << lengths[i]) - 1) & ~((i == (kLongCodeCount - 1)) ? 0U : 1U);
+
+		// When reading LSB first, the first bit read ends up in the LSB of the code
+		if (!msbFirst) {
+			uint32_t reversed = 0;
+			for (size_t j = 0; j < lengths[i]; j++)
+				reversed |= ((codes[i] >> j) & 1) << (lengths[i] - 1 - j);
+
+			codes[i] = reversed;
+		}
+	}
+
+	static const uint32_t kSequence[] = { 0, 20, 1, 19, 2, 18, 9, 10, 11, 8, 0, 0, 15, 3 };
+
+	Common::MemoryWriteStreamDynamic writeStream(true);
+	BitStreamWriter bitWriter(writeStream);
+
+	for (size_t i = 0; i < ARRAYSIZE(kSequence); i++)
+		bitWriter.putBits(codes[kSequence[i]], lengths[kSequence[i]]);
+
+	bitWriter.flush();
+
+	Common::MemoryReadStream readStream(writeStream.getData(), writeStream.size());
+	BitStream bitStream(readStream);
+
+	Common::Huffman huffman(0, kLongCodeCount, codes, lengths, 0);
+
+	for (size_t i = 0; i < ARRAYSIZE(kSequence); i++)
+		EXPECT_EQ(huffman.getSymbol(bitStream), kSequence[i]) << "At index " << i;
+}
+
+GTEST_TEST(Huffman, longCodesMSB) {
+	testLongCodes<Common::BitStreamWriter8MSB, Common::BitStream8MSB>(true);
+	testLongCodes<Common::BitStreamWriter32BEMSB, Common::BitStream32BEMSB>(true);
+}
+
+GTEST_TEST(Huffman, longCodesLSB) {
+	testLongCodes<Common::BitStreamWriter8LSB, Common::BitStream8LSB>(false);
+	testLongCodes<Common::BitStreamWriter32LELSB, Common::BitStream32LELSB>(false);
+}
@@ -0,0 +1,146 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** @file
+ *  Unit tests for the flattened bounding volume hierarchy.
+ */
+
+#include <vector>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/aabbnode.h"
+#include "src/common/linearbvh.h"
+
+/** Create a leaf covering [x, x + 1] x [y, y + 1] x [z, z]. */
+static Common::AABBNode *createLeaf(float x, float y, float z, int32_t property) {
+	float min[] = {x       , y       , z};
+	float max[] = {x + 1.0f, y + 1.0f, z};
+
+	return new Common::AABBNode(min, max, property);
+}
+
+/** Create a tree over the unit squares [first, first + count) along the x axis.
+ *
+ *  The squares' properties are their x position plus the base.
+ */
+static Common::AABBNode *createRow(float z, int32_t base, int32_t first, int32_t count) {
+	if (count == 1)
+		return createLeaf(first, 0.0f, z, base + first);
+
+	const int32_t leftCount = count / 2;
+
+	float min[] = {(float) first          , 0.0f, z};
+	float max[] = {(float) (first + count), 1.0f, z};
+
+	Common::AABBNode *node = new Common::AABBNode(min, max);
+	node->setChildren(createRow(z, base, first, leftCount), createRow(z, base, first + leftCount, count - leftCount));
+
+	return node;
+}
+
+static bool acceptAll(uint32_t UNUSED(property)) {
+	return true;
+}
+
+GTEST_TEST(LinearBVH, empty) {
+	Common::LinearBVH bvh;
+
+	EXPECT_TRUE(bvh.empty());
+	EXPECT_EQ(bvh.findPoint(0.5f, 0.5f, acceptAll), UINT32_MAX);
+
+	bvh.build(std::vector<Common::AABBNode *>(2, nullptr));
+
+	EXPECT_TRUE(bvh.empty());
+	EXPECT_EQ(bvh.getLeafCount(), 0);
+	EXPECT_EQ(bvh.findSegment(0.5f, 0.5f, 1.0f, 0.5f, 0.5f, -1.0f, acceptAll), UINT32_MAX);
+}
+
+GTEST_TEST(LinearBVH, findPoint) {
+	std::unique_ptr<Common::AABBNode> tree(createRow(0.0f, 0, 0, 100));
+
+	Common::LinearBVH bvh;
+	bvh.build(std::vector<Common::AABBNode *>(1, tree.get()));
+
+	ASSERT_EQ(bvh.getLeafCount(), 100);
+	EXPECT_GT(bvh.getNodeCount(), 1);
+
+	for (size_t i = 0; i < 100; i++)
+		EXPECT_EQ(bvh.findPoint(i + 0.5f, 0.5f, acceptAll), i) << "At index " << i;
+
+	EXPECT_EQ(bvh.findPoint(  -0.5f, 0.5f, acceptAll), UINT32_MAX);
+	EXPECT_EQ(bvh.findPoint(100.5f, 0.5f, acceptAll), UINT32_MAX);
+	EXPECT_EQ(bvh.findPoint(  50.5f, 1.5f, acceptAll), UINT32_MAX);
+
+	// Only rejected candidates
+	EXPECT_EQ(bvh.findPoint(50.5f, 0.5f, [](uint32_t p) { return p != 50; }), UINT32_MAX);
+}
+
+GTEST_TEST(LinearBVH, findPointOrder) {
+	// Two overlapping layers, the upper one in the second tree
+	std::vector<Common::AABBNode *> trees;
+	trees.push_back(createRow(0.0f,   0, 0, 20));
+	trees.push_back(createRow(5.0f, 100, 0, 20));
+
+	Common::LinearBVH bvh;
+	bvh.build(trees);
+
+	ASSERT_EQ(bvh.getLeafCount(), 40);
+
+	// Leaves are found in the order of the trees, like when walking the trees one by one
+	EXPECT_EQ(bvh.findPoint(3.5f, 0.5f, acceptAll), 3);
+	EXPECT_EQ(bvh.findPoint(3.5f, 0.5f, [](uint32_t p) { return p >= 100; }), 103);
+
+	// Points on the shared edge of two leaves are in both; the earlier one wins
+	EXPECT_EQ(bvh.findPoint(4.0f, 0.5f, acceptAll), 3);
+	EXPECT_EQ(bvh.findPoint(4.0f, 0.5f, [](uint32_t p) { return p != 3; }), 4);
+
+	for (std::vector<Common::AABBNode *>::iterator t = trees.begin(); t != trees.end(); ++t)
+		delete *t;
+}
+
+GTEST_TEST(LinearBVH, findSegment) {
+	std::vector<Common::AABBNode *> trees;
+	trees.push_back(createRow(0.0f,   0, 0, 20));
+	trees.push_back(createRow(5.0f, 100, 0, 20));
+
+	Common::LinearBVH bvh;
+	bvh.build(trees);
+
+	// Vertical segments, going through both layers
+	EXPECT_EQ(bvh.findSegment(7.5f, 0.5f, 10.0f, 7.5f, 0.5f, -10.0f, acceptAll), 7);
+	EXPECT_EQ(bvh.findSegment(7.5f, 0.5f, 10.0f, 7.5f, 0.5f,   2.0f, acceptAll), 107);
+	EXPECT_EQ(bvh.findSegment(7.5f, 0.5f,  2.0f, 7.5f, 0.5f,   3.0f, acceptAll), UINT32_MAX);
+	EXPECT_EQ(bvh.findSegment(7.5f, 1.5f, 10.0f, 7.5f, 1.5f, -10.0f, acceptAll), UINT32_MAX);
+
+	// A slanted segment, crossing the lower layer between x = 12 and x = 14
+	EXPECT_EQ(bvh.findSegment(10.5f, 0.5f, 2.0f, 14.5f, 0.5f, -2.0f, [](uint32_t p) { return p < 100; }), 12);
+	EXPECT_EQ(bvh.findSegment(10.5f, 0.5f, 2.0f, 14.5f, 0.5f, -2.0f, [](uint32_t p) { return p != 12; }), UINT32_MAX);
+
+	// A segment parallel to the layers, within the upper one
+	EXPECT_EQ(bvh.findSegment(-5.0f, 0.5f, 5.0f, 30.0f, 0.5f, 5.0f, acceptAll), 100);
+	EXPECT_EQ(bvh.findSegment(-5.0f, 0.5f, 4.0f, 30.0f, 0.5f, 4.0f, acceptAll), UINT32_MAX);
+
+	for (std::vector<Common::AABBNode *>::iterator t = trees.begin(); t != trees.end(); ++t)
+		delete *t;
+}
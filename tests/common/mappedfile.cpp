@@ -0,0 +1,143 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/** @file
+ *  Unit tests for our memory-mapped file read stream.
+ */
+
+#include <memory>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/platform.h"
+#include "src/common/memreadstream.h"
+#include "src/common/mappedfile.h"
+
+static const byte kData[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xAB, 0xCD, 0xEF };
+
+boost::filesystem::path kFilePath;
+
+class MappedFile : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kFilePath = tmpPath / uniquePath;
+
+		boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+
+		testFile.write(reinterpret_cast<const char *>(kData), ARRAYSIZE(kData));
+		testFile.close();
+	}
+
+	static void TearDownTestCase() {
+		if (!kFilePath.empty())
+			boost::filesystem::remove(kFilePath);
+	}
+};
+
+GTEST_TEST_F(MappedFile, map) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	Common::MappedFile file;
+	ASSERT_TRUE(file.open(kFilePath.generic_string()));
+	ASSERT_TRUE(file.isOpen());
+
+	ASSERT_EQ(file.getSize(), ARRAYSIZE(kData));
+
+	for (size_t i = 0; i < ARRAYSIZE(kData); i++)
+		EXPECT_EQ(file.getData()[i], kData[i]) << "At index " << i;
+
+	file.close();
+	EXPECT_FALSE(file.isOpen());
+}
+
+GTEST_TEST_F(MappedFile, mapMissing) {
+	Common::MappedFile file;
+	EXPECT_FALSE(file.open((kFilePath.generic_string() + ".missing").c_str()));
+	EXPECT_FALSE(file.isOpen());
+
+	EXPECT_THROW(Common::MappedReadStream stream((kFilePath.generic_string() + ".missing").c_str()), Common::Exception);
+}
+
+GTEST_TEST_F(MappedFile, read) {
+	Common::MappedReadStream stream(kFilePath.generic_string());
+
+	ASSERT_EQ(stream.size(), ARRAYSIZE(kData));
+
+	EXPECT_EQ(stream.readUint32BE(), 0x12345678);
+	EXPECT_EQ(stream.readUint32LE(), 0xEFCDAB90);
+	EXPECT_EQ(stream.pos(), stream.size());
+}
+
+GTEST_TEST_F(MappedFile, view) {
+	Common::MappedReadStream stream(kFilePath.generic_string());
+
+	std::unique_ptr<Common::MappedReadStream> view1(stream.getView(2, 6));
+	std::unique_ptr<Common::MappedReadStream> view2(stream.getView(4, 8));
+
+	ASSERT_EQ(view1->size(), 4);
+	ASSERT_EQ(view2->size(), 4);
+
+	// The views point directly into the mapping
+	EXPECT_EQ(view1->getData(), stream.getData() + 2);
+	EXPECT_EQ(view2->getData(), stream.getData() + 4);
+
+	// Each view has its own position
+	EXPECT_EQ(view1->readUint16BE(), 0x5678);
+	EXPECT_EQ(view2->readUint16BE(), 0x90AB);
+	EXPECT_EQ(view1->readUint16BE(), 0x90AB);
+	EXPECT_EQ(view2->readUint16BE(), 0xCDEF);
+
+	EXPECT_EQ(stream.pos(), 0);
+
+	EXPECT_THROW(stream.getView(6, 2), Common::Exception);
+	EXPECT_THROW(stream.getView(0, 9), Common::Exception);
+}
+
+GTEST_TEST_F(MappedFile, viewOutlivesStream) {
+	std::unique_ptr<Common::MappedReadStream> view;
+
+	{
+		Common::MappedReadStream stream(kFilePath.generic_string());
+
+		view.reset(stream.getView(4, 8));
+	}
+
+	EXPECT_EQ(view->readUint32BE(), 0x90ABCDEF);
+}
+
+GTEST_TEST_F(MappedFile, createView) {
+	Common::MappedReadStream mapped(kFilePath.generic_string());
+	Common::MemoryReadStream memory(kData);
+
+	std::unique_ptr<Common::MappedReadStream> view(Common::MappedReadStream::createView(mapped, 0, 4));
+	ASSERT_TRUE(view);
+	EXPECT_EQ(view->readUint32BE(), 0x12345678);
+
+	EXPECT_EQ(Common::MappedReadStream::createView(memory, 0, 4), static_cast<Common::MappedReadStream *>(0));
+}
@@ -70,6 +70,11 @@ tests_common_test_readfile_SOURCES  = tests/common/readfile.cpp
 tests_common_test_readfile_LDADD    = $(common_LIBS)
 tests_common_test_readfile_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                       += tests/common/test_mappedfile
+tests_common_test_mappedfile_SOURCES  = tests/common/mappedfile.cpp
+tests_common_test_mappedfile_LDADD    = $(common_LIBS)
+tests_common_test_mappedfile_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                      += tests/common/test_writefile
 tests_common_test_writefile_SOURCES  = tests/common/writefile.cpp
 tests_common_test_writefile_LDADD    = $(common_LIBS)
@@ -226,6 +231,11 @@ tests_common_test_boundingbox_SOURCES  = tests/common/boundingbox.cpp
 tests_common_test_boundingbox_LDADD    = $(common_LIBS)
 tests_common_test_boundingbox_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                    += tests/common/test_frustum
+tests_common_test_frustum_SOURCES  = tests/common/frustum.cpp
+tests_common_test_frustum_LDADD    = $(common_LIBS)
+tests_common_test_frustum_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                 += tests/common/test_rect
 tests_common_test_rect_SOURCES  = tests/common/rect.cpp
 tests_common_test_rect_LDADD    = $(common_LIBS)
@@ -241,6 +251,11 @@ tests_common_test_aabbnode_SOURCES  = tests/common/aabbnode.cpp
 tests_common_test_aabbnode_LDADD    = $(common_LIBS)
 tests_common_test_aabbnode_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                      += tests/common/test_linearbvh
+tests_common_test_linearbvh_SOURCES  = tests/common/linearbvh.cpp
+tests_common_test_linearbvh_LDADD    = $(common_LIBS)
+tests_common_test_linearbvh_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                                += tests/common/test_serializationstream
 tests_common_test_serializationstream_SOURCES  = tests/common/serializationstream.cpp
 tests_common_test_serializationstream_LDADD    = $(common_LIBS)
@@ -0,0 +1,104 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for KotOR objects moving within their area.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/system.h"
+
+#include "src/aurora/nwscript/object.h"
+
+#include "src/engines/aurora/spatialindex.h"
+
+#include "src/engines/kotorbase/types.h"
+#include "src/engines/kotorbase/creature.h"
+
+/** A bare creature, without any models to load. */
+class TestCreature : public Engines::KotORBase::Creature {
+protected:
+	void getPartModelsPC(PartModels &UNUSED(parts), uint32_t UNUSED(state), uint8_t UNUSED(textureVariation)) {
+	}
+};
+
+static void addCreature(Engines::SpatialIndex &index, Engines::KotORBase::Creature &creature,
+                        float x, float y, float z) {
+
+	creature.setPosition(x, y, z);
+
+	index.add(creature, Engines::KotORBase::kObjectTypeCreature, x, y, z);
+	creature.setSpatialIndex(&index);
+}
+
+GTEST_TEST(KotORBaseObject, setPositionMovesIndexEntry) {
+	Engines::SpatialIndex index;
+
+	TestCreature near, far;
+	addCreature(index, near,  1.0f,  1.0f, 0.0f);
+	addCreature(index, far , 80.0f, 80.0f, 0.0f);
+
+	std::vector<Aurora::NWScript::Object *> nearest;
+
+	index.findNearest(0.0f, 0.0f, 0.0f, Engines::KotORBase::kObjectTypeCreature, 1, nearest);
+	ASSERT_EQ(nearest.size(), 1);
+	EXPECT_EQ(nearest[0], &near);
+
+	// Jump the far creature, into another cell, right next to the origin
+	far.setPosition(0.5f, 0.0f, 0.0f);
+
+	index.findNearest(0.0f, 0.0f, 0.0f, Engines::KotORBase::kObjectTypeCreature, 1, nearest);
+	ASSERT_EQ(nearest.size(), 1);
+	EXPECT_EQ(nearest[0], &far);
+
+	// And away again
+	far.setPosition(-50.0f, 30.0f, 0.0f);
+
+	index.findNearest(0.0f, 0.0f, 0.0f, Engines::KotORBase::kObjectTypeCreature, 2, nearest);
+	ASSERT_EQ(nearest.size(), 2);
+	EXPECT_EQ(nearest[0], &near);
+	EXPECT_EQ(nearest[1], &far);
+
+	index.findNearest(-50.0f, 30.0f, 0.0f, Engines::KotORBase::kObjectTypeCreature, 1, nearest, 1.0f);
+	ASSERT_EQ(nearest.size(), 1);
+	EXPECT_EQ(nearest[0], &far);
+}
+
+GTEST_TEST(KotORBaseObject, setPositionOutsideIndex) {
+	Engines::SpatialIndex index;
+
+	TestCreature inside, outside;
+	addCreature(index, inside, 10.0f, 10.0f, 0.0f);
+
+	// An object that's not in an area doesn't end up in the index by moving
+	outside.setPosition(0.0f, 0.0f, 0.0f);
+	EXPECT_FALSE(index.has(outside));
+
+	// Nor does one that left it
+	inside.setSpatialIndex(0);
+	index.remove(inside);
+
+	inside.setPosition(0.0f, 0.0f, 0.0f);
+	EXPECT_FALSE(index.has(inside));
+	EXPECT_EQ(index.size(), 0);
+}
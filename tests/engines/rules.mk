@@ -34,3 +34,8 @@ check_PROGRAMS                     += tests/engines/test_trigger
 tests_engines_test_trigger_SOURCES  = tests/engines/trigger.cpp
 tests_engines_test_trigger_LDADD    = $(engines_LIBS)
 tests_engines_test_trigger_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                          += tests/engines/test_spatialindex
+tests_engines_test_spatialindex_SOURCES  = tests/engines/spatialindex.cpp
+tests_engines_test_spatialindex_LDADD    = $(engines_LIBS)
+tests_engines_test_spatialindex_CXXFLAGS = $(test_CXXFLAGS)
@@ -0,0 +1,286 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the Engines::SpatialIndex class.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/aurora/nwscript/object.h"
+
+#include "src/engines/aurora/spatialindex.h"
+
+typedef std::vector<Aurora::NWScript::Object *> ObjectList;
+
+static const uint32_t kTypeA = 1U << 0;
+static const uint32_t kTypeB = 1U << 1;
+
+GTEST_TEST(SpatialIndex, empty) {
+	Engines::SpatialIndex index;
+
+	EXPECT_EQ(index.size(), 0);
+
+	ObjectList objects;
+
+	index.findNearest(0.0f, 0.0f, 0.0f, Engines::SpatialIndex::kTypeAll, 5, objects);
+	EXPECT_TRUE(objects.empty());
+
+	index.findRegions(0.0f, 0.0f, Engines::SpatialIndex::kTypeAll, objects);
+	EXPECT_TRUE(objects.empty());
+}
+
+GTEST_TEST(SpatialIndex, findNearest) {
+	Engines::SpatialIndex index(10.0f);
+
+	Aurora::NWScript::Object objects[5];
+
+	index.add(objects[0], kTypeA,   1.0f,   0.0f, 0.0f);
+	index.add(objects[1], kTypeA,  25.0f,   0.0f, 0.0f);
+	index.add(objects[2], kTypeB,   3.0f,   0.0f, 0.0f);
+	index.add(objects[3], kTypeA, -40.0f, -40.0f, 0.0f);
+	index.add(objects[4], kTypeA,   0.0f,   0.0f, 5.0f);
+
+	EXPECT_EQ(index.size(), 5);
+	EXPECT_TRUE(index.has(objects[3]));
+
+	ObjectList nearest;
+
+	index.findNearest(0.0f, 0.0f, 0.0f, Engines::SpatialIndex::kTypeAll, 10, nearest);
+	ASSERT_EQ(nearest.size(), 5);
+	EXPECT_EQ(nearest[0], &objects[0]);
+	EXPECT_EQ(nearest[1], &objects[2]);
+	EXPECT_EQ(nearest[2], &objects[4]);
+	EXPECT_EQ(nearest[3], &objects[1]);
+	EXPECT_EQ(nearest[4], &objects[3]);
+
+	index.findNearest(0.0f, 0.0f, 0.0f, kTypeA, 2, nearest);
+	ASSERT_EQ(nearest.size(), 2);
+	EXPECT_EQ(nearest[0], &objects[0]);
+	EXPECT_EQ(nearest[1], &objects[4]);
+
+	index.findNearest(0.0f, 0.0f, 0.0f, kTypeB, 2, nearest);
+	ASSERT_EQ(nearest.size(), 1);
+	EXPECT_EQ(nearest[0], &objects[2]);
+
+	// Only within the radius
+	index.findNearest(0.0f, 0.0f, 0.0f, Engines::SpatialIndex::kTypeAll, 10, nearest, 4.0f);
+	ASSERT_EQ(nearest.size(), 2);
+	EXPECT_EQ(nearest[0], &objects[0]);
+	EXPECT_EQ(nearest[1], &objects[2]);
+
+	// Skip objects the filter rejects
+	index.findNearest(0.0f, 0.0f, 0.0f, Engines::SpatialIndex::kTypeAll, 1,
+	                  std::numeric_limits<float>::infinity(), nearest,
+	                  [&](Aurora::NWScript::Object *o) { return o != &objects[0]; });
+	ASSERT_EQ(nearest.size(), 1);
+	EXPECT_EQ(nearest[0], &objects[2]);
+
+	// Far outside of all objects
+	index.findNearest(1000.0f, 1000.0f, 0.0f, Engines::SpatialIndex::kTypeAll, 1, nearest);
+	ASSERT_EQ(nearest.size(), 1);
+	EXPECT_EQ(nearest[0], &objects[1]);
+}
+
+GTEST_TEST(SpatialIndex, findNearestTies) {
+	Engines::SpatialIndex index;
+
+	Aurora::NWScript::Object objects[3];
+
+	index.add(objects[2], kTypeA,  1.0f, 0.0f, 0.0f);
+	index.add(objects[0], kTypeA, -1.0f, 0.0f, 0.0f);
+	index.add(objects[1], kTypeA,  0.0f, 1.0f, 0.0f);
+
+	ObjectList nearest;
+	index.findNearest(0.0f, 0.0f, 0.0f, kTypeA, 3, nearest);
+
+	// Equally distant objects come in the order they were added
+	ASSERT_EQ(nearest.size(), 3);
+	EXPECT_EQ(nearest[0], &objects[2]);
+	EXPECT_EQ(nearest[1], &objects[0]);
+	EXPECT_EQ(nearest[2], &objects[1]);
+}
+
+GTEST_TEST(SpatialIndex, moveRemove) {
+	Engines::SpatialIndex index(10.0f);
+
+	Aurora::NWScript::Object objects[3];
+
+	index.add(objects[0], kTypeA,  5.0f, 5.0f, 0.0f);
+	index.add(objects[1], kTypeA, 15.0f, 5.0f, 0.0f);
+	index.add(objects[2], kTypeA, 95.0f, 5.0f, 0.0f);
+
+	ObjectList nearest;
+
+	index.move(objects[2], 6.0f, 5.0f, 0.0f);
+	index.findNearest(5.0f, 5.0f, 0.0f, kTypeA, 2, nearest);
+	ASSERT_EQ(nearest.size(), 2);
+	EXPECT_EQ(nearest[0], &objects[0]);
+	EXPECT_EQ(nearest[1], &objects[2]);
+
+	index.remove(objects[0]);
+	EXPECT_EQ(index.size(), 2);
+	EXPECT_FALSE(index.has(objects[0]));
+
+	index.findNearest(5.0f, 5.0f, 0.0f, kTypeA, 2, nearest);
+	ASSERT_EQ(nearest.size(), 2);
+	EXPECT_EQ(nearest[0], &objects[2]);
+	EXPECT_EQ(nearest[1], &objects[1]);
+
+	// Moving and removing unknown objects does nothing
+	index.move(objects[0], 0.0f, 0.0f, 0.0f);
+	index.remove(objects[0]);
+	EXPECT_EQ(index.size(), 2);
+
+	// Adding an object again moves it
+	index.add(objects[1], kTypeB, -50.0f, 0.0f, 0.0f);
+	EXPECT_EQ(index.size(), 2);
+
+	index.findNearest(-50.0f, 0.0f, 0.0f, kTypeB, 2, nearest);
+	ASSERT_EQ(nearest.size(), 1);
+	EXPECT_EQ(nearest[0], &objects[1]);
+
+	index.clear();
+	EXPECT_EQ(index.size(), 0);
+
+	index.findNearest(5.0f, 5.0f, 0.0f, kTypeA, 2, nearest);
+	EXPECT_TRUE(nearest.empty());
+}
+
+GTEST_TEST(SpatialIndex, findRegions) {
+	Engines::SpatialIndex index(10.0f);
+
+	Aurora::NWScript::Object objects[4];
+
+	index.addRegion(objects[0], kTypeA,  5.0f, 5.0f, 0.0f,   0.0f,  0.0f,   30.0f, 10.0f);
+	index.addRegion(objects[1], kTypeA, 15.0f, 5.0f, 0.0f,  10.0f,  0.0f,   20.0f, 10.0f);
+	index.addRegion(objects[2], kTypeB, 15.0f, 5.0f, 0.0f,  10.0f,  0.0f,   20.0f, 10.0f);
+	index.add      (objects[3], kTypeA, 15.0f, 5.0f, 0.0f);
+
+	ObjectList regions;
+
+	index.findRegions(15.0f, 5.0f, kTypeA, regions);
+	ASSERT_EQ(regions.size(), 2);
+	EXPECT_EQ(regions[0], &objects[0]);
+	EXPECT_EQ(regions[1], &objects[1]);
+
+	index.findRegions(15.0f, 5.0f, Engines::SpatialIndex::kTypeAll, regions);
+	ASSERT_EQ(regions.size(), 3);
+	EXPECT_EQ(regions[2], &objects[2]);
+
+	index.findRegions(25.0f, 5.0f, Engines::SpatialIndex::kTypeAll, regions);
+	ASSERT_EQ(regions.size(), 1);
+	EXPECT_EQ(regions[0], &objects[0]);
+
+	index.findRegions(25.0f, 15.0f, Engines::SpatialIndex::kTypeAll, regions);
+	EXPECT_TRUE(regions.empty());
+
+	// The rectangle moves along with the region
+	index.move(objects[0], 5.0f, 105.0f, 0.0f);
+
+	index.findRegions(25.0f, 105.0f, Engines::SpatialIndex::kTypeAll, regions);
+	ASSERT_EQ(regions.size(), 1);
+	EXPECT_EQ(regions[0], &objects[0]);
+
+	index.findRegions(25.0f, 5.0f, Engines::SpatialIndex::kTypeAll, regions);
+	EXPECT_TRUE(regions.empty());
+
+	index.remove(objects[1]);
+
+	index.findRegions(15.0f, 5.0f, Engines::SpatialIndex::kTypeAll, regions);
+	ASSERT_EQ(regions.size(), 1);
+	EXPECT_EQ(regions[0], &objects[2]);
+}
+
+GTEST_TEST(SpatialIndex, findRegionsLarge) {
+	Engines::SpatialIndex index(1.0f);
+
+	Aurora::NWScript::Object objects[2];
+
+	index.addRegion(objects[0], kTypeA, 0.0f, 0.0f, 0.0f, -1000.0f, -1000.0f, 1000.0f, 1000.0f);
+	index.addRegion(objects[1], kTypeA, 0.0f, 0.0f, 0.0f,    -1.0f,    -1.0f,    1.0f,    1.0f);
+
+	ObjectList regions;
+
+	index.findRegions(0.5f, 0.5f, kTypeA, regions);
+	ASSERT_EQ(regions.size(), 2);
+	EXPECT_EQ(regions[0], &objects[0]);
+	EXPECT_EQ(regions[1], &objects[1]);
+
+	index.findRegions(500.0f, -500.0f, kTypeA, regions);
+	ASSERT_EQ(regions.size(), 1);
+	EXPECT_EQ(regions[0], &objects[0]);
+
+	index.remove(objects[0]);
+
+	index.findRegions(500.0f, -500.0f, kTypeA, regions);
+	EXPECT_TRUE(regions.empty());
+}
+
+GTEST_TEST(SpatialIndex, findNearestRandom) {
+	static const size_t kObjectCount = 500;
+
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+
+	Engines::SpatialIndex index(8.0f);
+
+	std::vector<Aurora::NWScript::Object> objects(kObjectCount);
+	std::vector<float> positions(kObjectCount * 3);
+
+	for (size_t i = 0; i < kObjectCount; i++) {
+		for (size_t j = 0; j < 3; j++)
+			positions[i * 3 + j] = coordinate(rng) * ((j == 2) ? 0.1f : 1.0f);
+
+		index.add(objects[i], (i % 3) ? kTypeA : kTypeB, positions[i * 3 + 0], positions[i * 3 + 1], positions[i * 3 + 2]);
+	}
+
+	for (size_t q = 0; q < 100; q++) {
+		const float x = coordinate(rng) * 1.2f;
+		const float y = coordinate(rng) * 1.2f;
+		const float z = 0.0f;
+
+		// Brute force: sort all objects of type A by distance
+		std::vector<std::pair<float, size_t>> expected;
+		for (size_t i = 0; i < kObjectCount; i++) {
+			if (!(i % 3))
+				continue;
+
+			const float dX = positions[i * 3 + 0] - x;
+			const float dY = positions[i * 3 + 1] - y;
+			const float dZ = positions[i * 3 + 2] - z;
+
+			expected.push_back(std::make_pair(dX * dX + dY * dY + dZ * dZ, i));
+		}
+
+		std::sort(expected.begin(), expected.end());
+
+		ObjectList nearest;
+		index.findNearest(x, y, z, kTypeA, 8, nearest);
+
+		ASSERT_EQ(nearest.size(), 8) << "At query " << q;
+		for (size_t i = 0; i < nearest.size(); i++)
+			EXPECT_EQ(nearest[i], &objects[expected[i].second]) << "At query " << q << ", object " << i;
+	}
+}
@@ -0,0 +1,157 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the texture manager.
+ */
+
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/error.h"
+#include "src/common/threads.h"
+#include "src/common/platform.h"
+#include "src/common/writefile.h"
+
+#include "src/aurora/resman.h"
+
+#include "src/graphics/images/txi.h"
+
+#include "src/graphics/aurora/textureman.h"
+#include "src/graphics/aurora/texturehandle.h"
+#include "src/graphics/aurora/texture.h"
+
+/** A 2x2 TGA, 32 bits per pixel. */
+static const byte kGoodTGA[] = {
+	0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x00, 0x02, 0x00, 0x20, 0x08,
+	0x00, 0x00, 0xFF, 0x80, 0x00, 0xFF, 0x00, 0x80, 0xFF, 0x00, 0x00, 0x80, 0xFF, 0xFF, 0xFF, 0x80
+};
+
+/** A TGA of an image type that doesn't exist. */
+static const byte kBrokenTGA[] = {
+	0x00, 0x00, 0x63, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x00, 0x02, 0x00, 0x20, 0x08,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static boost::filesystem::path kDirectoryPath;
+
+static void writeFile(const char *name, const byte *data, size_t size) {
+	Common::WriteFile file((kDirectoryPath / name).generic_string());
+
+	file.write(data, size);
+	file.flush();
+}
+
+class TextureManager : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		// get() swaps in decoded images with the frame locked, which needs to know the main thread
+		if (!Common::initedThreads())
+			Common::initThreads();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kDirectoryPath = tmpPath / uniquePath;
+		boost::filesystem::create_directory(kDirectoryPath);
+
+		writeFile("good.tga"  , kGoodTGA  , sizeof(kGoodTGA));
+		writeFile("broken.tga", kBrokenTGA, sizeof(kBrokenTGA));
+
+		ResMan.registerDataBase(kDirectoryPath.generic_string());
+		ResMan.indexResourceDir("", 0, 0, 100);
+	}
+
+	static void TearDownTestCase() {
+		TextureMan.clear();
+		ResMan.clear();
+
+		if (!kDirectoryPath.empty())
+			boost::filesystem::remove_all(kDirectoryPath);
+	}
+};
+
+GTEST_TEST_F(TextureManager, getAsync) {
+	std::vector<Graphics::Aurora::TextureHandle> handles;
+	handles.push_back(TextureMan.getAsync("good"));
+	handles.push_back(TextureMan.getAsync("good"));
+
+	ASSERT_FALSE(handles[0].empty());
+	EXPECT_EQ(&handles[0].getTexture(), &handles[1].getTexture());
+
+	TextureMan.waitFor(handles);
+	EXPECT_NO_THROW(TextureMan.waitFor(handles[0]));
+
+	// The image isn't swapped in yet, but its properties are known already
+	bool alpha = false;
+	Graphics::TXI::Features features;
+	handles[0].getTexture().getProperties(alpha, features);
+
+	EXPECT_TRUE(alpha);
+	EXPECT_FALSE(features.decal);
+
+	// get() swaps in the image right away
+	Graphics::Aurora::TextureHandle handle = TextureMan.get("good");
+	EXPECT_EQ(&handle.getTexture(), &handles[0].getTexture());
+
+	EXPECT_EQ(handle.getTexture().getWidth() , 2);
+	EXPECT_EQ(handle.getTexture().getHeight(), 2);
+	EXPECT_TRUE(handle.getTexture().hasAlpha());
+}
+
+GTEST_TEST_F(TextureManager, getAsyncBroken) {
+	// Opening the resources works, decoding the image doesn't
+	Graphics::Aurora::TextureHandle handle1 = TextureMan.getAsync("broken");
+	Graphics::Aurora::TextureHandle handle2 = TextureMan.getAsync("broken");
+
+	ASSERT_FALSE(handle1.empty());
+	EXPECT_EQ(&handle1.getTexture(), &handle2.getTexture());
+
+	std::vector<Graphics::Aurora::TextureHandle> handles;
+	handles.push_back(handle1);
+	handles.push_back(handle2);
+
+	EXPECT_NO_THROW(TextureMan.waitFor(handles));
+
+	// Everybody waiting for the texture gets the error, not only the first one
+	EXPECT_THROW(TextureMan.waitFor(handle1), Common::Exception);
+	EXPECT_THROW(TextureMan.waitFor(handle2), Common::Exception);
+
+	// And so does everybody asking for it while it's still around
+	EXPECT_THROW(TextureMan.get("broken"), Common::Exception);
+	EXPECT_THROW(TextureMan.getAsync("broken"), Common::Exception);
+
+	handles.clear();
+	handle1.clear();
+	handle2.clear();
+
+	EXPECT_FALSE(TextureMan.hasTexture("broken"));
+
+	// Once it's gone, asking for it tries again, and fails again
+	EXPECT_THROW(TextureMan.get("broken"), Common::Exception);
+	EXPECT_FALSE(TextureMan.hasTexture("broken"));
+}
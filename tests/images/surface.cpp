@@ -114,3 +114,43 @@ GTEST_TEST(Surface, isCubeMap) {
 
 	EXPECT_FALSE(surface.isCubeMap());
 }
+
+GTEST_TEST(Surface, generateMipMaps) {
+	Graphics::Surface surface(4, 2);
+
+	// Columns alternating between 0x00 and 0xFF in the first channel, 0x40 in the others
+	byte *data = surface.getData();
+	for (int i = 0; i < 4 * 2; i++) {
+		data[i * 4 + 0] = (i & 1) ? 0xFF : 0x00;
+		data[i * 4 + 1] = 0x40;
+		data[i * 4 + 2] = 0x40;
+		data[i * 4 + 3] = 0x40;
+	}
+
+	surface.generateMipMaps();
+
+	ASSERT_EQ(surface.getMipMapCount(), 3);
+
+	const Graphics::ImageDecoder &image = surface;
+
+	EXPECT_EQ(image.getMipMap(1).width , 2);
+	EXPECT_EQ(image.getMipMap(1).height, 1);
+	EXPECT_EQ(image.getMipMap(1).size  , 2 * 1 * 4);
+
+	EXPECT_EQ(image.getMipMap(2).width , 1);
+	EXPECT_EQ(image.getMipMap(2).height, 1);
+	EXPECT_EQ(image.getMipMap(2).size  , 1 * 1 * 4);
+
+	for (size_t i = 1; i < 3; i++) {
+		const byte *mipData = image.getMipMap(i).data.get();
+
+		EXPECT_EQ(mipData[0], 0x80) << "At mip map " << i;
+		EXPECT_EQ(mipData[1], 0x40) << "At mip map " << i;
+		EXPECT_EQ(mipData[2], 0x40) << "At mip map " << i;
+		EXPECT_EQ(mipData[3], 0x40) << "At mip map " << i;
+	}
+
+	// Images that already have mip maps are left alone
+	surface.generateMipMaps();
+	EXPECT_EQ(surface.getMipMapCount(), 3);
+}